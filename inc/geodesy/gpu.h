@@ -3,6 +3,7 @@
 
 // Configuration for library
 #include "gpu/config.h"
+#include "gpu/worker_pool.h"
 
 #include "gpu/device.h"
 #include "gpu/resource.h"
@@ -17,6 +18,7 @@
 #include "gpu/command_buffer.h"
 #include "gpu/command_pool.h"
 #include "gpu/command_batch.h"
+#include "gpu/barrier_batch.h"
 // ----- GPU Resource Types ----- //
 // Explanation of resource types:
 //      - A resource is a handle to a GPU object.
@@ -26,7 +28,10 @@
 // textures, and image outputs for rendering.
 #include "gpu/buffer.h"
 #include "gpu/image.h"
+#include "gpu/pixel.h"
+#include "gpu/ktx2.h"
 #include "gpu/acceleration_structure.h"
+#include "gpu/shader_cache.h"
 #include "gpu/shader.h" // Not Actually GPU Resource, no context required for creation.
 // ----- GPU Metaresources ----- //
 // Explanation of meta resources:
@@ -39,6 +44,13 @@
 #include "gpu/descriptor.h"
 #include "gpu/framebuffer.h"
 #include "gpu/pipeline.h"
+#include "gpu/pipeline_builder.h"
+#include "gpu/culler.h"
+#include "gpu/mip_generator.h"
+#include "gpu/texture_streamer.h"
+#include "gpu/readback_ring.h"
+#include "gpu/command_recorder.h"
+#include "gpu/render_graph.h"
 #include "gpu/framechain.h"
 #include "gpu/executable_call.h"
 #include "gpu/context.h"
@@ -16,7 +16,19 @@ namespace geodesy::gpu {
 	class acceleration_structure : public resource {
 	public:
 
-		std::shared_ptr<buffer> Buffer;
+		// One bottom level acceleration structure of create_batch(), arguments of the mesh constructor.
+		struct geometry {
+			std::shared_ptr<buffer> 		VertexBuffer;
+			size_t 							VertexPositionOffset;
+			VkFormat 						VertexPositionFormat;
+			size_t 							VertexStride;
+			size_t 							VertexCount;
+			std::shared_ptr<buffer> 		IndexBuffer;
+			VkIndexType 					IndexType;
+			size_t 							TriangleCount;
+		};
+
+		std::shared_ptr<buffer> Buffer; 			// May be shared with others created by the same create_batch().
 		std::shared_ptr<buffer> UpdateScratchBuffer;
 		std::shared_ptr<buffer> BuildScratchBuffer;
 		std::shared_ptr<buffer> InstanceBuffer;
@@ -41,6 +53,13 @@ namespace geodesy::gpu {
 		);
 		~acceleration_structure();
 
+		// Builds many bottom level acceleration structures in one submission. Storage is sub-allocated from
+		// shared buffers, and the builds are issued in as few vkCmdBuildAccelerationStructuresKHR calls as a
+		// shared scratch buffer of aScratchSize bytes allows, the scratch buffer only grows past that for a
+		// single geometry needing more. Structures that fail to create are left nullptr
+		// in aAccelerationStructure, and the first error is returned.
+		static VkResult create_batch(std::shared_ptr<context> aContext, const std::vector<geometry>& aGeometry, std::vector<std::shared_ptr<acceleration_structure>>& aAccelerationStructure, size_t aScratchSize = 1 << 27);
+
 		VkDeviceAddress device_address() const;
 
 	};
@@ -0,0 +1,49 @@
+#pragma once
+#ifndef GEODESY_GPU_BARRIER_BATCH_H
+#define GEODESY_GPU_BARRIER_BATCH_H
+
+#include "config.h"
+
+#include "command_buffer.h"
+
+namespace geodesy::gpu {
+
+	// Collects the barriers required by several images and buffers, see image::require() and
+	// buffer::require(), and records all of them with a single vkCmdPipelineBarrier.
+	class barrier_batch {
+	public:
+
+		// Synchronization state of a buffer, or of a single mip level of a single array layer.
+		struct state {
+			unsigned int 				Layout; 			// Unused for buffers.
+			VkPipelineStageFlags 		WriteStage; 		// Last write or layout transition.
+			VkAccessFlags 				WriteAccess; 		// Zero once made available by a layout transition.
+			VkPipelineStageFlags 		ReadStage; 			// Reads since the last write.
+			VkAccessFlags 				ReadAccess; 		// Access types already made visible to ReadStage.
+			state();
+			state(unsigned int aLayout);
+		};
+
+		VkPipelineStageFlags 					SrcStage;
+		VkPipelineStageFlags 					DstStage;
+		std::vector<VkBufferMemoryBarrier> 		BufferBarrier;
+		std::vector<VkImageMemoryBarrier> 		ImageBarrier;
+
+		barrier_batch();
+
+		static bool is_write(VkAccessFlags aAccess);
+		// Advances aState past an access, returns true with the source scope if a barrier must precede it.
+		static bool access(state& aState, unsigned int aLayout, VkAccessFlags aAccess, VkPipelineStageFlags aStage, VkPipelineStageFlags& aSrcStage, VkAccessFlags& aSrcAccess);
+		// Advances aState past an access that was synchronized by the caller.
+		static void track(state& aState, unsigned int aLayout, VkAccessFlags aAccess, VkPipelineStageFlags aStage);
+
+		bool empty() const;
+		void clear();
+		// Records the collected barriers if any, and clears the batch.
+		void record(command_buffer* aCommandBuffer);
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_BARRIER_BATCH_H
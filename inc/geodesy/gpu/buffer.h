@@ -24,6 +24,7 @@
 #include "command_buffer.h"
 #include "command_pool.h"
 #include "command_batch.h"
+#include "barrier_batch.h"
 
 namespace geodesy::gpu {
 
@@ -86,6 +87,8 @@ namespace geodesy::gpu {
 
 		void* Ptr;
 
+		barrier_batch::state State; 		// Last accesses, tracked for the whole buffer.
+
 		buffer();
 		buffer(std::shared_ptr<context> aContext, create_info aCreateInfo, size_t aBufferSize, void* aBufferData = NULL);
 		buffer(std::shared_ptr<context> aContext, unsigned int aMemoryType, unsigned int aBufferUsage, size_t aBufferSize, void* aBufferData = NULL);
@@ -121,6 +124,15 @@ namespace geodesy::gpu {
 			size_t aOffset = 0, size_t aSize = UINT32_MAX
 		) const;
 
+		// Appends a barrier before accessing the buffer with aAccess at aStage, only if one is needed. Accesses
+		// are tracked for the whole buffer, and so the barrier covers the whole buffer.
+		void require(barrier_batch& aBarrier, VkAccessFlags aAccess, VkPipelineStageFlags aStage);
+		void require(command_buffer* aCommandBuffer, VkAccessFlags aAccess, VkPipelineStageFlags aStage);
+		// Records an access the caller already synchronized.
+		void track(VkAccessFlags aAccess, VkPipelineStageFlags aStage);
+		// Every recorded access has completed, after a host wait on its submission.
+		void reset_access();
+
 		VkMemoryRequirements memory_requirements() const;
 
 	};
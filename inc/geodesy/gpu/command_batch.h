@@ -20,6 +20,10 @@ namespace geodesy::gpu {
 		std::vector<std::shared_ptr<semaphore>> WaitSemaphoreList;
 		std::vector<VkPipelineStageFlags> WaitStageList;
 		std::vector<std::shared_ptr<semaphore>> SignalSemaphoreList;
+		// Timeline values, parallel to the semaphore lists. Left empty when only binary semaphores are used,
+		// entries of binary semaphores are ignored.
+		std::vector<uint64_t> WaitValueList;
+		std::vector<uint64_t> SignalValueList;
 
 		command_batch();
 		command_batch(std::vector<std::shared_ptr<command_buffer>> aCommandBufferList);
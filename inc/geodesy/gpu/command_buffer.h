@@ -5,28 +5,89 @@
 
 #include "resource.h"
 
+#include <optional>
+
 namespace geodesy::gpu {
 
+	class framebuffer;
+	class image;
+
 	class command_buffer : public resource {
 	public:
 
+		// Overrides of a rasterizer pipeline's baked state, applied on every bind() of that pipeline.
+		struct dynamic_state {
+			std::optional<VkCullModeFlags> 				CullMode;
+			std::optional<VkFrontFace> 					FrontFace;
+			std::optional<VkPrimitiveTopology> 			PrimitiveTopology;
+			std::optional<bool> 						DepthTestEnable;
+			std::optional<bool> 						DepthWriteEnable;
+			std::optional<VkCompareOp> 					DepthCompareOp;
+			std::optional<bool> 						PrimitiveRestartEnable;
+			std::optional<VkPolygonMode> 				PolygonMode;
+			std::map<uint32_t, bool> 					BlendEnable;
+		};
+
+		// Render pass subpass or dynamic rendering scope a secondary command buffer is executed in.
+		struct inheritance {
+			VkRenderPass 								RenderPass; 				// VK_NULL_HANDLE continues a dynamic rendering scope.
+			uint32_t 									Subpass;
+			VkFramebuffer 								Framebuffer; 				// Optional.
+			std::vector<VkFormat> 						ColorAttachmentFormat; 		// Dynamic rendering only, as are the two below.
+			VkFormat 									DepthAttachmentFormat;
+			VkFormat 									StencilAttachmentFormat;
+			VkSampleCountFlagBits 						RasterizationSamples;
+			inheritance();
+		};
+
+		// Attachment of an open dynamic rendering scope or render pass.
+		struct rendering_attachment {
+			std::shared_ptr<image> 						Image;
+			VkImageLayout 								Layout; 			// Layout while rendering, the initial layout for render passes.
+			VkImageLayout 								FinalLayout; 		// Layout after end().
+		};
+
 		std::shared_ptr<command_pool> CommandPool;
 
+		VkCommandBufferLevel Level;
 		VkCommandBuffer Handle;
 
+		// Recording state kept by the pipelines recorded into this command buffer, cleared by every begin().
+		bool RenderPassSkipped; 		// The open render pass or rendering scope was not begun, its end() is skipped as well.
+		std::map<const pipeline*, dynamic_state> DynamicState;
+		bool RenderingScope; 			// The open scope was begun with vkCmdBeginRendering rather than a render pass.
+		std::vector<rendering_attachment> RenderingAttachment;
+
 		command_buffer();
 		command_buffer(std::shared_ptr<context> aContext, std::shared_ptr<command_pool> aCommandPool, VkCommandBufferLevel aLevel = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 		virtual ~command_buffer();
 
 		VkResult begin();
+		// Secondary command buffers, continue the render pass subpass they will be executed in.
+		VkResult begin(VkRenderPass aRenderPass, uint32_t aSubpass, VkFramebuffer aFramebuffer = VK_NULL_HANDLE);
+		// Secondary command buffers, continue a dynamic rendering scope with these attachment formats.
+		VkResult begin(std::vector<VkFormat> aColorAttachmentFormat, VkFormat aDepthStencilAttachmentFormat, VkSampleCountFlagBits aSampleCount = VK_SAMPLE_COUNT_1_BIT);
+		// Secondary command buffers, continue the render pass subpass or dynamic rendering scope described.
+		VkResult begin(const inheritance& aInheritance);
+		// Secondary command buffers, inherits whichever of the two a rasterizer pipeline was created for.
+		VkResult begin(std::shared_ptr<pipeline> aPipeline, std::shared_ptr<framebuffer> aFramebuffer = nullptr);
+		// What a secondary recording aPipeline into aFramebuffer, or into its dynamic rendering scope, inherits.
+		static VkResult inheritance_of(std::shared_ptr<pipeline> aPipeline, std::shared_ptr<framebuffer> aFramebuffer, inheritance& aInheritance);
 		VkResult end();
 
+		// Primary command buffers, the render pass or dynamic rendering scope must have been begun with secondary contents.
+		void execute(std::vector<std::shared_ptr<command_buffer>> aCommandBufferList);
+
 		void bind_vertex_buffers(VkCommandBuffer aCommandBuffer, std::vector<VkBuffer> aBufferList, const VkDeviceSize* aOffset = NULL);
 		void bind_index_buffer(VkCommandBuffer aCommandBuffer, VkBuffer aBufferHandle, VkIndexType aIndexType);
 		void bind_descriptor_sets(VkCommandBuffer aCommandBuffer, VkPipelineBindPoint aPipelineBindPoint, VkPipelineLayout aPipelineLayout, std::vector<VkDescriptorSet> aDescriptorSetList, std::vector<uint32_t> aDynamicOffsetList = std::vector<uint32_t>(0));
 		void bind_pipeline(VkCommandBuffer aCommandBuffer, VkPipelineBindPoint aPipelineBindPoint, VkPipeline aPipelineHandle);
 		void draw_indexed(VkCommandBuffer aCommandBuffer, uint32_t aIndexCount, uint32_t aInstanceCount = 1, uint32_t aFirstIndex = 0, uint32_t aVertexOffset = 0, uint32_t aFirstInstance = 0);
 
+	private:
+
+		void clear_recording_state();
+
 	};
 	
 }
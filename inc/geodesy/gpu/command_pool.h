@@ -12,6 +12,7 @@ namespace geodesy::gpu {
 	public:
 
 		VkCommandPool                   Handle;
+		VkCommandPoolCreateFlags        Flags;
 
 		command_pool();
 		command_pool(std::shared_ptr<context> aContext, unsigned int aOperation, VkCommandPoolCreateFlags aFlags = 0);
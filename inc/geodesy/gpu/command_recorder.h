@@ -0,0 +1,53 @@
+#pragma once
+#ifndef GEODESY_GPU_COMMAND_RECORDER_H
+#define GEODESY_GPU_COMMAND_RECORDER_H
+
+#include "config.h"
+
+#include "worker_pool.h"
+#include "command_buffer.h"
+#include "command_pool.h"
+#include "framebuffer.h"
+#include "pipeline.h"
+
+#include <functional>
+
+namespace geodesy::gpu {
+
+	// Records a list of draws in parallel. The list is split into one contiguous range per worker,
+	// each range is recorded into a secondary command buffer allocated from that range's own pool,
+	// and the secondaries are executed in order into the primary command buffer.
+	class command_recorder {
+	public:
+
+		// Records draws [aBegin, aEnd) into a secondary that is already begun, with the pipeline bound and the
+		// primary's dynamic state overrides applied. Viewport, scissor and resources must still be set.
+		typedef std::function<void(command_buffer* aCommandBuffer, size_t aBegin, size_t aEnd)> record_function;
+
+		std::shared_ptr<context> 							Context;
+		std::shared_ptr<worker_pool> 						WorkerPool;
+		std::vector<std::shared_ptr<command_pool>> 			CommandPool; 		// One per range.
+		std::vector<std::shared_ptr<command_buffer>> 		CommandBuffer; 		// Secondaries recorded since the last reset().
+
+		command_recorder();
+		command_recorder(std::shared_ptr<context> aContext, std::shared_ptr<worker_pool> aWorkerPool, unsigned int aOperation = device::operation::GRAPHICS);
+
+		// Must be called from inside a render pass or dynamic rendering scope of aPipeline begun with
+		// VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS. Ranges smaller than aMinBatchSize are merged.
+		VkResult record(
+			command_buffer* 						aPrimary,
+			std::shared_ptr<pipeline> 				aPipeline,
+			std::shared_ptr<framebuffer> 			aFramebuffer,
+			size_t 									aDrawCount,
+			record_function 						aRecord,
+			size_t 									aMinBatchSize = 64
+		);
+
+		// Frees every secondary and resets the pools. Only once the primaries they were executed in have completed.
+		VkResult reset();
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_COMMAND_RECORDER_H
@@ -19,6 +19,9 @@
 #include "acceleration_structure.h"
 #include "pipeline.h"
 #include "framechain.h"
+#include "worker_pool.h"
+
+#include <shared_mutex>
 
 namespace geodesy::gpu {
 
@@ -37,8 +40,25 @@ namespace geodesy::gpu {
 		std::shared_ptr<device> Device;
 
 		std::map<unsigned int, queue> Queue;
+		std::set<std::string> Extensions; 		// Enabled device extensions.
+		bool DynamicRendering; 					// Dynamic rendering feature enabled, rasterizers skip render pass and framebuffer objects.
+		bool GraphicsPipelineLibrary; 			// Graphics pipeline library feature enabled, rasterizers are linked from shared parts.
+		bool ExtendedDynamicState; 				// Extended dynamic state feature enabled, cull mode, front face, topology and depth states.
+		bool ExtendedDynamicState2; 			// Extended dynamic state 2 feature enabled, primitive restart enable.
+		bool DynamicPolygonMode; 				// Extended dynamic state 3 polygon mode feature enabled.
+		bool DynamicColorBlendEnable; 			// Extended dynamic state 3 color blend enable feature enabled.
+		bool MultiDraw; 						// Multi draw feature enabled, draws of one call are split by MaxMultiDrawCount.
+		uint32_t MaxMultiDrawCount;
+		bool TimelineSemaphore; 				// Timeline semaphore feature enabled, needed by framechain.
+		bool ImageViewMinLod; 					// Image view min LOD feature enabled, views can clamp sampling to a resident mip level.
 		VkDevice Handle;
 
+		// Driver side pipeline cache shared by every pipeline created from this context.
+		VkPipelineCache PipelineCache;
+		std::string PipelineCachePath;
+		// Held shared while pipelines are created against PipelineCache, exclusive while merging into it.
+		std::shared_mutex PipelineCacheMutex;
+
 		context();
 		context(
 			std::shared_ptr<instance> aInstance,
@@ -51,6 +71,9 @@ namespace geodesy::gpu {
 		~context();
 
 		void* function_pointer(std::string aFunctionName) const;
+		bool extension_enabled(std::string aExtensionName) const;
+		// Background host work such as link time optimized pipelines, created on first use.
+		std::shared_ptr<worker_pool> get_worker_pool();
 
 		VkMemoryRequirements get_buffer_memory_requirements(VkBuffer aBufferHandle) const;
 		VkMemoryRequirements get_image_memory_requirements(VkImage aImageHandle) const;
@@ -59,6 +82,30 @@ namespace geodesy::gpu {
 
 		queue get_execution_queue(unsigned int aOperation);
 
+		// Seeds the pipeline cache from disk, rejects data not produced by this device. Returns VK_INCOMPLETE if no usable data was found.
+		VkResult load_pipeline_cache(std::string aFilePath);
+		// Writes the pipeline cache to disk, defaults to the path it was loaded from. Also called on destruction.
+		VkResult save_pipeline_cache(std::string aFilePath = "");
+		// True if aData starts with a pipeline cache header written by the device described by aProperties.
+		static bool valid_pipeline_cache(const std::vector<uint8_t>& aData, const VkPhysicalDeviceProperties& aProperties);
+
+		// Graphics pipeline library parts shared by every pipeline, keyed by a hash of the state they were built from.
+		VkPipeline find_pipeline_library(uint64_t aKey);
+		// Takes ownership. If another thread inserted the same key first, aLibrary is destroyed and the existing part returned.
+		VkPipeline insert_pipeline_library(uint64_t aKey, VkPipeline aLibrary);
+
+		// Single subpass render pass, shared by every caller with identical attachment descriptions. Owned by the context.
+		VkRenderPass create_render_pass(std::vector<VkAttachmentDescription> aColorAttachment, VkAttachmentDescription aDepthStencilAttachment);
+		// Framebuffer keyed by render pass, images, their view generations and resolution. The handle is owned by
+		// the context and evicted once any of its images is destroyed, the returned object only references it.
+		// Render passes not created by create_render_pass() get a framebuffer owned by the returned object.
+		std::shared_ptr<framebuffer> create_framebuffer(VkRenderPass aRenderPass, std::vector<std::shared_ptr<image>> aImage, std::array<unsigned int, 3> aResolution);
+		// Destroys the cached framebuffers attached to aImage, called when its view or handle is destroyed.
+		void evict_framebuffers(const image* aImage);
+		// Compute pipeline built from GLSL source, shared by every caller with identical source for as long as
+		// any of them holds it. Only weakly referenced here, pipelines hold their context.
+		std::shared_ptr<pipeline> create_compute_pipeline(std::string aSource);
+
 		VkResult wait();
 		VkResult wait(device::operation aDeviceOperation);
 		VkResult wait(std::shared_ptr<fence> aFence);
@@ -87,6 +134,36 @@ namespace geodesy::gpu {
 
 		PFN_vkGetDeviceProcAddr vkGetDeviceProcAddr;
 
+		struct render_pass_entry {
+			VkRenderPass 								Handle;
+			std::vector<VkAttachmentDescription> 		ColorAttachment;
+			VkAttachmentDescription 					DepthStencilAttachment;
+		};
+
+		struct framebuffer_entry {
+			VkFramebuffer 								Handle;
+			VkRenderPass 								RenderPass;
+			std::vector<const image*> 					Image;
+			std::vector<uint64_t> 						ViewGeneration;
+			std::array<unsigned int, 3> 				Resolution;
+		};
+
+		std::mutex WorkerPoolMutex;
+		std::shared_ptr<worker_pool> WorkerPool;
+
+		std::mutex PipelineLibraryMutex;
+		std::map<uint64_t, VkPipeline> PipelineLibrary;
+
+		std::mutex RenderPassMutex;
+		std::multimap<uint64_t, render_pass_entry> RenderPass;
+
+		std::mutex FramebufferMutex;
+		std::multimap<uint64_t, framebuffer_entry> Framebuffer;
+		std::set<const image*> FramebufferImage; 		// Images attached to at least one cached framebuffer.
+
+		std::mutex ComputePipelineMutex;
+		std::map<uint64_t, std::weak_ptr<pipeline>> ComputePipeline;
+
 	};
 
 }
@@ -0,0 +1,96 @@
+#pragma once
+#ifndef GEODESY_GPU_CULLER_H
+#define GEODESY_GPU_CULLER_H
+
+#include "config.h"
+
+#include "buffer.h"
+#include "image.h"
+#include "descriptor.h"
+#include "pipeline.h"
+
+namespace geodesy::gpu {
+
+	// GPU driven culling stage. Tests every instance against the camera frustum and, optionally, a
+	// hierarchical depth pyramid built from the previous frame's depth image, then compacts the
+	// visible ones into an indexed indirect draw buffer and a draw count for draw_indexed_indirect_count.
+	class culler : public resource {
+	public:
+
+		// One culled instance, matches the std430 layout used by the culling shader.
+		struct instance {
+			float 		Center[3]; 			// World space bounding sphere.
+			float 		Radius;
+			float 		Extent[3]; 			// Half extent of an axis aligned box around Center, zero tests the sphere only.
+			uint32_t 	InstanceIndex; 		// Written to firstInstance, indexes per instance data in the vertex shader.
+			uint32_t 	IndexCount;
+			uint32_t 	FirstIndex;
+			int32_t 	VertexOffset;
+			uint32_t 	Padding;
+		};
+
+		size_t 										MaxInstanceCount;
+		uint32_t 									FrameLatency; 		// build_hiz() calls before a replaced pyramid is released.
+		std::shared_ptr<buffer> 					InstanceBuffer; 	// instance[MaxInstanceCount], filled by the caller.
+		std::shared_ptr<buffer> 					DrawBuffer; 		// VkDrawIndexedIndirectCommand[MaxInstanceCount].
+		std::shared_ptr<buffer> 					CountBuffer; 		// Single uint32_t draw count.
+		std::shared_ptr<image> 						HiZ; 				// R32_SFLOAT max depth pyramid, nullptr until build_hiz().
+
+		culler();
+		culler(std::shared_ptr<context> aContext, size_t aMaxInstanceCount, uint32_t aFrameLatency = 3);
+		~culler();
+
+		// Gribb-Hartmann extraction of the inward facing, normalized left, right, bottom, top, near and far
+		// planes from a column major view projection with a 0 to 1 clip depth range.
+		static void frustum_planes(const float aViewProjection[16], float aPlane[6][4]);
+
+		// Reduces a depth image into the depth pyramid, recreating it when the resolution changes. The depth
+		// image must be sampleable, it is returned to aDepthLayout afterwards. Assumes a 0 near, 1 far depth range.
+		void build_hiz(command_buffer* aCommandBuffer, std::shared_ptr<image> aDepth, image::layout aDepthLayout);
+		// Culls the first aInstanceCount instances. aViewProjection is column major, clip = ViewProjection * world.
+		// Occlusion culling is used when aOcclusion is set and a depth pyramid exists. Must be recorded outside a render pass.
+		void cull(command_buffer* aCommandBuffer, const float aViewProjection[16], uint32_t aInstanceCount, bool aOcclusion = false);
+		// Draws the compacted instances with a pipeline already bound through pipeline::bind().
+		void draw(command_buffer* aCommandBuffer, std::shared_ptr<pipeline> aPipeline);
+
+	private:
+
+		// std140 view data, mirrors the culling shader uniform block.
+		struct view {
+			float 		ViewProjection[16];
+			float 		Plane[6][4]; 		// Inward facing, normalized.
+			uint32_t 	InstanceCount;
+			uint32_t 	HiZLevelCount; 		// Zero disables the occlusion test.
+			uint32_t 	HiZWidth;
+			uint32_t 	HiZHeight;
+		};
+
+		std::shared_ptr<buffer> 							ViewBuffer;
+		std::shared_ptr<pipeline> 							CullPipeline;
+		std::shared_ptr<pipeline> 							OcclusionPipeline;
+		std::shared_ptr<pipeline> 							ReducePipeline;
+		std::shared_ptr<descriptor::array> 					CullDescriptor;
+		std::shared_ptr<descriptor::array> 					OcclusionDescriptor;
+		std::vector<std::shared_ptr<descriptor::array>> 	ReduceDescriptor; 	// One per pyramid level.
+		std::vector<VkImageView> 							HiZView; 			// Single level views of HiZ.
+		VkImageView 										DepthView; 			// Depth view the first level was bound to.
+
+		// A replaced pyramid, or first level set, released once the frames that may still use it have completed.
+		struct retired {
+			uint64_t 											Build;
+			std::shared_ptr<image> 								HiZ;
+			std::vector<VkImageView> 							View;
+			std::vector<std::shared_ptr<descriptor::array>> 	Descriptor;
+		};
+
+		uint64_t 											BuildCount;
+		std::vector<retired> 								Retired;
+
+		void retire_hiz();
+		void release(bool aAll);
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_CULLER_H
@@ -20,26 +20,61 @@
 #include "pipeline.h"
 #include "framechain.h"
 
+#include <optional>
+
 namespace geodesy::gpu {
 
 	// This is a container class for a singular executable call to a gpu queue.
 	// This could be a rasterization draw call, a compute dispatch call, or a
 	// ray tracing call. This class will contain all the necessary metadata
-	// to facilitate a full call.
+	// to facilitate a full call. Parameters can be changed after creation, the
+	// call is then re-recorded in place by record(), reusing its command buffer,
+	// descriptor sets and framebuffer. The command pool must be created with
+	// VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, and the call must not be pending
+	// while it is re-recorded.
 	class executable_call : public command_buffer {
 	public:
 
 		std::shared_ptr<pipeline> Pipeline;
 		std::shared_ptr<framebuffer> Framebuffer;
+		std::vector<std::shared_ptr<image>> Image; 		// Attachments, referenced directly when dynamic rendering is used.
 		std::shared_ptr<descriptor::array> DescriptorArray;
+		std::map<std::pair<int, int>, std::shared_ptr<resource>> UniformSetBinding;
 
 		executable_call(std::shared_ptr<context> aContext, std::shared_ptr<command_pool> aCommandPool);
 
+		// Rebinds a single descriptor. Kept in UniformSetBinding and written by the next record(), the descriptor
+		// sets may still be in use by a pending submission until then.
+		void bind(std::pair<int, int> aSetBinding, std::shared_ptr<resource> aResource);
+		// True if parameters changed, or the pipeline became ready, since the last recording.
+		bool is_dirty() const;
+		// Re-records the command buffer if dirty, otherwise leaves it as is so it can be resubmitted.
+		// Descriptor sets and framebuffer are allocated by the first recording that sees the pipeline ready,
+		// until then an empty command buffer is recorded.
+		VkResult record();
+
+	protected:
+
+		bool Dirty;
+		bool RecordedReady; 	// Pipeline readiness at the last recording, commands are skipped while not ready.
+		std::set<std::pair<int, int>> PendingBinding; 	// Bound since the last recording, not yet written.
+
+		// Allocates whatever the call needs from a ready pipeline and is still missing.
+		virtual void allocate_resources();
+		void write_descriptor(std::pair<int, int> aSetBinding, std::shared_ptr<resource> aResource);
+		// Records the call into this command buffer, between begin() and end().
+		virtual void record_commands() = 0;
+
 	};
 
 	class rasterization_call : public executable_call {
 	public:
 
+		std::array<unsigned int, 3> Resolution;
+		std::vector<std::shared_ptr<buffer>> VertexBuffer;
+		std::shared_ptr<buffer> IndexBuffer;
+		std::optional<pipeline::draw_parameter> Draw; 	// Every vertex or index once if empty.
+
 		rasterization_call(
 			std::shared_ptr<context> aContext,
 			std::shared_ptr<command_pool> aCommandPool,
@@ -51,11 +86,23 @@ namespace geodesy::gpu {
 			std::map<std::pair<int, int>, std::shared_ptr<resource>> aUniformSetBinding = {}
 		);
 
+		// Replaces the attachments, the framebuffer is fetched from the context cache.
+		void set_image(std::vector<std::shared_ptr<image>> aImage, std::array<unsigned int, 3> aResolution);
+		void set_geometry(std::vector<std::shared_ptr<buffer>> aVertexBuffer, std::shared_ptr<buffer> aIndexBuffer = nullptr);
+		void set_draw(pipeline::draw_parameter aDraw);
+
+	protected:
+
+		void allocate_resources() override;
+		void record_commands() override;
+
 	};
 
 	class raytracing_call : public executable_call {
 	public:
 
+		std::array<unsigned int, 3> Resolution;
+
 		raytracing_call(
 			std::shared_ptr<context> aContext,
 			std::shared_ptr<command_pool> aCommandPool,
@@ -64,11 +111,19 @@ namespace geodesy::gpu {
 			std::map<std::pair<int, int>, std::shared_ptr<resource>> aUniformSetBinding = {}
 		);
 
+		void set_resolution(std::array<unsigned int, 3> aResolution);
+
+	protected:
+
+		void record_commands() override;
+
 	};
 
 	class compute_call : public executable_call {
 	public:
 
+		std::array<unsigned int, 3> ThreadGroupCount;
+
 		compute_call(
 			std::shared_ptr<context> aContext,
 			std::shared_ptr<command_pool> aCommandPool,
@@ -77,6 +132,12 @@ namespace geodesy::gpu {
 			std::map<std::pair<int, int>, std::shared_ptr<resource>> aUniformSetBinding = {}
 		);
 
+		void set_thread_group_count(std::array<unsigned int, 3> aThreadGroupCount);
+
+	protected:
+
+		void record_commands() override;
+
 	};
 
 }
@@ -13,13 +13,19 @@ namespace geodesy::gpu {
 	public:
 
 		std::vector<VkClearValue> ClearValue;
+		std::vector<std::shared_ptr<image>> Image; 	// Attachments in render pass order, their layouts are tracked by render pass begin() and end().
 		VkFramebuffer Handle;
+		bool Owned; 			// False for framebuffers handed out by the context's framebuffer cache.
 
 		framebuffer();
+		framebuffer(std::shared_ptr<context> aContext, VkFramebuffer aHandle, size_t aAttachmentCount);
 		framebuffer(std::shared_ptr<context> aContext, std::shared_ptr<pipeline> aPipeline, std::vector<std::shared_ptr<image>> aImageAttachements, std::array<unsigned int, 3> aResolution);
 		framebuffer(std::shared_ptr<context> aContext, std::shared_ptr<pipeline> aPipeline, std::map<std::string, std::shared_ptr<image>> aImage, std::vector<std::string> aAttachmentSelection, std::array<unsigned int, 3> aResolution);
 		~framebuffer();
 
+		// Opaque black for color attachments, far plane for depth stencil attachments.
+		static VkClearValue default_clear_value(VkFormat aFormat);
+
 	};
 
 }
@@ -3,8 +3,11 @@
 
 #include "config.h"
 
+#include <chrono>
+
 #include "device.h"
 #include "resource.h"
+#include "semaphore.h"
 #include "command_buffer.h"
 #include "command_pool.h"
 #include "command_batch.h"
@@ -12,22 +15,89 @@
 
 namespace geodesy::gpu {
 
+	// Headless framechain, N sets of offscreen images drawn in turn. Frames are numbered from 1, and a
+	// timeline semaphore reaches a frame's number once the GPU has finished it. next_frame() paces frames to
+	// FrameRate, or runs unthrottled for a FrameRate of zero, and only hands out an image set once the GPU
+	// is done with it and fewer than FramesInFlight frames are pending. Window system framechains derive from
+	// this and override next_frame() and get_acquire_present_semaphore_pair(). Needs the context's
+	// TimelineSemaphore feature.
+	//
+	//	Chain->next_frame();
+	//	CommandBuffer->begin(); Chain->begin(CommandBuffer.get());
+	//	... draw into Chain->Image[Chain->DrawIndex] ...
+	//	Chain->end(CommandBuffer.get()); CommandBuffer->end();
+	//	Chain->submit(device::operation::GRAPHICS, { Batch });
 	class framechain {
 	public:
 
+		struct attachment {
+			image::create_info 							CreateInfo;
+			image::format 								Format;
+		};
+
+		// Of the last finished frame, in seconds.
+		struct statistics {
+			uint64_t 									Frame;
+			double 										CpuTime; 		// From next_frame() to submit().
+			double 										GpuTime; 		// Between begin() and end() on the GPU, 0 if not recorded.
+			double 										Latency; 		// From submit() until the host saw the frame finish.
+		};
+
 		std::shared_ptr<context> Context;
 		double FrameRate;
 		std::vector<std::map<std::string, std::shared_ptr<image>>> Image;
 		std::array<unsigned int, 3> Resolution;
 
-		uint32_t ReadIndex;
+		uint32_t ReadIndex; 			// Image set of the last finished frame.
 		uint32_t DrawIndex;
 
+		uint32_t FramesInFlight;
+		uint64_t FrameIndex; 			// Number of the frame being drawn, 0 before the first next_frame().
+		std::shared_ptr<semaphore> Timeline;
+
 		framechain();
+		// Creates aFrameCount sets of the attachments, all with aResolution, left in their create_info layouts.
+		framechain(std::shared_ptr<context> aContext, std::array<unsigned int, 3> aResolution, double aFrameRate, uint32_t aFrameCount, std::map<std::string, attachment> aAttachment, uint32_t aFramesInFlight = 2);
+		virtual ~framechain();
 
 		virtual VkResult next_frame();
+		// Headless frames have no presentation engine to synchronize with, next_frame() returns only once
+		// the image set is free. Both semaphores are nullptr.
 		virtual std::pair<std::shared_ptr<semaphore>, std::shared_ptr<semaphore>> get_acquire_present_semaphore_pair();
 
+		// Timestamps bracketing the frame's GPU work, optional.
+		void begin(command_buffer* aCommandBuffer);
+		void end(command_buffer* aCommandBuffer);
+		// Submits the frame's work, the last batch also signals Timeline with FrameIndex.
+		VkResult submit(device::operation aDeviceOperation, std::vector<std::shared_ptr<command_batch>> aCommandBatchList);
+		// Waits until the GPU has finished every submitted frame.
+		VkResult wait();
+
+		statistics last_statistics() const;
+
+	private:
+
+		typedef std::chrono::steady_clock clock;
+
+		struct frame {
+			uint64_t 									Value; 			// Frame last drawn into this set, 0 if none.
+			bool 										Submitted;
+			bool 										Timestamped;
+			clock::time_point 							AcquireTime;
+			clock::time_point 							SubmitTime;
+		};
+
+		std::vector<frame> 								Frame;
+		VkQueryPool 									QueryPool; 		// Two timestamps per image set.
+		uint64_t 										SubmittedValue;
+		uint64_t 										CompletedValue;
+		clock::time_point 								NextFrameTime;
+		statistics 										Statistics;
+
+		// Records statistics of frames the GPU finished since the last call, seen finished at aCompletionTime.
+		// Taken by the caller as soon as it polled or waited, so pacing never counts as latency.
+		void collect(clock::time_point aCompletionTime);
+
 	};
 
 }
@@ -13,6 +13,7 @@
 #include "command_pool.h"
 #include "command_batch.h"
 #include "buffer.h"
+#include "barrier_batch.h"
 
 namespace geodesy::gpu {
 
@@ -348,6 +349,7 @@ namespace geodesy::gpu {
 			STENCIL_READ_ONLY_OPTIMAL_KHR = VK_IMAGE_LAYOUT_STENCIL_READ_ONLY_OPTIMAL_KHR,
 			READ_ONLY_OPTIMAL_KHR = VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL_KHR,
 			ATTACHMENT_OPTIMAL_KHR = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR,
+			LAYOUT_CURRENT = VK_IMAGE_LAYOUT_MAX_ENUM, 		// Not a Vulkan layout, the layout the image is tracked to be in.
 		};
 
 		struct create_info {
@@ -357,11 +359,27 @@ namespace geodesy::gpu {
 			int Memory;
 			int Usage;
 			bool MipLevels;
+			unsigned int MipLevelCount; 		// Overrides MipLevels when non zero, for partial mip chains.
+			bool Transient; 		// Render pass only attachment, TRANSIENT_ATTACHMENT usage in lazily allocated memory where supported.
 			create_info();
 			create_info(int aSample, int aTiling, int aMemory, int aUsage);
 		};
 
+		// One image of create_batch(), arguments of the device image constructor.
+		struct batch_item {
+			create_info 		CreateInfo;
+			format 				Format;
+			unsigned int 		X;
+			unsigned int 		Y 		= 1;
+			unsigned int 		Z 		= 1;
+			unsigned int 		T 		= 1;
+			void* 				Data 	= NULL; 		// Tightly packed level 0 of every layer, or NULL.
+		};
+
 		static size_t bytes_per_pixel(int aFormat);
+		// Texel block of block compressed formats, a single texel for all others.
+		static size_t block_size(int aFormat);
+		static VkExtent2D block_extent(int aFormat);
 		static size_t bits_per_pixel(int aFormat);
 		static size_t channel_count(int aFormat);
 		static VkImageAspectFlags aspect_flag(int aFormat);
@@ -375,8 +393,11 @@ namespace geodesy::gpu {
 		VkImageCreateInfo CreateInfo;
 		VkImage Handle;
 		VkImageView View;
+		uint64_t ViewGeneration; 							// Incremented whenever View is replaced, handles alone may be reused.
 		unsigned int MemoryType;
 		VkDeviceMemory MemoryHandle;
+		std::shared_ptr<VkDeviceMemory> SharedMemory; 		// Set when MemoryHandle is shared with other images, freed by the last of them.
+		std::vector<barrier_batch::state> State; 		// Per subresource, indexed by [Layer * mipLevels + Mip].
 
 		image();
 		image(format aFormat, unsigned int aX, unsigned int aY = 1, unsigned int aZ = 1, unsigned int aT = 1, size_t aSourceSize = 0, void* aSourceData = NULL);
@@ -384,6 +405,12 @@ namespace geodesy::gpu {
 		image(std::shared_ptr<context> aContext, create_info aCreateInfo, format aFormat, unsigned int aX, unsigned int aY = 1, unsigned int aZ = 1, unsigned int aT = 1, void* aTextureData = NULL);
 		~image();
 
+		// Creates many images at once. Images of the same memory type are bound to shared memory blocks, uploads
+		// are packed into shared staging buffers of up to aStagingSize bytes, and every transition, copy and mip
+		// level of one staging buffer is recorded into a single submission. Images that fail to create are left
+		// nullptr in aImage, and the first error is returned.
+		static VkResult create_batch(std::shared_ptr<context> aContext, const std::vector<batch_item>& aItem, std::vector<std::shared_ptr<image>>& aImage, size_t aStagingSize = 1 << 28);
+
 		// Scheduled Operations
 		void copy(command_buffer* aCommandBuffer, VkOffset3D aDestinationOffset, uint32_t aDestinationArrayLayer, std::shared_ptr<buffer> aSourceData, size_t aSourceOffset, VkExtent3D aRegionExtent, uint32_t aArrayLayerCount = UINT32_MAX);
 		void copy(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aSourceData, std::vector<VkBufferImageCopy> aRegionList);
@@ -396,8 +423,10 @@ namespace geodesy::gpu {
 			uint32_t aMipLevel = 0, uint32_t aMipLevelCount = UINT32_MAX,
 			uint32_t aArrayLayerStart = 0, uint32_t aArrayLayerCount = UINT32_MAX
 		);
-		void clear(command_buffer* aCommandBuffer, VkClearColorValue aClearColor, image::layout aCurrentImageLayout = SHADER_READ_ONLY_OPTIMAL, uint32_t aStartingArrayLayer = 0, uint32_t aArrayLayerCount = UINT32_MAX);
-		void clear_depth(command_buffer* aCommandBuffer, VkClearDepthStencilValue aClearDepthStencil, image::layout aCurrentImageLayout = SHADER_READ_ONLY_OPTIMAL, uint32_t aStartingArrayLayer = 0, uint32_t aArrayLayerCount = UINT32_MAX);
+		void clear(command_buffer* aCommandBuffer, VkClearColorValue aClearColor, image::layout aCurrentImageLayout = LAYOUT_CURRENT, uint32_t aStartingArrayLayer = 0, uint32_t aArrayLayerCount = UINT32_MAX);
+		void clear_depth(command_buffer* aCommandBuffer, VkClearDepthStencilValue aClearDepthStencil, image::layout aCurrentImageLayout = LAYOUT_CURRENT, uint32_t aStartingArrayLayer = 0, uint32_t aArrayLayerCount = UINT32_MAX);
+		// Blits each level into the next, see mip_generator for the compute path.
+		void generate_mipmaps(command_buffer* aCommandBuffer, layout aFinalLayout, VkFilter aFilter);
 
 		// Immediate Operations
 		VkResult copy(VkOffset3D aDestinationOffset, uint32_t aDestinationArrayLayer, std::shared_ptr<buffer> aSourceData, size_t aSourceOffset, VkExtent3D aRegionExtent, uint32_t aArrayLayerCount = UINT32_MAX);
@@ -409,10 +438,35 @@ namespace geodesy::gpu {
 			uint32_t aMipLevel = 0, uint32_t aMipLevelCount = UINT32_MAX,
 			uint32_t aArrayLayerStart = 0, uint32_t aArrayLayerCount = UINT32_MAX
 		);
-		VkResult clear(VkClearColorValue aClearColor, image::layout aCurrentImageLayout = SHADER_READ_ONLY_OPTIMAL, uint32_t aStartingArrayLayer = 0, uint32_t aArrayLayerCount = UINT32_MAX);
-		VkResult clear_depth(VkClearDepthStencilValue aClearDepthStencil, image::layout aCurrentImageLayout = SHADER_READ_ONLY_OPTIMAL, uint32_t aStartingArrayLayer = 0, uint32_t aArrayLayerCount = UINT32_MAX);
+		VkResult clear(VkClearColorValue aClearColor, image::layout aCurrentImageLayout = LAYOUT_CURRENT, uint32_t aStartingArrayLayer = 0, uint32_t aArrayLayerCount = UINT32_MAX);
+		VkResult clear_depth(VkClearDepthStencilValue aClearDepthStencil, image::layout aCurrentImageLayout = LAYOUT_CURRENT, uint32_t aStartingArrayLayer = 0, uint32_t aArrayLayerCount = UINT32_MAX);
 		VkResult generate_mipmaps(layout aCurrentLayout, layout aFinalLayout, VkFilter aFilter);
 
+		// Layout and access tracking. Operations recorded through this class keep it up to date, anything
+		// recorded outside of it (render passes, dispatches) should go through require() or track().
+		layout current_layout(uint32_t aMipLevel = 0, uint32_t aArrayLayer = 0);
+		// Appends only the barriers needed before accessing the subresources with aAccess at aStage in aLayout.
+		void require(
+			barrier_batch& aBarrier,
+			layout aLayout, VkAccessFlags aAccess, VkPipelineStageFlags aStage,
+			uint32_t aMipLevel = 0, uint32_t aMipLevelCount = UINT32_MAX,
+			uint32_t aArrayLayerStart = 0, uint32_t aArrayLayerCount = UINT32_MAX
+		);
+		void require(
+			command_buffer* aCommandBuffer,
+			layout aLayout, VkAccessFlags aAccess, VkPipelineStageFlags aStage,
+			uint32_t aMipLevel = 0, uint32_t aMipLevelCount = UINT32_MAX,
+			uint32_t aArrayLayerStart = 0, uint32_t aArrayLayerCount = UINT32_MAX
+		);
+		// Records an access the caller already synchronized, such as a render pass final layout.
+		void track(
+			layout aLayout, VkAccessFlags aAccess, VkPipelineStageFlags aStage,
+			uint32_t aMipLevel = 0, uint32_t aMipLevelCount = UINT32_MAX,
+			uint32_t aArrayLayerStart = 0, uint32_t aArrayLayerCount = UINT32_MAX
+		);
+		// Every recorded access has completed, after a host wait on its submission.
+		void reset_access();
+
 		// Write to image data memory from host memory.
 		VkResult write(VkOffset3D aDestinationOffset, uint32_t aDestinationArrayLayer, void* aSourceData, size_t aSourceOffset, VkExtent3D aDestinationExtent, uint32_t aDestinationArrayLayerCount = UINT32_MAX);
 		VkResult write(void* aSourceData, std::vector<VkBufferImageCopy> aRegionList);
@@ -421,9 +475,17 @@ namespace geodesy::gpu {
 		VkResult read(VkOffset3D aSourceOffset, uint32_t aSourceArrayLayer, void* aDestinationData, size_t aDestinationOffset, VkExtent3D aSourceExtent, uint32_t aSourceArrayLayerCount = UINT32_MAX);
 		VkResult read(void* aDestinationData, std::vector<VkBufferImageCopy> aRegionList);
 
+		// Bytes a region occupies in buffer memory, honouring bufferRowLength and bufferImageHeight.
+		size_t region_size(const VkBufferImageCopy& aRegion) const;
+		// Packs regions back to back with aligned offsets, returns the buffer size they need.
+		size_t stage(std::vector<VkBufferImageCopy>& aRegionList) const;
+
+		// A non zero aMinLod clamps sampling to levels at or below it, through VK_EXT_image_view_min_lod. It is
+		// ignored if the minLod feature is not enabled, see texture_streamer for the base level fallback.
 		VkImageView view(
 			uint32_t aMipLevel = 0, uint32_t aMipLevelCount = UINT32_MAX,
-			uint32_t aArrayLayerStart = 0, uint32_t aArrayLayerCount = UINT32_MAX
+			uint32_t aArrayLayerStart = 0, uint32_t aArrayLayerCount = UINT32_MAX,
+			float aMinLod = 0.0f
 		) const;
 
 		VkAttachmentDescription description(layout aStartingLayout, layout aEndingLayout) const;
@@ -440,8 +502,37 @@ namespace geodesy::gpu {
 		// Checks if the image has an alpha channel.
 		bool has_alpha_channel() const;
 
-		// Deep check for opacity, classifies image as opaque, transparent, or translucent.
-		int transparency(int aChannelSelection) const;
+		// Deep check for opacity, classifies image as opaque, transparent, or translucent. Channels are numbered
+		// by component, R G B A. Host images are analyzed directly, device images take the results of the last
+		// analyze_transparency() of the same channel, whose submission must have completed. Fills the
+		// percentages, returns -1 for unsupported formats or channels that were never analyzed.
+		int transparency(int aChannelSelection);
+		// Records a compute reduction of aChannelSelection over level 0 of the first layer, leaving it in
+		// SHADER_READ_ONLY_OPTIMAL, or GENERAL if it already was. Requires a 2D image with SAMPLED usage and a
+		// format that can be linearly filtered. Uploads with data run it on alpha in their own submission and
+		// read the counts back once it completes, keeping nothing but the percentages.
+		VkResult analyze_transparency(command_buffer* aCommandBuffer, int aChannelSelection);
+
+	private:
+
+		// Compute reduction recorded by analyze_transparency(), released once transparency() reads it.
+		struct coverage_query {
+			int 										Channel 		= -1;
+			std::shared_ptr<buffer> 					Result; 		// Opaque, transparent and translucent counts.
+			std::vector<std::shared_ptr<resource>> 		Resource; 		// Pipeline and descriptors of the dispatch.
+		};
+
+		coverage_query Coverage;
+		int CoverageChannel; 		// Channel the percentages describe, -1 if none.
+
+		// Fills CreateInfo and creates the handle and picks the memory type, without binding memory.
+		void create_handle(std::shared_ptr<context> aContext, create_info& aCreateInfo, format aFormat, unsigned int aX, unsigned int aY, unsigned int aZ, unsigned int aT);
+		// Uploads level 0, generates the mip chain of images with data, and moves every image to its final layout.
+		static VkResult upload(std::shared_ptr<context> aContext, const std::vector<image*>& aImage, const std::vector<void*>& aData, const std::vector<layout>& aFinalLayout, size_t aStagingSize);
+		// Blits level aMipLevel into the next, both must already be in their transfer layouts.
+		void blit_level(command_buffer* aCommandBuffer, uint32_t aMipLevel, VkFilter aFilter);
+
+		barrier_batch::state& subresource_state(uint32_t aMipLevel, uint32_t aArrayLayer);
 
 	};
 
@@ -0,0 +1,70 @@
+#pragma once
+#ifndef GEODESY_GPU_KTX2_H
+#define GEODESY_GPU_KTX2_H
+
+#include "config.h"
+
+#include <fstream>
+
+#include "buffer.h"
+#include "image.h"
+
+namespace geodesy::gpu {
+
+	// Reader for KTX2 texture containers. Only the header and level index are read when opened, level data
+	// is streamed from the file straight into staging memory when an image is created. Zstandard
+	// supercompression needs GEODESY_GPU_USE_ZSTD, BasisLZ and zlib need transcoding and are not supported.
+	class ktx2 {
+	public:
+
+		enum supercompression : uint32_t {
+			NONE 		= 0,
+			BASISLZ 	= 1,
+			ZSTANDARD 	= 2,
+			ZLIB 		= 3
+		};
+
+		struct level {
+			uint64_t 			ByteOffset;
+			uint64_t 			ByteLength; 			// Size in the file.
+			uint64_t 			UncompressedByteLength; // Size once supercompression is undone.
+		};
+
+		std::string 			Path;
+		image::format 			Format;
+		uint32_t 				Width;
+		uint32_t 				Height;
+		uint32_t 				Depth;
+		uint32_t 				LayerCount;
+		uint32_t 				FaceCount;
+		uint32_t 				LevelCount; 		// Levels stored in the file, at least one.
+		bool 					GenerateMipmaps; 	// The file left levelCount at zero, create_image() blits the chain.
+		supercompression 		Supercompression;
+		std::vector<level> 		Level; 				// Indexed by mip level, 0 is the largest.
+
+		// Throws if the file is not a KTX2 container, or if its counts are out of range: more levels than the full
+		// chain, a face count other than 1 or 6, or more layers times faces than aMaxArrayLayers. Pass the device's
+		// maxImageArrayLayers, the default is the minimum every device supports.
+		ktx2(std::string aPath, uint32_t aMaxArrayLayers = 256);
+
+		// Size of a mip level in the image, every layer and face included.
+		size_t level_size(uint32_t aLevel) const;
+		// Reads a mip level into aData, which must hold level_size(aLevel) bytes.
+		VkResult read_level(uint32_t aLevel, void* aData);
+
+		// Creates a sampled image holding every level, layer and face of the file, left in SHADER_READ_ONLY_OPTIMAL.
+		// Levels are streamed through one staging buffer of aStagingSize bytes, reused across submissions, and
+		// levels larger than it get a staging buffer of their own. Cube maps are loaded as 2D arrays of six
+		// layers per cube. Files without levels get a full chain blitted from level 0 when the format allows it,
+		// a single level otherwise.
+		VkResult create_image(std::shared_ptr<context> aContext, image::create_info aCreateInfo, std::shared_ptr<image>& aImage, size_t aStagingSize = 1 << 26);
+
+	private:
+
+		std::ifstream 			File;
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_KTX2_H
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef GEODESY_GPU_MIP_GENERATOR_H
+#define GEODESY_GPU_MIP_GENERATOR_H
+
+#include "config.h"
+
+#include "buffer.h"
+#include "image.h"
+#include "descriptor.h"
+#include "pipeline.h"
+
+namespace geodesy::gpu {
+
+	// Compute mip chain generation. Box, min and max reductions follow the single pass downsampler
+	// scheme: every work group reduces a 64x64 tile six levels down through shared memory, and the
+	// last work group of a layer to finish, found through an atomic counter, reduces the 1x1 results of
+	// all tiles the remaining six levels, for up to twelve levels in one dispatch. The Kaiser filter reads
+	// a 4x4 footprint that crosses tile borders and runs one dispatch per level instead. Images without
+	// STORAGE usage, or whose format cannot be a storage image, fall back to blits for box and Kaiser.
+	// The 2x2 reductions drop the last row or column of odd sized levels, so min and max pyramids
+	// are only conservative for power of two sizes.
+	class mip_generator : public resource {
+	public:
+
+		enum reduction : int {
+			BOX,
+			KAISER, 		// Kaiser windowed sinc, sharper than box for textures and probes.
+			MIN, 			// Hi-Z pyramid for reversed depth.
+			MAX 			// Hi-Z pyramid for a 0 near, 1 far depth range.
+		};
+
+		mip_generator();
+		mip_generator(std::shared_ptr<context> aContext);
+		~mip_generator();
+
+		// True if aImage can go through the compute path.
+		bool supported(std::shared_ptr<image> aImage) const;
+		// Regenerates every level of every layer from level 0 and leaves the image in aFinalLayout. Views and
+		// descriptors are cached per image and reduction. Min and max cannot fall back to blits, and return
+		// VK_ERROR_FORMAT_NOT_SUPPORTED for images supported() rejects. Must be recorded outside a render pass.
+		VkResult generate(command_buffer* aCommandBuffer, std::shared_ptr<image> aImage, reduction aReduction = BOX, image::layout aFinalLayout = image::layout::SHADER_READ_ONLY_OPTIMAL);
+		// Releases cached views and descriptors of images that no longer exist.
+		void prune();
+
+		// Levels one single pass dispatch reduces below a base level, out of aRemainingLevelCount. Level 6 of the
+		// base must fit the one 64x64 tile the last work group reduces, larger bases stop at level 6.
+		static uint32_t single_pass_level_count(uint32_t aBaseWidth, uint32_t aBaseHeight, uint32_t aRemainingLevelCount);
+
+	private:
+
+		// One dispatch, reducing BaseLevel into the LevelCount levels below it.
+		struct pass {
+			uint32_t 									BaseLevel;
+			uint32_t 									LevelCount;
+			std::array<unsigned int, 3> 				GroupCount;
+			std::shared_ptr<descriptor::array> 			Descriptor;
+			std::shared_ptr<buffer> 					Parameter; 		// Single pass only.
+		};
+
+		struct target {
+			std::weak_ptr<image> 						Image;
+			std::shared_ptr<pipeline> 					Pipeline;
+			std::vector<VkImageView> 					View; 			// Array view of each level.
+			std::vector<pass> 							Pass;
+			std::shared_ptr<buffer> 					Counter; 		// Work groups done per layer, single pass only.
+		};
+
+		std::map<std::string, std::shared_ptr<pipeline>> 				Pipeline; 		// Per storage format and reduction.
+		std::map<std::pair<VkImage, reduction>, target> 				Target;
+
+		std::shared_ptr<pipeline> get_pipeline(const char* aStorageFormat, reduction aReduction);
+		target* get_target(std::shared_ptr<image> aImage, reduction aReduction);
+		void destroy_target(target& aTarget);
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_MIP_GENERATOR_H
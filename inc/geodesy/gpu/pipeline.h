@@ -13,6 +13,12 @@
 #include "framebuffer.h"
 #include "acceleration_structure.h"
 
+#include <set>
+#include <atomic>
+#include <mutex>
+#include <future>
+#include <optional>
+
 /*
 Flow Chart of Pipeline Creation.
 Start:		     Vertex       Pixel
@@ -34,6 +40,9 @@ namespace geodesy::gpu {
 	class framebuffer;
 
 	class pipeline : public std::enable_shared_from_this<pipeline>, public resource {
+
+		friend class pipeline_builder;
+
 	public:
 
 		enum stage : unsigned int {
@@ -69,6 +78,15 @@ namespace geodesy::gpu {
 			INSTANCE = VK_VERTEX_INPUT_RATE_INSTANCE,
 		};
 
+		// Parameters of a single draw. Count and First refer to indices for indexed draws, vertices otherwise.
+		struct draw_parameter {
+			uint32_t 	Count;
+			uint32_t 	InstanceCount;
+			uint32_t 	First;
+			int32_t 	VertexOffset; 		// Indexed only.
+			uint32_t 	FirstInstance;
+		};
+
 		struct create_info {
 		public:
 
@@ -86,6 +104,15 @@ namespace geodesy::gpu {
 
 			void generate_descriptor_set_layout_binding();
 
+			// SPIRV cache helpers, a hit leaves Program and DescriptorSetVariable empty.
+			uint64_t key() const;
+			bool read_cache(shader_cache::program& aProgram);
+			void write_cache(shader_cache::program aProgram);
+
+			// Parses any unparsed shaders, links them and builds reflection.
+			void link(std::string aPipelineName);
+			void generate_byte_code();
+
 		};
 
 		// Pre creation options for a rasterizer pipeline.
@@ -110,6 +137,7 @@ namespace geodesy::gpu {
 			attachment DepthStencilAttachment;
 
 			VkPrimitiveTopology PrimitiveTopology;
+			uint32_t PatchControlPoints; 		// Vertices per patch, only used with tessellation shaders. Not known to the shaders themselves.
 			float MinDepth;
 			float MaxDepth;
 			VkPolygonMode PolygonMode;
@@ -184,12 +212,14 @@ namespace geodesy::gpu {
 		std::vector<VkPipelineShaderStageCreateInfo> Stage;
 		VkPipelineBindPoint BindPoint;
 		VkPipelineLayout Layout;
-		VkPipelineCache Cache;
+		VkPipelineCache Cache; // Owned by context, shared by all pipelines.
 		VkPipeline Handle;
 		VkDescriptorPool DescriptorPool;
 		std::vector<VkDescriptorSetLayout> DescriptorSetLayout;
-		VkRenderPass RenderPass;
+		VkRenderPass RenderPass; // Owned by context, or by the caller that supplied it.
+		uint32_t Subpass;
 		raytracer::shader_binding_table ShaderBindingTable;
+		std::shared_ptr<pipeline> Substitute; 	// Recorded in place of this pipeline until it is ready, may be nullptr.
 
 		pipeline();
 		pipeline(std::shared_ptr<context> aContext, std::shared_ptr<rasterizer> aRasterizer, VkRenderPass aRenderPass = VK_NULL_HANDLE, uint32_t aSubpassIndex = 0);
@@ -197,6 +227,12 @@ namespace geodesy::gpu {
 		pipeline(std::shared_ptr<context> aContext, std::shared_ptr<compute> aCompute);
 		~pipeline();
 
+		// Creates many rasterizer pipelines with a single vkCreateGraphicsPipelines call. Failed entries are nullptr.
+		static std::vector<std::shared_ptr<pipeline>> create(std::shared_ptr<context> aContext, std::vector<std::shared_ptr<rasterizer>> aRasterizerList);
+
+		// False while an asynchronous build is in flight, or if creation failed. Never blocks.
+		bool is_ready() const;
+
 		// Can be used for rasterization, raytracing, or compute.
 		void bind(
 			command_buffer* 											aCommandBuffer, 
@@ -215,7 +251,42 @@ namespace geodesy::gpu {
 			std::shared_ptr<buffer> 									aIndexBuffer = nullptr,
 			std::shared_ptr<descriptor::array> 							aDescriptorArray = nullptr
 		);
+		// Dynamic rendering API, attachments are passed as images, colors first then depth. The render
+		// pass layout transitions described by the rasterizer attachments are recorded as barriers.
+		void begin(command_buffer* aCommandBuffer, std::vector<std::shared_ptr<image>> aImage, VkRect2D aRenderArea, std::vector<VkClearValue> aClearValue = {}, VkSubpassContents aSubpassContents = VK_SUBPASS_CONTENTS_INLINE);
+		void rasterize(
+			command_buffer* 				 							aCommandBuffer,
+			std::vector<std::shared_ptr<image>> 						aImage,
+			std::array<unsigned int, 3> 								aResolution,
+			std::vector<std::shared_ptr<buffer>> 						aVertexBuffer = {},
+			std::shared_ptr<buffer> 									aIndexBuffer = nullptr,
+			std::shared_ptr<descriptor::array> 							aDescriptorArray = nullptr
+		);
+		// Ends either a render pass or dynamic rendering, whichever begin() started.
 		void end(command_buffer* aCommandBuffer);
+		// Draw API, recorded between begin() and end() after bind(). Skipped while the pipeline is not ready.
+		void set_viewport(command_buffer* aCommandBuffer, std::array<unsigned int, 3> aResolution);
+		void draw(command_buffer* aCommandBuffer, draw_parameter aDraw);
+		void draw_indexed(command_buffer* aCommandBuffer, draw_parameter aDraw);
+		// Uses VK_EXT_multi_draw when its feature is enabled and every draw shares instance parameters, otherwise one draw each.
+		void draw(command_buffer* aCommandBuffer, const std::vector<draw_parameter>& aDraw);
+		void draw_indexed(command_buffer* aCommandBuffer, const std::vector<draw_parameter>& aDraw);
+		// Indirect draws read VkDrawIndirectCommand or VkDrawIndexedIndirectCommand records from a buffer with INDIRECT usage.
+		void draw_indirect(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aIndirectBuffer, VkDeviceSize aOffset, uint32_t aDrawCount, uint32_t aStride = sizeof(VkDrawIndirectCommand));
+		void draw_indexed_indirect(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aIndirectBuffer, VkDeviceSize aOffset, uint32_t aDrawCount, uint32_t aStride = sizeof(VkDrawIndexedIndirectCommand));
+		// Draw count is read from a uint32_t in aCountBuffer, clamped to aMaxDrawCount.
+		void draw_indirect_count(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aIndirectBuffer, VkDeviceSize aOffset, std::shared_ptr<buffer> aCountBuffer, VkDeviceSize aCountOffset, uint32_t aMaxDrawCount, uint32_t aStride = sizeof(VkDrawIndirectCommand));
+		void draw_indexed_indirect_count(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aIndirectBuffer, VkDeviceSize aOffset, std::shared_ptr<buffer> aCountBuffer, VkDeviceSize aCountOffset, uint32_t aMaxDrawCount, uint32_t aStride = sizeof(VkDrawIndexedIndirectCommand));
+		// Per command buffer overrides of the rasterizer defaults, re-applied on every bind(). Only states
+		// made dynamic by VK_EXT_extended_dynamic_state 1, 2 and 3 take effect, the rest stay baked.
+		void set_cull_mode(command_buffer* aCommandBuffer, VkCullModeFlags aCullMode);
+		void set_front_face(command_buffer* aCommandBuffer, VkFrontFace aFrontFace);
+		void set_primitive_topology(command_buffer* aCommandBuffer, VkPrimitiveTopology aPrimitiveTopology); // Must stay in the same topology class.
+		void set_depth_test(command_buffer* aCommandBuffer, bool aDepthTestEnable, bool aDepthWriteEnable, VkCompareOp aDepthCompareOp);
+		void set_primitive_restart(command_buffer* aCommandBuffer, bool aPrimitiveRestartEnable);
+		void set_polygon_mode(command_buffer* aCommandBuffer, VkPolygonMode aPolygonMode);
+		void set_blend_enable(command_buffer* aCommandBuffer, uint32_t aAttachmentIndex, bool aBlendEnable);
+		void clear_dynamic_state(command_buffer* aCommandBuffer);
 		// Raytracing API
 		void raytrace(
 			command_buffer* 				 							aCommandBuffer,
@@ -268,6 +339,52 @@ namespace geodesy::gpu {
 
 	private:
 
+		std::atomic<bool> Ready;
+		std::mutex Mutex;
+		std::future<VkPipeline> Optimized; 				// Link time optimized replacement for a fast linked Handle, swapped in at bind().
+		std::vector<VkPipeline> Retired; 				// Replaced handles, may still be referenced by recorded command buffers.
+		uint64_t LayoutKey; 							// Identity of the layout definition, including push constant ranges.
+		bool SharedRenderPass; 							// RenderPass is the context's cached one for these attachments.
+		std::set<VkDynamicState> DynamicState; 			// Every dynamic state of the rasterizer pipeline.
+		bool ExtendedDynamicState; 						// States beyond viewport and scissor are dynamic, they are set at bind().
+
+		// This pipeline if ready, otherwise a ready substitute, otherwise nullptr.
+		pipeline* active();
+		// Takes ownership of another pipeline's handles, then publishes this pipeline as ready.
+		void adopt(pipeline& aPipeline);
+		// Records rasterizer defaults merged with this command buffer's overrides.
+		void apply_dynamic_state(command_buffer* aCommandBuffer);
+
+		// Backing storage for a VkGraphicsPipelineCreateInfo, must outlive the create call.
+		struct rasterizer_state {
+			std::vector<VkVertexInputAttributeDescription> 		VertexAttributeDescription;
+			std::vector<VkDynamicState> 						DynamicStates;
+			VkPipelineVertexInputStateCreateInfo 				Input;
+			VkPipelineInputAssemblyStateCreateInfo 				InputAssembly;
+			VkPipelineTessellationStateCreateInfo 				Tesselation;
+			VkPipelineViewportStateCreateInfo 					Viewport;
+			VkPipelineRasterizationStateCreateInfo 				Rasterizer;
+			VkPipelineMultisampleStateCreateInfo 				Multisample;
+			VkPipelineDepthStencilStateCreateInfo 				DepthStencil;
+			VkPipelineColorBlendStateCreateInfo					ColorBlend;
+			VkPipelineDynamicStateCreateInfo 					DynamicState;
+			std::vector<VkFormat> 								ColorAttachmentFormat;
+			VkPipelineRenderingCreateInfo 						Rendering;
+			VkGraphicsPipelineCreateInfo 						CreateInfo;
+		};
+
+		VkResult prepare(std::shared_ptr<context> aContext, std::shared_ptr<rasterizer> aRasterizer, VkRenderPass aRenderPass, uint32_t aSubpassIndex);
+		void create_rasterizer_state(rasterizer_state& aState, std::shared_ptr<rasterizer> aRasterizer);
+		// VK_EXT_graphics_pipeline_library path, fast links cached parts and starts an optimized link in the background.
+		VkResult link_libraries(rasterizer_state& aState, std::shared_ptr<rasterizer> aRasterizer);
+		// Binds, sets viewport and scissor to the resolution and draws every vertex or index.
+		void record_draw(
+			command_buffer* 											aCommandBuffer,
+			std::array<unsigned int, 3> 								aResolution,
+			std::vector<std::shared_ptr<buffer>> 						aVertexBuffer,
+			std::shared_ptr<buffer> 									aIndexBuffer,
+			std::shared_ptr<descriptor::array> 							aDescriptorArray
+		);
 		VkResult shader_stage_create(std::shared_ptr<create_info> aCreateInfo);
 		VkResult create_pipeline_layout(std::vector<std::vector<VkDescriptorSetLayoutBinding>> aDescriptorSetLayoutBinding);
 
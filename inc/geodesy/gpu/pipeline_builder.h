@@ -0,0 +1,74 @@
+#pragma once
+#ifndef GEODESY_GPU_PIPELINE_BUILDER_H
+#define GEODESY_GPU_PIPELINE_BUILDER_H
+
+#include "config.h"
+
+#include "shader.h"
+#include "pipeline.h"
+#include "worker_pool.h"
+
+namespace geodesy::gpu {
+
+	// Builds pipelines concurrently on a worker pool. Each task links and generates SPIRV with its own
+	// glslang::TProgram. Shaders may be shared between builds in flight, each is parsed once and linked
+	// by one build at a time, see shader::compile(). Rasterizer pipelines that finish compiling are
+	// gathered and created in batches with a single vkCreateGraphicsPipelines call. Every build returns
+	// a future that resolves independently, to nullptr if compilation or creation failed.
+	//
+	// The build_async() variants return a pipeline immediately instead. It reports is_ready() false,
+	// and records its substitute or nothing, until the background build completes and hands its
+	// handles over. A failed build leaves it permanently not ready.
+	class pipeline_builder {
+	public:
+
+		// Called on the worker after reflection, before creation. Use to bind vertex buffers and attachments.
+		typedef std::function<void(pipeline::rasterizer&)> rasterizer_setup;
+
+		std::shared_ptr<context> 							Context;
+		std::shared_ptr<worker_pool> 						WorkerPool;
+		size_t 												BatchSize;
+
+		pipeline_builder(std::shared_ptr<context> aContext, std::shared_ptr<worker_pool> aWorkerPool = nullptr, size_t aBatchSize = 16);
+		~pipeline_builder();
+
+		std::shared_future<std::shared_ptr<pipeline>> build(std::vector<std::shared_ptr<shader>> aShaderList, rasterizer_setup aSetup = nullptr);
+		std::shared_future<std::shared_ptr<pipeline>> build(std::shared_ptr<shader> aComputeShader);
+		std::shared_future<std::shared_ptr<pipeline>> build(std::vector<pipeline::raytracer::shader_group> aShaderGroup, uint32_t aMaxRecursionDepth);
+
+		std::shared_ptr<pipeline> build_async(std::vector<std::shared_ptr<shader>> aShaderList, rasterizer_setup aSetup = nullptr, std::shared_ptr<pipeline> aSubstitute = nullptr);
+		std::shared_ptr<pipeline> build_async(std::shared_ptr<shader> aComputeShader, std::shared_ptr<pipeline> aSubstitute = nullptr);
+		std::shared_ptr<pipeline> build_async(std::vector<pipeline::raytracer::shader_group> aShaderGroup, uint32_t aMaxRecursionDepth, std::shared_ptr<pipeline> aSubstitute = nullptr);
+
+		// Creates any rasterizer pipelines still waiting for a full batch.
+		void flush();
+		// Blocks until every submitted build has resolved.
+		void wait();
+
+	private:
+
+		struct pending {
+			std::shared_ptr<pipeline::rasterizer> 						Rasterizer;
+			std::shared_ptr<std::promise<std::shared_ptr<pipeline>>> 	Promise;
+			std::shared_ptr<pipeline> 									Target; 		// Placeholder to adopt the result, or nullptr.
+		};
+
+		std::mutex 													Mutex;
+		std::condition_variable 									Condition;
+		size_t 														InFlight;
+		size_t 														Compiling;
+		std::vector<pending> 										Pending;
+
+		std::shared_future<std::shared_ptr<pipeline>> enqueue(std::vector<std::shared_ptr<shader>> aShaderList, rasterizer_setup aSetup, std::shared_ptr<pipeline> aTarget);
+		std::shared_future<std::shared_ptr<pipeline>> enqueue(std::shared_ptr<shader> aComputeShader, std::shared_ptr<pipeline> aTarget);
+		std::shared_future<std::shared_ptr<pipeline>> enqueue(std::vector<pipeline::raytracer::shader_group> aShaderGroup, uint32_t aMaxRecursionDepth, std::shared_ptr<pipeline> aTarget);
+		std::shared_ptr<pipeline> placeholder(std::shared_ptr<pipeline> aSubstitute);
+		void create_batch(std::vector<pending> aBatch);
+		void resolve(const pending& aPending, std::shared_ptr<pipeline> aPipeline);
+		void finish();
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_PIPELINE_BUILDER_H
@@ -0,0 +1,605 @@
+#pragma once
+#ifndef GEODESY_GPU_PIXEL_H
+#define GEODESY_GPU_PIXEL_H
+
+#include "config.h"
+
+#include <cstdint>
+#include <utility>
+
+// Host side pixel processing. Format traits are resolved through a table built at compile time, and
+// the conversion kernels use SSE2 or NEON when the target has them, with scalar fallbacks otherwise.
+// The AVX2, SSSE3 and F16C paths are compiled in with the GEODESY_GPU_SIMD CMake option.
+//
+// Every kernel works on tightly packed arrays and accepts aDestination == aSource when both elements
+// have the same size.
+namespace geodesy::gpu::pixel {
+
+	struct format_traits {
+		uint16_t 		BitsPerPixel; 		// Zero for block compressed, planar and unknown formats.
+		uint8_t 		ChannelCount;
+		uint8_t 		BlockWidth; 		// Texel block extent, 1x1 for uncompressed formats.
+		uint8_t 		BlockHeight;
+		uint8_t 		BlockSize; 			// Bytes per texel block, zero for planar and unknown formats.
+	};
+
+	constexpr uint16_t format_bits_per_pixel(int aFormat) {
+		switch (aFormat) {
+		default: return 0;
+		case VK_FORMAT_R4G4_UNORM_PACK8: return 8;
+		case VK_FORMAT_R4G4B4A4_UNORM_PACK16: return 16;
+		case VK_FORMAT_B4G4R4A4_UNORM_PACK16: return 16;
+		case VK_FORMAT_R5G6B5_UNORM_PACK16: return 16;
+		case VK_FORMAT_B5G6R5_UNORM_PACK16: return 16;
+		case VK_FORMAT_R5G5B5A1_UNORM_PACK16: return 16;
+		case VK_FORMAT_B5G5R5A1_UNORM_PACK16: return 16;
+		case VK_FORMAT_A1R5G5B5_UNORM_PACK16: return 16;
+		case VK_FORMAT_R8_UNORM: return 8;
+		case VK_FORMAT_R8_SNORM: return 8;
+		case VK_FORMAT_R8_USCALED: return 8;
+		case VK_FORMAT_R8_SSCALED: return 8;
+		case VK_FORMAT_R8_UINT: return 8;
+		case VK_FORMAT_R8_SINT: return 8;
+		case VK_FORMAT_R8_SRGB: return 8;
+		case VK_FORMAT_R8G8_UNORM: return 16;
+		case VK_FORMAT_R8G8_SNORM: return 16;
+		case VK_FORMAT_R8G8_USCALED: return 16;
+		case VK_FORMAT_R8G8_SSCALED: return 16;
+		case VK_FORMAT_R8G8_UINT: return 16;
+		case VK_FORMAT_R8G8_SINT: return 16;
+		case VK_FORMAT_R8G8_SRGB: return 16;
+		case VK_FORMAT_R8G8B8_UNORM: return 24;
+		case VK_FORMAT_R8G8B8_SNORM: return 24;
+		case VK_FORMAT_R8G8B8_USCALED: return 24;
+		case VK_FORMAT_R8G8B8_SSCALED: return 24;
+		case VK_FORMAT_R8G8B8_UINT: return 24;
+		case VK_FORMAT_R8G8B8_SINT: return 24;
+		case VK_FORMAT_R8G8B8_SRGB: return 24;
+		case VK_FORMAT_B8G8R8_UNORM: return 24;
+		case VK_FORMAT_B8G8R8_SNORM: return 24;
+		case VK_FORMAT_B8G8R8_USCALED: return 24;
+		case VK_FORMAT_B8G8R8_SSCALED: return 24;
+		case VK_FORMAT_B8G8R8_UINT: return 24;
+		case VK_FORMAT_B8G8R8_SINT: return 24;
+		case VK_FORMAT_B8G8R8_SRGB: return 24;
+		case VK_FORMAT_R8G8B8A8_UNORM: return 32;
+		case VK_FORMAT_R8G8B8A8_SNORM: return 32;
+		case VK_FORMAT_R8G8B8A8_USCALED: return 32;
+		case VK_FORMAT_R8G8B8A8_SSCALED: return 32;
+		case VK_FORMAT_R8G8B8A8_UINT: return 32;
+		case VK_FORMAT_R8G8B8A8_SINT: return 32;
+		case VK_FORMAT_R8G8B8A8_SRGB: return 32;
+		case VK_FORMAT_B8G8R8A8_UNORM: return 32;
+		case VK_FORMAT_B8G8R8A8_SNORM: return 32;
+		case VK_FORMAT_B8G8R8A8_USCALED: return 32;
+		case VK_FORMAT_B8G8R8A8_SSCALED: return 32;
+		case VK_FORMAT_B8G8R8A8_UINT: return 32;
+		case VK_FORMAT_B8G8R8A8_SINT: return 32;
+		case VK_FORMAT_B8G8R8A8_SRGB: return 32;
+		case VK_FORMAT_A8B8G8R8_UNORM_PACK32: return 32;
+		case VK_FORMAT_A8B8G8R8_SNORM_PACK32: return 32;
+		case VK_FORMAT_A8B8G8R8_USCALED_PACK32: return 32;
+		case VK_FORMAT_A8B8G8R8_SSCALED_PACK32: return 32;
+		case VK_FORMAT_A8B8G8R8_UINT_PACK32: return 32;
+		case VK_FORMAT_A8B8G8R8_SINT_PACK32: return 32;
+		case VK_FORMAT_A8B8G8R8_SRGB_PACK32: return 32;
+		case VK_FORMAT_A2R10G10B10_UNORM_PACK32: return 32;
+		case VK_FORMAT_A2R10G10B10_SNORM_PACK32: return 32;
+		case VK_FORMAT_A2R10G10B10_USCALED_PACK32: return 32;
+		case VK_FORMAT_A2R10G10B10_SSCALED_PACK32: return 32;
+		case VK_FORMAT_A2R10G10B10_UINT_PACK32: return 32;
+		case VK_FORMAT_A2R10G10B10_SINT_PACK32: return 32;
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32: return 32;
+		case VK_FORMAT_A2B10G10R10_SNORM_PACK32: return 32;
+		case VK_FORMAT_A2B10G10R10_USCALED_PACK32: return 32;
+		case VK_FORMAT_A2B10G10R10_SSCALED_PACK32: return 32;
+		case VK_FORMAT_A2B10G10R10_UINT_PACK32: return 32;
+		case VK_FORMAT_A2B10G10R10_SINT_PACK32: return 32;
+		case VK_FORMAT_R16_UNORM: return 16;
+		case VK_FORMAT_R16_SNORM: return 16;
+		case VK_FORMAT_R16_USCALED: return 16;
+		case VK_FORMAT_R16_SSCALED: return 16;
+		case VK_FORMAT_R16_UINT: return 16;
+		case VK_FORMAT_R16_SINT: return 16;
+		case VK_FORMAT_R16_SFLOAT: return 16;
+		case VK_FORMAT_R16G16_UNORM: return 32;
+		case VK_FORMAT_R16G16_SNORM: return 32;
+		case VK_FORMAT_R16G16_USCALED: return 32;
+		case VK_FORMAT_R16G16_SSCALED: return 32;
+		case VK_FORMAT_R16G16_UINT: return 32;
+		case VK_FORMAT_R16G16_SINT: return 32;
+		case VK_FORMAT_R16G16_SFLOAT: return 32;
+		case VK_FORMAT_R16G16B16_UNORM: return 48;
+		case VK_FORMAT_R16G16B16_SNORM: return 48;
+		case VK_FORMAT_R16G16B16_USCALED: return 48;
+		case VK_FORMAT_R16G16B16_SSCALED: return 48;
+		case VK_FORMAT_R16G16B16_UINT: return 48;
+		case VK_FORMAT_R16G16B16_SINT: return 48;
+		case VK_FORMAT_R16G16B16_SFLOAT: return 48;
+		case VK_FORMAT_R16G16B16A16_UNORM: return 64;
+		case VK_FORMAT_R16G16B16A16_SNORM: return 64;
+		case VK_FORMAT_R16G16B16A16_USCALED: return 64;
+		case VK_FORMAT_R16G16B16A16_SSCALED: return 64;
+		case VK_FORMAT_R16G16B16A16_UINT: return 64;
+		case VK_FORMAT_R16G16B16A16_SINT: return 64;
+		case VK_FORMAT_R16G16B16A16_SFLOAT: return 64;
+		case VK_FORMAT_R32_UINT: return 32;
+		case VK_FORMAT_R32_SINT: return 32;
+		case VK_FORMAT_R32_SFLOAT: return 32;
+		case VK_FORMAT_R32G32_UINT: return 64;
+		case VK_FORMAT_R32G32_SINT: return 64;
+		case VK_FORMAT_R32G32_SFLOAT: return 64;
+		case VK_FORMAT_R32G32B32_UINT: return 96;
+		case VK_FORMAT_R32G32B32_SINT: return 96;
+		case VK_FORMAT_R32G32B32_SFLOAT: return 96;
+		case VK_FORMAT_R32G32B32A32_UINT: return 128;
+		case VK_FORMAT_R32G32B32A32_SINT: return 128;
+		case VK_FORMAT_R32G32B32A32_SFLOAT: return 128;
+		case VK_FORMAT_R64_UINT: return 64;
+		case VK_FORMAT_R64_SINT: return 64;
+		case VK_FORMAT_R64_SFLOAT: return 64;
+		case VK_FORMAT_R64G64_UINT: return 128;
+		case VK_FORMAT_R64G64_SINT: return 128;
+		case VK_FORMAT_R64G64_SFLOAT: return 128;
+		case VK_FORMAT_R64G64B64_UINT: return 192;
+		case VK_FORMAT_R64G64B64_SINT: return 192;
+		case VK_FORMAT_R64G64B64_SFLOAT: return 192;
+		case VK_FORMAT_R64G64B64A64_UINT: return 256;
+		case VK_FORMAT_R64G64B64A64_SINT: return 256;
+		case VK_FORMAT_R64G64B64A64_SFLOAT: return 256;
+		case VK_FORMAT_B10G11R11_UFLOAT_PACK32: return 32;
+		case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32: return 32;
+		case VK_FORMAT_D16_UNORM: return 16;
+		case VK_FORMAT_X8_D24_UNORM_PACK32: return 32;
+		case VK_FORMAT_D32_SFLOAT: return 32;
+		case VK_FORMAT_S8_UINT: return 8;
+		case VK_FORMAT_D16_UNORM_S8_UINT: return 24;
+		case VK_FORMAT_D24_UNORM_S8_UINT: return 32;
+		case VK_FORMAT_D32_SFLOAT_S8_UINT: return 40;
+		}
+	}
+
+	constexpr uint8_t format_channel_count(int aFormat) {
+		switch (aFormat) {
+		// ===== 1 CHANNEL (R) =====
+		case VK_FORMAT_R8_UNORM:
+		case VK_FORMAT_R8_SNORM:
+		case VK_FORMAT_R8_USCALED:
+		case VK_FORMAT_R8_SSCALED:
+		case VK_FORMAT_R8_UINT:
+		case VK_FORMAT_R8_SINT:
+		case VK_FORMAT_R8_SRGB:
+		case VK_FORMAT_R16_UNORM:
+		case VK_FORMAT_R16_SNORM:
+		case VK_FORMAT_R16_USCALED:
+		case VK_FORMAT_R16_SSCALED:
+		case VK_FORMAT_R16_UINT:
+		case VK_FORMAT_R16_SINT:
+		case VK_FORMAT_R16_SFLOAT:
+		case VK_FORMAT_R32_UINT:
+		case VK_FORMAT_R32_SINT:
+		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_R64_UINT:
+		case VK_FORMAT_R64_SINT:
+		case VK_FORMAT_R64_SFLOAT:
+			return 1;
+		// ===== 2 CHANNELS (RG) =====
+		case VK_FORMAT_R4G4_UNORM_PACK8:
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_R8G8_SNORM:
+		case VK_FORMAT_R8G8_USCALED:
+		case VK_FORMAT_R8G8_SSCALED:
+		case VK_FORMAT_R8G8_UINT:
+		case VK_FORMAT_R8G8_SINT:
+		case VK_FORMAT_R8G8_SRGB:
+		case VK_FORMAT_R16G16_UNORM:
+		case VK_FORMAT_R16G16_SNORM:
+		case VK_FORMAT_R16G16_USCALED:
+		case VK_FORMAT_R16G16_SSCALED:
+		case VK_FORMAT_R16G16_UINT:
+		case VK_FORMAT_R16G16_SINT:
+		case VK_FORMAT_R16G16_SFLOAT:
+		case VK_FORMAT_R32G32_UINT:
+		case VK_FORMAT_R32G32_SINT:
+		case VK_FORMAT_R32G32_SFLOAT:
+		case VK_FORMAT_R64G64_UINT:
+		case VK_FORMAT_R64G64_SINT:
+		case VK_FORMAT_R64G64_SFLOAT:
+			return 2;
+		// ===== 3 CHANNELS (RGB) =====
+		case VK_FORMAT_R5G6B5_UNORM_PACK16:
+		case VK_FORMAT_B5G6R5_UNORM_PACK16:
+		case VK_FORMAT_R8G8B8_UNORM:
+		case VK_FORMAT_R8G8B8_SNORM:
+		case VK_FORMAT_R8G8B8_USCALED:
+		case VK_FORMAT_R8G8B8_SSCALED:
+		case VK_FORMAT_R8G8B8_UINT:
+		case VK_FORMAT_R8G8B8_SINT:
+		case VK_FORMAT_R8G8B8_SRGB:
+		case VK_FORMAT_B8G8R8_UNORM:
+		case VK_FORMAT_B8G8R8_SNORM:
+		case VK_FORMAT_B8G8R8_USCALED:
+		case VK_FORMAT_B8G8R8_SSCALED:
+		case VK_FORMAT_B8G8R8_UINT:
+		case VK_FORMAT_B8G8R8_SINT:
+		case VK_FORMAT_B8G8R8_SRGB:
+		case VK_FORMAT_R16G16B16_UNORM:
+		case VK_FORMAT_R16G16B16_SNORM:
+		case VK_FORMAT_R16G16B16_USCALED:
+		case VK_FORMAT_R16G16B16_SSCALED:
+		case VK_FORMAT_R16G16B16_UINT:
+		case VK_FORMAT_R16G16B16_SINT:
+		case VK_FORMAT_R16G16B16_SFLOAT:
+		case VK_FORMAT_R32G32B32_UINT:
+		case VK_FORMAT_R32G32B32_SINT:
+		case VK_FORMAT_R32G32B32_SFLOAT:
+		case VK_FORMAT_R64G64B64_UINT:
+		case VK_FORMAT_R64G64B64_SINT:
+		case VK_FORMAT_R64G64B64_SFLOAT:
+		case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+		case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+			return 3;
+		// ===== 4 CHANNELS (RGBA) =====
+		case VK_FORMAT_R4G4B4A4_UNORM_PACK16:
+		case VK_FORMAT_B4G4R4A4_UNORM_PACK16:
+		case VK_FORMAT_R5G5B5A1_UNORM_PACK16:
+		case VK_FORMAT_B5G5R5A1_UNORM_PACK16:
+		case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SNORM:
+		case VK_FORMAT_R8G8B8A8_USCALED:
+		case VK_FORMAT_R8G8B8A8_SSCALED:
+		case VK_FORMAT_R8G8B8A8_UINT:
+		case VK_FORMAT_R8G8B8A8_SINT:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SNORM:
+		case VK_FORMAT_B8G8R8A8_USCALED:
+		case VK_FORMAT_B8G8R8A8_SSCALED:
+		case VK_FORMAT_B8G8R8A8_UINT:
+		case VK_FORMAT_B8G8R8A8_SINT:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+		case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+		case VK_FORMAT_A8B8G8R8_SNORM_PACK32:
+		case VK_FORMAT_A8B8G8R8_USCALED_PACK32:
+		case VK_FORMAT_A8B8G8R8_SSCALED_PACK32:
+		case VK_FORMAT_A8B8G8R8_UINT_PACK32:
+		case VK_FORMAT_A8B8G8R8_SINT_PACK32:
+		case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+		case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+		case VK_FORMAT_A2R10G10B10_SNORM_PACK32:
+		case VK_FORMAT_A2R10G10B10_USCALED_PACK32:
+		case VK_FORMAT_A2R10G10B10_SSCALED_PACK32:
+		case VK_FORMAT_A2R10G10B10_UINT_PACK32:
+		case VK_FORMAT_A2R10G10B10_SINT_PACK32:
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+		case VK_FORMAT_A2B10G10R10_SNORM_PACK32:
+		case VK_FORMAT_A2B10G10R10_USCALED_PACK32:
+		case VK_FORMAT_A2B10G10R10_SSCALED_PACK32:
+		case VK_FORMAT_A2B10G10R10_UINT_PACK32:
+		case VK_FORMAT_A2B10G10R10_SINT_PACK32:
+		case VK_FORMAT_R16G16B16A16_UNORM:
+		case VK_FORMAT_R16G16B16A16_SNORM:
+		case VK_FORMAT_R16G16B16A16_USCALED:
+		case VK_FORMAT_R16G16B16A16_SSCALED:
+		case VK_FORMAT_R16G16B16A16_UINT:
+		case VK_FORMAT_R16G16B16A16_SINT:
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R32G32B32A32_UINT:
+		case VK_FORMAT_R32G32B32A32_SINT:
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+		case VK_FORMAT_R64G64B64A64_UINT:
+		case VK_FORMAT_R64G64B64A64_SINT:
+		case VK_FORMAT_R64G64B64A64_SFLOAT:
+			return 4;
+		// ===== DEPTH/STENCIL FORMATS (1 or 2 channels) =====
+		case VK_FORMAT_D16_UNORM:
+		case VK_FORMAT_X8_D24_UNORM_PACK32:
+		case VK_FORMAT_D32_SFLOAT:
+		case VK_FORMAT_S8_UINT:
+			return 1;
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return 2;  // Depth + Stencil
+		default: return 0;
+		}
+	}
+
+	// Block compressed formats, the ASTC HDR variants are only reached through the switch fallback of traits().
+	constexpr uint8_t format_block_width(int aFormat) {
+		switch (aFormat) {
+		default: return 1;
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+		case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+		case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+		case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+		case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+			return 4;
+		case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK:
+			return 4;
+		case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_5x4_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_5x5_SFLOAT_BLOCK:
+			return 5;
+		case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_6x5_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_6x6_SFLOAT_BLOCK:
+			return 6;
+		case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_8x5_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_8x6_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_8x8_SFLOAT_BLOCK:
+			return 8;
+		case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x5_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x6_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x8_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x10_SFLOAT_BLOCK:
+			return 10;
+		case VK_FORMAT_ASTC_12x10_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_12x10_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK:
+			return 12;
+		}
+	}
+
+	constexpr uint8_t format_block_height(int aFormat) {
+		switch (aFormat) {
+		default: return 1;
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+		case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+		case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+		case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+		case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+		case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_5x4_SFLOAT_BLOCK:
+			return 4;
+		case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_5x5_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_6x5_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_8x5_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x5_SFLOAT_BLOCK:
+			return 5;
+		case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_6x6_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_8x6_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x6_SFLOAT_BLOCK:
+			return 6;
+		case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_8x8_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x8_SFLOAT_BLOCK:
+			return 8;
+		case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x10_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_12x10_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_12x10_SFLOAT_BLOCK:
+			return 10;
+		case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK:
+			return 12;
+		}
+	}
+
+	constexpr uint8_t format_block_size(int aFormat) {
+		switch (aFormat) {
+		default: return (uint8_t)(format_bits_per_pixel(aFormat) / 8);
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+		case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+		case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+			return 8;
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+		case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+		case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+		case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_5x4_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_5x5_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_6x5_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_6x6_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_8x5_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_8x6_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_8x8_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x5_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x6_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x8_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_10x10_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_12x10_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_12x10_SFLOAT_BLOCK:
+		case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK:
+			return 16;
+		}
+	}
+
+	template<size_t... I>
+	constexpr std::array<format_traits, sizeof...(I)> make_traits_table(std::index_sequence<I...>) {
+		return {{ format_traits{ format_bits_per_pixel((int)I), format_channel_count((int)I), format_block_width((int)I), format_block_height((int)I), format_block_size((int)I) }... }};
+	}
+
+	// Every core format, VK_FORMAT_UNDEFINED through VK_FORMAT_ASTC_12x12_SRGB_BLOCK.
+	inline constexpr size_t CoreFormatCount = (size_t)VK_FORMAT_ASTC_12x12_SRGB_BLOCK + 1;
+	inline constexpr std::array<format_traits, CoreFormatCount> FormatTraits = make_traits_table(std::make_index_sequence<CoreFormatCount>{});
+
+	// Table lookup for core formats, extension formats fall back to the switches.
+	constexpr format_traits traits(int aFormat) {
+		if ((aFormat >= 0) && ((size_t)aFormat < CoreFormatCount)) return FormatTraits[aFormat];
+		return format_traits{ format_bits_per_pixel(aFormat), format_channel_count(aFormat), format_block_width(aFormat), format_block_height(aFormat), format_block_size(aFormat) };
+	}
+
+	// Replicates one aPixelSize byte pixel aCount times.
+	void fill(void* aDestination, const void* aPixel, size_t aPixelSize, size_t aCount);
+
+	// Swaps the first and third byte of aCount 4 byte pixels, RGBA8 <-> BGRA8.
+	void swizzle_rgba8_bgra8(void* aDestination, const void* aSource, size_t aCount);
+
+	// aCount unorm bytes to floats in [0, 1], and back with clamping and rounding to nearest.
+	void unorm8_to_float(float* aDestination, const uint8_t* aSource, size_t aCount);
+	void float_to_unorm8(uint8_t* aDestination, const float* aSource, size_t aCount);
+
+	// sRGB encoded bytes to linear floats and back. With aChannelCount of 4 the last channel of every
+	// pixel is alpha and converted as unorm, aCount counts pixels.
+	void srgb8_to_linear(float* aDestination, const uint8_t* aSource, size_t aCount, size_t aChannelCount = 4);
+	void linear_to_srgb8(uint8_t* aDestination, const float* aSource, size_t aCount, size_t aChannelCount = 4);
+
+	// IEEE half precision pack and unpack of aCount values, rounding to nearest even.
+	void float_to_half(uint16_t* aDestination, const float* aSource, size_t aCount);
+	void half_to_float(float* aDestination, const uint16_t* aSource, size_t aCount);
+
+	// RGB to RGBA channel expansion of aCount pixels, alpha set to aAlpha. aDestination must not overlap aSource.
+	void rgb8_to_rgba8(uint8_t* aDestination, const uint8_t* aSource, size_t aCount, uint8_t aAlpha = 0xFF);
+	void rgb32f_to_rgba32f(float* aDestination, const float* aSource, size_t aCount, float aAlpha = 1.0f);
+
+	// Values at or above OpaqueThreshold count as opaque, at or below TransparentThreshold as transparent.
+	inline constexpr float OpaqueThreshold 		= 0.999f;
+	inline constexpr float TransparentThreshold 	= 0.001f;
+
+	struct coverage {
+		size_t 			Opaque;
+		size_t 			Transparent;
+		size_t 			Translucent;
+	};
+
+	// Classifies one channel of aCount pixels. aSource points at the channel of the first pixel and
+	// aStride is the distance between pixels in elements, so a single channel of interleaved data is
+	// read without being copied out first.
+	coverage coverage_unorm8(const uint8_t* aSource, size_t aCount, size_t aStride);
+	coverage coverage_unorm16(const uint16_t* aSource, size_t aCount, size_t aStride);
+	coverage coverage_half(const uint16_t* aSource, size_t aCount, size_t aStride);
+	coverage coverage_float(const float* aSource, size_t aCount, size_t aStride);
+
+}
+
+#endif // !GEODESY_GPU_PIXEL_H
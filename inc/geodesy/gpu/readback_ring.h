@@ -0,0 +1,88 @@
+#pragma once
+#ifndef GEODESY_GPU_READBACK_RING_H
+#define GEODESY_GPU_READBACK_RING_H
+
+#include "config.h"
+
+#include <functional>
+
+#include "buffer.h"
+#include "image.h"
+
+namespace geodesy::gpu {
+
+	// Ring of persistently mapped, host cached readback buffers for capturing frames without stalling. The
+	// copy of a frame is recorded into the frame's own command buffer, followed by an event the host polls,
+	// so the GPU keeps rendering while the host consumes earlier frames. Rows are tightly packed. Frames can
+	// be converted on the host to an output format, see convertible().
+	class readback_ring : public resource {
+	public:
+
+		struct frame {
+			uint64_t 					Index; 			// Frame index given to record().
+			image::format 				Format; 		// Output format of Data.
+			VkExtent3D 					Extent;
+			uint32_t 					LayerCount;
+			size_t 						RowPitch;
+			size_t 						Size;
+			const void* 				Data;
+		};
+
+		typedef std::function<void(const frame& aFrame)> callback;
+
+		uint32_t 						SlotCount;
+		size_t 							SlotSize;
+		image::format 					OutputFormat; 	// FORMAT_UNDEFINED keeps the format of the image.
+		callback 						Callback;
+
+		readback_ring();
+		readback_ring(std::shared_ptr<context> aContext, uint32_t aSlotCount, size_t aSlotSize, image::format aOutputFormat = image::format::FORMAT_UNDEFINED, callback aCallback = nullptr);
+		~readback_ring();
+
+		// True if frames of aSourceFormat can be delivered as aOutputFormat.
+		static bool convertible(int aSourceFormat, int aOutputFormat);
+
+		// Records the copy of every layer of level aMipLevel into the next slot. Frames are dropped rather
+		// than waited for: VK_NOT_READY is returned while that slot still holds a frame the host has not
+		// consumed. The slot stays pending until aCommandBuffer completes, cancel() it if it is never submitted.
+		VkResult record(command_buffer* aCommandBuffer, std::shared_ptr<image> aImage, uint64_t aFrameIndex, uint32_t aMipLevel = 0);
+		// Takes back the last record() not yet consumed, newest first, for command buffers that will not be
+		// submitted. Returns false if there is none, or its copy has already completed.
+		bool cancel();
+		// Takes the oldest finished frame in recording order. Its data stays valid until the next call to
+		// next() or poll(). Returns false if it is still in flight, or nothing is pending.
+		bool next(frame& aFrame);
+		// Hands every finished frame to Callback in recording order, returns how many.
+		size_t poll();
+		// Frames recorded and not yet consumed.
+		size_t pending() const;
+
+	private:
+
+		struct slot {
+			std::shared_ptr<buffer> 	Buffer;
+			uint8_t* 					Data; 			// Persistently mapped.
+			VkEvent 					Event;
+			bool 						Pending;
+			uint64_t 					Index;
+			image::format 				Format; 		// Of the copied image.
+			VkExtent3D 					Extent;
+			uint32_t 					LayerCount;
+			size_t 						Size;
+			std::vector<uint8_t> 		Converted;
+		};
+
+		std::vector<slot> 				Slot;
+		uint32_t 						WriteIndex;
+		uint32_t 						ReadIndex;
+		int 							Held; 			// Slot last returned by next(), released on the next call.
+		bool 							Coherent;
+
+		void release_held();
+		bool convert(slot& aSlot, frame& aFrame);
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_READBACK_RING_H
@@ -0,0 +1,164 @@
+#pragma once
+#ifndef GEODESY_GPU_RENDER_GRAPH_H
+#define GEODESY_GPU_RENDER_GRAPH_H
+
+#include "config.h"
+
+#include "device.h"
+#include "semaphore.h"
+#include "fence.h"
+#include "command_buffer.h"
+#include "command_pool.h"
+#include "command_batch.h"
+#include "buffer.h"
+#include "image.h"
+
+#include <functional>
+
+namespace geodesy::gpu {
+
+	// Frame graph. Passes declare the images and buffers they read and write, compile() then derives
+	// the barriers and layout transitions between them, groups adjacent passes on the same queue
+	// into a single command buffer, places transient images whose lifetimes do not overlap in
+	// shared memory, and generates the semaphores and queue ownership transfers needed to run
+	// passes across the graphics, compute and transfer queues. Passes execute in declaration order.
+	class render_graph {
+	public:
+
+		typedef std::function<void(command_buffer* aCommandBuffer)> record_function;
+
+		class pass {
+		public:
+
+			struct image_access {
+				std::shared_ptr<image> 			Image;
+				image::layout 					Layout;
+				VkPipelineStageFlags 			Stage;
+				VkAccessFlags 					Access;
+				bool 							Write;
+			};
+
+			struct buffer_access {
+				std::shared_ptr<buffer> 		Buffer;
+				VkPipelineStageFlags 			Stage;
+				VkAccessFlags 					Access;
+				bool 							Write;
+			};
+
+			std::string 						Name;
+			device::operation 					Operation;
+			std::vector<image_access> 			Image;
+			std::vector<buffer_access> 			Buffer;
+			record_function 					Record;
+
+			pass(std::string aName, device::operation aOperation, record_function aRecord);
+
+			pass& read(std::shared_ptr<image> aImage, image::layout aLayout, VkPipelineStageFlags aStage, VkAccessFlags aAccess = VK_ACCESS_SHADER_READ_BIT);
+			pass& write(std::shared_ptr<image> aImage, image::layout aLayout, VkPipelineStageFlags aStage, VkAccessFlags aAccess);
+			pass& read(std::shared_ptr<buffer> aBuffer, VkPipelineStageFlags aStage, VkAccessFlags aAccess = VK_ACCESS_SHADER_READ_BIT);
+			pass& write(std::shared_ptr<buffer> aBuffer, VkPipelineStageFlags aStage, VkAccessFlags aAccess);
+
+		};
+
+		std::shared_ptr<context> 								Context;
+		std::vector<std::shared_ptr<pass>> 						Pass;
+
+		render_graph();
+		render_graph(std::shared_ptr<context> aContext);
+		~render_graph();
+
+		std::shared_ptr<pass> add_pass(std::string aName, device::operation aOperation, record_function aRecord);
+
+		// Image only used within one frame of the graph. Handles are created by compile(), contents are
+		// undefined at the first pass that uses it every frame.
+		std::shared_ptr<image> create_transient(image::create_info aCreateInfo, image::format aFormat, unsigned int aX, unsigned int aY, unsigned int aZ = 1, unsigned int aT = 1);
+		// Layout an external image is in when the graph starts, and the layout it is left in, LAYOUT_UNDEFINED keeps the last used layout.
+		// Images that are not imported, or imported with LAYOUT_CURRENT, start in the layout they are tracked to be in when
+		// execute() records the graph, so each execution picks up where the previous one left them.
+		void import(std::shared_ptr<image> aImage, image::layout aInitialLayout, image::layout aFinalLayout = image::layout::LAYOUT_UNDEFINED);
+
+		// Schedules passes, derives barriers and allocates transient memory. Must be called again after passes change.
+		VkResult compile();
+		// Records every pass and submits them. The previous execution must have completed, aFence covers the whole graph.
+		// Every image used is tracked in the layout the graph leaves it in.
+		VkResult execute(std::shared_ptr<fence> aFence = nullptr);
+
+	private:
+
+		// Synchronization state of a resource while walking the graph.
+		struct state {
+			image::layout 							Layout;
+			VkPipelineStageFlags 					WriteStage; 		// Last write.
+			VkAccessFlags 							WriteAccess;
+			VkPipelineStageFlags 					ReadStage; 			// Reads since the last write.
+			VkAccessFlags 							ReadAccess; 		// Reads since the last write already made visible.
+			uint32_t 								QueueFamily; 		// Owning queue family, VK_QUEUE_FAMILY_IGNORED before first use.
+			size_t 									Batch; 				// Batch of the last access.
+		};
+
+		struct transient {
+			std::shared_ptr<image> 					Image;
+			image::create_info 						CreateInfo;
+			size_t 									FirstPass;
+			size_t 									LastPass;
+			size_t 									Block; 				// Index into Memory.
+		};
+
+		struct import_info {
+			image::layout 							InitialLayout;
+			image::layout 							FinalLayout;
+		};
+
+		// Where the graph leaves an image, written back to its tracking by execute().
+		struct image_track {
+			image* 									Image;
+			image::layout 							Layout;
+			VkAccessFlags 							Access;
+			VkPipelineStageFlags 					Stage;
+		};
+
+		// First barrier of an image whose initial layout comes from its tracking, patched by execute().
+		struct first_use {
+			image* 									Image;
+			size_t 									Batch;
+			size_t 									Pass; 				// Index into the batch's Barrier.
+			size_t 									Barrier; 			// Index into that set's ImageBarrier.
+		};
+
+		struct barrier_set {
+			VkPipelineStageFlags 					SrcStage;
+			VkPipelineStageFlags 					DstStage;
+			std::vector<VkImageMemoryBarrier> 		ImageBarrier;
+			std::vector<VkBufferMemoryBarrier> 		BufferBarrier;
+		};
+
+		// Run of adjacent passes on one queue family, recorded into one command buffer and submitted together.
+		struct batch {
+			device::operation 						Operation;
+			uint32_t 								QueueFamily;
+			std::vector<size_t> 					Pass;
+			std::vector<barrier_set> 				Barrier; 			// Before each pass, parallel to Pass.
+			std::vector<VkImageMemoryBarrier> 		ReleaseImage; 		// Ownership released at the end of the batch.
+			std::vector<VkBufferMemoryBarrier> 		ReleaseBuffer;
+			VkPipelineStageFlags 					ReleaseStage;
+			barrier_set 							Final; 				// Final layouts of imported images last used in this batch.
+			std::shared_ptr<command_batch> 			Submission;
+		};
+
+		std::vector<transient> 									Transient;
+		std::map<std::shared_ptr<image>, import_info> 			Import;
+		std::vector<VkDeviceMemory> 							Memory; 			// Transient memory blocks, shared by aliased images.
+		std::map<uint32_t, std::shared_ptr<command_pool>> 		CommandPool; 		// One per queue family.
+		std::vector<batch> 										Batch;
+		std::vector<std::shared_ptr<semaphore>> 				Semaphore;
+		std::vector<image_track> 								Track;
+		std::vector<first_use> 									FirstUse;
+
+		void destroy_transients();
+		VkResult allocate_transients();
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_RENDER_GRAPH_H
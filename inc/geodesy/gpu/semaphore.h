@@ -11,10 +11,19 @@ namespace geodesy::gpu {
     public:
 
         VkSemaphore Handle;
+        bool Timeline;
 
         semaphore();
         semaphore(std::shared_ptr<context> aContext);
+        // Timeline semaphore, needs the timelineSemaphore feature. Submissions give their wait and signal
+        // values through command_batch.
+        semaphore(std::shared_ptr<context> aContext, uint64_t aInitialValue);
         ~semaphore();
+
+        // Timeline semaphores only.
+        uint64_t value() const;
+        VkResult wait(uint64_t aValue, uint64_t aTimeout = UINT64_MAX) const;
+        VkResult signal(uint64_t aValue);
         
     };
     
@@ -4,6 +4,10 @@
 
 #include "config.h"
 
+#include "shader_cache.h"
+
+#include <mutex>
+
 namespace geodesy::gpu {
 
 	class shader /*: public io::file, public glslang::TIntermTraverser*/ {
@@ -31,17 +35,29 @@ namespace geodesy::gpu {
 		static bool initialize();
 		static void terminate();
 
+		// Process wide SPIRV cache, in memory by default. Set to nullptr to disable.
+		static std::shared_ptr<shader_cache> Cache;
+
 		stage Stage;
-		std::shared_ptr<glslang::TShader> Handle;
+		std::string Source;
+		uint64_t Key;								// Hash of source, stage and compiler options.
+		std::shared_ptr<glslang::TShader> Handle;	// Parsed lazily, stays null when a pipeline is served from cache.
+		mutable std::mutex Mutex;					// Guards Handle, held by pipelines while they link against it.
 
 		shader();
 		shader(stage aShaderStage, std::string aSourceCode);
 
+		// Parses the source if it has not been already, safe to call from several threads at once.
+		bool compile();
+		std::string info_log() const;
+
 		VkShaderStageFlagBits get_stage();
 		VkPipelineShaderStageCreateInfo pipeline_shader_stage_create_info();
 
 	private:
 
+		bool Parsed;
+
 		bool compile_source(stage aShaderStage, std::string aSourceCode);
 
 	};
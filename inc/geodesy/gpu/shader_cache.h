@@ -0,0 +1,57 @@
+#pragma once
+#ifndef GEODESY_GPU_SHADER_CACHE_H
+#define GEODESY_GPU_SHADER_CACHE_H
+
+#include "config.h"
+
+#include <mutex>
+
+// Bump whenever compiler options or the serialized layout change, invalidates all cached entries.
+#define GEODESY_GPU_SHADER_CACHE_VERSION 1
+
+namespace geodesy::gpu {
+
+	// Content addressed cache of glslang output. Entries are keyed by a hash of the
+	// shader sources, stages and compiler options, and hold everything a pipeline
+	// create_info would otherwise need a linked glslang::TProgram for.
+	class shader_cache {
+	public:
+
+		struct program {
+			std::vector<uint64_t>										ShaderKey;							// Key of each linked shader stage.
+			std::vector<std::vector<unsigned int>>						ByteCode;							// SPIRV Byte Code, parallel to ShaderKey.
+			std::vector<std::vector<VkDescriptorSetLayoutBinding>>		DescriptorSetLayoutBinding;
+			std::vector<VkVertexInputAttributeDescription>				VertexAttribute;					// Rasterizer only.
+			std::vector<VkFormat>										ColorAttachmentFormat;				// Rasterizer only.
+		};
+
+		// 64 bit FNV-1a.
+		static uint64_t hash(const void* aData, size_t aSize, uint64_t aSeed = 14695981039346656037ull);
+		static uint64_t hash(std::string aString, uint64_t aSeed = 14695981039346656037ull);
+		// On disk layout of a single entry, deserialize() rejects data written for another key or cache version.
+		static std::vector<uint8_t> serialize(uint64_t aKey, const program& aProgram);
+		static bool deserialize(uint64_t aKey, const std::vector<uint8_t>& aData, program& aProgram);
+		// Sibling of aFilePath unique to this process and call, written before being renamed over aFilePath.
+		static std::string temporary_path(std::string aFilePath);
+
+		std::string Directory;
+
+		// An empty directory keeps the cache in memory only.
+		shader_cache(std::string aDirectory = "");
+
+		bool find(uint64_t aKey, program& aProgram);
+		void insert(uint64_t aKey, const program& aProgram);
+		void clear();
+
+	private:
+
+		std::mutex Mutex;
+		std::map<uint64_t, program> Program;
+
+		std::string file_path(uint64_t aKey) const;
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_SHADER_CACHE_H
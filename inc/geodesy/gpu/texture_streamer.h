@@ -0,0 +1,129 @@
+#pragma once
+#ifndef GEODESY_GPU_TEXTURE_STREAMER_H
+#define GEODESY_GPU_TEXTURE_STREAMER_H
+
+#include "config.h"
+
+#include <functional>
+#include <future>
+
+#include "buffer.h"
+#include "image.h"
+#include "worker_pool.h"
+
+namespace geodesy::gpu {
+
+	// Mip residency manager for images created with their full mip chain. Only the coarsest levels are
+	// uploaded when a texture is added, finer levels are loaded on worker threads when requested, one level
+	// at a time, and evicted least recently requested first once the streamed levels exceed the budget.
+	// Views are clamped to the resident levels, with VK_EXT_image_view_min_lod when the context enables minLod,
+	// otherwise by starting the view at the finest resident level.
+	//
+	// Requests come from request() or from the feedback buffer, one uint per texture that shaders lower to the
+	// finest level of the image they would sample if every level were resident:
+	//
+	//	layout (set = 0, binding = 0) buffer texture_feedback { uint Level[]; } Feedback;
+	//	float Lod = max(floor(textureQueryLod(Sampler, UV).y), 0.0);
+	//	atomicMin(Feedback.Level[Texture], uint(Lod) + BaseLevel);
+	//
+	// The unclamped LOD is used since the clamped one never drops below the resident level. It is relative to
+	// the base level of the view, BaseLevel is base_level() of the texture as of its last descriptor update.
+	// Feedback of overlapping frames in flight is mixed, requests are only hints.
+	class texture_streamer : public resource {
+	public:
+
+		// Writes level aLevel of every layer, tightly packed, into aData of aSize bytes. Runs on worker threads.
+		typedef std::function<VkResult(uint32_t aLevel, void* aData, size_t aSize)> loader;
+
+		struct create_info {
+			size_t 				Budget; 				// Bytes of streamed levels resident at once, across every texture.
+			size_t 				StagingSize; 			// Bytes of level data loading or waiting for upload at once.
+			uint32_t 			ResidentLevelCount; 	// Coarsest levels uploaded by add(), never evicted.
+			uint32_t 			TextureCapacity; 		// Texture slots, and uints in the feedback buffer.
+			uint32_t 			FrameLatency; 			// update() calls before replaced views and staging buffers are released.
+			create_info();
+		};
+
+		std::shared_ptr<worker_pool> 		WorkerPool;
+		std::shared_ptr<buffer> 			Feedback; 		// Host visible, TextureCapacity uints.
+
+		texture_streamer();
+		texture_streamer(std::shared_ptr<context> aContext, create_info aCreateInfo, std::shared_ptr<worker_pool> aWorkerPool = nullptr);
+		~texture_streamer();
+
+		// Uploads the coarsest levels of aImage through aLoader and waits for them, returns the texture slot
+		// or -1. aImage must have TRANSFER_DST and SAMPLED usage, and is left in SHADER_READ_ONLY_OPTIMAL.
+		int add(std::shared_ptr<image> aImage, loader aLoader);
+		// Waits for pending loads of the texture, its views and image are released after FrameLatency updates.
+		void remove(int aTexture);
+
+		// View clamped to the resident levels, replaced whenever update() reports the texture changed.
+		VkImageView view(int aTexture) const;
+		uint32_t resident_level(int aTexture) const;
+		// First level of view(), zero with the min LOD feature, the resident level otherwise.
+		uint32_t base_level(int aTexture) const;
+		size_t resident_size() const;
+
+		// Requests level aLevel or finer for the next update().
+		void request(int aTexture, uint32_t aLevel);
+		// Records the reset of every feedback entry, before anything of the frame writes it.
+		void reset_feedback(command_buffer* aCommandBuffer);
+		// Turns feedback of a completed frame into requests.
+		void read_feedback();
+
+		// Records the uploads of finished loads and their transitions to SHADER_READ_ONLY_OPTIMAL, evicts
+		// levels over budget, and starts loads for pending requests. Textures whose view was replaced are
+		// appended to aChanged, their descriptors must be updated before the command buffer is submitted.
+		VkResult update(command_buffer* aCommandBuffer, std::vector<int>& aChanged);
+
+	private:
+
+		// One level loading on a worker thread into its own staging buffer.
+		struct load {
+			uint32_t 							Level;
+			size_t 								Size;
+			std::shared_ptr<buffer> 			Staging;
+			std::future<VkResult> 				Result;
+		};
+
+		struct texture {
+			std::shared_ptr<image> 				Image;
+			loader 								Loader;
+			VkImageView 						View;
+			uint32_t 							ResidentLevel; 		// Finest level that may be sampled.
+			uint32_t 							MinimumLevel; 		// Finest level add() uploaded, never evicted below.
+			uint32_t 							RequestedLevel; 	// Finest level requested since the last update().
+			uint32_t 							DesiredLevel; 		// Finest level requested, kept until a coarser request.
+			uint64_t 							LastRequest; 		// Update of the last request, for eviction.
+			std::shared_ptr<load> 				Load; 				// Pending load of level ResidentLevel - 1.
+		};
+
+		// Released once the GPU can no longer be using it.
+		struct retired {
+			uint64_t 							Update;
+			VkImageView 						View;
+			std::shared_ptr<buffer> 			Staging;
+			std::shared_ptr<image> 				Image; 				// Image of a removed texture.
+		};
+
+		create_info 							CreateInfo;
+		std::shared_ptr<command_pool> 			CommandPool; 		// Uploads of add().
+		bool 									MinLod;
+		uint64_t 								UpdateCount;
+		size_t 									ResidentSize; 		// Bytes of streamed levels, levels add() uploaded are not counted.
+		size_t 									StagingSize; 		// Bytes of pending loads.
+		std::vector<texture> 					Texture; 			// Indexed by slot, slots without an image are free.
+		std::vector<retired> 					Retired;
+
+		size_t level_size(const texture& aTexture, uint32_t aLevel) const;
+		VkImageView create_view(const texture& aTexture) const;
+		void replace_view(int aTexture, std::vector<int>& aChanged);
+		// Evicts the finest streamed level of the least recently requested texture other than aKeep.
+		bool evict(int aKeep, std::vector<int>& aChanged);
+		void release(bool aAll);
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_TEXTURE_STREAMER_H
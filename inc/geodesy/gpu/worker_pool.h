@@ -0,0 +1,55 @@
+#pragma once
+#ifndef GEODESY_GPU_WORKER_POOL_H
+#define GEODESY_GPU_WORKER_POOL_H
+
+#include "config.h"
+
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace geodesy::gpu {
+
+	// Fixed size thread pool used for host side work such as shader compilation and
+	// pipeline creation. Tasks run in submission order, their results are returned as futures.
+	class worker_pool {
+	public:
+
+		worker_pool(size_t aThreadCount = 0);
+		~worker_pool();
+
+		template<typename F>
+		std::future<std::invoke_result_t<F>> submit(F&& aTask) {
+			typedef std::invoke_result_t<F> result;
+			std::shared_ptr<std::packaged_task<result()>> Task = std::make_shared<std::packaged_task<result()>>(std::forward<F>(aTask));
+			std::future<result> Future = Task->get_future();
+			{
+				std::lock_guard<std::mutex> Lock(this->Mutex);
+				this->Task.push([Task]() { (*Task)(); });
+			}
+			this->Condition.notify_one();
+			return Future;
+		}
+
+		size_t size() const;
+
+		// True if called from one of this pool's threads.
+		bool is_worker_thread() const;
+
+	private:
+
+		bool 								Stop;
+		std::mutex 							Mutex;
+		std::condition_variable 			Condition;
+		std::queue<std::function<void()>> 	Task;
+		std::vector<std::thread> 			Thread;
+
+		void run();
+
+	};
+
+}
+
+#endif // !GEODESY_GPU_WORKER_POOL_H
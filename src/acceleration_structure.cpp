@@ -1,6 +1,14 @@
 #include <geodesy/gpu/acceleration_structure.h>
 
 #include <geodesy/gpu/context.h>
+#include <geodesy/gpu/instance.h>
+
+#include <algorithm>
+
+// Largest buffer create_batch() sub-allocates acceleration structures from, larger ones get their own.
+#define GPU_ACCELERATION_STRUCTURE_BATCH_BLOCK_SIZE (1 << 28)
+// Required alignment of acceleration structure offsets within their buffer.
+#define GPU_ACCELERATION_STRUCTURE_OFFSET_ALIGNMENT 256
 
 namespace geodesy::gpu {
 
@@ -8,7 +16,8 @@ namespace geodesy::gpu {
 		// Zero init here.
 		this->Context = nullptr;
 		this->Type = resource::type::ACCELERATION_STRUCTURE;
-		
+		this->Handle = VK_NULL_HANDLE;
+		this->DeviceAddress = 0;
 	}
 
 	acceleration_structure::acceleration_structure(
@@ -137,7 +146,7 @@ namespace geodesy::gpu {
 	acceleration_structure::acceleration_structure(
 		std::shared_ptr<context> 									aContext, 
 		const std::vector<VkAccelerationStructureInstanceKHR>& 		aInstanceList	// List of Mesh Instances in Scene
-	) {
+	) : acceleration_structure() {
 		PFN_vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizesKHR = (PFN_vkGetAccelerationStructureBuildSizesKHR)aContext->function_pointer("vkGetAccelerationStructureBuildSizesKHR");
 		PFN_vkCreateAccelerationStructureKHR vkCreateAccelerationStructureKHR = (PFN_vkCreateAccelerationStructureKHR)aContext->function_pointer("vkCreateAccelerationStructureKHR");
 		PFN_vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR = (PFN_vkCmdBuildAccelerationStructuresKHR)aContext->function_pointer("vkCmdBuildAccelerationStructuresKHR");
@@ -257,7 +266,248 @@ namespace geodesy::gpu {
 	}
 
 	acceleration_structure::~acceleration_structure() {
+		if ((this->Context == nullptr) || (this->Handle == VK_NULL_HANDLE)) return;
+		PFN_vkDestroyAccelerationStructureKHR vkDestroyAccelerationStructureKHR = (PFN_vkDestroyAccelerationStructureKHR)this->Context->function_pointer("vkDestroyAccelerationStructureKHR");
+		// Buffer must outlive the handle, it is released after this.
+		vkDestroyAccelerationStructureKHR(this->Context->Handle, this->Handle, NULL);
+	}
+
+	VkResult acceleration_structure::create_batch(std::shared_ptr<context> aContext, const std::vector<geometry>& aGeometry, std::vector<std::shared_ptr<acceleration_structure>>& aAccelerationStructure, size_t aScratchSize) {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkGetPhysicalDeviceProperties2 vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2)aContext->Instance->function_pointer("vkGetPhysicalDeviceProperties2");
+		if (vkGetPhysicalDeviceProperties2 == NULL) {
+			vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2)aContext->Instance->function_pointer("vkGetPhysicalDeviceProperties2KHR");
+		}
+		PFN_vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizesKHR = (PFN_vkGetAccelerationStructureBuildSizesKHR)aContext->function_pointer("vkGetAccelerationStructureBuildSizesKHR");
+		PFN_vkCreateAccelerationStructureKHR vkCreateAccelerationStructureKHR = (PFN_vkCreateAccelerationStructureKHR)aContext->function_pointer("vkCreateAccelerationStructureKHR");
+		PFN_vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR = (PFN_vkCmdBuildAccelerationStructuresKHR)aContext->function_pointer("vkCmdBuildAccelerationStructuresKHR");
+		PFN_vkCmdPipelineBarrier vkCmdPipelineBarrier = (PFN_vkCmdPipelineBarrier)aContext->function_pointer("vkCmdPipelineBarrier");
+
+		aAccelerationStructure = std::vector<std::shared_ptr<acceleration_structure>>(aGeometry.size(), nullptr);
+		if (aGeometry.size() == 0) return Result;
+		if (vkGetPhysicalDeviceProperties2 == NULL) return VK_ERROR_INITIALIZATION_FAILED;
+
+		VkPhysicalDeviceAccelerationStructurePropertiesKHR PDASP{};
+		PDASP.sType 							= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+		PDASP.pNext 							= NULL;
+		VkPhysicalDeviceProperties2 PDP2{};
+		PDP2.sType 								= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		PDP2.pNext 								= &PDASP;
+		vkGetPhysicalDeviceProperties2(aContext->Device->Handle, &PDP2);
+		VkDeviceSize ScratchAlignment = std::max<VkDeviceSize>(PDASP.minAccelerationStructureScratchOffsetAlignment, 1);
+		auto align = [](VkDeviceSize aSize, VkDeviceSize aAlignment) -> VkDeviceSize {
+			return ((aSize + aAlignment - 1) / aAlignment) * aAlignment;
+		};
+
+		// Describe and size every build, geometry and range storage must stay put until recorded.
+		std::vector<VkAccelerationStructureGeometryKHR> ASG(aGeometry.size());
+		std::vector<VkAccelerationStructureBuildGeometryInfoKHR> ASBGI(aGeometry.size());
+		std::vector<VkAccelerationStructureBuildSizesInfoKHR> ASBSI(aGeometry.size());
+		std::vector<VkAccelerationStructureBuildRangeInfoKHR> ASBRI(aGeometry.size());
+		std::vector<bool> Valid(aGeometry.size(), false);
+		for (size_t i = 0; i < aGeometry.size(); i++) {
+			const geometry& Geometry = aGeometry[i];
+			if ((Geometry.VertexBuffer == nullptr) || (Geometry.IndexBuffer == nullptr) || (Geometry.VertexCount == 0) || (Geometry.TriangleCount == 0)) {
+				Result = VK_ERROR_INITIALIZATION_FAILED;
+				continue;
+			}
+			uint32_t PrimitiveCount = Geometry.TriangleCount;
+
+			ASG[i] = {};
+			ASG[i].sType											= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+			ASG[i].pNext											= NULL;
+			ASG[i].geometryType										= VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+			ASG[i].geometry.triangles.sType							= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+			ASG[i].geometry.triangles.pNext							= NULL;
+			ASG[i].geometry.triangles.vertexFormat					= Geometry.VertexPositionFormat;
+			ASG[i].geometry.triangles.vertexData.deviceAddress 		= Geometry.VertexBuffer->device_address() + Geometry.VertexPositionOffset;
+			ASG[i].geometry.triangles.vertexStride					= Geometry.VertexStride;
+			ASG[i].geometry.triangles.maxVertex						= Geometry.VertexCount - 1;
+			ASG[i].geometry.triangles.indexType						= Geometry.IndexType;
+			ASG[i].geometry.triangles.indexData.deviceAddress 		= Geometry.IndexBuffer->device_address();
+			ASG[i].geometry.triangles.transformData.deviceAddress	= 0;
+			ASG[i].flags											= VK_GEOMETRY_OPAQUE_BIT_KHR;
+
+			ASBGI[i] = {};
+			ASBGI[i].sType											= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+			ASBGI[i].pNext											= NULL;
+			ASBGI[i].type											= VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+			ASBGI[i].flags											= VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+			ASBGI[i].mode											= VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+			ASBGI[i].srcAccelerationStructure						= VK_NULL_HANDLE;
+			ASBGI[i].dstAccelerationStructure						= VK_NULL_HANDLE;
+			ASBGI[i].geometryCount									= 1;
+			ASBGI[i].pGeometries									= &ASG[i];
+			ASBGI[i].ppGeometries									= NULL;
+			ASBGI[i].scratchData.deviceAddress						= 0;
+
+			ASBSI[i] = {};
+			ASBSI[i].sType											= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+			ASBSI[i].pNext											= NULL;
+			vkGetAccelerationStructureBuildSizesKHR(aContext->Handle, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &ASBGI[i], &PrimitiveCount, &ASBSI[i]);
+
+			ASBRI[i].primitiveCount 	= PrimitiveCount;
+			ASBRI[i].primitiveOffset 	= 0;
+			ASBRI[i].firstVertex 		= 0;
+			ASBRI[i].transformOffset 	= 0;
+			Valid[i] = true;
+		}
+
+		// Structures are placed back to back in shared storage blocks, structures larger than a block get their own.
+		struct block {
+			VkDeviceSize 								Size;
+			std::vector<std::pair<size_t, VkDeviceSize>> 	Structure; 		// Index and offset.
+		};
+		std::vector<block> Block;
+		for (size_t i = 0; i < aGeometry.size(); i++) {
+			if (!Valid[i]) continue;
+			VkDeviceSize Offset = Block.empty() ? 0 : align(Block.back().Size, GPU_ACCELERATION_STRUCTURE_OFFSET_ALIGNMENT);
+			if (Block.empty() || (Offset + ASBSI[i].accelerationStructureSize > GPU_ACCELERATION_STRUCTURE_BATCH_BLOCK_SIZE)) {
+				Block.push_back({ 0, {} });
+				Offset = 0;
+			}
+			Block.back().Structure.push_back({ i, Offset });
+			Block.back().Size = Offset + ASBSI[i].accelerationStructureSize;
+		}
+
+		gpu::buffer::create_info ASBCI;
+		ASBCI.Memory = device::memory::DEVICE_LOCAL;
+		ASBCI.Usage = buffer::usage::ACCELERATION_STRUCTURE_STORAGE_KHR | buffer::usage::SHADER_DEVICE_ADDRESS | buffer::usage::STORAGE | buffer::usage::TRANSFER_SRC | buffer::usage::TRANSFER_DST;
+		for (const block& Storage : Block) {
+			std::shared_ptr<buffer> Buffer = aContext->create<buffer>(ASBCI, Storage.Size);
+			for (const auto& [Index, Offset] : Storage.Structure) {
+				if (Buffer == nullptr) {
+					Valid[Index] = false;
+					Result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+					continue;
+				}
+				std::shared_ptr<acceleration_structure> AccelerationStructure = std::make_shared<acceleration_structure>();
+				AccelerationStructure->Context = aContext;
+				AccelerationStructure->Buffer = Buffer;
+
+				VkAccelerationStructureCreateInfoKHR ASCI{};
+				ASCI.sType 				= VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+				ASCI.pNext 				= NULL;
+				ASCI.createFlags 		= 0;
+				ASCI.buffer 			= Buffer->Handle;
+				ASCI.offset 			= Offset;
+				ASCI.size 				= ASBSI[Index].accelerationStructureSize;
+				ASCI.type 				= VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+				ASCI.deviceAddress 		= 0;
+				VkResult CreateResult = vkCreateAccelerationStructureKHR(aContext->Handle, &ASCI, NULL, &AccelerationStructure->Handle);
+				if (CreateResult != VK_SUCCESS) {
+					AccelerationStructure->Handle = VK_NULL_HANDLE;
+					Valid[Index] = false;
+					Result = (Result == VK_SUCCESS) ? CreateResult : Result;
+					continue;
+				}
+				ASBGI[Index].dstAccelerationStructure = AccelerationStructure->Handle;
+				aAccelerationStructure[Index] = AccelerationStructure;
+			}
+		}
+
+		// One scratch buffer is shared by every build of a pass, and reused by the next pass once a barrier
+		// has ordered the builds. It is sized to the whole batch when that fits aScratchSize.
+		VkDeviceSize ScratchSize = 0;
+		VkDeviceSize LargestScratchSize = 0;
+		for (size_t i = 0; i < aGeometry.size(); i++) {
+			if (!Valid[i]) continue;
+			ScratchSize += align(ASBSI[i].buildScratchSize, ScratchAlignment);
+			LargestScratchSize = std::max(LargestScratchSize, align(ASBSI[i].buildScratchSize, ScratchAlignment));
+		}
+		if (LargestScratchSize == 0) return Result;
+		ScratchSize = std::max(std::min(ScratchSize, (VkDeviceSize)aScratchSize), LargestScratchSize);
+
+		gpu::buffer::create_info SBCI;
+		SBCI.Memory = device::memory::DEVICE_LOCAL;
+		SBCI.Usage = buffer::usage::SHADER_DEVICE_ADDRESS | buffer::usage::STORAGE | buffer::usage::TRANSFER_SRC | buffer::usage::TRANSFER_DST;
+		// Padded so the base address can be aligned.
+		std::shared_ptr<buffer> ScratchBuffer = aContext->create<buffer>(SBCI, ScratchSize + ScratchAlignment);
+		if (ScratchBuffer == nullptr) {
+			aAccelerationStructure = std::vector<std::shared_ptr<acceleration_structure>>(aGeometry.size(), nullptr);
+			return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+		}
+		VkDeviceAddress ScratchAddress = align(ScratchBuffer->device_address(), ScratchAlignment);
+
+		VkMemoryBarrier ScratchBarrier{};
+		ScratchBarrier.sType 			= VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		ScratchBarrier.srcAccessMask 	= VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+		ScratchBarrier.dstAccessMask 	= VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+		VkMemoryBarrier Barrier{};
+		Barrier.sType 					= VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		Barrier.srcAccessMask 			= VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+		Barrier.dstAccessMask 			= VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+
+		auto CommandPool = aContext->create<command_pool>(device::operation::GRAPHICS);
+		auto CommandBuffer = (CommandPool != nullptr) ? CommandPool->create<command_buffer>() : nullptr;
+		if (CommandBuffer == nullptr) {
+			aAccelerationStructure = std::vector<std::shared_ptr<acceleration_structure>>(aGeometry.size(), nullptr);
+			return VK_ERROR_INITIALIZATION_FAILED;
+		}
+
+		// Builds are packed into the scratch buffer in order, a pass is recorded whenever the next one does not fit.
+		std::vector<VkAccelerationStructureBuildGeometryInfoKHR> Pass;
+		std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> PassRange;
+		VkDeviceSize ScratchOffset = 0;
+		auto record_pass = [&]() {
+			if (Pass.size() == 0) return;
+			vkCmdBuildAccelerationStructuresKHR(CommandBuffer->Handle, Pass.size(), Pass.data(), PassRange.data());
+			vkCmdPipelineBarrier(
+				CommandBuffer->Handle,
+				VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+				0,
+				1, &ScratchBarrier,
+				0, NULL,
+				0, NULL
+			);
+			Pass.clear();
+			PassRange.clear();
+			ScratchOffset = 0;
+		};
+
+		VkResult RecordResult = CommandBuffer->begin();
+		if (RecordResult != VK_SUCCESS) {
+			aAccelerationStructure = std::vector<std::shared_ptr<acceleration_structure>>(aGeometry.size(), nullptr);
+			return RecordResult;
+		}
+		for (size_t i = 0; i < aGeometry.size(); i++) {
+			if (!Valid[i]) continue;
+			VkDeviceSize Size = align(ASBSI[i].buildScratchSize, ScratchAlignment);
+			if (ScratchOffset + Size > ScratchSize) {
+				record_pass();
+			}
+			ASBGI[i].scratchData.deviceAddress = ScratchAddress + ScratchOffset;
+			Pass.push_back(ASBGI[i]);
+			PassRange.push_back(&ASBRI[i]);
+			ScratchOffset += Size;
+		}
+		record_pass();
+		vkCmdPipelineBarrier(
+			CommandBuffer->Handle,
+			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+			0,
+			1, &Barrier,
+			0, NULL,
+			0, NULL
+		);
+		RecordResult = CommandBuffer->end();
+		if (RecordResult != VK_SUCCESS) {
+			aAccelerationStructure = std::vector<std::shared_ptr<acceleration_structure>>(aGeometry.size(), nullptr);
+			return RecordResult;
+		}
 
+		VkResult ExecuteResult = aContext->execute_and_wait(device::operation::GRAPHICS, CommandBuffer);
+		if (ExecuteResult != VK_SUCCESS) {
+			aAccelerationStructure = std::vector<std::shared_ptr<acceleration_structure>>(aGeometry.size(), nullptr);
+			return ExecuteResult;
+		}
+
+		for (std::shared_ptr<acceleration_structure> AccelerationStructure : aAccelerationStructure) {
+			if (AccelerationStructure == nullptr) continue;
+			AccelerationStructure->DeviceAddress = AccelerationStructure->device_address();
+		}
+		return Result;
 	}
 
 	VkDeviceAddress acceleration_structure::device_address() const {
@@ -0,0 +1,93 @@
+#include <geodesy/gpu/barrier_batch.h>
+#include <geodesy/gpu/context.h>
+
+namespace geodesy::gpu {
+
+	barrier_batch::state::state() : state(VK_IMAGE_LAYOUT_UNDEFINED) {}
+
+	barrier_batch::state::state(unsigned int aLayout) {
+		this->Layout 		= aLayout;
+		this->WriteStage 	= 0;
+		this->WriteAccess 	= 0;
+		this->ReadStage 	= 0;
+		this->ReadAccess 	= 0;
+	}
+
+	barrier_batch::barrier_batch() {
+		this->SrcStage 		= 0;
+		this->DstStage 		= 0;
+	}
+
+	bool barrier_batch::is_write(VkAccessFlags aAccess) {
+		const VkAccessFlags WriteAccess =
+			VK_ACCESS_SHADER_WRITE_BIT |
+			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+			VK_ACCESS_TRANSFER_WRITE_BIT |
+			VK_ACCESS_HOST_WRITE_BIT |
+			VK_ACCESS_MEMORY_WRITE_BIT |
+			VK_ACCESS_TRANSFORM_FEEDBACK_WRITE_BIT_EXT |
+			VK_ACCESS_TRANSFORM_FEEDBACK_COUNTER_WRITE_BIT_EXT |
+			VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR |
+			VK_ACCESS_COMMAND_PREPROCESS_WRITE_BIT_NV;
+		return (aAccess & WriteAccess) != 0;
+	}
+
+	bool barrier_batch::access(state& aState, unsigned int aLayout, VkAccessFlags aAccess, VkPipelineStageFlags aStage, VkPipelineStageFlags& aSrcStage, VkAccessFlags& aSrcAccess) {
+		bool Write = is_write(aAccess);
+		bool Needed = false;
+		if ((aLayout != aState.Layout) || Write) {
+			// Layout transitions and writes wait on every earlier access.
+			aSrcStage 	= aState.WriteStage | aState.ReadStage;
+			aSrcAccess 	= aState.WriteAccess;
+			Needed 		= (aLayout != aState.Layout) || (aSrcStage != 0);
+			track(aState, aLayout, aAccess, aStage);
+		}
+		else {
+			// Reads only wait on the last write, unless it was already made visible to them.
+			bool Covered = ((aState.ReadStage & aStage) == aStage) && ((aState.ReadAccess & aAccess) == aAccess);
+			aSrcStage 	= aState.WriteStage;
+			aSrcAccess 	= aState.WriteAccess;
+			Needed 		= (aState.WriteStage != 0) && !Covered;
+			aState.ReadStage 	|= aStage;
+			aState.ReadAccess 	|= aAccess;
+		}
+		return Needed;
+	}
+
+	void barrier_batch::track(state& aState, unsigned int aLayout, VkAccessFlags aAccess, VkPipelineStageFlags aStage) {
+		bool Write = is_write(aAccess);
+		aState.Layout 		= aLayout;
+		aState.WriteStage 	= aStage;
+		aState.WriteAccess 	= Write ? aAccess : 0;
+		aState.ReadStage 	= Write ? 0 : aStage;
+		aState.ReadAccess 	= Write ? 0 : aAccess;
+	}
+
+	bool barrier_batch::empty() const {
+		return (this->BufferBarrier.size() == 0) && (this->ImageBarrier.size() == 0);
+	}
+
+	void barrier_batch::clear() {
+		this->SrcStage 		= 0;
+		this->DstStage 		= 0;
+		this->BufferBarrier.clear();
+		this->ImageBarrier.clear();
+	}
+
+	void barrier_batch::record(command_buffer* aCommandBuffer) {
+		if (this->empty()) return;
+		PFN_vkCmdPipelineBarrier vkCmdPipelineBarrier = (PFN_vkCmdPipelineBarrier)aCommandBuffer->Context->function_pointer("vkCmdPipelineBarrier");
+		vkCmdPipelineBarrier(
+			aCommandBuffer->Handle,
+			(this->SrcStage != 0) ? this->SrcStage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			(this->DstStage != 0) ? this->DstStage : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			0, NULL,
+			this->BufferBarrier.size(), this->BufferBarrier.data(),
+			this->ImageBarrier.size(), this->ImageBarrier.data()
+		);
+		this->clear();
+	}
+
+}
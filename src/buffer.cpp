@@ -104,6 +104,8 @@ namespace geodesy::gpu {
 	void buffer::copy(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aSourceData, std::vector<VkBufferCopy> aRegionList) {
 		PFN_vkCmdCopyBuffer vkCmdCopyBuffer = (PFN_vkCmdCopyBuffer)this->Context->function_pointer("vkCmdCopyBuffer");
 		vkCmdCopyBuffer(aCommandBuffer->Handle, aSourceData->Handle, this->Handle, aRegionList.size(), aRegionList.data());
+		aSourceData->track(VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+		this->track(VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 	}
 
 	void buffer::copy(command_buffer* aCommandBuffer, size_t aDestinationOffset, std::shared_ptr<image> aSourceData, VkOffset3D aSourceOffset, uint32_t aSourceArrayLayer, VkExtent3D aRegionExtent, uint32_t aArrayLayerCount) {
@@ -127,6 +129,10 @@ namespace geodesy::gpu {
 			this->Handle, 
 			aRegionList.size(), aRegionList.data()
 		);
+		for (const VkBufferImageCopy& Region : aRegionList) {
+			aSourceData->track(image::TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Region.imageSubresource.mipLevel, 1, Region.imageSubresource.baseArrayLayer, Region.imageSubresource.layerCount);
+		}
+		this->track(VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 	}
 	
 	VkResult buffer::copy(size_t aDestinationOffset, std::shared_ptr<buffer> aSourceData, size_t aSourceOffset, size_t aRegionSize) {
@@ -151,6 +157,8 @@ namespace geodesy::gpu {
 
 		// Execute command buffer.
 		Result = Context->execute_and_wait(device::operation::TRANSFER, CommandBuffer);
+		this->reset_access();
+		aSourceData->reset_access();
 
 		return Result;
 	}
@@ -182,6 +190,8 @@ namespace geodesy::gpu {
 
 		// Execute command buffer.
 		Result = Context->execute_and_wait(device::operation::TRANSFER, CommandBuffer);
+		this->reset_access();
+		aSourceData->reset_access();
 
 		return Result;
 	}
@@ -353,6 +363,30 @@ namespace geodesy::gpu {
 		return MemoryBarrier;
 	}
 
+	void buffer::require(barrier_batch& aBarrier, VkAccessFlags aAccess, VkPipelineStageFlags aStage) {
+		VkPipelineStageFlags SrcStage = 0;
+		VkAccessFlags SrcAccess = 0;
+		// Tracked for the whole buffer, so the barrier covers all of it.
+		if (!barrier_batch::access(this->State, VK_IMAGE_LAYOUT_UNDEFINED, aAccess, aStage, SrcStage, SrcAccess)) return;
+		aBarrier.SrcStage |= SrcStage;
+		aBarrier.DstStage |= aStage;
+		aBarrier.BufferBarrier.push_back(this->memory_barrier(SrcAccess, aAccess, 0, VK_WHOLE_SIZE));
+	}
+
+	void buffer::require(command_buffer* aCommandBuffer, VkAccessFlags aAccess, VkPipelineStageFlags aStage) {
+		barrier_batch Barrier;
+		this->require(Barrier, aAccess, aStage);
+		Barrier.record(aCommandBuffer);
+	}
+
+	void buffer::track(VkAccessFlags aAccess, VkPipelineStageFlags aStage) {
+		barrier_batch::track(this->State, VK_IMAGE_LAYOUT_UNDEFINED, aAccess, aStage);
+	}
+
+	void buffer::reset_access() {
+		this->State = barrier_batch::state();
+	}
+
 	VkMemoryRequirements buffer::memory_requirements() const {
 		return this->Context->get_buffer_memory_requirements(this->Handle);
 	}
@@ -2,14 +2,27 @@
 
 #include <geodesy/gpu/command_pool.h>
 
+#include <geodesy/gpu/pipeline.h>
+#include <geodesy/gpu/framebuffer.h>
 #include <geodesy/gpu/context.h>
 
 namespace geodesy::gpu {
 
+	command_buffer::inheritance::inheritance() {
+		this->RenderPass 				= VK_NULL_HANDLE;
+		this->Subpass 					= 0;
+		this->Framebuffer 				= VK_NULL_HANDLE;
+		this->DepthAttachmentFormat 	= VK_FORMAT_UNDEFINED;
+		this->StencilAttachmentFormat 	= VK_FORMAT_UNDEFINED;
+		this->RasterizationSamples 		= VK_SAMPLE_COUNT_1_BIT;
+	}
+
 	command_buffer::command_buffer() {
 		this->Type = resource::type::COMMAND_BUFFER;
 		this->CommandPool = nullptr;
+		this->Level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 		this->Handle = VK_NULL_HANDLE;
+		this->clear_recording_state();
 	}
 
 	command_buffer::command_buffer(std::shared_ptr<context> aContext, std::shared_ptr<command_pool> aCommandPool, VkCommandBufferLevel aLevel) : command_buffer() {
@@ -18,6 +31,7 @@ namespace geodesy::gpu {
 		PFN_vkAllocateCommandBuffers vkAllocateCommandBuffers = (PFN_vkAllocateCommandBuffers)aContext->function_pointer("vkAllocateCommandBuffers");
 		this->Context 					= aContext;
 		this->CommandPool 				= aCommandPool;
+		this->Level 					= aLevel;
 		CBAI.sType						= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		CBAI.pNext						= NULL;
 		CBAI.commandPool				= aCommandPool->Handle;
@@ -34,19 +48,118 @@ namespace geodesy::gpu {
 
 	VkResult command_buffer::begin() {
 		VkCommandBufferBeginInfo BeginInfo{};
+		VkCommandBufferInheritanceInfo CBII{};
 		PFN_vkBeginCommandBuffer vkBeginCommandBuffer = (PFN_vkBeginCommandBuffer)this->Context->function_pointer("vkBeginCommandBuffer");
+		this->clear_recording_state();
+		CBII.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		CBII.pNext = NULL;
 		BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		BeginInfo.pNext = NULL;
 		BeginInfo.flags = 0;
-		BeginInfo.pInheritanceInfo = NULL;
+		// Secondaries always require inheritance info, even outside a render pass.
+		BeginInfo.pInheritanceInfo = (this->Level == VK_COMMAND_BUFFER_LEVEL_SECONDARY) ? &CBII : NULL;
 		return vkBeginCommandBuffer(this->Handle, &BeginInfo);
 	}
+
+	VkResult command_buffer::begin(VkRenderPass aRenderPass, uint32_t aSubpass, VkFramebuffer aFramebuffer) {
+		inheritance Inheritance;
+		Inheritance.RenderPass 		= aRenderPass;
+		Inheritance.Subpass 		= aSubpass;
+		Inheritance.Framebuffer 	= aFramebuffer;
+		return this->begin(Inheritance);
+	}
+
+	VkResult command_buffer::begin(std::vector<VkFormat> aColorAttachmentFormat, VkFormat aDepthStencilAttachmentFormat, VkSampleCountFlagBits aSampleCount) {
+		inheritance Inheritance;
+		VkImageAspectFlags Aspect = (aDepthStencilAttachmentFormat != VK_FORMAT_UNDEFINED) ? image::aspect_flag(aDepthStencilAttachmentFormat) : 0;
+		Inheritance.ColorAttachmentFormat 		= aColorAttachmentFormat;
+		Inheritance.DepthAttachmentFormat 		= (Aspect & VK_IMAGE_ASPECT_DEPTH_BIT) ? aDepthStencilAttachmentFormat : VK_FORMAT_UNDEFINED;
+		Inheritance.StencilAttachmentFormat 	= (Aspect & VK_IMAGE_ASPECT_STENCIL_BIT) ? aDepthStencilAttachmentFormat : VK_FORMAT_UNDEFINED;
+		Inheritance.RasterizationSamples 		= aSampleCount;
+		return this->begin(Inheritance);
+	}
+
+	VkResult command_buffer::begin(const inheritance& aInheritance) {
+		VkCommandBufferBeginInfo BeginInfo{};
+		VkCommandBufferInheritanceInfo CBII{};
+		VkCommandBufferInheritanceRenderingInfo CBIRI{};
+		PFN_vkBeginCommandBuffer vkBeginCommandBuffer = (PFN_vkBeginCommandBuffer)this->Context->function_pointer("vkBeginCommandBuffer");
+		this->clear_recording_state();
+		CBIRI.sType 					= VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+		CBIRI.pNext 					= NULL;
+		CBIRI.flags 					= 0;
+		CBIRI.viewMask 					= 0;
+		CBIRI.colorAttachmentCount 		= aInheritance.ColorAttachmentFormat.size();
+		CBIRI.pColorAttachmentFormats 	= aInheritance.ColorAttachmentFormat.data();
+		CBIRI.depthAttachmentFormat 	= aInheritance.DepthAttachmentFormat;
+		CBIRI.stencilAttachmentFormat 	= aInheritance.StencilAttachmentFormat;
+		CBIRI.rasterizationSamples 		= aInheritance.RasterizationSamples;
+		CBII.sType 						= VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		// Rendering info is ignored by render passes, only chained for dynamic rendering.
+		CBII.pNext 						= (aInheritance.RenderPass == VK_NULL_HANDLE) ? &CBIRI : NULL;
+		CBII.renderPass 				= aInheritance.RenderPass;
+		CBII.subpass 					= aInheritance.Subpass;
+		CBII.framebuffer 				= aInheritance.Framebuffer;
+		CBII.occlusionQueryEnable 		= VK_FALSE;
+		CBII.queryFlags 				= 0;
+		CBII.pipelineStatistics 		= 0;
+		BeginInfo.sType 				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		BeginInfo.pNext 				= NULL;
+		BeginInfo.flags 				= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		BeginInfo.pInheritanceInfo 		= &CBII;
+		return vkBeginCommandBuffer(this->Handle, &BeginInfo);
+	}
+
+	VkResult command_buffer::begin(std::shared_ptr<pipeline> aPipeline, std::shared_ptr<framebuffer> aFramebuffer) {
+		inheritance Inheritance;
+		VkResult Result = inheritance_of(aPipeline, aFramebuffer, Inheritance);
+		if (Result == VK_ERROR_FEATURE_NOT_PRESENT) return this->begin();
+		if (Result != VK_SUCCESS) return Result;
+		return this->begin(Inheritance);
+	}
+
+	VkResult command_buffer::inheritance_of(std::shared_ptr<pipeline> aPipeline, std::shared_ptr<framebuffer> aFramebuffer, inheritance& aInheritance) {
+		// Render pass and attachment formats are only published once an asynchronous build completes.
+		if (!aPipeline->is_ready()) return VK_NOT_READY;
+		std::shared_ptr<pipeline::rasterizer> Rasterizer = std::dynamic_pointer_cast<pipeline::rasterizer>(aPipeline->CreateInfo);
+		if (Rasterizer == nullptr) return VK_ERROR_FEATURE_NOT_PRESENT;
+		aInheritance = inheritance();
+		aInheritance.RenderPass 	= aPipeline->RenderPass;
+		aInheritance.Subpass 		= aPipeline->Subpass;
+		aInheritance.Framebuffer 	= (aFramebuffer != nullptr) ? aFramebuffer->Handle : VK_NULL_HANDLE;
+		if (aPipeline->RenderPass != VK_NULL_HANDLE) return VK_SUCCESS;
+		// Same sample count the pipeline was created with, depth only passes take it from the depth attachment.
+		VkFormat DepthStencilFormat = Rasterizer->DepthStencilAttachment.Description.format;
+		VkImageAspectFlags Aspect = (DepthStencilFormat != VK_FORMAT_UNDEFINED) ? image::aspect_flag(DepthStencilFormat) : 0;
+		for (const pipeline::rasterizer::attachment& Attachment : Rasterizer->ColorAttachment) {
+			aInheritance.ColorAttachmentFormat.push_back(Attachment.Description.format);
+		}
+		aInheritance.DepthAttachmentFormat 		= (Aspect & VK_IMAGE_ASPECT_DEPTH_BIT) ? DepthStencilFormat : VK_FORMAT_UNDEFINED;
+		aInheritance.StencilAttachmentFormat 	= (Aspect & VK_IMAGE_ASPECT_STENCIL_BIT) ? DepthStencilFormat : VK_FORMAT_UNDEFINED;
+		if (Rasterizer->ColorAttachment.size() > 0) {
+			aInheritance.RasterizationSamples 	= Rasterizer->ColorAttachment[0].Description.samples;
+		}
+		else if (DepthStencilFormat != VK_FORMAT_UNDEFINED) {
+			aInheritance.RasterizationSamples 	= Rasterizer->DepthStencilAttachment.Description.samples;
+		}
+		return VK_SUCCESS;
+	}
 	
 	VkResult command_buffer::end() {
 		PFN_vkEndCommandBuffer vkEndCommandBuffer = (PFN_vkEndCommandBuffer)this->Context->function_pointer("vkEndCommandBuffer");
 		return vkEndCommandBuffer(this->Handle);
 	}
 
+	void command_buffer::execute(std::vector<std::shared_ptr<command_buffer>> aCommandBufferList) {
+		PFN_vkCmdExecuteCommands vkCmdExecuteCommands = (PFN_vkCmdExecuteCommands)this->Context->function_pointer("vkCmdExecuteCommands");
+		std::vector<VkCommandBuffer> Handle;
+		for (std::shared_ptr<command_buffer> CommandBuffer : aCommandBufferList) {
+			if (CommandBuffer != nullptr) Handle.push_back(CommandBuffer->Handle);
+		}
+		if (Handle.size() == 0) return;
+		vkCmdExecuteCommands(this->Handle, Handle.size(), Handle.data());
+	}
+
 	void command_buffer::bind_vertex_buffers(VkCommandBuffer aCommandBuffer, std::vector<VkBuffer> aBufferList, const VkDeviceSize* aOffset) {
 		PFN_vkCmdBindVertexBuffers vkCmdBindVertexBuffers = (PFN_vkCmdBindVertexBuffers)this->Context->function_pointer("vkCmdBindVertexBuffers");
 		vkCmdBindVertexBuffers(aCommandBuffer, 0, aBufferList.size(), aBufferList.data(), aOffset);
@@ -72,4 +185,12 @@ namespace geodesy::gpu {
 		vkCmdDrawIndexed(aCommandBuffer, aIndexCount, aInstanceCount, aFirstIndex, aVertexOffset, aFirstInstance);
 	}
 
+	void command_buffer::clear_recording_state() {
+		// Beginning implicitly resets the command buffer, nothing recorded before applies anymore.
+		this->RenderPassSkipped = false;
+		this->DynamicState.clear();
+		this->RenderingScope = false;
+		this->RenderingAttachment.clear();
+	}
+
 }
@@ -6,6 +6,7 @@ namespace geodesy::gpu {
 
 	command_pool::command_pool() {
 		this->Handle = VK_NULL_HANDLE;
+		this->Flags = 0;
 		this->Type = resource::type::COMMAND_POOL;
 	}
 
@@ -13,6 +14,7 @@ namespace geodesy::gpu {
 		PFN_vkCreateCommandPool vkCreateCommandPool = (PFN_vkCreateCommandPool)aContext->function_pointer("vkCreateCommandPool");
 		
 		this->Context = aContext;
+		this->Flags = aFlags;
 
 		context::queue Q = aContext->get_execution_queue(aOperation);
 		VkCommandPoolCreateInfo CPCI = {};
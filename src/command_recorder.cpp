@@ -0,0 +1,102 @@
+#include <geodesy/gpu/command_recorder.h>
+#include <geodesy/gpu/context.h>
+
+#include <algorithm>
+
+namespace geodesy::gpu {
+
+	command_recorder::command_recorder() {
+		this->Context = nullptr;
+		this->WorkerPool = nullptr;
+	}
+
+	command_recorder::command_recorder(std::shared_ptr<context> aContext, std::shared_ptr<worker_pool> aWorkerPool, unsigned int aOperation) : command_recorder() {
+		this->Context = aContext;
+		this->WorkerPool = aWorkerPool;
+		// Command pools are externally synchronized, every range gets its own.
+		size_t PoolCount = (aWorkerPool != nullptr) ? aWorkerPool->size() : 1;
+		for (size_t i = 0; i < PoolCount; i++) {
+			std::shared_ptr<command_pool> Pool = aContext->create<command_pool>(aOperation, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+			if (Pool == nullptr) {
+				throw std::runtime_error("Failed to create command recorder pool.");
+			}
+			this->CommandPool.push_back(Pool);
+		}
+	}
+
+	VkResult command_recorder::record(
+		command_buffer* 						aPrimary,
+		std::shared_ptr<pipeline> 				aPipeline,
+		std::shared_ptr<framebuffer> 			aFramebuffer,
+		size_t 									aDrawCount,
+		record_function 						aRecord,
+		size_t 									aMinBatchSize
+	) {
+		if (aDrawCount == 0) return VK_SUCCESS;
+
+		// Secondaries inherit only the render pass or rendering scope, never bound pipelines or dynamic state.
+		command_buffer::inheritance Inheritance;
+		VkResult Result = command_buffer::inheritance_of(aPipeline, aFramebuffer, Inheritance);
+		if (Result != VK_SUCCESS) return Result;
+		const std::map<const pipeline*, command_buffer::dynamic_state> DynamicState = aPrimary->DynamicState;
+
+		size_t RangeCount = std::min(this->CommandPool.size(), (aDrawCount + std::max<size_t>(aMinBatchSize, 1) - 1) / std::max<size_t>(aMinBatchSize, 1));
+		RangeCount = std::max<size_t>(RangeCount, 1);
+		size_t RangeSize = (aDrawCount + RangeCount - 1) / RangeCount;
+
+		std::vector<std::shared_ptr<command_buffer>> Secondary(RangeCount);
+		for (size_t i = 0; i < RangeCount; i++) {
+			Secondary[i] = this->CommandPool[i]->create<command_buffer>(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+			if (Secondary[i] == nullptr) return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+
+		auto Task = [&](size_t aIndex) -> VkResult {
+			size_t Begin = aIndex * RangeSize;
+			size_t End = std::min(Begin + RangeSize, aDrawCount);
+			VkResult Result = Secondary[aIndex]->begin(Inheritance);
+			if (Result != VK_SUCCESS) return Result;
+			Secondary[aIndex]->DynamicState = DynamicState;
+			aPipeline->bind(Secondary[aIndex].get());
+			if (Begin < End) {
+				aRecord(Secondary[aIndex].get(), Begin, End);
+			}
+			return Secondary[aIndex]->end();
+		};
+
+		// Recorded inline if there is no pool, or if called from one of its threads, waiting would deadlock.
+		if ((this->WorkerPool == nullptr) || (RangeCount == 1) || this->WorkerPool->is_worker_thread()) {
+			for (size_t i = 0; i < RangeCount; i++) {
+				VkResult TaskResult = Task(i);
+				if (TaskResult != VK_SUCCESS) Result = TaskResult;
+			}
+		}
+		else {
+			std::vector<std::future<VkResult>> Future;
+			for (size_t i = 0; i < RangeCount; i++) {
+				Future.push_back(this->WorkerPool->submit([&Task, i]() { return Task(i); }));
+			}
+			for (std::future<VkResult>& TaskResult : Future) {
+				VkResult Value = TaskResult.get();
+				if (Value != VK_SUCCESS) Result = Value;
+			}
+		}
+		if (Result != VK_SUCCESS) return Result;
+
+		// Stitched back in submission order.
+		aPrimary->execute(Secondary);
+		this->CommandBuffer.insert(this->CommandBuffer.end(), Secondary.begin(), Secondary.end());
+		return VK_SUCCESS;
+	}
+
+	VkResult command_recorder::reset() {
+		PFN_vkResetCommandPool vkResetCommandPool = (PFN_vkResetCommandPool)this->Context->function_pointer("vkResetCommandPool");
+		VkResult Result = VK_SUCCESS;
+		this->CommandBuffer.clear();
+		for (std::shared_ptr<command_pool> Pool : this->CommandPool) {
+			VkResult PoolResult = vkResetCommandPool(this->Context->Handle, Pool->Handle, 0);
+			if (PoolResult != VK_SUCCESS) Result = PoolResult;
+		}
+		return Result;
+	}
+
+}
@@ -1,6 +1,11 @@
 #include <geodesy/gpu/context.h>
 #include <geodesy/gpu/instance.h>
 
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+
 namespace geodesy::gpu {
 
 	// Internal Execution Submission Structure
@@ -8,12 +13,27 @@ namespace geodesy::gpu {
 		std::vector<VkCommandBuffer> 				CommandBufferList;
 		std::vector<VkSemaphore> 					WaitSemaphoreList;
 		std::vector<VkSemaphore> 					SignalSemaphoreList;
+		std::vector<uint64_t> 						WaitValueList;
+		std::vector<uint64_t> 						SignalValueList;
+		VkTimelineSemaphoreSubmitInfo 				TimelineInfo;
 	};
 
 	context::context() {
 		this->Instance = nullptr;
 		this->Device = nullptr;
 		this->Handle = VK_NULL_HANDLE;
+		this->PipelineCache = VK_NULL_HANDLE;
+		this->PipelineCachePath = "";
+		this->DynamicRendering = false;
+		this->GraphicsPipelineLibrary = false;
+		this->ExtendedDynamicState = false;
+		this->ExtendedDynamicState2 = false;
+		this->DynamicPolygonMode = false;
+		this->DynamicColorBlendEnable = false;
+		this->MultiDraw = false;
+		this->MaxMultiDrawCount = 0;
+		this->TimelineSemaphore = false;
+		this->ImageViewMinLod = false;
 		this->vkGetDeviceProcAddr = NULL;
 	}
 
@@ -31,6 +51,70 @@ namespace geodesy::gpu {
 
 		this->Instance = aInstance;
 		this->Device = aDevice;
+		this->Extensions = aExtensions;
+
+		// Dynamic rendering, pipeline libraries, extended dynamic state 1 to 3, multi draw, timeline semaphores and image view min LOD are features, look for them in the enabled feature chain.
+		for (const VkBaseInStructure* Next = (const VkBaseInStructure*)aNext; Next != NULL; Next = Next->pNext) {
+			if (Next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES) {
+				this->DynamicRendering |= (((const VkPhysicalDeviceDynamicRenderingFeatures*)Next)->dynamicRendering == VK_TRUE);
+			}
+			if (Next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES) {
+				this->DynamicRendering |= (((const VkPhysicalDeviceVulkan13Features*)Next)->dynamicRendering == VK_TRUE);
+			}
+			if (Next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT) {
+				this->GraphicsPipelineLibrary |= (((const VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT*)Next)->graphicsPipelineLibrary == VK_TRUE);
+			}
+			if (Next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT) {
+				this->ExtendedDynamicState |= (((const VkPhysicalDeviceExtendedDynamicStateFeaturesEXT*)Next)->extendedDynamicState == VK_TRUE);
+			}
+			if (Next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT) {
+				this->ExtendedDynamicState2 |= (((const VkPhysicalDeviceExtendedDynamicState2FeaturesEXT*)Next)->extendedDynamicState2 == VK_TRUE);
+			}
+			if (Next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT) {
+				this->DynamicPolygonMode |= (((const VkPhysicalDeviceExtendedDynamicState3FeaturesEXT*)Next)->extendedDynamicState3PolygonMode == VK_TRUE);
+				this->DynamicColorBlendEnable |= (((const VkPhysicalDeviceExtendedDynamicState3FeaturesEXT*)Next)->extendedDynamicState3ColorBlendEnable == VK_TRUE);
+			}
+			if (Next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_FEATURES_EXT) {
+				this->MultiDraw |= (((const VkPhysicalDeviceMultiDrawFeaturesEXT*)Next)->multiDraw == VK_TRUE);
+			}
+			if (Next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES) {
+				this->TimelineSemaphore |= (((const VkPhysicalDeviceVulkan12Features*)Next)->timelineSemaphore == VK_TRUE);
+			}
+			if (Next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES) {
+				this->TimelineSemaphore |= (((const VkPhysicalDeviceTimelineSemaphoreFeatures*)Next)->timelineSemaphore == VK_TRUE);
+			}
+			if (Next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_VIEW_MIN_LOD_FEATURES_EXT) {
+				this->ImageViewMinLod |= (((const VkPhysicalDeviceImageViewMinLodFeaturesEXT*)Next)->minLod == VK_TRUE);
+			}
+		}
+		// The feature structs alone do not enable their extensions. Extended dynamic state 1 and 2 are core in
+		// Vulkan 1.3 without a feature bit, but their commands are loaded by their extension names.
+		this->ExtendedDynamicState &= (aExtensions.count(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME) > 0);
+		this->ExtendedDynamicState2 &= (aExtensions.count(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME) > 0);
+		this->GraphicsPipelineLibrary &= (aExtensions.count(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) > 0);
+		this->DynamicPolygonMode &= (aExtensions.count(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME) > 0);
+		this->DynamicColorBlendEnable &= (aExtensions.count(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME) > 0);
+		this->MultiDraw &= (aExtensions.count(VK_EXT_MULTI_DRAW_EXTENSION_NAME) > 0);
+		this->ImageViewMinLod &= (aExtensions.count(VK_EXT_IMAGE_VIEW_MIN_LOD_EXTENSION_NAME) > 0);
+		// Core since Vulkan 1.2, an extension before.
+		this->TimelineSemaphore &= (aDevice->Properties.apiVersion >= VK_API_VERSION_1_2) || (aExtensions.count(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) > 0);
+		if (this->MultiDraw) {
+			PFN_vkGetPhysicalDeviceProperties2 vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2)aInstance->function_pointer("vkGetPhysicalDeviceProperties2");
+			if (vkGetPhysicalDeviceProperties2 == NULL) {
+				vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2)aInstance->function_pointer("vkGetPhysicalDeviceProperties2KHR");
+			}
+			VkPhysicalDeviceMultiDrawPropertiesEXT MDP{};
+			MDP.sType 				= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_PROPERTIES_EXT;
+			MDP.pNext 				= NULL;
+			VkPhysicalDeviceProperties2 PDP2{};
+			PDP2.sType 				= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			PDP2.pNext 				= &MDP;
+			if (vkGetPhysicalDeviceProperties2 != NULL) {
+				vkGetPhysicalDeviceProperties2(aDevice->Handle, &PDP2);
+			}
+			this->MaxMultiDrawCount = MDP.maxMultiDrawCount;
+			this->MultiDraw = (this->MaxMultiDrawCount > 0);
+		}
 		this->vkGetDeviceProcAddr = (PFN_vkGetDeviceProcAddr)aInstance->function_pointer("vkGetDeviceProcAddr");
 
 		// This keeps track of how many queues have been used up in QueueIndexMap.
@@ -110,18 +194,71 @@ namespace geodesy::gpu {
 		for (auto& Q : Queue) {
 			vkGetDeviceQueue(this->Handle, Q.second.FamilyIndex, Q.second.Index, &Q.second.Handle);
 		}
+
+		// Empty pipeline cache, can be seeded later with load_pipeline_cache.
+		PFN_vkCreatePipelineCache vkCreatePipelineCache = (PFN_vkCreatePipelineCache)this->function_pointer("vkCreatePipelineCache");
+		VkPipelineCacheCreateInfo PCCI{};
+		PCCI.sType						= VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		PCCI.pNext						= NULL;
+		PCCI.flags						= 0;
+		PCCI.initialDataSize			= 0;
+		PCCI.pInitialData				= NULL;
+		Result = vkCreatePipelineCache(this->Handle, &PCCI, NULL, &this->PipelineCache);
+		if (Result != VK_SUCCESS) {
+			this->PipelineCache = VK_NULL_HANDLE;
+		}
 	}
 
 	context::~context() {
+		PFN_vkDestroyPipelineCache vkDestroyPipelineCache = (PFN_vkDestroyPipelineCache)this->function_pointer("vkDestroyPipelineCache");
 		PFN_vkDestroyDevice vkDestroyDevice = (PFN_vkDestroyDevice)this->function_pointer("vkDestroyDevice");
+		PFN_vkDestroyPipeline vkDestroyPipeline = (PFN_vkDestroyPipeline)this->function_pointer("vkDestroyPipeline");
+		PFN_vkDestroyFramebuffer vkDestroyFramebuffer = (PFN_vkDestroyFramebuffer)this->function_pointer("vkDestroyFramebuffer");
+		PFN_vkDestroyRenderPass vkDestroyRenderPass = (PFN_vkDestroyRenderPass)this->function_pointer("vkDestroyRenderPass");
+		// Finish background work first, it may still be creating objects on this device.
+		this->WorkerPool = nullptr;
+		// Cached objects outlive the pipelines and calls that used them.
+		for (auto& [Key, Entry] : this->Framebuffer) {
+			vkDestroyFramebuffer(this->Handle, Entry.Handle, NULL);
+		}
+		this->Framebuffer.clear();
+		this->FramebufferImage.clear();
+		for (auto& [Key, Entry] : this->RenderPass) {
+			vkDestroyRenderPass(this->Handle, Entry.Handle, NULL);
+		}
+		this->RenderPass.clear();
+		// Pipeline library parts outlive the pipelines linked from them.
+		for (auto& [Key, Library] : this->PipelineLibrary) {
+			vkDestroyPipeline(this->Handle, Library, NULL);
+		}
+		this->PipelineLibrary.clear();
+		// Persist pipeline cache before tear down.
+		if (this->PipelineCache != VK_NULL_HANDLE) {
+			if (this->PipelineCachePath.size() > 0) {
+				this->save_pipeline_cache();
+			}
+			vkDestroyPipelineCache(this->Handle, this->PipelineCache, NULL);
+		}
 		// Finally destroy device.
 		vkDestroyDevice(this->Handle, NULL);
 	}
 
+	std::shared_ptr<worker_pool> context::get_worker_pool() {
+		std::lock_guard<std::mutex> Lock(this->WorkerPoolMutex);
+		if (this->WorkerPool == nullptr) {
+			this->WorkerPool = std::make_shared<worker_pool>();
+		}
+		return this->WorkerPool;
+	}
+
 	void* context::function_pointer(std::string aFunctionName) const {
 		return (void*)vkGetDeviceProcAddr(this->Handle, aFunctionName.c_str());
 	}
 
+	bool context::extension_enabled(std::string aExtensionName) const {
+		return this->Extensions.count(aExtensionName) > 0;
+	}
+
 	VkMemoryRequirements context::get_buffer_memory_requirements(VkBuffer aBufferHandle) const {
 		VkMemoryRequirements MemoryRequirements;
 		PFN_vkGetBufferMemoryRequirements vkGetBufferMemoryRequirements = (PFN_vkGetBufferMemoryRequirements)this->function_pointer("vkGetBufferMemoryRequirements");
@@ -174,6 +311,354 @@ namespace geodesy::gpu {
 		}
 	}
 
+	VkResult context::load_pipeline_cache(std::string aFilePath) {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkCreatePipelineCache vkCreatePipelineCache = (PFN_vkCreatePipelineCache)this->function_pointer("vkCreatePipelineCache");
+		PFN_vkMergePipelineCaches vkMergePipelineCaches = (PFN_vkMergePipelineCaches)this->function_pointer("vkMergePipelineCaches");
+		PFN_vkDestroyPipelineCache vkDestroyPipelineCache = (PFN_vkDestroyPipelineCache)this->function_pointer("vkDestroyPipelineCache");
+
+		// Future saves go back to the same file.
+		this->PipelineCachePath = aFilePath;
+
+		// Read entire cache file.
+		std::vector<uint8_t> Data;
+		std::ifstream File(aFilePath, std::ios::binary | std::ios::ate);
+		if (File.is_open()) {
+			std::streamsize FileSize = File.tellg();
+			if (FileSize > 0) {
+				Data.resize((size_t)FileSize);
+				File.seekg(0, std::ios::beg);
+				if (!File.read((char*)Data.data(), FileSize)) {
+					Data.clear();
+				}
+			}
+		}
+
+		// Stale data from a different driver or GPU is discarded.
+		if (!valid_pipeline_cache(Data, this->Device->Properties)) {
+			Data.clear();
+		}
+
+		if (this->PipelineCache == VK_NULL_HANDLE) {
+			return VK_ERROR_INITIALIZATION_FAILED;
+		}
+		if (Data.empty()) {
+			return VK_INCOMPLETE;
+		}
+
+		// Pipelines may be building against the live cache on other threads, so the handle never changes.
+		// The file contents are merged into it through a temporary cache instead.
+		VkPipelineCache FileCache = VK_NULL_HANDLE;
+		VkPipelineCacheCreateInfo PCCI{};
+		PCCI.sType						= VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		PCCI.pNext						= NULL;
+		PCCI.flags						= 0;
+		PCCI.initialDataSize			= Data.size();
+		PCCI.pInitialData				= Data.data();
+		Result = vkCreatePipelineCache(this->Handle, &PCCI, NULL, &FileCache);
+		if (Result != VK_SUCCESS) {
+			// Driver rejected the data anyway, the live cache is left as is.
+			return VK_INCOMPLETE;
+		}
+		{
+			// The merge target must not be in use by pipeline creations on other threads.
+			std::unique_lock<std::shared_mutex> Lock(this->PipelineCacheMutex);
+			Result = vkMergePipelineCaches(this->Handle, this->PipelineCache, 1, &FileCache);
+		}
+		vkDestroyPipelineCache(this->Handle, FileCache, NULL);
+		return Result;
+	}
+
+	bool context::valid_pipeline_cache(const std::vector<uint8_t>& aData, const VkPhysicalDeviceProperties& aProperties) {
+		if (aData.size() < sizeof(VkPipelineCacheHeaderVersionOne)) return false;
+		VkPipelineCacheHeaderVersionOne Header;
+		std::memcpy(&Header, aData.data(), sizeof(VkPipelineCacheHeaderVersionOne));
+		return
+			(Header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne)) &&
+			(Header.headerSize <= aData.size()) &&
+			(Header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE) &&
+			(Header.vendorID == aProperties.vendorID) &&
+			(Header.deviceID == aProperties.deviceID) &&
+			(std::memcmp(Header.pipelineCacheUUID, aProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0);
+	}
+
+	VkResult context::save_pipeline_cache(std::string aFilePath) {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkGetPipelineCacheData vkGetPipelineCacheData = (PFN_vkGetPipelineCacheData)this->function_pointer("vkGetPipelineCacheData");
+
+		std::string FilePath = aFilePath.size() > 0 ? aFilePath : this->PipelineCachePath;
+		if ((this->PipelineCache == VK_NULL_HANDLE) || (FilePath.size() == 0)) {
+			return VK_ERROR_INITIALIZATION_FAILED;
+		}
+
+		// Query size, then contents.
+		std::shared_lock<std::shared_mutex> Lock(this->PipelineCacheMutex);
+		size_t DataSize = 0;
+		Result = vkGetPipelineCacheData(this->Handle, this->PipelineCache, &DataSize, NULL);
+		if ((Result != VK_SUCCESS) || (DataSize == 0)) {
+			return Result;
+		}
+		std::vector<uint8_t> Data(DataSize);
+		Result = vkGetPipelineCacheData(this->Handle, this->PipelineCache, &DataSize, Data.data());
+		if (Result != VK_SUCCESS) {
+			return Result;
+		}
+
+		// Write to a temporary file, then rename over the old cache so a crash never leaves a truncated file behind.
+		std::string TemporaryPath = shader_cache::temporary_path(FilePath);
+		{
+			std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+			if (!File.is_open()) {
+				return VK_ERROR_INITIALIZATION_FAILED;
+			}
+			File.write((const char*)Data.data(), DataSize);
+			File.flush();
+			if (!File.good()) {
+				File.close();
+				std::error_code ErrorCode;
+				std::filesystem::remove(TemporaryPath, ErrorCode);
+				return VK_ERROR_INITIALIZATION_FAILED;
+			}
+		}
+		std::error_code ErrorCode;
+		std::filesystem::rename(TemporaryPath, FilePath, ErrorCode);
+		if (ErrorCode) {
+			std::filesystem::remove(TemporaryPath, ErrorCode);
+			return VK_ERROR_INITIALIZATION_FAILED;
+		}
+
+		return VK_SUCCESS;
+	}
+
+	VkPipeline context::find_pipeline_library(uint64_t aKey) {
+		std::lock_guard<std::mutex> Lock(this->PipelineLibraryMutex);
+		auto It = this->PipelineLibrary.find(aKey);
+		return It != this->PipelineLibrary.end() ? It->second : VK_NULL_HANDLE;
+	}
+
+	VkPipeline context::insert_pipeline_library(uint64_t aKey, VkPipeline aLibrary) {
+		PFN_vkDestroyPipeline vkDestroyPipeline = (PFN_vkDestroyPipeline)this->function_pointer("vkDestroyPipeline");
+		std::lock_guard<std::mutex> Lock(this->PipelineLibraryMutex);
+		auto It = this->PipelineLibrary.find(aKey);
+		if (It != this->PipelineLibrary.end()) {
+			// Lost the race, keep the first one.
+			vkDestroyPipeline(this->Handle, aLibrary, NULL);
+			return It->second;
+		}
+		this->PipelineLibrary[aKey] = aLibrary;
+		return aLibrary;
+	}
+
+	VkRenderPass context::create_render_pass(std::vector<VkAttachmentDescription> aColorAttachment, VkAttachmentDescription aDepthStencilAttachment) {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkCreateRenderPass vkCreateRenderPass = (PFN_vkCreateRenderPass)this->function_pointer("vkCreateRenderPass");
+		bool DepthStencilExists = (aDepthStencilAttachment.format != VK_FORMAT_UNDEFINED);
+		if (!DepthStencilExists) {
+			aDepthStencilAttachment = {};
+		}
+
+		// Key covers formats, samples, load/store ops and layouts, hits are confirmed against the full descriptions.
+		uint64_t Key = shader_cache::hash(aColorAttachment.data(), aColorAttachment.size() * sizeof(VkAttachmentDescription));
+		Key = shader_cache::hash(&aDepthStencilAttachment, sizeof(VkAttachmentDescription), Key);
+
+		std::lock_guard<std::mutex> Lock(this->RenderPassMutex);
+		auto Range = this->RenderPass.equal_range(Key);
+		for (auto It = Range.first; It != Range.second; ++It) {
+			const render_pass_entry& Entry = It->second;
+			bool Match = (Entry.ColorAttachment.size() == aColorAttachment.size());
+			Match = Match && (std::memcmp(Entry.ColorAttachment.data(), aColorAttachment.data(), aColorAttachment.size() * sizeof(VkAttachmentDescription)) == 0);
+			Match = Match && (std::memcmp(&Entry.DepthStencilAttachment, &aDepthStencilAttachment, sizeof(VkAttachmentDescription)) == 0);
+			if (Match) return Entry.Handle;
+		}
+
+		// Attachments
+		std::vector<VkAttachmentDescription> AttachmentDescription = aColorAttachment;
+
+		// References
+		std::vector<VkAttachmentReference> ColorAttachmentReference(aColorAttachment.size());
+		VkAttachmentReference DepthAttachmentReference{};
+
+		// If depth stencil format is not undefined, add to attachment description.
+		if (DepthStencilExists) {
+			DepthAttachmentReference = { (uint32_t)AttachmentDescription.size(), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+			AttachmentDescription.push_back(aDepthStencilAttachment);
+		}
+
+		// Convert to references. 
+		for (size_t i = 0; i < aColorAttachment.size(); i++) {
+			ColorAttachmentReference[i].attachment	= i;
+			ColorAttachmentReference[i].layout		= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		}
+
+		// Subpass Description
+		std::vector<VkSubpassDescription> SubpassDescription(1);
+		SubpassDescription[0].flags							= 0;
+		SubpassDescription[0].pipelineBindPoint				= VK_PIPELINE_BIND_POINT_GRAPHICS;
+		SubpassDescription[0].inputAttachmentCount			= 0;
+		SubpassDescription[0].pInputAttachments				= NULL;
+		SubpassDescription[0].colorAttachmentCount			= ColorAttachmentReference.size();
+		SubpassDescription[0].pColorAttachments				= ColorAttachmentReference.data();
+		SubpassDescription[0].pResolveAttachments			= NULL;
+		SubpassDescription[0].pDepthStencilAttachment		= DepthStencilExists ? &DepthAttachmentReference : NULL;
+		SubpassDescription[0].preserveAttachmentCount		= 0;
+		SubpassDescription[0].pPreserveAttachments			= NULL;
+
+		// Subpass Dependency
+		std::vector<VkSubpassDependency> SubpassDependency(1);
+		SubpassDependency[0].srcSubpass						= VK_SUBPASS_EXTERNAL;
+		SubpassDependency[0].dstSubpass						= 0;
+		SubpassDependency[0].srcStageMask					= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		SubpassDependency[0].dstStageMask					= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		SubpassDependency[0].srcAccessMask					= 0;
+		SubpassDependency[0].dstAccessMask					= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		SubpassDependency[0].dependencyFlags				= 0;
+
+		VkRenderPassCreateInfo RPCI{};
+		RPCI.sType											= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		RPCI.pNext											= NULL;
+		RPCI.flags											= 0;
+		RPCI.attachmentCount								= AttachmentDescription.size();
+		RPCI.pAttachments									= AttachmentDescription.data();
+		RPCI.subpassCount									= SubpassDescription.size();
+		RPCI.pSubpasses										= SubpassDescription.data();
+		RPCI.dependencyCount								= SubpassDependency.size();
+		RPCI.pDependencies									= SubpassDependency.data();
+
+		VkRenderPass Pass = VK_NULL_HANDLE;
+		Result = vkCreateRenderPass(this->Handle, &RPCI, NULL, &Pass);
+		if (Result != VK_SUCCESS) return VK_NULL_HANDLE;
+
+		this->RenderPass.insert({ Key, { Pass, aColorAttachment, aDepthStencilAttachment } });
+		return Pass;
+	}
+
+	std::shared_ptr<framebuffer> context::create_framebuffer(VkRenderPass aRenderPass, std::vector<std::shared_ptr<image>> aImage, std::array<unsigned int, 3> aResolution) {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkCreateFramebuffer vkCreateFramebuffer = (PFN_vkCreateFramebuffer)this->function_pointer("vkCreateFramebuffer");
+
+		// View handles are reused by the driver, images are only reused once their entries have been evicted.
+		std::vector<VkImageView> View(aImage.size());
+		std::vector<const image*> Image(aImage.size());
+		std::vector<uint64_t> ViewGeneration(aImage.size());
+		for (size_t i = 0; i < aImage.size(); i++) {
+			View[i] 			= aImage[i]->View;
+			Image[i] 			= aImage[i].get();
+			ViewGeneration[i] 	= aImage[i]->ViewGeneration;
+		}
+
+		// Only render passes from create_render_pass() are cached against. They live as long as the context, so
+		// their handles are never reused by another render pass. Framebuffers of other render passes are not cached.
+		uint64_t RenderPassKey = 0;
+		bool CachedRenderPass = false;
+		{
+			std::lock_guard<std::mutex> Lock(this->RenderPassMutex);
+			for (const auto& [PassKey, PassEntry] : this->RenderPass) {
+				if (PassEntry.Handle == aRenderPass) {
+					RenderPassKey 		= PassKey;
+					CachedRenderPass 	= true;
+					break;
+				}
+			}
+		}
+
+		VkFramebufferCreateInfo FBCI{};
+		FBCI.sType				= VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		FBCI.pNext				= NULL;
+		FBCI.flags				= 0;
+		FBCI.renderPass			= aRenderPass;
+		FBCI.attachmentCount	= View.size();
+		FBCI.pAttachments		= View.data();
+		FBCI.width				= aResolution[0];
+		FBCI.height				= aResolution[1];
+		FBCI.layers				= 1;
+		if (!CachedRenderPass) {
+			VkFramebuffer Handle = VK_NULL_HANDLE;
+			Result = vkCreateFramebuffer(this->Handle, &FBCI, NULL, &Handle);
+			if (Result != VK_SUCCESS) return nullptr;
+			std::shared_ptr<framebuffer> Uncached = std::make_shared<framebuffer>(this->shared_from_this(), Handle, aImage.size());
+			Uncached->Owned = true;
+			Uncached->Image = aImage;
+			for (size_t i = 0; i < aImage.size(); i++) {
+				Uncached->ClearValue[i] = framebuffer::default_clear_value(aImage[i]->CreateInfo.format);
+			}
+			return Uncached;
+		}
+
+		uint64_t Key = shader_cache::hash(&RenderPassKey, sizeof(uint64_t));
+		Key = shader_cache::hash(Image.data(), Image.size() * sizeof(const image*), Key);
+		Key = shader_cache::hash(ViewGeneration.data(), ViewGeneration.size() * sizeof(uint64_t), Key);
+		Key = shader_cache::hash(aResolution.data(), aResolution.size() * sizeof(unsigned int), Key);
+
+		std::lock_guard<std::mutex> Lock(this->FramebufferMutex);
+		auto Range = this->Framebuffer.equal_range(Key);
+		for (auto It = Range.first; It != Range.second; ++It) {
+			const framebuffer_entry& Entry = It->second;
+			if ((Entry.RenderPass == aRenderPass) && (Entry.Image == Image) && (Entry.ViewGeneration == ViewGeneration) && (Entry.Resolution == aResolution)) {
+				std::shared_ptr<framebuffer> Cached = std::make_shared<framebuffer>(this->shared_from_this(), It->second.Handle, aImage.size());
+				Cached->Image = aImage;
+				for (size_t i = 0; i < aImage.size(); i++) {
+					Cached->ClearValue[i] = framebuffer::default_clear_value(aImage[i]->CreateInfo.format);
+				}
+				return Cached;
+			}
+		}
+
+		framebuffer_entry Entry;
+		Entry.Handle 			= VK_NULL_HANDLE;
+		Entry.RenderPass 		= aRenderPass;
+		Entry.Image 			= Image;
+		Entry.ViewGeneration 	= ViewGeneration;
+		Entry.Resolution 		= aResolution;
+		Result = vkCreateFramebuffer(this->Handle, &FBCI, NULL, &Entry.Handle);
+		if (Result != VK_SUCCESS) return nullptr;
+
+		this->Framebuffer.insert({ Key, Entry });
+		this->FramebufferImage.insert(Image.begin(), Image.end());
+		std::shared_ptr<framebuffer> Created = std::make_shared<framebuffer>(this->shared_from_this(), Entry.Handle, aImage.size());
+		Created->Image = aImage;
+		for (size_t i = 0; i < aImage.size(); i++) {
+			Created->ClearValue[i] = framebuffer::default_clear_value(aImage[i]->CreateInfo.format);
+		}
+		return Created;
+	}
+
+	void context::evict_framebuffers(const image* aImage) {
+		PFN_vkDestroyFramebuffer vkDestroyFramebuffer = (PFN_vkDestroyFramebuffer)this->function_pointer("vkDestroyFramebuffer");
+		std::lock_guard<std::mutex> Lock(this->FramebufferMutex);
+		// Most images are never attached to a cached framebuffer.
+		if (this->FramebufferImage.erase(aImage) == 0) return;
+		for (auto It = this->Framebuffer.begin(); It != this->Framebuffer.end();) {
+			const std::vector<const image*>& Image = It->second.Image;
+			if (std::find(Image.begin(), Image.end(), aImage) != Image.end()) {
+				vkDestroyFramebuffer(this->Handle, It->second.Handle, NULL);
+				It = this->Framebuffer.erase(It);
+			}
+			else {
+				++It;
+			}
+		}
+	}
+
+	std::shared_ptr<pipeline> context::create_compute_pipeline(std::string aSource) {
+		uint64_t Key = shader_cache::hash(aSource);
+		std::lock_guard<std::mutex> Lock(this->ComputePipelineMutex);
+		auto It = this->ComputePipeline.find(Key);
+		if (It != this->ComputePipeline.end()) {
+			std::shared_ptr<pipeline> Cached = It->second.lock();
+			if (Cached != nullptr) return Cached;
+		}
+
+		std::shared_ptr<shader> ComputeShader = geodesy::make<shader>(shader::stage::COMPUTE, aSource);
+		if (ComputeShader == nullptr) return nullptr;
+		std::shared_ptr<pipeline::compute> Compute = geodesy::make<pipeline::compute>(ComputeShader);
+		if (Compute == nullptr) return nullptr;
+		std::shared_ptr<pipeline> Created = this->create<pipeline>(Compute);
+		if (Created != nullptr) {
+			this->ComputePipeline[Key] = Created;
+		}
+		return Created;
+	}
+
 	VkResult context::wait() {
 		PFN_vkDeviceWaitIdle vkDeviceWaitIdle = (PFN_vkDeviceWaitIdle)this->function_pointer("vkDeviceWaitIdle");
 		return vkDeviceWaitIdle(this->Handle);
@@ -265,12 +750,24 @@ namespace geodesy::gpu {
 			for (size_t j = 0; j < aCommandBatchList[i]->SignalSemaphoreList.size(); j++) {
 				Submissions[i].SignalSemaphoreList[j] = aCommandBatchList[i]->SignalSemaphoreList[j]->Handle;
 			}
+			// Timeline values are padded to the semaphore counts, binary semaphores ignore theirs.
+			Submissions[i].WaitValueList = aCommandBatchList[i]->WaitValueList;
+			Submissions[i].WaitValueList.resize(Submissions[i].WaitSemaphoreList.size(), 0);
+			Submissions[i].SignalValueList = aCommandBatchList[i]->SignalValueList;
+			Submissions[i].SignalValueList.resize(Submissions[i].SignalSemaphoreList.size(), 0);
+			Submissions[i].TimelineInfo = {};
+			Submissions[i].TimelineInfo.sType 						= VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			Submissions[i].TimelineInfo.pNext 						= NULL;
+			Submissions[i].TimelineInfo.waitSemaphoreValueCount 	= Submissions[i].WaitValueList.size();
+			Submissions[i].TimelineInfo.pWaitSemaphoreValues 		= Submissions[i].WaitValueList.data();
+			Submissions[i].TimelineInfo.signalSemaphoreValueCount 	= Submissions[i].SignalValueList.size();
+			Submissions[i].TimelineInfo.pSignalSemaphoreValues 		= Submissions[i].SignalValueList.data();
 		}
 
 		// Finalize into VkSubmitInfo structures.
 		for (size_t i = 0; i < aCommandBatchList.size(); i++) {
 			ExecutionLoad[i].sType						= VK_STRUCTURE_TYPE_SUBMIT_INFO;
-			ExecutionLoad[i].pNext						= NULL;
+			ExecutionLoad[i].pNext						= (aCommandBatchList[i]->WaitValueList.empty() && aCommandBatchList[i]->SignalValueList.empty()) ? NULL : &Submissions[i].TimelineInfo;
 			ExecutionLoad[i].waitSemaphoreCount			= Submissions[i].WaitSemaphoreList.size();
 			ExecutionLoad[i].pWaitSemaphores			= Submissions[i].WaitSemaphoreList.data();
 			ExecutionLoad[i].pWaitDstStageMask			= aCommandBatchList[i]->WaitStageList.data();
@@ -0,0 +1,358 @@
+#include <geodesy/gpu/culler.h>
+#include <geodesy/gpu/context.h>
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace geodesy::gpu {
+
+	// Frustum and optional Hi-Z test, visible instances are appended to the draw buffer. Prefixed with
+	// the version and OCCLUSION define.
+	static const char* CullSource = R"(
+layout (local_size_x = 64) in;
+
+struct instance {
+	vec4 Sphere;
+	vec3 Extent;
+	uint InstanceIndex;
+	uint IndexCount;
+	uint FirstIndex;
+	int VertexOffset;
+	uint Padding;
+};
+
+layout (set = 0, binding = 0) uniform view {
+	mat4 ViewProjection;
+	vec4 Plane[6];
+	uvec4 Parameter; // InstanceCount, HiZLevelCount, HiZWidth, HiZHeight
+} View;
+
+layout (set = 0, binding = 1) readonly buffer instance_buffer {
+	instance Instance[];
+};
+
+layout (set = 0, binding = 2) writeonly buffer draw_buffer {
+	uint Draw[];
+};
+
+layout (set = 0, binding = 3) buffer count_buffer {
+	uint Count;
+};
+
+#if OCCLUSION
+layout (set = 0, binding = 4) uniform sampler2D HiZ;
+
+bool occluded(vec3 aMin, vec3 aMax) {
+	vec2 UVMin = vec2(1.0);
+	vec2 UVMax = vec2(0.0);
+	float Depth = 1.0;
+	for (int i = 0; i < 8; i++) {
+		vec3 Corner = vec3((i & 1) != 0 ? aMax.x : aMin.x, (i & 2) != 0 ? aMax.y : aMin.y, (i & 4) != 0 ? aMax.z : aMin.z);
+		vec4 Clip = View.ViewProjection * vec4(Corner, 1.0);
+		// Crosses the near plane, never occluded.
+		if (Clip.w <= 1e-5) return false;
+		vec3 NDC = Clip.xyz / Clip.w;
+		UVMin = min(UVMin, NDC.xy * 0.5 + 0.5);
+		UVMax = max(UVMax, NDC.xy * 0.5 + 0.5);
+		Depth = min(Depth, NDC.z);
+	}
+	UVMin = clamp(UVMin, 0.0, 1.0);
+	UVMax = clamp(UVMax, 0.0, 1.0);
+	vec2 Size = (UVMax - UVMin) * vec2(View.Parameter.zw);
+	// Level at which the footprint covers at most 2x2 texels.
+	int Level = clamp(int(ceil(log2(max(max(Size.x, Size.y), 1.0)))), 0, int(View.Parameter.y) - 1);
+	ivec2 LevelSize = textureSize(HiZ, Level);
+	ivec2 Min = clamp(ivec2(UVMin * vec2(LevelSize)), ivec2(0), LevelSize - 1);
+	ivec2 Max = clamp(ivec2(UVMax * vec2(LevelSize)), ivec2(0), LevelSize - 1);
+	float Occluder = max(
+		max(texelFetch(HiZ, Min, Level).r, texelFetch(HiZ, ivec2(Max.x, Min.y), Level).r),
+		max(texelFetch(HiZ, ivec2(Min.x, Max.y), Level).r, texelFetch(HiZ, Max, Level).r)
+	);
+	return Depth > Occluder;
+}
+#endif
+
+void main() {
+	uint i = gl_GlobalInvocationID.x;
+	if (i >= View.Parameter.x) return;
+	instance Object = Instance[i];
+	vec3 Center = Object.Sphere.xyz;
+	float Radius = Object.Sphere.w;
+	bool Box = dot(Object.Extent, Object.Extent) > 0.0;
+	for (int p = 0; p < 6; p++) {
+		// Boxes use their projected radius along the plane normal.
+		float Reach = Box ? dot(abs(View.Plane[p].xyz), Object.Extent) : Radius;
+		if (dot(View.Plane[p].xyz, Center) + View.Plane[p].w < -Reach) return;
+	}
+#if OCCLUSION
+	vec3 Extent = Box ? Object.Extent : vec3(Radius);
+	if ((View.Parameter.y > 0) && occluded(Center - Extent, Center + Extent)) return;
+#endif
+	uint Slot = atomicAdd(Count, 1);
+	Draw[Slot * 5 + 0] = Object.IndexCount;
+	Draw[Slot * 5 + 1] = 1;
+	Draw[Slot * 5 + 2] = Object.FirstIndex;
+	Draw[Slot * 5 + 3] = uint(Object.VertexOffset);
+	Draw[Slot * 5 + 4] = Object.InstanceIndex;
+}
+)";
+
+	// Conservative max reduction of one pyramid level into the next.
+	static const char* ReduceSource = R"(
+#version 450
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (set = 0, binding = 0) uniform sampler2D Source;
+layout (set = 0, binding = 1, r32f) uniform writeonly image2D Destination;
+
+void main() {
+	ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 DestinationSize = imageSize(Destination);
+	if (any(greaterThanEqual(p, DestinationSize))) return;
+	ivec2 SourceSize = textureSize(Source, 0);
+	// Footprint of this texel in the source level, odd sizes cover an extra row or column.
+	ivec2 Lo = (p * SourceSize) / DestinationSize;
+	ivec2 Hi = min(((p + 1) * SourceSize + DestinationSize - 1) / DestinationSize, SourceSize) - 1;
+	float Depth = 0.0;
+	for (int y = Lo.y; y <= Hi.y; y++) {
+		for (int x = Lo.x; x <= Hi.x; x++) {
+			Depth = max(Depth, texelFetch(Source, ivec2(x, y), 0).r);
+		}
+	}
+	imageStore(Destination, p, vec4(Depth));
+}
+)";
+
+	void culler::frustum_planes(const float aViewProjection[16], float aPlane[6][4]) {
+		float Row[4][4];
+		for (int r = 0; r < 4; r++) {
+			for (int c = 0; c < 4; c++) {
+				Row[r][c] = aViewProjection[c * 4 + r];
+			}
+		}
+		for (int c = 0; c < 4; c++) {
+			aPlane[0][c] = Row[3][c] + Row[0][c]; 	// Left
+			aPlane[1][c] = Row[3][c] - Row[0][c]; 	// Right
+			aPlane[2][c] = Row[3][c] + Row[1][c]; 	// Bottom
+			aPlane[3][c] = Row[3][c] - Row[1][c]; 	// Top
+			aPlane[4][c] = Row[2][c]; 				// Near
+			aPlane[5][c] = Row[3][c] - Row[2][c]; 	// Far
+		}
+		for (int p = 0; p < 6; p++) {
+			float Length = std::sqrt(aPlane[p][0] * aPlane[p][0] + aPlane[p][1] * aPlane[p][1] + aPlane[p][2] * aPlane[p][2]);
+			if (Length <= 0.0f) continue;
+			for (int c = 0; c < 4; c++) {
+				aPlane[p][c] /= Length;
+			}
+		}
+	}
+
+	culler::culler() {
+		this->Context = nullptr;
+		this->Type = resource::type::UNKNOWN;
+		this->MaxInstanceCount = 0;
+		this->FrameLatency = 3;
+		this->DepthView = VK_NULL_HANDLE;
+		this->BuildCount = 0;
+	}
+
+	culler::culler(std::shared_ptr<context> aContext, size_t aMaxInstanceCount, uint32_t aFrameLatency) : culler() {
+		this->Context = aContext;
+		this->MaxInstanceCount = aMaxInstanceCount;
+		this->FrameLatency = aFrameLatency;
+
+		this->CullPipeline = aContext->create_compute_pipeline(std::string("#version 450\n#define OCCLUSION 0\n") + CullSource);
+		this->OcclusionPipeline = aContext->create_compute_pipeline(std::string("#version 450\n#define OCCLUSION 1\n") + CullSource);
+		this->ReducePipeline = aContext->create_compute_pipeline(ReduceSource);
+		if ((this->CullPipeline == nullptr) || (this->OcclusionPipeline == nullptr) || (this->ReducePipeline == nullptr)) {
+			throw std::runtime_error("Failed to create culling pipelines.");
+		}
+
+		this->InstanceBuffer = aContext->create<buffer>(
+			device::memory::DEVICE_LOCAL,
+			buffer::usage::STORAGE | buffer::usage::TRANSFER_DST | buffer::usage::TRANSFER_SRC,
+			aMaxInstanceCount, aMaxInstanceCount * sizeof(instance)
+		);
+		this->DrawBuffer = aContext->create<buffer>(
+			device::memory::DEVICE_LOCAL,
+			buffer::usage::STORAGE | buffer::usage::INDIRECT | buffer::usage::TRANSFER_SRC,
+			aMaxInstanceCount, aMaxInstanceCount * sizeof(VkDrawIndexedIndirectCommand)
+		);
+		this->CountBuffer = aContext->create<buffer>(
+			device::memory::DEVICE_LOCAL,
+			buffer::usage::STORAGE | buffer::usage::INDIRECT | buffer::usage::TRANSFER_DST | buffer::usage::TRANSFER_SRC,
+			1, sizeof(uint32_t)
+		);
+		this->ViewBuffer = aContext->create<buffer>(
+			device::memory::DEVICE_LOCAL,
+			buffer::usage::UNIFORM | buffer::usage::TRANSFER_DST,
+			1, sizeof(view)
+		);
+		if ((this->InstanceBuffer == nullptr) || (this->DrawBuffer == nullptr) || (this->CountBuffer == nullptr) || (this->ViewBuffer == nullptr)) {
+			throw std::runtime_error("Failed to create culling buffers.");
+		}
+
+		this->CullDescriptor = aContext->create<descriptor::array>(this->CullPipeline);
+		this->CullDescriptor->bind(0, 0, 0, this->ViewBuffer->Handle);
+		this->CullDescriptor->bind(0, 1, 0, this->InstanceBuffer->Handle);
+		this->CullDescriptor->bind(0, 2, 0, this->DrawBuffer->Handle);
+		this->CullDescriptor->bind(0, 3, 0, this->CountBuffer->Handle);
+	}
+
+	culler::~culler() {
+		this->retire_hiz();
+		this->release(true);
+	}
+
+	void culler::build_hiz(command_buffer* aCommandBuffer, std::shared_ptr<image> aDepth, image::layout aDepthLayout) {
+		unsigned int Width = aDepth->CreateInfo.extent.width;
+		unsigned int Height = aDepth->CreateInfo.extent.height;
+		this->BuildCount++;
+		this->release(false);
+
+		// (Re)create the pyramid, every level is kept in GENERAL. Frames in flight may still sample the old one.
+		if ((this->HiZ == nullptr) || (this->HiZ->CreateInfo.extent.width != Width) || (this->HiZ->CreateInfo.extent.height != Height)) {
+			this->retire_hiz();
+			image::create_info HCI;
+			HCI.Layout 		= image::layout::GENERAL;
+			HCI.Memory 		= device::memory::DEVICE_LOCAL;
+			HCI.Usage 		= image::usage::STORAGE | image::usage::SAMPLED;
+			HCI.MipLevels 	= true;
+			this->HiZ = this->Context->create<image>(HCI, image::format::R32_SFLOAT, Width, Height);
+			if (this->HiZ == nullptr) return;
+
+			this->HiZView = std::vector<VkImageView>(this->HiZ->CreateInfo.mipLevels);
+			this->ReduceDescriptor = std::vector<std::shared_ptr<descriptor::array>>(this->HiZView.size());
+			for (size_t i = 0; i < this->HiZView.size(); i++) {
+				this->HiZView[i] = this->HiZ->view(i, 1);
+				this->ReduceDescriptor[i] = this->Context->create<descriptor::array>(this->ReducePipeline);
+				if (i > 0) {
+					this->ReduceDescriptor[i]->bind(0, 0, 0, this->HiZView[i - 1], image::layout::GENERAL);
+				}
+				this->ReduceDescriptor[i]->bind(0, 1, 0, this->HiZView[i], image::layout::GENERAL);
+			}
+
+			this->OcclusionDescriptor = this->Context->create<descriptor::array>(this->OcclusionPipeline);
+			this->OcclusionDescriptor->bind(0, 0, 0, this->ViewBuffer->Handle);
+			this->OcclusionDescriptor->bind(0, 1, 0, this->InstanceBuffer->Handle);
+			this->OcclusionDescriptor->bind(0, 2, 0, this->DrawBuffer->Handle);
+			this->OcclusionDescriptor->bind(0, 3, 0, this->CountBuffer->Handle);
+			this->OcclusionDescriptor->bind(0, 4, 0, this->HiZ->View, image::layout::GENERAL);
+		}
+		if (this->DepthView != aDepth->View) {
+			// Frames in flight may still use the first level's set, it is replaced rather than rewritten.
+			if (this->DepthView != VK_NULL_HANDLE) {
+				retired Entry;
+				Entry.Build 		= this->BuildCount;
+				Entry.Descriptor 	= { this->ReduceDescriptor[0] };
+				this->Retired.push_back(Entry);
+				this->ReduceDescriptor[0] = this->Context->create<descriptor::array>(this->ReducePipeline);
+				this->ReduceDescriptor[0]->bind(0, 1, 0, this->HiZView[0], image::layout::GENERAL);
+			}
+			this->ReduceDescriptor[0]->bind(0, 0, 0, aDepth->View, image::layout::SHADER_READ_ONLY_OPTIMAL);
+			this->DepthView = aDepth->View;
+		}
+
+		// Depth writes visible to the first reduction, previous culls done reading the pyramid.
+		pipeline::barrier(aCommandBuffer,
+			pipeline::stage::LATE_FRAGMENT_TESTS | pipeline::stage::COMPUTE_SHADER, pipeline::stage::COMPUTE_SHADER,
+			{}, {}, {
+				aDepth->memory_barrier(device::access::DEPTH_STENCIL_ATTACHMENT_WRITE, device::access::SHADER_READ, aDepthLayout, image::layout::SHADER_READ_ONLY_OPTIMAL),
+				this->HiZ->memory_barrier(device::access::SHADER_READ, device::access::SHADER_WRITE, image::layout::GENERAL, image::layout::GENERAL)
+			}
+		);
+		for (size_t i = 0; i < this->HiZView.size(); i++) {
+			unsigned int LevelWidth = std::max(1u, Width >> i);
+			unsigned int LevelHeight = std::max(1u, Height >> i);
+			this->ReducePipeline->dispatch(aCommandBuffer, { (LevelWidth + 7) / 8, (LevelHeight + 7) / 8, 1 }, this->ReduceDescriptor[i]);
+			pipeline::barrier(aCommandBuffer,
+				pipeline::stage::COMPUTE_SHADER, pipeline::stage::COMPUTE_SHADER,
+				{}, {}, { this->HiZ->memory_barrier(device::access::SHADER_WRITE, device::access::SHADER_READ, image::layout::GENERAL, image::layout::GENERAL, i, 1) }
+			);
+		}
+		pipeline::barrier(aCommandBuffer,
+			pipeline::stage::COMPUTE_SHADER, pipeline::stage::EARLY_FRAGMENT_TESTS | pipeline::stage::LATE_FRAGMENT_TESTS,
+			{}, {}, { aDepth->memory_barrier(device::access::SHADER_READ, device::access::DEPTH_STENCIL_ATTACHMENT_READ | device::access::DEPTH_STENCIL_ATTACHMENT_WRITE, image::layout::SHADER_READ_ONLY_OPTIMAL, aDepthLayout) }
+		);
+	}
+
+	void culler::cull(command_buffer* aCommandBuffer, const float aViewProjection[16], uint32_t aInstanceCount, bool aOcclusion) {
+		PFN_vkCmdUpdateBuffer vkCmdUpdateBuffer = (PFN_vkCmdUpdateBuffer)this->Context->function_pointer("vkCmdUpdateBuffer");
+		PFN_vkCmdFillBuffer vkCmdFillBuffer = (PFN_vkCmdFillBuffer)this->Context->function_pointer("vkCmdFillBuffer");
+		bool Occlusion = aOcclusion && (this->HiZ != nullptr);
+
+		// View data travels inline with the command buffer, frames in flight never share it.
+		view View{};
+		std::memcpy(View.ViewProjection, aViewProjection, sizeof(View.ViewProjection));
+		frustum_planes(aViewProjection, View.Plane);
+		View.InstanceCount 		= std::min<size_t>(aInstanceCount, this->MaxInstanceCount);
+		View.HiZLevelCount 		= Occlusion ? this->HiZ->CreateInfo.mipLevels : 0;
+		View.HiZWidth 			= Occlusion ? this->HiZ->CreateInfo.extent.width : 0;
+		View.HiZHeight 			= Occlusion ? this->HiZ->CreateInfo.extent.height : 0;
+
+		// Previous draws done reading the draw and count buffers before they are overwritten.
+		pipeline::barrier(aCommandBuffer,
+			pipeline::stage::DRAW_INDIRECT | pipeline::stage::COMPUTE_SHADER, pipeline::stage::TRANSFER,
+			device::access::INDIRECT_COMMAND_READ | device::access::UNIFORM_READ, device::access::TRANSFER_WRITE
+		);
+		vkCmdUpdateBuffer(aCommandBuffer->Handle, this->ViewBuffer->Handle, 0, sizeof(view), &View);
+		vkCmdFillBuffer(aCommandBuffer->Handle, this->CountBuffer->Handle, 0, sizeof(uint32_t), 0);
+		pipeline::barrier(aCommandBuffer,
+			pipeline::stage::TRANSFER | pipeline::stage::DRAW_INDIRECT, pipeline::stage::COMPUTE_SHADER,
+			device::access::TRANSFER_WRITE, device::access::UNIFORM_READ | device::access::SHADER_READ | device::access::SHADER_WRITE
+		);
+
+		if (Occlusion) {
+			this->OcclusionPipeline->dispatch(aCommandBuffer, { (View.InstanceCount + 63) / 64, 1, 1 }, this->OcclusionDescriptor);
+		}
+		else {
+			this->CullPipeline->dispatch(aCommandBuffer, { (View.InstanceCount + 63) / 64, 1, 1 }, this->CullDescriptor);
+		}
+
+		// Compacted draws visible to the indirect stage.
+		pipeline::barrier(aCommandBuffer,
+			pipeline::stage::COMPUTE_SHADER, pipeline::stage::DRAW_INDIRECT,
+			device::access::SHADER_WRITE, device::access::INDIRECT_COMMAND_READ
+		);
+	}
+
+	void culler::draw(command_buffer* aCommandBuffer, std::shared_ptr<pipeline> aPipeline) {
+		aPipeline->draw_indexed_indirect_count(aCommandBuffer, this->DrawBuffer, 0, this->CountBuffer, 0, this->MaxInstanceCount);
+	}
+
+	void culler::retire_hiz() {
+		if (this->HiZ == nullptr) return;
+		retired Entry;
+		Entry.Build 		= this->BuildCount;
+		Entry.HiZ 			= this->HiZ;
+		Entry.View 			= this->HiZView;
+		Entry.Descriptor 	= this->ReduceDescriptor;
+		Entry.Descriptor.push_back(this->OcclusionDescriptor);
+		this->Retired.push_back(Entry);
+		this->OcclusionDescriptor = nullptr;
+		this->ReduceDescriptor.clear();
+		this->HiZView.clear();
+		this->HiZ = nullptr;
+		this->DepthView = VK_NULL_HANDLE;
+	}
+
+	void culler::release(bool aAll) {
+		if ((this->Context == nullptr) || (this->Retired.size() == 0)) return;
+		PFN_vkDestroyImageView vkDestroyImageView = (PFN_vkDestroyImageView)this->Context->function_pointer("vkDestroyImageView");
+		std::vector<retired> Kept;
+		for (retired& Entry : this->Retired) {
+			if (!aAll && (Entry.Build + this->FrameLatency > this->BuildCount)) {
+				Kept.push_back(Entry);
+				continue;
+			}
+			// Descriptor sets referencing the views go first.
+			Entry.Descriptor.clear();
+			for (VkImageView View : Entry.View) {
+				vkDestroyImageView(this->Context->Handle, View, NULL);
+			}
+		}
+		this->Retired = Kept;
+	}
+
+}
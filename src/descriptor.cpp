@@ -39,6 +39,11 @@ namespace geodesy::gpu {
 		PFN_vkCreateDescriptorPool vkCreateDescriptorPool = (PFN_vkCreateDescriptorPool)aContext->function_pointer("vkCreateDescriptorPool");
 		PFN_vkAllocateDescriptorSets vkAllocateDescriptorSets = (PFN_vkAllocateDescriptorSets)aContext->function_pointer("vkAllocateDescriptorSets");
 		PFN_vkCreateSampler vkCreateSampler = (PFN_vkCreateSampler)aContext->function_pointer("vkCreateSampler");
+
+		// Set layouts are only published once an asynchronous build completes.
+		if (!aPipeline->is_ready()) {
+			throw std::runtime_error("Descriptor array requires a ready pipeline.");
+		}
 		
 		this->DescriptorSetLayoutBinding = aPipeline->descriptor_set_layout_binding();
 		this->Context = aContext;
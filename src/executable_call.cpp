@@ -4,7 +4,92 @@
 
 namespace geodesy::gpu {
 
-	executable_call::executable_call(std::shared_ptr<context> aContext, std::shared_ptr<command_pool> aCommandPool) : command_buffer(aContext, aCommandPool) {}
+	executable_call::executable_call(std::shared_ptr<context> aContext, std::shared_ptr<command_pool> aCommandPool) : command_buffer(aContext, aCommandPool) {
+		// record() begins the command buffer again without resetting the pool.
+		if ((aCommandPool->Flags & VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT) == 0) {
+			throw std::runtime_error("Executable calls need a command pool created with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT.");
+		}
+		this->Dirty = true;
+		this->RecordedReady = false;
+	}
+
+	void executable_call::bind(std::pair<int, int> aSetBinding, std::shared_ptr<resource> aResource) {
+		if (aResource == nullptr) return;
+		// Written by the next record(), once the call is no longer pending.
+		this->UniformSetBinding[aSetBinding] = aResource;
+		this->PendingBinding.insert(aSetBinding);
+		this->Dirty = true;
+	}
+
+	bool executable_call::is_dirty() const {
+		return this->Dirty || ((this->Pipeline != nullptr) && (this->Pipeline->is_ready() != this->RecordedReady));
+	}
+
+	VkResult executable_call::record() {
+		if (!this->is_dirty()) return VK_SUCCESS;
+		bool Ready = this->Pipeline->is_ready();
+		// A build_async placeholder has no layout or render pass until it is ready, nothing
+		// is allocated against it before then. Substitutes are not recorded for the same reason.
+		if (Ready) {
+			this->allocate_resources();
+			if (this->DescriptorArray != nullptr) {
+				for (const std::pair<int, int>& SetBinding : this->PendingBinding) {
+					this->write_descriptor(SetBinding, this->UniformSetBinding[SetBinding]);
+				}
+			}
+			this->PendingBinding.clear();
+		}
+		// Beginning an executable command buffer implicitly resets it.
+		VkResult Result = this->begin();
+		if (Result != VK_SUCCESS) return Result;
+		if (Ready) {
+			this->record_commands();
+		}
+		Result = this->end();
+		if (Result == VK_SUCCESS) {
+			this->Dirty = false;
+			this->RecordedReady = Ready;
+		}
+		return Result;
+	}
+
+	void executable_call::allocate_resources() {
+		// Allocate Descriptor Set Array
+		if ((this->DescriptorArray != nullptr) || (this->Pipeline->CreateInfo == nullptr)) return;
+		if (this->Pipeline->CreateInfo->DescriptorSetLayoutBinding.size() == 0) return;
+		this->DescriptorArray = this->Context->create<descriptor::array>(this->Pipeline);
+
+		// Bind Resources to Descriptor Sets
+		for (auto& [SetBinding, Resource] : this->UniformSetBinding) {
+			this->write_descriptor(SetBinding, Resource);
+		}
+	}
+
+	void executable_call::write_descriptor(std::pair<int, int> aSetBinding, std::shared_ptr<resource> aResource) {
+		switch(aResource->Type) {
+		case resource::type::BUFFER: {
+			// Bind Buffer resources
+			std::shared_ptr<buffer> BufferResource = std::dynamic_pointer_cast<buffer>(aResource);
+			this->DescriptorArray->bind(aSetBinding.first, aSetBinding.second, 0, BufferResource->Handle);
+			}
+			break;
+		case resource::type::IMAGE: {
+			// Bind Image resources
+			std::shared_ptr<image> ImageResource = std::dynamic_pointer_cast<image>(aResource);
+			this->DescriptorArray->bind(aSetBinding.first, aSetBinding.second, 0, ImageResource->View);
+			}
+			break;
+		case resource::type::ACCELERATION_STRUCTURE: {
+			// Bind Acceleration Structure resources
+			std::shared_ptr<acceleration_structure> AccelerationStructureResource = std::dynamic_pointer_cast<acceleration_structure>(aResource);
+			this->DescriptorArray->bind(aSetBinding.first, aSetBinding.second, 0, AccelerationStructureResource->Handle);
+			}
+			break;
+		default:
+			// Unsupported resource type
+			break;
+		}
+	}
 
 	rasterization_call::rasterization_call(
 		std::shared_ptr<context> 									aContext,
@@ -16,44 +101,72 @@ namespace geodesy::gpu {
 		std::shared_ptr<buffer> 									aIndexBuffer,
 		std::map<std::pair<int, int>, std::shared_ptr<resource>> 	aUniformSetBinding
 	) : executable_call(aContext, aCommandPool) {
-		VkResult Result = VK_SUCCESS;
-		std::shared_ptr<pipeline::rasterizer> Rasterizer = std::dynamic_pointer_cast<pipeline::rasterizer>(aRasterizationPipeline->CreateInfo);
 		// These objects need to persist longer than the call, so they are passed in.
 		this->Pipeline = aRasterizationPipeline;
+		this->VertexBuffer = aVertexBuffer;
+		this->IndexBuffer = aIndexBuffer;
 
-		// Allocate Framebuffer object metadata.
-		this->Framebuffer = aContext->create<framebuffer>(aRasterizationPipeline, aImage, aResolution);
+		this->Image = aImage;
+		this->Resolution = aResolution;
+		this->UniformSetBinding = aUniformSetBinding;
 
-		// Allocate Descriptor Set Array
-		if (Rasterizer->DescriptorSetLayoutBinding.size() > 0) {
-			this->DescriptorArray = aContext->create<descriptor::array>(aRasterizationPipeline);
+		// Record to Command Buffer, allocates the framebuffer and descriptor sets once the pipeline is ready.
+		this->record();
+	}
+
+	void rasterization_call::set_image(std::vector<std::shared_ptr<image>> aImage, std::array<unsigned int, 3> aResolution) {
+		this->Image = aImage;
+		this->Resolution = aResolution;
+		// Fetched again by the next record().
+		this->Framebuffer = nullptr;
+		this->Dirty = true;
+	}
+
+	void rasterization_call::allocate_resources() {
+		executable_call::allocate_resources();
+		// Allocate Framebuffer object metadata, dynamic rendering uses the image views directly.
+		if ((this->Framebuffer == nullptr) && (this->Pipeline->RenderPass != VK_NULL_HANDLE)) {
+			this->Framebuffer = this->Context->create_framebuffer(this->Pipeline->RenderPass, this->Image, this->Resolution);
 		}
+	}
 
-		// Bind Resources to Descriptor Sets
-		for (auto& [SetBinding, Resource] : aUniformSetBinding) {
-			switch(Resource->Type) {
-			case resource::type::BUFFER: {
-				// Bind Buffer resources
-				std::shared_ptr<buffer> BufferResource = std::dynamic_pointer_cast<buffer>(Resource);
-				this->DescriptorArray->bind(SetBinding.first, SetBinding.second, 0, BufferResource->Handle);
-				}
-				break;
-			case resource::type::IMAGE: {
-				// Bind Image resources
-				std::shared_ptr<image> ImageResource = std::dynamic_pointer_cast<image>(Resource);
-				this->DescriptorArray->bind(SetBinding.first, SetBinding.second, 0, ImageResource->View);
-				}
-				break;
-			default:
-				// Unsupported resource type
-				break;
+	void rasterization_call::set_geometry(std::vector<std::shared_ptr<buffer>> aVertexBuffer, std::shared_ptr<buffer> aIndexBuffer) {
+		this->VertexBuffer = aVertexBuffer;
+		this->IndexBuffer = aIndexBuffer;
+		this->Dirty = true;
+	}
+
+	void rasterization_call::set_draw(pipeline::draw_parameter aDraw) {
+		this->Draw = aDraw;
+		this->Dirty = true;
+	}
+
+	void rasterization_call::record_commands() {
+		if (!this->Draw.has_value()) {
+			if (this->Framebuffer != nullptr) {
+				this->Pipeline->rasterize(this, this->Framebuffer, this->Resolution, this->VertexBuffer, this->IndexBuffer, this->DescriptorArray);
 			}
+			else {
+				this->Pipeline->rasterize(this, this->Image, this->Resolution, this->VertexBuffer, this->IndexBuffer, this->DescriptorArray);
+			}
+			return;
 		}
-
-		// Record to Command Buffer
-		Result = this->begin();
-		this->Pipeline->rasterize(this, this->Framebuffer, aResolution, aVertexBuffer, aIndexBuffer, this->DescriptorArray);
-		Result = this->end();
+		VkRect2D RenderArea = { { 0, 0 }, { this->Resolution[0], this->Resolution[1] } };
+		if (this->Framebuffer != nullptr) {
+			this->Pipeline->begin(this, this->Framebuffer, RenderArea);
+		}
+		else {
+			this->Pipeline->begin(this, this->Image, RenderArea);
+		}
+		this->Pipeline->bind(this, this->VertexBuffer, this->IndexBuffer, this->DescriptorArray);
+		this->Pipeline->set_viewport(this, this->Resolution);
+		if (this->IndexBuffer != nullptr) {
+			this->Pipeline->draw_indexed(this, *this->Draw);
+		}
+		else {
+			this->Pipeline->draw(this, *this->Draw);
+		}
+		this->Pipeline->end(this);
 	}
 
 	raytracing_call::raytracing_call(
@@ -63,40 +176,20 @@ namespace geodesy::gpu {
 		std::array<unsigned int, 3> 								aResolution,
 		std::map<std::pair<int, int>, std::shared_ptr<resource>> 	aUniformSetBinding
 	) : executable_call(aContext, aCommandPool) {
-		VkResult Result = VK_SUCCESS;
+		this->Pipeline = aRaytracerPipeline;
+		this->Resolution = aResolution;
+		this->UniformSetBinding = aUniformSetBinding;
 
-		// Allocate Descriptor Set Array
-		if (aRaytracerPipeline->CreateInfo->DescriptorSetLayoutBinding.size() > 0) {
-			this->DescriptorArray = aContext->create<descriptor::array>(aRaytracerPipeline);
-		}
+		this->record();
+	}
 
-		// Bind Resources to Descriptor Sets
-		for (auto& [SetBinding, Resource] : aUniformSetBinding) {
-			switch(Resource->Type) {
-			case resource::type::BUFFER: {
-				// Bind Buffer resources
-				std::shared_ptr<buffer> BufferResource = std::dynamic_pointer_cast<buffer>(Resource);
-				this->DescriptorArray->bind(SetBinding.first, SetBinding.second, 0, BufferResource->Handle);
-				}
-				break;
-			case resource::type::IMAGE: {
-				// Bind Image resources
-				std::shared_ptr<image> ImageResource = std::dynamic_pointer_cast<image>(Resource);
-				this->DescriptorArray->bind(SetBinding.first, SetBinding.second, 0, ImageResource->View);
-				}
-				break;
-			case resource::type::ACCELERATION_STRUCTURE: {
-				// Bind Acceleration Structure resources
-				std::shared_ptr<acceleration_structure> AccelerationStructureResource = std::dynamic_pointer_cast<acceleration_structure>(Resource);
-				this->DescriptorArray->bind(SetBinding.first, SetBinding.second, 0, AccelerationStructureResource->Handle);
-				}
-				break;
-			}
-		}
+	void raytracing_call::set_resolution(std::array<unsigned int, 3> aResolution) {
+		this->Resolution = aResolution;
+		this->Dirty = true;
+	}
 
-		Result = this->begin();
-		this->Pipeline->raytrace(this, aResolution, this->DescriptorArray);
-		Result = this->end();
+	void raytracing_call::record_commands() {
+		this->Pipeline->raytrace(this, this->Resolution, this->DescriptorArray);
 	}
 
 	compute_call::compute_call(
@@ -106,40 +199,20 @@ namespace geodesy::gpu {
 		std::array<unsigned int, 3> 								aThreadGroupCount,
 		std::map<std::pair<int, int>, std::shared_ptr<resource>> 	aUniformSetBinding
 	) : executable_call(aContext, aCommandPool) {
-		VkResult Result = VK_SUCCESS;
+		this->Pipeline = aComputePipeline;
+		this->ThreadGroupCount = aThreadGroupCount;
+		this->UniformSetBinding = aUniformSetBinding;
 
-		// Allocate Descriptor Set Array
-		if (aComputePipeline->CreateInfo->DescriptorSetLayoutBinding.size() > 0) {
-			this->DescriptorArray = aContext->create<descriptor::array>(aComputePipeline);
-		}
+		this->record();
+	}
 
-		// Bind Resources to Descriptor Sets
-		for (auto& [SetBinding, Resource] : aUniformSetBinding) {
-			switch(Resource->Type) {
-			case resource::type::BUFFER: {
-				// Bind Buffer resources
-				std::shared_ptr<buffer> BufferResource = std::dynamic_pointer_cast<buffer>(Resource);
-				this->DescriptorArray->bind(SetBinding.first, SetBinding.second, 0, BufferResource->Handle);
-				}
-				break;
-			case resource::type::IMAGE: {
-				// Bind Image resources
-				std::shared_ptr<image> ImageResource = std::dynamic_pointer_cast<image>(Resource);
-				this->DescriptorArray->bind(SetBinding.first, SetBinding.second, 0, ImageResource->View);
-				}
-				break;
-			case resource::type::ACCELERATION_STRUCTURE: {
-				// Bind Acceleration Structure resources
-				std::shared_ptr<acceleration_structure> AccelerationStructureResource = std::dynamic_pointer_cast<acceleration_structure>(Resource);
-				this->DescriptorArray->bind(SetBinding.first, SetBinding.second, 0, AccelerationStructureResource->Handle);
-				}
-				break;
-			}
-		}
+	void compute_call::set_thread_group_count(std::array<unsigned int, 3> aThreadGroupCount) {
+		this->ThreadGroupCount = aThreadGroupCount;
+		this->Dirty = true;
+	}
 
-		Result = this->begin();
-		this->Pipeline->dispatch(this, aThreadGroupCount, this->DescriptorArray);
-		Result = this->end();
+	void compute_call::record_commands() {
+		this->Pipeline->dispatch(this, this->ThreadGroupCount, this->DescriptorArray);
 	}
 
 }
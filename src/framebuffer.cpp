@@ -9,14 +9,30 @@ namespace geodesy::gpu {
 		this->Type = resource::type::FRAMEBUFFER;
 		this->ClearValue = {};
 		this->Handle = VK_NULL_HANDLE;
+		this->Owned = true;
 	}
 
-	framebuffer::framebuffer(std::shared_ptr<context> aContext, std::shared_ptr<pipeline> aPipeline, std::vector<std::shared_ptr<image>> aImageAttachements, std::array<unsigned int, 3> aResolution) {
+	framebuffer::framebuffer(std::shared_ptr<context> aContext, VkFramebuffer aHandle, size_t aAttachmentCount) : framebuffer() {
+		this->Context = aContext;
+		this->ClearValue = std::vector<VkClearValue>(aAttachmentCount);
+		for (size_t i = 0; i < aAttachmentCount; i++) {
+			this->ClearValue[i].color = { 0.0f, 0.0f, 0.0f, 1.0f };
+		}
+		this->Handle = aHandle;
+		this->Owned = false;
+	}
+
+	framebuffer::framebuffer(std::shared_ptr<context> aContext, std::shared_ptr<pipeline> aPipeline, std::vector<std::shared_ptr<image>> aImageAttachements, std::array<unsigned int, 3> aResolution) : framebuffer() {
 		PFN_vkCreateFramebuffer vkCreateFramebuffer = (PFN_vkCreateFramebuffer)aContext->function_pointer("vkCreateFramebuffer");
+		// The render pass is only published once an asynchronous build completes.
+		if (!aPipeline->is_ready()) {
+			throw std::runtime_error("Framebuffer requires a ready pipeline.");
+		}
 		this->Context = aContext;
+		this->Image = aImageAttachements;
 		this->ClearValue = std::vector<VkClearValue>(aImageAttachements.size());
 		for (size_t i = 0; i < aImageAttachements.size(); i++) {
-			this->ClearValue[i].color = { 0.0f, 0.0f, 0.0f, 1.0f };
+			this->ClearValue[i] = default_clear_value(aImageAttachements[i]->CreateInfo.format);
 		}
 		std::vector<VkImageView> Attachment(aImageAttachements.size());
 		for (size_t i = 0; i < aImageAttachements.size(); i++) {
@@ -36,12 +52,17 @@ namespace geodesy::gpu {
 		Result = vkCreateFramebuffer(aContext->Handle, &FBCI, NULL, &this->Handle);
 	}
 
-	framebuffer::framebuffer(std::shared_ptr<context> aContext, std::shared_ptr<pipeline> aPipeline, std::map<std::string, std::shared_ptr<image>> aImage, std::vector<std::string> aAttachmentSelection, std::array<unsigned int, 3> aResolution) {
+	framebuffer::framebuffer(std::shared_ptr<context> aContext, std::shared_ptr<pipeline> aPipeline, std::map<std::string, std::shared_ptr<image>> aImage, std::vector<std::string> aAttachmentSelection, std::array<unsigned int, 3> aResolution) : framebuffer() {
 		PFN_vkCreateFramebuffer vkCreateFramebuffer = (PFN_vkCreateFramebuffer)aContext->function_pointer("vkCreateFramebuffer");
+		// The render pass is only published once an asynchronous build completes.
+		if (!aPipeline->is_ready()) {
+			throw std::runtime_error("Framebuffer requires a ready pipeline.");
+		}
 		this->Context = aContext;
 		this->ClearValue = std::vector<VkClearValue>(aAttachmentSelection.size());
 		for (size_t i = 0; i < aAttachmentSelection.size(); i++) {
-			this->ClearValue[i].color = { 0.0f, 0.0f, 0.0f, 1.0f };
+			this->Image.push_back(aImage[aAttachmentSelection[i]]);
+			this->ClearValue[i] = default_clear_value(aImage[aAttachmentSelection[i]]->CreateInfo.format);
 		}
 		std::vector<VkImageView> Attachment(aAttachmentSelection.size());
 		for (size_t i = 0; i < aAttachmentSelection.size(); i++) {
@@ -61,7 +82,20 @@ namespace geodesy::gpu {
 		Result = vkCreateFramebuffer(aContext->Handle, &FBCI, NULL, &this->Handle);
 	}
 
+	VkClearValue framebuffer::default_clear_value(VkFormat aFormat) {
+		// Depth clears to the far plane, a zeroed color value would fail every LESS depth test.
+		VkClearValue Value{};
+		if (image::aspect_flag(aFormat) & (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
+			Value.depthStencil = { 1.0f, 0 };
+		}
+		else {
+			Value.color = { 0.0f, 0.0f, 0.0f, 1.0f };
+		}
+		return Value;
+	}
+
 	framebuffer::~framebuffer() {
+		if (!this->Owned || (this->Handle == VK_NULL_HANDLE)) return;
 		PFN_vkDestroyFramebuffer vkDestroyFramebuffer = (PFN_vkDestroyFramebuffer)this->Context->function_pointer("vkDestroyFramebuffer");
 		vkDestroyFramebuffer(this->Context->Handle, this->Handle, NULL);
 	}
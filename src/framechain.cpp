@@ -1,4 +1,8 @@
 #include <geodesy/gpu/framechain.h>
+#include <geodesy/gpu/context.h>
+
+#include <thread>
+#include <algorithm>
 
 namespace geodesy::gpu {
 
@@ -8,17 +12,212 @@ namespace geodesy::gpu {
 		this->Resolution = { 0, 0, 1 };
 		this->ReadIndex = 0;
 		this->DrawIndex = 0;
+		this->FramesInFlight = 1;
+		this->FrameIndex = 0;
+		this->Timeline = nullptr;
+		this->QueryPool = VK_NULL_HANDLE;
+		this->SubmittedValue = 0;
+		this->CompletedValue = 0;
+		this->NextFrameTime = clock::now();
+		this->Statistics = { 0, 0.0, 0.0, 0.0 };
+	}
+
+	framechain::framechain(std::shared_ptr<context> aContext, std::array<unsigned int, 3> aResolution, double aFrameRate, uint32_t aFrameCount, std::map<std::string, attachment> aAttachment, uint32_t aFramesInFlight) : framechain() {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkCreateQueryPool vkCreateQueryPool = (PFN_vkCreateQueryPool)aContext->function_pointer("vkCreateQueryPool");
+		if (aFrameCount == 0) {
+			throw std::runtime_error("Framechain needs at least one frame.");
+		}
+		if (!aContext->TimelineSemaphore) {
+			throw std::runtime_error("Framechain needs the timelineSemaphore feature, enable it in the context's feature chain.");
+		}
+		this->Context 			= aContext;
+		this->Resolution 		= aResolution;
+		this->FrameRate 		= aFrameRate;
+		this->FramesInFlight 	= std::clamp(aFramesInFlight, 1u, aFrameCount);
+
+		this->Timeline = aContext->create<semaphore>((uint64_t)0);
+		if (this->Timeline == nullptr) {
+			throw std::runtime_error("Failed to create framechain timeline semaphore.");
+		}
+
+		// Every image of every set shares the memory blocks and submission of one batch.
+		std::vector<image::batch_item> Item;
+		for (uint32_t i = 0; i < aFrameCount; i++) {
+			for (const auto& [Name, Attachment] : aAttachment) {
+				image::batch_item BatchItem;
+				BatchItem.CreateInfo 	= Attachment.CreateInfo;
+				BatchItem.Format 		= Attachment.Format;
+				BatchItem.X 			= aResolution[0];
+				BatchItem.Y 			= aResolution[1];
+				BatchItem.Z 			= aResolution[2];
+				Item.push_back(BatchItem);
+			}
+		}
+		std::vector<std::shared_ptr<image>> BatchImage;
+		Result = image::create_batch(aContext, Item, BatchImage);
+		if (Result != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create framechain images.");
+		}
+		this->Image = std::vector<std::map<std::string, std::shared_ptr<image>>>(aFrameCount);
+		size_t Index = 0;
+		for (uint32_t i = 0; i < aFrameCount; i++) {
+			for (const auto& [Name, Attachment] : aAttachment) {
+				this->Image[i][Name] = BatchImage[Index++];
+			}
+		}
+
+		// Without timestamp support on graphics and compute queues begin() and end() record nothing.
+		if (aContext->Device->Properties.limits.timestampComputeAndGraphics) {
+			VkQueryPoolCreateInfo QPCI{};
+			QPCI.sType 			= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			QPCI.pNext 			= NULL;
+			QPCI.flags 			= 0;
+			QPCI.queryType 		= VK_QUERY_TYPE_TIMESTAMP;
+			QPCI.queryCount 	= 2 * aFrameCount;
+			Result = vkCreateQueryPool(aContext->Handle, &QPCI, NULL, &this->QueryPool);
+			if (Result != VK_SUCCESS) {
+				this->QueryPool = VK_NULL_HANDLE;
+			}
+		}
+
+		this->Frame = std::vector<frame>(aFrameCount, { 0, false, false, clock::now(), clock::now() });
 	}
-	
+
+	framechain::~framechain() {
+		if (this->Timeline == nullptr) return;
+		PFN_vkDestroyQueryPool vkDestroyQueryPool = (PFN_vkDestroyQueryPool)this->Context->function_pointer("vkDestroyQueryPool");
+		// Images may still be in use by submitted frames.
+		this->wait();
+		if (this->QueryPool != VK_NULL_HANDLE) {
+			vkDestroyQueryPool(this->Context->Handle, this->QueryPool, NULL);
+		}
+	}
+
 	// This function is special because it presents, and acquires next frame.
 	VkResult framechain::next_frame() {
-		this->ReadIndex = this->DrawIndex;
-		this->DrawIndex = (this->DrawIndex + 1) % this->Image.size();
-		return VK_SUCCESS;
+		VkResult Result = VK_SUCCESS;
+		if (this->Timeline == nullptr) {
+			this->ReadIndex = this->DrawIndex;
+			this->DrawIndex = (this->DrawIndex + 1) % this->Image.size();
+			return VK_SUCCESS;
+		}
+
+		// Frames that finished while the host was away are timed before pacing sleeps.
+		this->collect(clock::now());
+
+		// Paced against a running target, so sleep overshoot does not accumulate. A frame late by more than
+		// a whole period restarts the schedule instead of rushing to catch up.
+		if (this->FrameRate > 0.0) {
+			clock::time_point Now = clock::now();
+			clock::duration Period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / this->FrameRate));
+			this->NextFrameTime = (this->FrameIndex > 0) ? this->NextFrameTime + Period : Now;
+			if (this->NextFrameTime + Period < Now) {
+				this->NextFrameTime = Now;
+			}
+			std::this_thread::sleep_until(this->NextFrameTime);
+		}
+
+		this->FrameIndex++;
+		this->DrawIndex = (uint32_t)((this->FrameIndex - 1) % this->Image.size());
+
+		// Frames are submitted in order, so waiting for frame FrameIndex - FramesInFlight also frees this set.
+		// Frames that were never submitted are not waited for.
+		uint64_t WaitValue = (this->FrameIndex > this->FramesInFlight) ? this->FrameIndex - this->FramesInFlight : 0;
+		WaitValue = std::min(WaitValue, this->SubmittedValue);
+		if (WaitValue > this->CompletedValue) {
+			Result = this->Timeline->wait(WaitValue);
+			if (Result != VK_SUCCESS) return Result;
+		}
+		this->collect(clock::now());
+		if (this->CompletedValue > 0) {
+			this->ReadIndex = (uint32_t)((this->CompletedValue - 1) % this->Image.size());
+		}
+
+		frame& Frame = this->Frame[this->DrawIndex];
+		Frame.Value 		= this->FrameIndex;
+		Frame.Submitted 	= false;
+		Frame.Timestamped 	= false;
+		Frame.AcquireTime 	= clock::now();
+		return Result;
 	}
 
 	std::pair<std::shared_ptr<semaphore>, std::shared_ptr<semaphore>> framechain::get_acquire_present_semaphore_pair() {
 		return std::make_pair(nullptr, nullptr);
 	}
 
+	void framechain::begin(command_buffer* aCommandBuffer) {
+		PFN_vkCmdResetQueryPool vkCmdResetQueryPool = (PFN_vkCmdResetQueryPool)this->Context->function_pointer("vkCmdResetQueryPool");
+		PFN_vkCmdWriteTimestamp vkCmdWriteTimestamp = (PFN_vkCmdWriteTimestamp)this->Context->function_pointer("vkCmdWriteTimestamp");
+		if ((this->QueryPool == VK_NULL_HANDLE) || (this->FrameIndex == 0)) return;
+		vkCmdResetQueryPool(aCommandBuffer->Handle, this->QueryPool, 2 * this->DrawIndex, 2);
+		vkCmdWriteTimestamp(aCommandBuffer->Handle, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, this->QueryPool, 2 * this->DrawIndex);
+		this->Frame[this->DrawIndex].Timestamped = true;
+	}
+
+	void framechain::end(command_buffer* aCommandBuffer) {
+		PFN_vkCmdWriteTimestamp vkCmdWriteTimestamp = (PFN_vkCmdWriteTimestamp)this->Context->function_pointer("vkCmdWriteTimestamp");
+		if ((this->QueryPool == VK_NULL_HANDLE) || (this->FrameIndex == 0) || !this->Frame[this->DrawIndex].Timestamped) return;
+		vkCmdWriteTimestamp(aCommandBuffer->Handle, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, this->QueryPool, 2 * this->DrawIndex + 1);
+	}
+
+	VkResult framechain::submit(device::operation aDeviceOperation, std::vector<std::shared_ptr<command_batch>> aCommandBatchList) {
+		VkResult Result = VK_SUCCESS;
+		if ((this->Timeline == nullptr) || (this->FrameIndex == 0)) return VK_ERROR_INITIALIZATION_FAILED;
+		if (aCommandBatchList.empty()) {
+			aCommandBatchList.push_back(std::make_shared<command_batch>());
+		}
+
+		// The timeline signal is appended to the caller's last batch for the submission only.
+		std::shared_ptr<command_batch> Batch = aCommandBatchList.back();
+		size_t SignalValueCount = Batch->SignalValueList.size();
+		Batch->SignalValueList.resize(Batch->SignalSemaphoreList.size(), 0);
+		Batch->SignalSemaphoreList.push_back(this->Timeline);
+		Batch->SignalValueList.push_back(this->FrameIndex);
+		Result = this->Context->execute(aDeviceOperation, aCommandBatchList);
+		Batch->SignalSemaphoreList.pop_back();
+		Batch->SignalValueList.resize(SignalValueCount);
+		if (Result != VK_SUCCESS) return Result;
+
+		frame& Frame = this->Frame[this->DrawIndex];
+		Frame.Submitted 		= true;
+		Frame.SubmitTime 		= clock::now();
+		this->SubmittedValue 	= this->FrameIndex;
+		return Result;
+	}
+
+	VkResult framechain::wait() {
+		VkResult Result = VK_SUCCESS;
+		if ((this->Timeline == nullptr) || (this->SubmittedValue <= this->CompletedValue)) return Result;
+		Result = this->Timeline->wait(this->SubmittedValue);
+		this->collect(clock::now());
+		return Result;
+	}
+
+	framechain::statistics framechain::last_statistics() const {
+		return this->Statistics;
+	}
+
+	void framechain::collect(clock::time_point aCompletionTime) {
+		PFN_vkGetQueryPoolResults vkGetQueryPoolResults = (PFN_vkGetQueryPoolResults)this->Context->function_pointer("vkGetQueryPoolResults");
+		uint64_t Value = this->Timeline->value();
+		if (Value <= this->CompletedValue) return;
+		double TimestampPeriod = this->Context->Device->Properties.limits.timestampPeriod;
+		for (uint32_t i = 0; i < this->Frame.size(); i++) {
+			const frame& Frame = this->Frame[i];
+			if (!Frame.Submitted || (Frame.Value <= this->CompletedValue) || (Frame.Value > Value) || (Frame.Value < this->Statistics.Frame)) continue;
+			statistics Statistics{};
+			Statistics.Frame 		= Frame.Value;
+			Statistics.CpuTime 		= std::chrono::duration<double>(Frame.SubmitTime - Frame.AcquireTime).count();
+			Statistics.Latency 		= std::chrono::duration<double>(aCompletionTime - Frame.SubmitTime).count();
+			Statistics.GpuTime 		= 0.0;
+			uint64_t Timestamp[2] = { 0, 0 };
+			if (Frame.Timestamped && (vkGetQueryPoolResults(this->Context->Handle, this->QueryPool, 2 * i, 2, sizeof(Timestamp), Timestamp, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)) {
+				Statistics.GpuTime 		= (double)(Timestamp[1] - Timestamp[0]) * TimestampPeriod * 1e-9;
+			}
+			this->Statistics = Statistics;
+		}
+		this->CompletedValue = Value;
+	}
+
 }
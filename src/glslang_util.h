@@ -33,6 +33,18 @@
 
 namespace geodesy::gpu {
 
+	// Compiler options shared by shader parsing and program linking, any change here must be reflected in the cache key.
+	inline const EShMessages CompilerMessages = (EShMessages)(
+		EShMessages::EShMsgAST | 
+		EShMessages::EShMsgSpvRules | 
+		EShMessages::EShMsgVulkanRules | 
+		EShMessages::EShMsgDebugInfo | 
+		EShMessages::EShMsgBuiltinSymbolTable
+	);
+	inline const glslang::EShTargetClientVersion CompilerClientVersion 				= glslang::EShTargetClientVersion::EShTargetVulkan_1_2;
+	inline const glslang::EShTargetLanguageVersion CompilerTargetLanguageVersion 	= glslang::EShTargetLanguageVersion::EShTargetSpv_1_4;
+	inline const int CompilerDefaultVersion 										= 100;
+
 	EShLanguage vulkan_to_glslang(VkShaderStageFlagBits aStage);
 	VkShaderStageFlagBits vulkan_to_glslang(EShLanguage aStage);
 
@@ -13,11 +13,15 @@
 
 #include <vector>
 #include <algorithm>
+#include <numeric>
+#include <sstream>
 
 #include "glslang_util.h"
 
+#include <geodesy/gpu/pixel.h>
 #include <geodesy/gpu/pipeline.h>
 #include <geodesy/gpu/context.h>
+#include <geodesy/gpu/instance.h>
 
 // #define STB_IMAGE_IMPLEMENTATION
 // #include <stb_image.h>
@@ -26,6 +30,12 @@
 //#define FREEIMAGE_LIB
 //#include <FreeImage.h>
 
+// Memory blocks shared by images created through image::create_batch().
+#define GPU_IMAGE_BATCH_BLOCK_SIZE (1 << 28)
+
+// Share of pixels between the coverage thresholds above which alpha testing no longer suffices.
+#define GPU_IMAGE_TRANSLUCENT_FRACTION 0.01f
+
 // So gross.
 // Group these later based on spec.
 // https://www.khronos.org/registry/vulkan/specs/1.2-extensions/html/vkspec.html#texel-block-size
@@ -100,6 +110,8 @@ namespace geodesy::gpu {
 		this->Memory = 0;
 		this->Usage = image::usage::TRANSFER_DST | image::usage::TRANSFER_SRC;
 		this->MipLevels = false;
+		this->MipLevelCount = 0;
+		this->Transient = false;
 	}
 
 	image::create_info::create_info(int aSample, int aTiling, int aMemory, int aUsage) : create_info() {
@@ -113,406 +125,21 @@ namespace geodesy::gpu {
 		return (image::bits_per_pixel(aFormat) / 8);
 	}
 
+	size_t image::block_size(int aFormat) {
+		return pixel::traits(aFormat).BlockSize;
+	}
+
+	VkExtent2D image::block_extent(int aFormat) {
+		pixel::format_traits Traits = pixel::traits(aFormat);
+		return { Traits.BlockWidth, Traits.BlockHeight };
+	}
+
 	size_t image::bits_per_pixel(int aFormat) {
-		switch (aFormat) {
-		default: return 0;
-		case VK_FORMAT_R4G4_UNORM_PACK8: return 8;
-		case VK_FORMAT_R4G4B4A4_UNORM_PACK16: return 16;
-		case VK_FORMAT_B4G4R4A4_UNORM_PACK16: return 16;
-		case VK_FORMAT_R5G6B5_UNORM_PACK16: return 16;
-		case VK_FORMAT_B5G6R5_UNORM_PACK16: return 16;
-		case VK_FORMAT_R5G5B5A1_UNORM_PACK16: return 16;
-		case VK_FORMAT_B5G5R5A1_UNORM_PACK16: return 16;
-		case VK_FORMAT_A1R5G5B5_UNORM_PACK16: return 16;
-		case VK_FORMAT_R8_UNORM: return 8;
-		case VK_FORMAT_R8_SNORM: return 8;
-		case VK_FORMAT_R8_USCALED: return 8;
-		case VK_FORMAT_R8_SSCALED: return 8;
-		case VK_FORMAT_R8_UINT: return 8;
-		case VK_FORMAT_R8_SINT: return 8;
-		case VK_FORMAT_R8_SRGB: return 8;
-		case VK_FORMAT_R8G8_UNORM: return 16;
-		case VK_FORMAT_R8G8_SNORM: return 16;
-		case VK_FORMAT_R8G8_USCALED: return 16;
-		case VK_FORMAT_R8G8_SSCALED: return 16;
-		case VK_FORMAT_R8G8_UINT: return 16;
-		case VK_FORMAT_R8G8_SINT: return 16;
-		case VK_FORMAT_R8G8_SRGB: return 16;
-		case VK_FORMAT_R8G8B8_UNORM: return 24;
-		case VK_FORMAT_R8G8B8_SNORM: return 24;
-		case VK_FORMAT_R8G8B8_USCALED: return 24;
-		case VK_FORMAT_R8G8B8_SSCALED: return 24;
-		case VK_FORMAT_R8G8B8_UINT: return 24;
-		case VK_FORMAT_R8G8B8_SINT: return 24;
-		case VK_FORMAT_R8G8B8_SRGB: return 24;
-		case VK_FORMAT_B8G8R8_UNORM: return 24;
-		case VK_FORMAT_B8G8R8_SNORM: return 24;
-		case VK_FORMAT_B8G8R8_USCALED: return 24;
-		case VK_FORMAT_B8G8R8_SSCALED: return 24;
-		case VK_FORMAT_B8G8R8_UINT: return 24;
-		case VK_FORMAT_B8G8R8_SINT: return 24;
-		case VK_FORMAT_B8G8R8_SRGB: return 24;
-		case VK_FORMAT_R8G8B8A8_UNORM: return 32;
-		case VK_FORMAT_R8G8B8A8_SNORM: return 32;
-		case VK_FORMAT_R8G8B8A8_USCALED: return 32;
-		case VK_FORMAT_R8G8B8A8_SSCALED: return 32;
-		case VK_FORMAT_R8G8B8A8_UINT: return 32;
-		case VK_FORMAT_R8G8B8A8_SINT: return 32;
-		case VK_FORMAT_R8G8B8A8_SRGB: return 32;
-		case VK_FORMAT_B8G8R8A8_UNORM: return 32;
-		case VK_FORMAT_B8G8R8A8_SNORM: return 32;
-		case VK_FORMAT_B8G8R8A8_USCALED: return 32;
-		case VK_FORMAT_B8G8R8A8_SSCALED: return 32;
-		case VK_FORMAT_B8G8R8A8_UINT: return 32;
-		case VK_FORMAT_B8G8R8A8_SINT: return 32;
-		case VK_FORMAT_B8G8R8A8_SRGB: return 32;
-		case VK_FORMAT_A8B8G8R8_UNORM_PACK32: return 32;
-		case VK_FORMAT_A8B8G8R8_SNORM_PACK32: return 32;
-		case VK_FORMAT_A8B8G8R8_USCALED_PACK32: return 32;
-		case VK_FORMAT_A8B8G8R8_SSCALED_PACK32: return 32;
-		case VK_FORMAT_A8B8G8R8_UINT_PACK32: return 32;
-		case VK_FORMAT_A8B8G8R8_SINT_PACK32: return 32;
-		case VK_FORMAT_A8B8G8R8_SRGB_PACK32: return 32;
-		case VK_FORMAT_A2R10G10B10_UNORM_PACK32: return 32;
-		case VK_FORMAT_A2R10G10B10_SNORM_PACK32: return 32;
-		case VK_FORMAT_A2R10G10B10_USCALED_PACK32: return 32;
-		case VK_FORMAT_A2R10G10B10_SSCALED_PACK32: return 32;
-		case VK_FORMAT_A2R10G10B10_UINT_PACK32: return 32;
-		case VK_FORMAT_A2R10G10B10_SINT_PACK32: return 32;
-		case VK_FORMAT_A2B10G10R10_UNORM_PACK32: return 32;
-		case VK_FORMAT_A2B10G10R10_SNORM_PACK32: return 32;
-		case VK_FORMAT_A2B10G10R10_USCALED_PACK32: return 32;
-		case VK_FORMAT_A2B10G10R10_SSCALED_PACK32: return 32;
-		case VK_FORMAT_A2B10G10R10_UINT_PACK32: return 32;
-		case VK_FORMAT_A2B10G10R10_SINT_PACK32: return 32;
-		case VK_FORMAT_R16_UNORM: return 16;
-		case VK_FORMAT_R16_SNORM: return 16;
-		case VK_FORMAT_R16_USCALED: return 16;
-		case VK_FORMAT_R16_SSCALED: return 16;
-		case VK_FORMAT_R16_UINT: return 16;
-		case VK_FORMAT_R16_SINT: return 16;
-		case VK_FORMAT_R16_SFLOAT: return 16;
-		case VK_FORMAT_R16G16_UNORM: return 16;
-		case VK_FORMAT_R16G16_SNORM: return 16;
-		case VK_FORMAT_R16G16_USCALED: return 16;
-		case VK_FORMAT_R16G16_SSCALED: return 16;
-		case VK_FORMAT_R16G16_UINT: return 16;
-		case VK_FORMAT_R16G16_SINT: return 16;
-		case VK_FORMAT_R16G16_SFLOAT: return 16;
-		case VK_FORMAT_R16G16B16_UNORM: return 48;
-		case VK_FORMAT_R16G16B16_SNORM: return 48;
-		case VK_FORMAT_R16G16B16_USCALED: return 48;
-		case VK_FORMAT_R16G16B16_SSCALED: return 48;
-		case VK_FORMAT_R16G16B16_UINT: return 48;
-		case VK_FORMAT_R16G16B16_SINT: return 48;
-		case VK_FORMAT_R16G16B16_SFLOAT: return 48;
-		case VK_FORMAT_R16G16B16A16_UNORM: return 64;
-		case VK_FORMAT_R16G16B16A16_SNORM: return 64;
-		case VK_FORMAT_R16G16B16A16_USCALED: return 64;
-		case VK_FORMAT_R16G16B16A16_SSCALED: return 64;
-		case VK_FORMAT_R16G16B16A16_UINT: return 64;
-		case VK_FORMAT_R16G16B16A16_SINT: return 64;
-		case VK_FORMAT_R16G16B16A16_SFLOAT: return 64;
-		case VK_FORMAT_R32_UINT: return 32;
-		case VK_FORMAT_R32_SINT: return 32;
-		case VK_FORMAT_R32_SFLOAT: return 32;
-		case VK_FORMAT_R32G32_UINT: return 64;
-		case VK_FORMAT_R32G32_SINT: return 64;
-		case VK_FORMAT_R32G32_SFLOAT: return 64;
-		case VK_FORMAT_R32G32B32_UINT: return 96;
-		case VK_FORMAT_R32G32B32_SINT: return 96;
-		case VK_FORMAT_R32G32B32_SFLOAT: return 96;
-		case VK_FORMAT_R32G32B32A32_UINT: return 128;
-		case VK_FORMAT_R32G32B32A32_SINT: return 128;
-		case VK_FORMAT_R32G32B32A32_SFLOAT: return 128;
-		case VK_FORMAT_R64_UINT: return 64;
-		case VK_FORMAT_R64_SINT: return 64;
-		case VK_FORMAT_R64_SFLOAT: return 64;
-		case VK_FORMAT_R64G64_UINT: return 128;
-		case VK_FORMAT_R64G64_SINT: return 128;
-		case VK_FORMAT_R64G64_SFLOAT: return 128;
-		case VK_FORMAT_R64G64B64_UINT: return 192;
-		case VK_FORMAT_R64G64B64_SINT: return 192;
-		case VK_FORMAT_R64G64B64_SFLOAT: return 192;
-		case VK_FORMAT_R64G64B64A64_UINT: return 256;
-		case VK_FORMAT_R64G64B64A64_SINT: return 256;
-		case VK_FORMAT_R64G64B64A64_SFLOAT: return 256;
-		case VK_FORMAT_B10G11R11_UFLOAT_PACK32: return 32;
-		case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32: return 32;
-		case VK_FORMAT_D16_UNORM: return 16;
-		case VK_FORMAT_X8_D24_UNORM_PACK32: return 32;
-		case VK_FORMAT_D32_SFLOAT: return 32;
-		case VK_FORMAT_S8_UINT: return 8;
-		case VK_FORMAT_D16_UNORM_S8_UINT: return 24;
-		case VK_FORMAT_D24_UNORM_S8_UINT: return 32;
-		case VK_FORMAT_D32_SFLOAT_S8_UINT: return 40;
-			// I might comment this section out.
-			/*
-		case VK_FORMAT_BC1_RGB_UNORM_BLOCK                              : return 0;
-		case VK_FORMAT_BC1_RGB_SRGB_BLOCK                               : return 0;
-		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK                             : return 0;
-		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK                              : return 0;
-		case VK_FORMAT_BC2_UNORM_BLOCK                                  : return 0;
-		case VK_FORMAT_BC2_SRGB_BLOCK                                   : return 0;
-		case VK_FORMAT_BC3_UNORM_BLOCK                                  : return 0;
-		case VK_FORMAT_BC3_SRGB_BLOCK                                   : return 0;
-		case VK_FORMAT_BC4_UNORM_BLOCK                                  : return 0;
-		case VK_FORMAT_BC4_SNORM_BLOCK                                  : return 0;
-		case VK_FORMAT_BC5_UNORM_BLOCK                                  : return 0;
-		case VK_FORMAT_BC5_SNORM_BLOCK                                  : return 0;
-		case VK_FORMAT_BC6H_UFLOAT_BLOCK                                : return 0;
-		case VK_FORMAT_BC6H_SFLOAT_BLOCK                                : return 0;
-		case VK_FORMAT_BC7_UNORM_BLOCK                                  : return 0;
-		case VK_FORMAT_BC7_SRGB_BLOCK                                   : return 0;
-		case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK                          : return 0;
-		case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK                           : return 0;
-		case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK                        : return 0;
-		case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK                         : return 0;
-		case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK                        : return 0;
-		case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK                         : return 0;
-		case VK_FORMAT_EAC_R11_UNORM_BLOCK                              : return 0;
-		case VK_FORMAT_EAC_R11_SNORM_BLOCK                              : return 0;
-		case VK_FORMAT_EAC_R11G11_UNORM_BLOCK                           : return 0;
-		case VK_FORMAT_EAC_R11G11_SNORM_BLOCK                           : return 0;
-		case VK_FORMAT_ASTC_4x4_UNORM_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_4x4_SRGB_BLOCK                              : return 0;
-		case VK_FORMAT_ASTC_5x4_UNORM_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_5x4_SRGB_BLOCK                              : return 0;
-		case VK_FORMAT_ASTC_5x5_UNORM_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_5x5_SRGB_BLOCK                              : return 0;
-		case VK_FORMAT_ASTC_6x5_UNORM_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_6x5_SRGB_BLOCK                              : return 0;
-		case VK_FORMAT_ASTC_6x6_UNORM_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_6x6_SRGB_BLOCK                              : return 0;
-		case VK_FORMAT_ASTC_8x5_UNORM_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_8x5_SRGB_BLOCK                              : return 0;
-		case VK_FORMAT_ASTC_8x6_UNORM_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_8x6_SRGB_BLOCK                              : return 0;
-		case VK_FORMAT_ASTC_8x8_UNORM_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_8x8_SRGB_BLOCK                              : return 0;
-		case VK_FORMAT_ASTC_10x5_UNORM_BLOCK                            : return 0;
-		case VK_FORMAT_ASTC_10x5_SRGB_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_10x6_UNORM_BLOCK                            : return 0;
-		case VK_FORMAT_ASTC_10x6_SRGB_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_10x8_UNORM_BLOCK                            : return 0;
-		case VK_FORMAT_ASTC_10x8_SRGB_BLOCK                             : return 0;
-		case VK_FORMAT_ASTC_10x10_UNORM_BLOCK                           : return 0;
-		case VK_FORMAT_ASTC_10x10_SRGB_BLOCK                            : return 0;
-		case VK_FORMAT_ASTC_12x10_UNORM_BLOCK                           : return 0;
-		case VK_FORMAT_ASTC_12x10_SRGB_BLOCK                            : return 0;
-		case VK_FORMAT_ASTC_12x12_UNORM_BLOCK                           : return 0;
-		case VK_FORMAT_ASTC_12x12_SRGB_BLOCK                            : return 0;
-		case VK_FORMAT_G8B8G8R8_422_UNORM                               : return 0;
-		case VK_FORMAT_B8G8R8G8_422_UNORM                               : return 0;
-		case VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM                        : return 0;
-		case VK_FORMAT_G8_B8R8_2PLANE_420_UNORM                         : return 0;
-		case VK_FORMAT_G8_B8_R8_3PLANE_422_UNORM                        : return 0;
-		case VK_FORMAT_G8_B8R8_2PLANE_422_UNORM                         : return 0;
-		case VK_FORMAT_G8_B8_R8_3PLANE_444_UNORM                        : return 0;
-		case VK_FORMAT_R10X6_UNORM_PACK16                               : return 0;
-		case VK_FORMAT_R10X6G10X6_UNORM_2PACK16                         : return 0;
-		case VK_FORMAT_R10X6G10X6B10X6A10X6_UNORM_4PACK16               : return 0;
-		case VK_FORMAT_G10X6B10X6G10X6R10X6_422_UNORM_4PACK16           : return 0;
-		case VK_FORMAT_B10X6G10X6R10X6G10X6_422_UNORM_4PACK16           : return 0;
-		case VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_420_UNORM_3PACK16       : return 0;
-		case VK_FORMAT_G10X6_B10X6R10X6_2PLANE_420_UNORM_3PACK16        : return 0;
-		case VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_422_UNORM_3PACK16       : return 0;
-		case VK_FORMAT_G10X6_B10X6R10X6_2PLANE_422_UNORM_3PACK16        : return 0;
-		case VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_444_UNORM_3PACK16       : return 0;
-		case VK_FORMAT_R12X4_UNORM_PACK16                               : return 0;
-		case VK_FORMAT_R12X4G12X4_UNORM_2PACK16                         : return 0;
-		case VK_FORMAT_R12X4G12X4B12X4A12X4_UNORM_4PACK16               : return 0;
-		case VK_FORMAT_G12X4B12X4G12X4R12X4_422_UNORM_4PACK16           : return 0;
-		case VK_FORMAT_B12X4G12X4R12X4G12X4_422_UNORM_4PACK16           : return 0;
-		case VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_420_UNORM_3PACK16       : return 0;
-		case VK_FORMAT_G12X4_B12X4R12X4_2PLANE_420_UNORM_3PACK16        : return 0;
-		case VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_422_UNORM_3PACK16       : return 0;
-		case VK_FORMAT_G12X4_B12X4R12X4_2PLANE_422_UNORM_3PACK16        : return 0;
-		case VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_444_UNORM_3PACK16       : return 0;
-		case VK_FORMAT_G16B16G16R16_422_UNORM                           : return 0;
-		case VK_FORMAT_B16G16R16G16_422_UNORM                           : return 0;
-		case VK_FORMAT_G16_B16_R16_3PLANE_420_UNORM                     : return 0;
-		case VK_FORMAT_G16_B16R16_2PLANE_420_UNORM                      : return 0;
-		case VK_FORMAT_G16_B16_R16_3PLANE_422_UNORM                     : return 0;
-		case VK_FORMAT_G16_B16R16_2PLANE_422_UNORM                      : return 0;
-		case VK_FORMAT_G16_B16_R16_3PLANE_444_UNORM                     : return 0;
-		case VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG                      : return 0;
-		case VK_FORMAT_PVRTC1_4BPP_UNORM_BLOCK_IMG                      : return 0;
-		case VK_FORMAT_PVRTC2_2BPP_UNORM_BLOCK_IMG                      : return 0;
-		case VK_FORMAT_PVRTC2_4BPP_UNORM_BLOCK_IMG                      : return 0;
-		case VK_FORMAT_PVRTC1_2BPP_SRGB_BLOCK_IMG                       : return 0;
-		case VK_FORMAT_PVRTC1_4BPP_SRGB_BLOCK_IMG                       : return 0;
-		case VK_FORMAT_PVRTC2_2BPP_SRGB_BLOCK_IMG                       : return 0;
-		case VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG                       : return 0;
-		case VK_FORMAT_ASTC_4x4_SFLOAT_BLOCK_EXT                        : return 0;
-		case VK_FORMAT_ASTC_5x4_SFLOAT_BLOCK_EXT                        : return 0;
-		case VK_FORMAT_ASTC_5x5_SFLOAT_BLOCK_EXT                        : return 0;
-		case VK_FORMAT_ASTC_6x5_SFLOAT_BLOCK_EXT                        : return 0;
-		case VK_FORMAT_ASTC_6x6_SFLOAT_BLOCK_EXT                        : return 0;
-		case VK_FORMAT_ASTC_8x5_SFLOAT_BLOCK_EXT                        : return 0;
-		case VK_FORMAT_ASTC_8x6_SFLOAT_BLOCK_EXT                        : return 0;
-		case VK_FORMAT_ASTC_8x8_SFLOAT_BLOCK_EXT                        : return 0;
-		case VK_FORMAT_ASTC_10x5_SFLOAT_BLOCK_EXT                       : return 0;
-		case VK_FORMAT_ASTC_10x6_SFLOAT_BLOCK_EXT                       : return 0;
-		case VK_FORMAT_ASTC_10x8_SFLOAT_BLOCK_EXT                       : return 0;
-		case VK_FORMAT_ASTC_10x10_SFLOAT_BLOCK_EXT                      : return 0;
-		case VK_FORMAT_ASTC_12x10_SFLOAT_BLOCK_EXT                      : return 0;
-		case VK_FORMAT_ASTC_12x12_SFLOAT_BLOCK_EXT                      : return 0;
-		case VK_FORMAT_G8_B8R8_2PLANE_444_UNORM_EXT                     : return 0;
-		case VK_FORMAT_G10X6_B10X6R10X6_2PLANE_444_UNORM_3PACK16_EXT    : return 0;
-		case VK_FORMAT_G12X4_B12X4R12X4_2PLANE_444_UNORM_3PACK16_EXT    : return 0;
-		case VK_FORMAT_G16_B16R16_2PLANE_444_UNORM_EXT                  : return 0;
-		case VK_FORMAT_A4R4G4B4_UNORM_PACK16_EXT                        : return 0;
-		case VK_FORMAT_A4B4G4R4_UNORM_PACK16_EXT                        : return 0;
-			*/
-		}
+		return pixel::traits(aFormat).BitsPerPixel;
 	}
 
 	size_t image::channel_count(int aFormat) {
-		switch (aFormat) {
-		// ===== 1 CHANNEL (R) =====
-		case VK_FORMAT_R8_UNORM:
-		case VK_FORMAT_R8_SNORM:
-		case VK_FORMAT_R8_USCALED:
-		case VK_FORMAT_R8_SSCALED:
-		case VK_FORMAT_R8_UINT:
-		case VK_FORMAT_R8_SINT:
-		case VK_FORMAT_R8_SRGB:
-		case VK_FORMAT_R16_UNORM:
-		case VK_FORMAT_R16_SNORM:
-		case VK_FORMAT_R16_USCALED:
-		case VK_FORMAT_R16_SSCALED:
-		case VK_FORMAT_R16_UINT:
-		case VK_FORMAT_R16_SINT:
-		case VK_FORMAT_R16_SFLOAT:
-		case VK_FORMAT_R32_UINT:
-		case VK_FORMAT_R32_SINT:
-		case VK_FORMAT_R32_SFLOAT:
-		case VK_FORMAT_R64_UINT:
-		case VK_FORMAT_R64_SINT:
-		case VK_FORMAT_R64_SFLOAT:
-			return 1;
-		// ===== 2 CHANNELS (RG) =====
-		case VK_FORMAT_R4G4_UNORM_PACK8:
-		case VK_FORMAT_R8G8_UNORM:
-		case VK_FORMAT_R8G8_SNORM:
-		case VK_FORMAT_R8G8_USCALED:
-		case VK_FORMAT_R8G8_SSCALED:
-		case VK_FORMAT_R8G8_UINT:
-		case VK_FORMAT_R8G8_SINT:
-		case VK_FORMAT_R8G8_SRGB:
-		case VK_FORMAT_R16G16_UNORM:
-		case VK_FORMAT_R16G16_SNORM:
-		case VK_FORMAT_R16G16_USCALED:
-		case VK_FORMAT_R16G16_SSCALED:
-		case VK_FORMAT_R16G16_UINT:
-		case VK_FORMAT_R16G16_SINT:
-		case VK_FORMAT_R16G16_SFLOAT:
-		case VK_FORMAT_R32G32_UINT:
-		case VK_FORMAT_R32G32_SINT:
-		case VK_FORMAT_R32G32_SFLOAT:
-		case VK_FORMAT_R64G64_UINT:
-		case VK_FORMAT_R64G64_SINT:
-		case VK_FORMAT_R64G64_SFLOAT:
-			return 2;
-		// ===== 3 CHANNELS (RGB) =====
-		case VK_FORMAT_R5G6B5_UNORM_PACK16:
-		case VK_FORMAT_B5G6R5_UNORM_PACK16:
-		case VK_FORMAT_R8G8B8_UNORM:
-		case VK_FORMAT_R8G8B8_SNORM:
-		case VK_FORMAT_R8G8B8_USCALED:
-		case VK_FORMAT_R8G8B8_SSCALED:
-		case VK_FORMAT_R8G8B8_UINT:
-		case VK_FORMAT_R8G8B8_SINT:
-		case VK_FORMAT_R8G8B8_SRGB:
-		case VK_FORMAT_B8G8R8_UNORM:
-		case VK_FORMAT_B8G8R8_SNORM:
-		case VK_FORMAT_B8G8R8_USCALED:
-		case VK_FORMAT_B8G8R8_SSCALED:
-		case VK_FORMAT_B8G8R8_UINT:
-		case VK_FORMAT_B8G8R8_SINT:
-		case VK_FORMAT_B8G8R8_SRGB:
-		case VK_FORMAT_R16G16B16_UNORM:
-		case VK_FORMAT_R16G16B16_SNORM:
-		case VK_FORMAT_R16G16B16_USCALED:
-		case VK_FORMAT_R16G16B16_SSCALED:
-		case VK_FORMAT_R16G16B16_UINT:
-		case VK_FORMAT_R16G16B16_SINT:
-		case VK_FORMAT_R16G16B16_SFLOAT:
-		case VK_FORMAT_R32G32B32_UINT:
-		case VK_FORMAT_R32G32B32_SINT:
-		case VK_FORMAT_R32G32B32_SFLOAT:
-		case VK_FORMAT_R64G64B64_UINT:
-		case VK_FORMAT_R64G64B64_SINT:
-		case VK_FORMAT_R64G64B64_SFLOAT:
-		case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
-		case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
-			return 3;
-		// ===== 4 CHANNELS (RGBA) =====
-		case VK_FORMAT_R4G4B4A4_UNORM_PACK16:
-		case VK_FORMAT_B4G4R4A4_UNORM_PACK16:
-		case VK_FORMAT_R5G5B5A1_UNORM_PACK16:
-		case VK_FORMAT_B5G5R5A1_UNORM_PACK16:
-		case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
-		case VK_FORMAT_R8G8B8A8_UNORM:
-		case VK_FORMAT_R8G8B8A8_SNORM:
-		case VK_FORMAT_R8G8B8A8_USCALED:
-		case VK_FORMAT_R8G8B8A8_SSCALED:
-		case VK_FORMAT_R8G8B8A8_UINT:
-		case VK_FORMAT_R8G8B8A8_SINT:
-		case VK_FORMAT_R8G8B8A8_SRGB:
-		case VK_FORMAT_B8G8R8A8_UNORM:
-		case VK_FORMAT_B8G8R8A8_SNORM:
-		case VK_FORMAT_B8G8R8A8_USCALED:
-		case VK_FORMAT_B8G8R8A8_SSCALED:
-		case VK_FORMAT_B8G8R8A8_UINT:
-		case VK_FORMAT_B8G8R8A8_SINT:
-		case VK_FORMAT_B8G8R8A8_SRGB:
-		case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
-		case VK_FORMAT_A8B8G8R8_SNORM_PACK32:
-		case VK_FORMAT_A8B8G8R8_USCALED_PACK32:
-		case VK_FORMAT_A8B8G8R8_SSCALED_PACK32:
-		case VK_FORMAT_A8B8G8R8_UINT_PACK32:
-		case VK_FORMAT_A8B8G8R8_SINT_PACK32:
-		case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
-		case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
-		case VK_FORMAT_A2R10G10B10_SNORM_PACK32:
-		case VK_FORMAT_A2R10G10B10_USCALED_PACK32:
-		case VK_FORMAT_A2R10G10B10_SSCALED_PACK32:
-		case VK_FORMAT_A2R10G10B10_UINT_PACK32:
-		case VK_FORMAT_A2R10G10B10_SINT_PACK32:
-		case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
-		case VK_FORMAT_A2B10G10R10_SNORM_PACK32:
-		case VK_FORMAT_A2B10G10R10_USCALED_PACK32:
-		case VK_FORMAT_A2B10G10R10_SSCALED_PACK32:
-		case VK_FORMAT_A2B10G10R10_UINT_PACK32:
-		case VK_FORMAT_A2B10G10R10_SINT_PACK32:
-		case VK_FORMAT_R16G16B16A16_UNORM:
-		case VK_FORMAT_R16G16B16A16_SNORM:
-		case VK_FORMAT_R16G16B16A16_USCALED:
-		case VK_FORMAT_R16G16B16A16_SSCALED:
-		case VK_FORMAT_R16G16B16A16_UINT:
-		case VK_FORMAT_R16G16B16A16_SINT:
-		case VK_FORMAT_R16G16B16A16_SFLOAT:
-		case VK_FORMAT_R32G32B32A32_UINT:
-		case VK_FORMAT_R32G32B32A32_SINT:
-		case VK_FORMAT_R32G32B32A32_SFLOAT:
-		case VK_FORMAT_R64G64B64A64_UINT:
-		case VK_FORMAT_R64G64B64A64_SINT:
-		case VK_FORMAT_R64G64B64A64_SFLOAT:
-			return 4;
-		// ===== DEPTH/STENCIL FORMATS (1 or 2 channels) =====
-		case VK_FORMAT_D16_UNORM:
-		case VK_FORMAT_X8_D24_UNORM_PACK32:
-		case VK_FORMAT_D32_SFLOAT:
-		case VK_FORMAT_S8_UINT:
-			return 1;
-		case VK_FORMAT_D16_UNORM_S8_UINT:
-		case VK_FORMAT_D24_UNORM_S8_UINT:
-		case VK_FORMAT_D32_SFLOAT_S8_UINT:
-			return 2;  // Depth + Stencil
-		default: return 0;
-		}
+		return pixel::traits(aFormat).ChannelCount;
 	}
 
 	VkImageAspectFlags image::aspect_flag(int aFormat) {
@@ -787,9 +414,11 @@ namespace geodesy::gpu {
 		this->OpaquePercentage 						= 0.0f;
 		this->TransparentPercentage 				= 0.0f;
 		this->TranslucentPercentage 				= 0.0f;
+		this->CoverageChannel 						= -1;
 		this->CreateInfo							= {};
 		this->Handle								= VK_NULL_HANDLE;
 		this->View 									= VK_NULL_HANDLE;
+		this->ViewGeneration 						= 0;
 		this->MemoryType							= 0;
 		this->MemoryHandle							= VK_NULL_HANDLE;
 		this->CreateInfo.sType						= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -882,9 +511,7 @@ namespace geodesy::gpu {
 			if (aSourceSize != PixelSize || aSourceData == nullptr) {
 				throw std::runtime_error("Invalid source data or size does not match pixel format");
 			}
-			for (size_t i = 0; i < (this->HostSize / PixelSize); i++) {
-				memcpy((char*)this->HostData + i * PixelSize, aSourceData, PixelSize);
-			}
+			pixel::fill(this->HostData, aSourceData, PixelSize, this->HostSize / PixelSize);
 		}
 		else {
 			memset(this->HostData, 0, this->HostSize);
@@ -900,54 +527,19 @@ namespace geodesy::gpu {
 
 	image::image(std::shared_ptr<context> aContext, create_info aCreateInfo, format aFormat, unsigned int aX, unsigned int aY, unsigned int aZ, unsigned int aT, void* aTextureData) : image() {
 		VkResult Result = VK_SUCCESS;
-		PFN_vkCreateImage vkCreateImage = (PFN_vkCreateImage)aContext->function_pointer("vkCreateImage");
 		PFN_vkBindImageMemory vkBindImageMemory = (PFN_vkBindImageMemory)aContext->function_pointer("vkBindImageMemory");
 
-		// Image Handle Info
-		this->Context								= aContext;
-
-		this->CreateInfo.sType						= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-		this->CreateInfo.pNext						= NULL;
-		this->CreateInfo.flags						= 0;
-		if ((aY == 1) && (aZ == 1)) {
-			// 1D Image
-			this->CreateInfo.imageType 					= VK_IMAGE_TYPE_1D;
-		} else if (aZ == 1) {
-			// 2D Image
-			this->CreateInfo.imageType 					= VK_IMAGE_TYPE_2D;
-		} else {
-			// 3D Image
-			this->CreateInfo.imageType 					= VK_IMAGE_TYPE_3D;
-		}
-		this->CreateInfo.format						= (VkFormat)aFormat;
-		this->CreateInfo.extent						= { aX, aY, aZ };
-		if (aCreateInfo.MipLevels) {
-			this->CreateInfo.mipLevels					= std::floor(std::log2(std::max(std::max(aX, aY), aZ))) + 1;
+		if (aCreateInfo.Transient && (aTextureData != NULL)) {
+			throw std::runtime_error("Transient attachments can not be initialized with data.");
 		}
-		else {
-			this->CreateInfo.mipLevels					= 1;
-		}
-		this->CreateInfo.arrayLayers				= aT;
-		this->CreateInfo.samples					= (VkSampleCountFlagBits)aCreateInfo.Sample;
-		this->CreateInfo.tiling						= (VkImageTiling)aCreateInfo.Tiling;
-		this->CreateInfo.usage						= (VkImageUsageFlags)aCreateInfo.Usage;
-		this->CreateInfo.sharingMode				= VK_SHARING_MODE_EXCLUSIVE;
-		this->CreateInfo.queueFamilyIndexCount		= 0;
-		this->CreateInfo.pQueueFamilyIndices		= NULL;
-		this->CreateInfo.initialLayout				= VK_IMAGE_LAYOUT_UNDEFINED;
 
-		Result = vkCreateImage(aContext->Handle, &CreateInfo, NULL, &this->Handle);
-		if (Result != VK_SUCCESS) {
-			// TODO: Error handling
-			throw std::runtime_error("Failed to create image.");
-		}
+		this->create_handle(aContext, aCreateInfo, aFormat, aX, aY, aZ, aT);
 
 		// Get memory requirements of the image object.
 		VkMemoryRequirements MemoryRequirements = this->memory_requirements();
 
 		// Find the memory index for the heap that best suits the memory requirements, and desired memory properties.
-		this->MemoryType = aCreateInfo.Memory;
-		this->MemoryHandle = this->Context->allocate_memory(MemoryRequirements, aCreateInfo.Memory);
+		this->MemoryHandle = this->Context->allocate_memory(MemoryRequirements, this->MemoryType);
 
 		// Bind the image object to the memory object.
 		Result = vkBindImageMemory(this->Context->Handle, this->Handle, this->MemoryHandle, 0);
@@ -956,32 +548,139 @@ namespace geodesy::gpu {
 			throw std::runtime_error("Failed to create image.");
 		}
 
-		// Write data to the image.
-		if (aTextureData != NULL) {
+		// Create Image View, before the upload that may sample it.
+		this->View = this->view();
+		this->ViewGeneration++;
+
+		// Upload, mip generation and the transition to the requested layout share one submission.
+		layout FinalLayout = (aTextureData != NULL) ? SHADER_READ_ONLY_OPTIMAL : (layout)aCreateInfo.Layout;
+		Result = upload(aContext, { this }, { aTextureData }, { FinalLayout }, SIZE_MAX);
 
-			// Transition to TRANSFER_DST_OPTIMAL
-			Result = this->transition(LAYOUT_UNDEFINED, TRANSFER_DST_OPTIMAL);
+		this->CreateInfo.initialLayout				= (VkImageLayout)aCreateInfo.Layout;
+	}
 
-			// Write the texture data to the image.
-			Result = this->write({ 0, 0, 0 }, 0, aTextureData, 0, { aX, aY, aZ }, aT);
+	VkResult image::create_batch(std::shared_ptr<context> aContext, const std::vector<batch_item>& aItem, std::vector<std::shared_ptr<image>>& aImage, size_t aStagingSize) {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkBindImageMemory vkBindImageMemory = (PFN_vkBindImageMemory)aContext->function_pointer("vkBindImageMemory");
 
-			// Generate mipmaps & transition to SHADER_READ_ONLY_OPTIMAL
-			Result = this->generate_mipmaps(TRANSFER_DST_OPTIMAL, SHADER_READ_ONLY_OPTIMAL, VK_FILTER_LINEAR);
+		// Handles first, their memory requirements decide how they are packed.
+		aImage = std::vector<std::shared_ptr<image>>(aItem.size(), nullptr);
+		std::vector<VkMemoryRequirements> Requirements(aItem.size());
+		for (size_t i = 0; i < aItem.size(); i++) {
+			if (aItem[i].CreateInfo.Transient && (aItem[i].Data != NULL)) {
+				Result = VK_ERROR_INITIALIZATION_FAILED;
+				continue;
+			}
+			try {
+				std::shared_ptr<image> Image = std::make_shared<image>();
+				create_info CreateInfo = aItem[i].CreateInfo;
+				Image->create_handle(aContext, CreateInfo, aItem[i].Format, aItem[i].X, aItem[i].Y, aItem[i].Z, aItem[i].T);
+				Requirements[i] = Image->memory_requirements();
+				aImage[i] = Image;
+			}
+			catch (const std::runtime_error&) {
+				Result = VK_ERROR_INITIALIZATION_FAILED;
+			}
+		}
 
+		// Images of the same memory type are placed back to back in shared blocks, images larger than a block get their own.
+		struct block {
+			int 									TypeIndex;
+			unsigned int 							MemoryType;
+			VkDeviceSize 							Size;
+			VkDeviceSize 							Alignment;
+			VkImageTiling 							Tiling; 		// Of the last image placed.
+			std::vector<std::pair<size_t, VkDeviceSize>> 	Image; 			// Index and offset.
+		};
+		std::vector<block> Block;
+		std::map<int, size_t> OpenBlock;
+		VkDeviceSize Granularity = aContext->Device->Properties.limits.bufferImageGranularity;
+		for (size_t i = 0; i < aImage.size(); i++) {
+			if (aImage[i] == nullptr) continue;
+			int TypeIndex = aContext->Device->get_memory_type_index(Requirements[i], aImage[i]->MemoryType);
+			if (TypeIndex < 0) {
+				aImage[i] = nullptr;
+				Result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+				continue;
+			}
+			auto It = OpenBlock.find(TypeIndex);
+			VkDeviceSize Offset = 0;
+			if (It != OpenBlock.end()) {
+				// Linear and optimal images next to each other must not share a granularity page.
+				VkDeviceSize Alignment = Requirements[i].alignment;
+				if (Block[It->second].Tiling != aImage[i]->CreateInfo.tiling) {
+					Alignment = std::max(Alignment, Granularity);
+				}
+				Offset = ((Block[It->second].Size + Alignment - 1) / Alignment) * Alignment;
+			}
+			if ((It == OpenBlock.end()) || (Offset + Requirements[i].size > GPU_IMAGE_BATCH_BLOCK_SIZE)) {
+				block NewBlock;
+				NewBlock.TypeIndex 		= TypeIndex;
+				NewBlock.MemoryType 	= aImage[i]->MemoryType;
+				NewBlock.Size 			= 0;
+				NewBlock.Alignment 		= 1;
+				Block.push_back(NewBlock);
+				OpenBlock[TypeIndex] = Block.size() - 1;
+				Offset = 0;
+			}
+			block& Entry = Block[OpenBlock[TypeIndex]];
+			Entry.Size 			= Offset + Requirements[i].size;
+			Entry.Alignment 	= std::max(Entry.Alignment, Requirements[i].alignment);
+			Entry.Tiling 		= aImage[i]->CreateInfo.tiling;
+			Entry.Image.push_back(std::make_pair(i, Offset));
 		}
-		else {
-			// Transition to SHADER_READ_ONLY_OPTIMAL
-			Result = this->transition(LAYOUT_UNDEFINED, (layout)aCreateInfo.Layout);
+
+		// The last image using a block frees it.
+		for (const block& Entry : Block) {
+			VkMemoryRequirements BlockRequirements{};
+			BlockRequirements.size 				= Entry.Size;
+			BlockRequirements.alignment 		= Entry.Alignment;
+			BlockRequirements.memoryTypeBits 	= 1u << Entry.TypeIndex;
+			VkDeviceMemory Memory = aContext->allocate_memory(BlockRequirements, Entry.MemoryType);
+			std::shared_ptr<VkDeviceMemory> SharedMemory = nullptr;
+			if (Memory != VK_NULL_HANDLE) {
+				SharedMemory = std::shared_ptr<VkDeviceMemory>(new VkDeviceMemory(Memory), [aContext](VkDeviceMemory* aMemory) {
+					aContext->free_memory(*aMemory);
+					delete aMemory;
+				});
+			}
+			for (const auto& [Index, Offset] : Entry.Image) {
+				if ((Memory == VK_NULL_HANDLE) || (vkBindImageMemory(aContext->Handle, aImage[Index]->Handle, Memory, Offset) != VK_SUCCESS)) {
+					aImage[Index] = nullptr;
+					Result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+					continue;
+				}
+				aImage[Index]->MemoryHandle = Memory;
+				aImage[Index]->SharedMemory = SharedMemory;
+			}
 		}
 
-		this->CreateInfo.initialLayout				= (VkImageLayout)aCreateInfo.Layout;
+		std::vector<image*> Image;
+		std::vector<void*> Data;
+		std::vector<layout> FinalLayout;
+		for (size_t i = 0; i < aImage.size(); i++) {
+			if (aImage[i] == nullptr) continue;
+			aImage[i]->View = aImage[i]->view();
+			aImage[i]->ViewGeneration++;
+			Image.push_back(aImage[i].get());
+			Data.push_back(aItem[i].Data);
+			FinalLayout.push_back((aItem[i].Data != NULL) ? SHADER_READ_ONLY_OPTIMAL : (layout)aItem[i].CreateInfo.Layout);
+		}
+		VkResult UploadResult = upload(aContext, Image, Data, FinalLayout, aStagingSize);
 
-		// Create Image View
-		this->View = this->view();
+		for (size_t i = 0; i < aImage.size(); i++) {
+			if (aImage[i] == nullptr) continue;
+			aImage[i]->CreateInfo.initialLayout 	= (VkImageLayout)aItem[i].CreateInfo.Layout;
+		}
+
+		return (Result != VK_SUCCESS) ? Result : UploadResult;
 	}
 
 	// Destructor
 	image::~image() {
+		if (Context != nullptr) {
+			Context->evict_framebuffers(this);
+		}
 		if (View != VK_NULL_HANDLE) {
 			PFN_vkDestroyImageView vkDestroyImageView = (PFN_vkDestroyImageView)this->Context->function_pointer("vkDestroyImageView");
 			vkDestroyImageView(Context->Handle, View, NULL);
@@ -989,7 +688,9 @@ namespace geodesy::gpu {
 		if (Handle != VK_NULL_HANDLE) {
 			PFN_vkDestroyImage vkDestroyImage = (PFN_vkDestroyImage)this->Context->function_pointer("vkDestroyImage");
 			vkDestroyImage(Context->Handle, Handle, NULL);
-			Context->free_memory(MemoryHandle);
+			if (SharedMemory == nullptr) {
+				Context->free_memory(MemoryHandle);
+			}
 		}
 		// if (HostData != NULL) {
 		// 	stbi_image_free(HostData);
@@ -1012,6 +713,10 @@ namespace geodesy::gpu {
 	void image::copy(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aSourceData, std::vector<VkBufferImageCopy> aRegionList) {
 		PFN_vkCmdCopyBufferToImage vkCmdCopyBufferToImage = (PFN_vkCmdCopyBufferToImage)this->Context->function_pointer("vkCmdCopyBufferToImage");
 		vkCmdCopyBufferToImage(aCommandBuffer->Handle, aSourceData->Handle, this->Handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, aRegionList.size(), aRegionList.data());
+		aSourceData->track(VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+		for (const VkBufferImageCopy& Region : aRegionList) {
+			this->track(TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Region.imageSubresource.mipLevel, 1, Region.imageSubresource.baseArrayLayer, Region.imageSubresource.layerCount);
+		}
 	}
 
 	void image::copy(command_buffer* aCommandBuffer, VkOffset3D aDestinationOffset, uint32_t aDestinationArrayLayer, std::shared_ptr<image> aSourceData, VkOffset3D aSourceOffset, uint32_t aSourceArrayLayer, VkExtent3D aRegionExtent, uint32_t aArrayLayerCount) {
@@ -1033,6 +738,10 @@ namespace geodesy::gpu {
 			this->Handle, 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
 			aRegionList.size(), aRegionList.data()
 		);
+		for (const VkImageCopy& Region : aRegionList) {
+			aSourceData->track(TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Region.srcSubresource.mipLevel, 1, Region.srcSubresource.baseArrayLayer, Region.srcSubresource.layerCount);
+			this->track(TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Region.dstSubresource.mipLevel, 1, Region.dstSubresource.baseArrayLayer, Region.dstSubresource.layerCount);
+		}
 	}
 
 	void image::transition(
@@ -1042,6 +751,11 @@ namespace geodesy::gpu {
 		uint32_t aMipLevel, uint32_t aMipLevelCount,
 		uint32_t aArrayLayerStart, uint32_t aArrayLayerCount
 	) {
+		if (aCurrentLayout == LAYOUT_CURRENT) {
+			// Skipped where the tracked layout already matches.
+			this->require(aCommandBuffer, aFinalLayout, device::access::MEMORY_READ, aDstStageMask, aMipLevel, aMipLevelCount, aArrayLayerStart, aArrayLayerCount);
+			return;
+		}
 		PFN_vkCmdPipelineBarrier vkCmdPipelineBarrier = (PFN_vkCmdPipelineBarrier)this->Context->function_pointer("vkCmdPipelineBarrier");
 		VkImageMemoryBarrier ImageMemoryBarrier = this->memory_barrier(
 			// All Write Ops Must Finish			// Prepare Reading
@@ -1059,6 +773,7 @@ namespace geodesy::gpu {
 			0, NULL,
 			1, &ImageMemoryBarrier
 		);
+		this->track(aFinalLayout, device::access::MEMORY_READ, aDstStageMask, aMipLevel, aMipLevelCount, aArrayLayerStart, aArrayLayerCount);
 	}
 
 	void image::clear(command_buffer* aCommandBuffer, VkClearColorValue aClearColor, image::layout aCurrentImageLayout, uint32_t aStartingArrayLayer, uint32_t aArrayLayerCount) {
@@ -1069,9 +784,16 @@ namespace geodesy::gpu {
 		SubresourceRange.levelCount 	= this->CreateInfo.mipLevels;
 		SubresourceRange.baseArrayLayer = std::min(aStartingArrayLayer, this->CreateInfo.arrayLayers - 1);
 		SubresourceRange.layerCount 	= std::min(aArrayLayerCount, this->CreateInfo.arrayLayers - SubresourceRange.baseArrayLayer);
-		this->transition(aCommandBuffer, aCurrentImageLayout, TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, this->CreateInfo.mipLevels, aStartingArrayLayer, aArrayLayerCount);
+		// Returned to the layout it was in, images that were UNDEFINED are left in TRANSFER_DST_OPTIMAL.
+		layout FinalLayout = (aCurrentImageLayout == LAYOUT_CURRENT) ? this->current_layout(0, SubresourceRange.baseArrayLayer) : aCurrentImageLayout;
+		if (aCurrentImageLayout != LAYOUT_CURRENT) {
+			this->track(aCurrentImageLayout, VK_ACCESS_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, this->CreateInfo.mipLevels, aStartingArrayLayer, aArrayLayerCount);
+		}
+		this->require(aCommandBuffer, TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, this->CreateInfo.mipLevels, aStartingArrayLayer, aArrayLayerCount);
 		vkCmdClearColorImage(aCommandBuffer->Handle, this->Handle, (VkImageLayout)TRANSFER_DST_OPTIMAL, &aClearColor, 1, &SubresourceRange);
-		this->transition(aCommandBuffer, TRANSFER_DST_OPTIMAL, aCurrentImageLayout, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, this->CreateInfo.mipLevels, aStartingArrayLayer, aArrayLayerCount);
+		if ((FinalLayout != LAYOUT_UNDEFINED) && (FinalLayout != TRANSFER_DST_OPTIMAL)) {
+			this->require(aCommandBuffer, FinalLayout, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, this->CreateInfo.mipLevels, aStartingArrayLayer, aArrayLayerCount);
+		}
 	}
 
 	void image::clear_depth(command_buffer* aCommandBuffer, VkClearDepthStencilValue aClearDepthStencil, image::layout aCurrentImageLayout, uint32_t aStartingArrayLayer, uint32_t aArrayLayerCount) {
@@ -1082,9 +804,16 @@ namespace geodesy::gpu {
 		SubresourceRange.levelCount 	= this->CreateInfo.mipLevels;
 		SubresourceRange.baseArrayLayer = std::min(aStartingArrayLayer, this->CreateInfo.arrayLayers - 1);
 		SubresourceRange.layerCount 	= std::min(aArrayLayerCount, this->CreateInfo.arrayLayers - SubresourceRange.baseArrayLayer);
-		this->transition(aCommandBuffer, aCurrentImageLayout, TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, this->CreateInfo.mipLevels, aStartingArrayLayer, aArrayLayerCount);
+		// Returned to the layout it was in, images that were UNDEFINED are left in TRANSFER_DST_OPTIMAL.
+		layout FinalLayout = (aCurrentImageLayout == LAYOUT_CURRENT) ? this->current_layout(0, SubresourceRange.baseArrayLayer) : aCurrentImageLayout;
+		if (aCurrentImageLayout != LAYOUT_CURRENT) {
+			this->track(aCurrentImageLayout, VK_ACCESS_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, this->CreateInfo.mipLevels, aStartingArrayLayer, aArrayLayerCount);
+		}
+		this->require(aCommandBuffer, TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, this->CreateInfo.mipLevels, aStartingArrayLayer, aArrayLayerCount);
 		vkCmdClearDepthStencilImage(aCommandBuffer->Handle, this->Handle, (VkImageLayout)TRANSFER_DST_OPTIMAL, &aClearDepthStencil, 1, &SubresourceRange);
-		this->transition(aCommandBuffer, TRANSFER_DST_OPTIMAL, aCurrentImageLayout, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, this->CreateInfo.mipLevels, aStartingArrayLayer, aArrayLayerCount);
+		if ((FinalLayout != LAYOUT_UNDEFINED) && (FinalLayout != TRANSFER_DST_OPTIMAL)) {
+			this->require(aCommandBuffer, FinalLayout, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, this->CreateInfo.mipLevels, aStartingArrayLayer, aArrayLayerCount);
+		}
 	}
 
 	VkResult image::copy(VkOffset3D aDestinationOffset, uint32_t aDestinationArrayLayer, std::shared_ptr<buffer> aSourceData, size_t aSourceOffset, VkExtent3D aRegionExtent, uint32_t aArrayLayerCount) {
@@ -1111,6 +840,8 @@ namespace geodesy::gpu {
 
 		// Execute command buffer.
 		Result = Context->execute_and_wait(device::operation::TRANSFER, CommandBuffer);
+		this->reset_access();
+		aSourceData->reset_access();
 
 		return Result;
 	}
@@ -1138,6 +869,8 @@ namespace geodesy::gpu {
 
 		// Execute command buffer.
 		Result = Context->execute_and_wait(device::operation::TRANSFER, CommandBuffer);
+		this->reset_access();
+		aSourceData->reset_access();
 
 		return Result;
 	}
@@ -1150,32 +883,23 @@ namespace geodesy::gpu {
 		// This function will transition the designated image resources after 
 		// all other operations are completed.
 		VkResult Result = VK_SUCCESS;
-		PFN_vkCmdPipelineBarrier vkCmdPipelineBarrier = (PFN_vkCmdPipelineBarrier)this->Context->function_pointer("vkCmdPipelineBarrier");
-		VkImageMemoryBarrier ImageMemoryBarrier = this->memory_barrier(
-			// All Write Ops Must Finish			// Prepare Reading
-			device::access::MEMORY_WRITE, 			device::access::MEMORY_READ,
-			// Previous Layout						// New Layout
-			aCurrentLayout, 						aFinalLayout,
-			aMipLevel, aMipLevelCount,
-			aArrayLayerStart, aArrayLayerCount			
-		);
 		auto CommandPool = Context->create<command_pool>(device::operation::TRANSFER);
 		auto CommandBuffer = CommandPool->create<command_buffer>();
 
-		// Record Command Buffer
+		// Record Command Buffer, LAYOUT_CURRENT transitions each run of subresources from its own tracked layout.
 		Result = CommandBuffer->begin();
-		vkCmdPipelineBarrier(
-			CommandBuffer->Handle, 
-			pipeline::stage::BOTTOM_OF_PIPE, pipeline::stage::TOP_OF_PIPE, 
-			0,
-			0, NULL,
-			0, NULL,
-			1, &ImageMemoryBarrier
+		this->transition(
+			CommandBuffer.get(), 
+			aCurrentLayout, aFinalLayout, 
+			pipeline::stage::ALL_COMMANDS, pipeline::stage::ALL_COMMANDS, 
+			aMipLevel, aMipLevelCount, 
+			aArrayLayerStart, aArrayLayerCount
 		);
 		Result = CommandBuffer->end();
 
 		// Execute
 		Result = Context->execute_and_wait(device::operation::TRANSFER, CommandBuffer);
+		this->reset_access();
 
 		return Result;
 	}
@@ -1192,6 +916,7 @@ namespace geodesy::gpu {
 
 		// Execute command buffer.
 		Result = Context->execute_and_wait(device::operation::GRAPHICS, CommandBuffer);
+		this->reset_access();
 
 		return Result;
 	}
@@ -1208,106 +933,54 @@ namespace geodesy::gpu {
 
 		// Execute command buffer.
 		Result = Context->execute_and_wait(device::operation::GRAPHICS, CommandBuffer);
+		this->reset_access();
 
 		return Result;
 	}
 
+	void image::generate_mipmaps(command_buffer* aCommandBuffer, layout aFinalLayout, VkFilter aFilter) {
+		if (aFinalLayout == LAYOUT_CURRENT) {
+			aFinalLayout = this->current_layout();
+		}
+
+		for (uint32_t i = 0; i + 1 < this->CreateInfo.mipLevels; i++) {
+			// Only the two levels taking part in the blit wait, and only on the transfer stage.
+			barrier_batch Barrier;
+			this->require(Barrier, TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, i, 1);
+			this->require(Barrier, TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, i + 1, 1);
+			Barrier.record(aCommandBuffer);
+			this->blit_level(aCommandBuffer, i, aFilter);
+		}
+
+		this->require(aCommandBuffer, aFinalLayout, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+	}
+
 	VkResult image::generate_mipmaps(layout aCurrentLayout, layout aFinalLayout, VkFilter aFilter) {
 		VkResult Result = VK_SUCCESS;
-		PFN_vkCmdPipelineBarrier vkCmdPipelineBarrier = (PFN_vkCmdPipelineBarrier)this->Context->function_pointer("vkCmdPipelineBarrier");
-		PFN_vkCmdBlitImage vkCmdBlitImage = (PFN_vkCmdBlitImage)this->Context->function_pointer("vkCmdBlitImage");
 
 		// ----- Generate MipMaps ----- // 
 
-		this->transition(aCurrentLayout, layout::TRANSFER_DST_OPTIMAL);
+		if (aCurrentLayout == LAYOUT_CURRENT) {
+			aCurrentLayout = this->current_layout();
+		}
+		else {
+			this->track(aCurrentLayout, 0, 0);
+		}
+		if (aFinalLayout == LAYOUT_CURRENT) {
+			aFinalLayout = aCurrentLayout;
+		}
 
 		auto CommandPool = Context->create<command_pool>(device::operation::GRAPHICS);
 		auto CommandBuffer = CommandPool->create<command_buffer>();
 
-		VkOffset3D d = { (int32_t)this->CreateInfo.extent.width, (int32_t)this->CreateInfo.extent.height, (int32_t)this->CreateInfo.extent.depth };
-
+		// Transitions are recorded along with the blits, one submission in total.
 		Result = CommandBuffer->begin();
-		for (uint32_t i = 0; i < this->CreateInfo.mipLevels - 1; i++) {
-			VkImageMemoryBarrier ImageTransition{};
-			VkImageBlit IBO{};
-
-			// Image Blitting Source Level
-			IBO.srcSubresource.aspectMask = aspect_flag(this->CreateInfo.format);
-			IBO.srcSubresource.mipLevel = i;
-			IBO.srcSubresource.baseArrayLayer = 0;
-			IBO.srcSubresource.layerCount = this->CreateInfo.arrayLayers;
-			IBO.srcOffsets[0] = { 0, 0, 0 };
-			IBO.srcOffsets[1] = { (d.x >> i) ? d.x >> i : 1, (d.y >> i) ? d.y >> i : 1, (d.z >> i) ? d.z >> i : 1 };
-
-			// Image Blitting Destination Level
-			IBO.dstSubresource.aspectMask = aspect_flag(this->CreateInfo.format);
-			IBO.dstSubresource.mipLevel = i + 1;
-			IBO.dstSubresource.baseArrayLayer = 0;
-			IBO.dstSubresource.layerCount = this->CreateInfo.arrayLayers;
-			IBO.dstOffsets[0] = { 0, 0, 0 };
-			IBO.dstOffsets[1] = { (d.x >> (i + 1)) ? d.x >> (i + 1) : 1, (d.y >> (i + 1)) ? d.y >> (i + 1) : 1, (d.z >> (i + 1)) ? d.z >> (i + 1) : 1 };
-
-			// Source Image Section
-			ImageTransition = this->memory_barrier(
-				// All Write Ops Must Finish			// Prepare Reading
-				device::access::MEMORY_WRITE, device::access::MEMORY_READ,
-				// Previous Layout						// New Layout
-				image::layout::TRANSFER_DST_OPTIMAL, image::layout::TRANSFER_SRC_OPTIMAL,
-				i, 1
-			);
-
-			vkCmdPipelineBarrier(
-				CommandBuffer->Handle,
-				pipeline::stage::BOTTOM_OF_PIPE, pipeline::stage::TOP_OF_PIPE,
-				0,
-				0, NULL,
-				0, NULL,
-				1, &ImageTransition
-			);
-
-			vkCmdBlitImage(
-				CommandBuffer->Handle,
-				this->Handle, (VkImageLayout)layout::TRANSFER_SRC_OPTIMAL,
-				this->Handle, (VkImageLayout)layout::TRANSFER_DST_OPTIMAL,
-				1, &IBO,
-				aFilter
-			);
-
-		}
-
-		// Transition the final mip level to TRANSFER_SRC_OPTIMAL.
-		VkImageMemoryBarrier FinalTransition = this->memory_barrier(
-			device::access::MEMORY_WRITE, device::access::MEMORY_READ,
-			image::layout::TRANSFER_DST_OPTIMAL, image::layout::TRANSFER_SRC_OPTIMAL,
-			this->CreateInfo.mipLevels - 1, 1
-		);
-
-		vkCmdPipelineBarrier(
-			CommandBuffer->Handle,
-			pipeline::stage::BOTTOM_OF_PIPE, pipeline::stage::TOP_OF_PIPE,
-			0,
-			0, NULL,
-			0, NULL,
-			1, &FinalTransition
-		);
-
-		FinalTransition = this->memory_barrier(
-			device::access::MEMORY_WRITE, 			device::access::MEMORY_READ,
-			image::layout::TRANSFER_SRC_OPTIMAL, 	aFinalLayout
-		);
-
-		vkCmdPipelineBarrier(
-			CommandBuffer->Handle,
-			pipeline::stage::BOTTOM_OF_PIPE, pipeline::stage::TOP_OF_PIPE,
-			0,
-			0, NULL,
-			0, NULL,
-			1, &FinalTransition
-		);
+		this->generate_mipmaps(CommandBuffer.get(), aFinalLayout, aFilter);
 		Result = CommandBuffer->end();
 
 		// Execute command buffer.
 		Result = Context->execute_and_wait(device::operation::GRAPHICS, CommandBuffer);
+		this->reset_access();
 
 		return Result;
 	}
@@ -1331,35 +1004,51 @@ namespace geodesy::gpu {
 
 	VkResult image::write(void* aSourceData, std::vector<VkBufferImageCopy> aRegionList) {
 		VkResult Result = VK_SUCCESS;
+		if (aRegionList.size() == 0) return Result;
 
-		// Staging Buffer size is determined by the largest transfer region, and then allocated so that all regions can be copied to the buffer.
-		// without reallocation.
-
-		size_t StagingBufferSize = 0;
-		for (const VkBufferImageCopy& Region : aRegionList) {
-			size_t RegionSize = Region.imageExtent.width * Region.imageExtent.height * Region.imageExtent.depth * Region.imageSubresource.layerCount * bytes_per_pixel(this->CreateInfo.format);
-			if (StagingBufferSize < RegionSize) {
-				StagingBufferSize = RegionSize;
-			}
-		}
-
-		std::shared_ptr<buffer> StagingBuffer = std::make_shared<buffer>(
+		// Every region is packed into one host visible staging buffer, offsets keep copies texel aligned.
+		std::vector<VkBufferImageCopy> StagingRegion = aRegionList;
+		size_t StagingBufferSize = this->stage(StagingRegion);
+		std::shared_ptr<buffer> StagingBuffer = geodesy::make<buffer>(
 			Context,
-			device::memory::DEVICE_LOCAL,
-			buffer::TRANSFER_SRC | buffer::TRANSFER_DST,
+			device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT,
+			buffer::TRANSFER_SRC,
 			StagingBufferSize
 		);
+		if (StagingBuffer == nullptr) return VK_ERROR_OUT_OF_HOST_MEMORY;
 
-		for (const VkBufferImageCopy& Region : aRegionList) {
-			// Calculate Region Size
-			size_t RegionSize = Region.imageExtent.width * Region.imageExtent.height * Region.imageExtent.depth * Region.imageSubresource.layerCount * bytes_per_pixel(this->CreateInfo.format);
-			
-			// Write data to device buffer.
-			Result = StagingBuffer->write(0, aSourceData, Region.bufferOffset, RegionSize);
+		uint8_t* StagingData = (uint8_t*)StagingBuffer->map_memory(0, StagingBufferSize);
+		if (StagingData == NULL) return VK_ERROR_MEMORY_MAP_FAILED;
+		for (size_t i = 0; i < aRegionList.size(); i++) {
+			memcpy(StagingData + StagingRegion[i].bufferOffset, (uint8_t*)aSourceData + aRegionList[i].bufferOffset, this->region_size(aRegionList[i]));
+		}
+		StagingBuffer->unmap_memory();
 
-			// Copy data from device buffer to image.
-			Result = this->copy(Region.imageOffset, Region.imageSubresource.baseArrayLayer, StagingBuffer, Region.bufferOffset, Region.imageExtent, Region.imageSubresource.layerCount);
+		// One submission covers every mip level and layer, each is returned to the layout it was in.
+		auto CommandPool = Context->create<command_pool>(device::operation::TRANSFER);
+		auto CommandBuffer = CommandPool->create<command_buffer>();
+		Result = CommandBuffer->begin();
+		if (Result != VK_SUCCESS) return Result;
+		std::vector<layout> PreviousLayout(aRegionList.size());
+		barrier_batch Barrier;
+		for (size_t i = 0; i < aRegionList.size(); i++) {
+			const VkImageSubresourceLayers& Subresource = aRegionList[i].imageSubresource;
+			PreviousLayout[i] = this->current_layout(Subresource.mipLevel, Subresource.baseArrayLayer);
+			this->require(Barrier, TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Subresource.mipLevel, 1, Subresource.baseArrayLayer, Subresource.layerCount);
 		}
+		Barrier.record(CommandBuffer.get());
+		this->copy(CommandBuffer.get(), StagingBuffer, StagingRegion);
+		for (size_t i = 0; i < aRegionList.size(); i++) {
+			const VkImageSubresourceLayers& Subresource = aRegionList[i].imageSubresource;
+			if ((PreviousLayout[i] == LAYOUT_UNDEFINED) || (PreviousLayout[i] == TRANSFER_DST_OPTIMAL)) continue;
+			this->require(Barrier, PreviousLayout[i], 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, Subresource.mipLevel, 1, Subresource.baseArrayLayer, Subresource.layerCount);
+		}
+		Barrier.record(CommandBuffer.get());
+		Result = CommandBuffer->end();
+		if (Result != VK_SUCCESS) return Result;
+
+		Result = Context->execute_and_wait(device::operation::TRANSFER, CommandBuffer);
+		this->reset_access();
 
 		return Result;
 	}
@@ -1382,47 +1071,101 @@ namespace geodesy::gpu {
 
 	VkResult image::read(void* aDestinationData, std::vector<VkBufferImageCopy> aRegionList) {
 		VkResult Result = VK_SUCCESS;
+		if (aRegionList.size() == 0) return Result;
 
-		size_t StagingBufferSize = 0;
-		for (const VkBufferImageCopy& Region : aRegionList) {
-			size_t RegionSize = Region.imageExtent.width * Region.imageExtent.height * Region.imageExtent.depth * Region.imageSubresource.layerCount * bytes_per_pixel(this->CreateInfo.format);
-			if (StagingBufferSize < RegionSize) {
-				StagingBufferSize = RegionSize;
-			}
-		}
-
-		std::shared_ptr<buffer> StagingBuffer = std::make_shared<buffer>(
+		std::vector<VkBufferImageCopy> StagingRegion = aRegionList;
+		size_t StagingBufferSize = this->stage(StagingRegion);
+		std::shared_ptr<buffer> StagingBuffer = geodesy::make<buffer>(
 			Context,
-			device::memory::DEVICE_LOCAL,
-			buffer::TRANSFER_SRC | buffer::TRANSFER_DST,
+			device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT,
+			buffer::TRANSFER_DST,
 			StagingBufferSize
 		);
+		if (StagingBuffer == nullptr) return VK_ERROR_OUT_OF_HOST_MEMORY;
 
-		for (const VkBufferImageCopy& Region : aRegionList) {
-			// Calculate Region Size
-			size_t RegionSize = Region.imageExtent.width * Region.imageExtent.height * Region.imageExtent.depth * Region.imageSubresource.layerCount * bytes_per_pixel(this->CreateInfo.format);
+		// One submission copies every region straight into host visible memory.
+		auto CommandPool = Context->create<command_pool>(device::operation::TRANSFER);
+		auto CommandBuffer = CommandPool->create<command_buffer>();
+		Result = CommandBuffer->begin();
+		if (Result != VK_SUCCESS) return Result;
+		std::vector<layout> PreviousLayout(aRegionList.size());
+		barrier_batch Barrier;
+		for (size_t i = 0; i < aRegionList.size(); i++) {
+			const VkImageSubresourceLayers& Subresource = aRegionList[i].imageSubresource;
+			PreviousLayout[i] = this->current_layout(Subresource.mipLevel, Subresource.baseArrayLayer);
+			this->require(Barrier, TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Subresource.mipLevel, 1, Subresource.baseArrayLayer, Subresource.layerCount);
+		}
+		Barrier.record(CommandBuffer.get());
+		StagingBuffer->copy(CommandBuffer.get(), this->shared_from_this(), StagingRegion);
+		// Device writes made available to the host.
+		pipeline::barrier(CommandBuffer.get(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT);
+		for (size_t i = 0; i < aRegionList.size(); i++) {
+			const VkImageSubresourceLayers& Subresource = aRegionList[i].imageSubresource;
+			if ((PreviousLayout[i] == LAYOUT_UNDEFINED) || (PreviousLayout[i] == TRANSFER_SRC_OPTIMAL)) continue;
+			this->require(Barrier, PreviousLayout[i], 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, Subresource.mipLevel, 1, Subresource.baseArrayLayer, Subresource.layerCount);
+		}
+		Barrier.record(CommandBuffer.get());
+		Result = CommandBuffer->end();
+		if (Result != VK_SUCCESS) return Result;
 
-			// Copy data from texture to staging buffer
-			Result = StagingBuffer->copy(0, this->shared_from_this(), Region.imageOffset, Region.imageSubresource.baseArrayLayer, Region.imageExtent, Region.imageSubresource.layerCount);
+		Result = Context->execute_and_wait(device::operation::TRANSFER, CommandBuffer);
+		this->reset_access();
+		if (Result != VK_SUCCESS) return Result;
 
-			// Read data from device buffer.
-			Result = StagingBuffer->read(0, aDestinationData, Region.bufferOffset, RegionSize);
-			
+		uint8_t* StagingData = (uint8_t*)StagingBuffer->map_memory(0, StagingBufferSize);
+		if (StagingData == NULL) return VK_ERROR_MEMORY_MAP_FAILED;
+		for (size_t i = 0; i < aRegionList.size(); i++) {
+			memcpy((uint8_t*)aDestinationData + aRegionList[i].bufferOffset, StagingData + StagingRegion[i].bufferOffset, this->region_size(aRegionList[i]));
 		}
+		StagingBuffer->unmap_memory();
 
 		return Result;
 	}
 
+	size_t image::region_size(const VkBufferImageCopy& aRegion) const {
+		if ((aRegion.imageExtent.width == 0) || (aRegion.imageExtent.height == 0) || (aRegion.imageExtent.depth == 0) || (aRegion.imageSubresource.layerCount == 0)) return 0;
+		// Rows and pitches count texel blocks, partial blocks at the edges of a level are whole blocks in memory.
+		pixel::format_traits Traits = pixel::traits(this->CreateInfo.format);
+		size_t BlockWidth 	= Traits.BlockWidth;
+		size_t BlockHeight 	= Traits.BlockHeight;
+		size_t RowLength 	= (aRegion.bufferRowLength != 0) ? aRegion.bufferRowLength : aRegion.imageExtent.width;
+		size_t ImageHeight 	= (aRegion.bufferImageHeight != 0) ? aRegion.bufferImageHeight : aRegion.imageExtent.height;
+		size_t RowPitch 	= ((RowLength + BlockWidth - 1) / BlockWidth) * Traits.BlockSize;
+		size_t SlicePitch 	= RowPitch * ((ImageHeight + BlockHeight - 1) / BlockHeight);
+		size_t SliceCount 	= (size_t)aRegion.imageExtent.depth * aRegion.imageSubresource.layerCount;
+		size_t RowCount 	= (aRegion.imageExtent.height + BlockHeight - 1) / BlockHeight;
+		size_t ColumnCount 	= (aRegion.imageExtent.width + BlockWidth - 1) / BlockWidth;
+		// The last row of the last slice is only as long as the region is wide.
+		return SlicePitch * (SliceCount - 1) + RowPitch * (RowCount - 1) + ColumnCount * Traits.BlockSize;
+	}
+
+	size_t image::stage(std::vector<VkBufferImageCopy>& aRegionList) const {
+		// Offsets must be multiples of the texel block size and of 4.
+		size_t Alignment = std::lcm(std::max<size_t>(block_size(this->CreateInfo.format), 1), (size_t)4);
+		size_t Offset = 0;
+		for (VkBufferImageCopy& Region : aRegionList) {
+			Offset = ((Offset + Alignment - 1) / Alignment) * Alignment;
+			Region.bufferOffset = Offset;
+			Offset += this->region_size(Region);
+		}
+		return Offset;
+	}
+
 	VkImageView image::view(
 		uint32_t aMipLevel, uint32_t aMipLevelCount,
-		uint32_t aArrayLayerStart, uint32_t aArrayLayerCount
+		uint32_t aArrayLayerStart, uint32_t aArrayLayerCount,
+		float aMinLod
 	) const {
 		VkResult Result = VK_SUCCESS;
 		VkImageViewCreateInfo IVCI{};
+		VkImageViewMinLodCreateInfoEXT IVMLCI{};
 		VkImageView IV = VK_NULL_HANDLE;
 		PFN_vkCreateImageView vkCreateImageView = (PFN_vkCreateImageView)this->Context->function_pointer("vkCreateImageView");
+		IVMLCI.sType							= VK_STRUCTURE_TYPE_IMAGE_VIEW_MIN_LOD_CREATE_INFO_EXT;
+		IVMLCI.pNext							= NULL;
+		IVMLCI.minLod							= aMinLod;
 		IVCI.sType								= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		IVCI.pNext								= NULL;
+		IVCI.pNext								= ((aMinLod > 0.0f) && this->Context->ImageViewMinLod) ? &IVMLCI : NULL;
 		IVCI.flags								= 0;
 		IVCI.image								= this->Handle;
 		switch(CreateInfo.imageType) {
@@ -1461,6 +1204,13 @@ namespace geodesy::gpu {
 		AD.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_STORE;
 		AD.initialLayout	= (VkImageLayout)aStartingLayout;
 		AD.finalLayout		= (VkImageLayout)aEndingLayout;
+		if (this->CreateInfo.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) {
+			// Nothing to load or keep, the attachment never leaves tile memory.
+			AD.loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR;
+			AD.storeOp			= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			AD.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			AD.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
+		}
 		return AD;
 	}
 
@@ -1492,6 +1242,131 @@ namespace geodesy::gpu {
 		return this->Context->get_image_memory_requirements(this->Handle);
 	}
 
+	image::layout image::current_layout(uint32_t aMipLevel, uint32_t aArrayLayer) {
+		if ((aMipLevel >= this->CreateInfo.mipLevels) || (aArrayLayer >= this->CreateInfo.arrayLayers)) return (layout)this->CreateInfo.initialLayout;
+		return (layout)this->subresource_state(aMipLevel, aArrayLayer).Layout;
+	}
+
+	void image::require(
+		barrier_batch& aBarrier,
+		layout aLayout, VkAccessFlags aAccess, VkPipelineStageFlags aStage,
+		uint32_t aMipLevel, uint32_t aMipLevelCount,
+		uint32_t aArrayLayerStart, uint32_t aArrayLayerCount
+	) {
+		if ((aMipLevel >= this->CreateInfo.mipLevels) || (aArrayLayerStart >= this->CreateInfo.arrayLayers)) return;
+		uint32_t MipEnd = aMipLevel + std::min(aMipLevelCount, this->CreateInfo.mipLevels - aMipLevel);
+		uint32_t LayerEnd = aArrayLayerStart + std::min(aArrayLayerCount, this->CreateInfo.arrayLayers - aArrayLayerStart);
+		auto same_transition = [](const VkImageMemoryBarrier& aLHS, const VkImageMemoryBarrier& aRHS) -> bool {
+			return (aLHS.image == aRHS.image) && (aLHS.oldLayout == aRHS.oldLayout) && (aLHS.newLayout == aRHS.newLayout) && (aLHS.srcAccessMask == aRHS.srcAccessMask) && (aLHS.dstAccessMask == aRHS.dstAccessMask);
+		};
+		// Barrier of the batch already covering a subresource, -1 if none.
+		auto pending = [&](uint32_t aMip, uint32_t aLayer) -> int {
+			for (size_t i = 0; i < aBarrier.ImageBarrier.size(); i++) {
+				const VkImageSubresourceRange& Range = aBarrier.ImageBarrier[i].subresourceRange;
+				if (aBarrier.ImageBarrier[i].image != this->Handle) continue;
+				if ((aMip >= Range.baseMipLevel) && (aMip < Range.baseMipLevel + Range.levelCount) && (aLayer >= Range.baseArrayLayer) && (aLayer < Range.baseArrayLayer + Range.layerCount)) return (int)i;
+			}
+			return -1;
+		};
+		for (uint32_t Layer = aArrayLayerStart; Layer < LayerEnd; Layer++) {
+			for (uint32_t Mip = aMipLevel; Mip < MipEnd; Mip++) {
+				barrier_batch::state& State = this->subresource_state(Mip, Layer);
+				barrier_batch::state Previous = State;
+				unsigned int OldLayout = State.Layout;
+				VkPipelineStageFlags SrcStage = 0;
+				VkAccessFlags SrcAccess = 0;
+				if (!barrier_batch::access(State, aLayout, aAccess, aStage, SrcStage, SrcAccess)) continue;
+
+				// A subresource transitions once per batch. Accesses required after an earlier one in the same batch
+				// join its barrier, which keeps the first old layout, and are unordered with it like any two
+				// accesses recorded after the batch.
+				int Pending = pending(Mip, Layer);
+				if (Pending >= 0) {
+					VkImageSubresourceRange Range = aBarrier.ImageBarrier[Pending].subresourceRange;
+					if ((aBarrier.ImageBarrier[Pending].newLayout != (VkImageLayout)aLayout) && ((Range.levelCount > 1) || (Range.layerCount > 1))) {
+						// Split into single subresources so only this one changes its new layout.
+						VkImageMemoryBarrier Covering = aBarrier.ImageBarrier[Pending];
+						aBarrier.ImageBarrier.erase(aBarrier.ImageBarrier.begin() + Pending);
+						for (uint32_t SplitLayer = Range.baseArrayLayer; SplitLayer < Range.baseArrayLayer + Range.layerCount; SplitLayer++) {
+							for (uint32_t SplitMip = Range.baseMipLevel; SplitMip < Range.baseMipLevel + Range.levelCount; SplitMip++) {
+								VkImageMemoryBarrier Single = Covering;
+								Single.subresourceRange.baseMipLevel 	= SplitMip;
+								Single.subresourceRange.levelCount 		= 1;
+								Single.subresourceRange.baseArrayLayer 	= SplitLayer;
+								Single.subresourceRange.layerCount 		= 1;
+								aBarrier.ImageBarrier.push_back(Single);
+							}
+						}
+						Pending = pending(Mip, Layer);
+					}
+					aBarrier.ImageBarrier[Pending].newLayout 		= (VkImageLayout)aLayout;
+					aBarrier.ImageBarrier[Pending].dstAccessMask 	|= aAccess;
+					aBarrier.DstStage |= aStage;
+					State.WriteStage 	|= Previous.WriteStage;
+					State.WriteAccess 	|= Previous.WriteAccess;
+					State.ReadStage 	|= Previous.ReadStage;
+					State.ReadAccess 	|= Previous.ReadAccess;
+					continue;
+				}
+
+				aBarrier.SrcStage |= SrcStage;
+				aBarrier.DstStage |= aStage;
+				VkImageMemoryBarrier Barrier = this->memory_barrier(SrcAccess, aAccess, OldLayout, aLayout, Mip, 1, Layer, 1);
+				// Neighbouring mip levels of a layer with the same transition share a barrier.
+				if ((aBarrier.ImageBarrier.size() > 0) && same_transition(aBarrier.ImageBarrier.back(), Barrier)) {
+					VkImageSubresourceRange& Range = aBarrier.ImageBarrier.back().subresourceRange;
+					if ((Range.baseArrayLayer == Layer) && (Range.layerCount == 1) && (Range.baseMipLevel + Range.levelCount == Mip)) {
+						Range.levelCount++;
+						continue;
+					}
+				}
+				aBarrier.ImageBarrier.push_back(Barrier);
+			}
+			// And so do neighbouring layers with the same mip range.
+			size_t Count = aBarrier.ImageBarrier.size();
+			if ((Count >= 2) && same_transition(aBarrier.ImageBarrier[Count - 2], aBarrier.ImageBarrier[Count - 1])) {
+				VkImageSubresourceRange& Previous = aBarrier.ImageBarrier[Count - 2].subresourceRange;
+				const VkImageSubresourceRange& Last = aBarrier.ImageBarrier[Count - 1].subresourceRange;
+				if ((Last.baseArrayLayer == Layer) && (Previous.baseMipLevel == Last.baseMipLevel) && (Previous.levelCount == Last.levelCount) && (Previous.baseArrayLayer + Previous.layerCount == Layer)) {
+					Previous.layerCount++;
+					aBarrier.ImageBarrier.pop_back();
+				}
+			}
+		}
+	}
+
+	void image::require(
+		command_buffer* aCommandBuffer,
+		layout aLayout, VkAccessFlags aAccess, VkPipelineStageFlags aStage,
+		uint32_t aMipLevel, uint32_t aMipLevelCount,
+		uint32_t aArrayLayerStart, uint32_t aArrayLayerCount
+	) {
+		barrier_batch Barrier;
+		this->require(Barrier, aLayout, aAccess, aStage, aMipLevel, aMipLevelCount, aArrayLayerStart, aArrayLayerCount);
+		Barrier.record(aCommandBuffer);
+	}
+
+	void image::track(
+		layout aLayout, VkAccessFlags aAccess, VkPipelineStageFlags aStage,
+		uint32_t aMipLevel, uint32_t aMipLevelCount,
+		uint32_t aArrayLayerStart, uint32_t aArrayLayerCount
+	) {
+		if ((aMipLevel >= this->CreateInfo.mipLevels) || (aArrayLayerStart >= this->CreateInfo.arrayLayers)) return;
+		uint32_t MipEnd = aMipLevel + std::min(aMipLevelCount, this->CreateInfo.mipLevels - aMipLevel);
+		uint32_t LayerEnd = aArrayLayerStart + std::min(aArrayLayerCount, this->CreateInfo.arrayLayers - aArrayLayerStart);
+		for (uint32_t Layer = aArrayLayerStart; Layer < LayerEnd; Layer++) {
+			for (uint32_t Mip = aMipLevel; Mip < MipEnd; Mip++) {
+				barrier_batch::track(this->subresource_state(Mip, Layer), aLayout, aAccess, aStage);
+			}
+		}
+	}
+
+	void image::reset_access() {
+		for (barrier_batch::state& State : this->State) {
+			State = barrier_batch::state(State.Layout);
+		}
+	}
+
 	bool image::has_alpha_channel() const {
 		switch (this->CreateInfo.format) {
 		case VK_FORMAT_R4G4B4A4_UNORM_PACK16:
@@ -1551,16 +1426,393 @@ namespace geodesy::gpu {
 		}
 	}
 
-	int image::transparency(int aChannelSelection) const {
+	// Counts the pixels of level 0 whose CHANNEL is opaque, transparent or in between. Prefixed with the version,
+	// the CHANNEL define and the OPAQUE_THRESHOLD and TRANSPARENT_THRESHOLD defines of pixel::coverage_float().
+	static const char* CoverageSource = R"(
+layout (local_size_x = 16, local_size_y = 16) in;
+
+layout (set = 0, binding = 0) uniform sampler2D Source;
+
+layout (set = 0, binding = 1) buffer coverage_buffer {
+	uint Count[3]; // Opaque, transparent, translucent
+} Coverage;
+
+shared uint GroupCount[3];
+
+void main() {
+	if (gl_LocalInvocationIndex < 3) {
+		GroupCount[gl_LocalInvocationIndex] = 0;
+	}
+	barrier();
+	ivec2 Texel = ivec2(gl_GlobalInvocationID.xy);
+	if (all(lessThan(Texel, textureSize(Source, 0)))) {
+		float Value = texelFetch(Source, Texel, 0)[CHANNEL];
+		uint Class = (Value >= OPAQUE_THRESHOLD) ? 0u : ((Value <= TRANSPARENT_THRESHOLD) ? 1u : 2u);
+		atomicAdd(GroupCount[Class], 1u);
+	}
+	barrier();
+	// One global atomic per class and work group.
+	if ((gl_LocalInvocationIndex < 3) && (GroupCount[gl_LocalInvocationIndex] > 0)) {
+		atomicAdd(Coverage.Count[gl_LocalInvocationIndex], GroupCount[gl_LocalInvocationIndex]);
+	}
+}
+)";
+
+	// Coverage of one component of tightly packed pixels, false for formats without a host kernel.
+	static bool host_coverage(int aFormat, const void* aData, size_t aCount, int aChannel, pixel::coverage& aCoverage) {
+		size_t Stride = image::channel_count(aFormat);
+		switch (aFormat) {
+		case VK_FORMAT_B8G8R8_UNORM:
+		case VK_FORMAT_B8G8R8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			// Red and blue are swapped in memory.
+			aChannel = (aChannel == 0) ? 2 : ((aChannel == 2) ? 0 : aChannel);
+			aCoverage = pixel::coverage_unorm8((const uint8_t*)aData + aChannel, aCount, Stride);
+			return true;
+		case VK_FORMAT_R8_UNORM:
+		case VK_FORMAT_R8_SRGB:
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_R8G8_SRGB:
+		case VK_FORMAT_R8G8B8_UNORM:
+		case VK_FORMAT_R8G8B8_SRGB:
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+		case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+			aCoverage = pixel::coverage_unorm8((const uint8_t*)aData + aChannel, aCount, Stride);
+			return true;
+		case VK_FORMAT_R16_UNORM:
+		case VK_FORMAT_R16G16_UNORM:
+		case VK_FORMAT_R16G16B16_UNORM:
+		case VK_FORMAT_R16G16B16A16_UNORM:
+			aCoverage = pixel::coverage_unorm16((const uint16_t*)aData + aChannel, aCount, Stride);
+			return true;
+		case VK_FORMAT_R16_SFLOAT:
+		case VK_FORMAT_R16G16_SFLOAT:
+		case VK_FORMAT_R16G16B16_SFLOAT:
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			aCoverage = pixel::coverage_half((const uint16_t*)aData + aChannel, aCount, Stride);
+			return true;
+		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_R32G32_SFLOAT:
+		case VK_FORMAT_R32G32B32_SFLOAT:
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			aCoverage = pixel::coverage_float((const float*)aData + aChannel, aCount, Stride);
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	int image::transparency(int aChannelSelection) {
 		int TransparencyType = -1; // 0 = Opaque, 1 = Transparent, 2 = Translucent
-		// Opaque - 0: All pixels are 1.0f
-		// Transparent - 1: At least one pixel is 0.0f
-		// Translucent - 2: x% of pixels are greater than 0.0f and less than 0.95f.
+		// Opaque - 0: All pixels are at or above pixel::OpaqueThreshold.
+		// Transparent - 1: Some pixels are not opaque, but few enough lie between the thresholds for alpha testing.
+		// Translucent - 2: More than GPU_IMAGE_TRANSLUCENT_FRACTION of pixels lie between the thresholds, needs blending.
 
 		// Check if Channel Selection is valid
 		if ((aChannelSelection < 0) || (aChannelSelection >= image::channel_count(this->CreateInfo.format))) return TransparencyType;
 
+		pixel::coverage Count = { 0, 0, 0 };
+		bool Counted = false;
+		if (this->HostData != NULL) {
+			size_t PixelCount = this->HostSize / std::max<size_t>(bytes_per_pixel(this->CreateInfo.format), 1);
+			if (!host_coverage(this->CreateInfo.format, this->HostData, PixelCount, aChannelSelection, Count)) return TransparencyType;
+			Counted = true;
+		}
+		else if ((this->Coverage.Result != nullptr) && (this->Coverage.Channel == aChannelSelection)) {
+			uint32_t Result[3] = { 0, 0, 0 };
+			if (this->Coverage.Result->read(0, Result, 0, sizeof(Result)) != VK_SUCCESS) return TransparencyType;
+			Count = { Result[0], Result[1], Result[2] };
+			this->Coverage = coverage_query();
+			Counted = true;
+		}
+
+		if (Counted) {
+			float TotalPixels = (float)(Count.Opaque + Count.Transparent + Count.Translucent);
+			if (TotalPixels == 0.0f) return TransparencyType;
+			this->OpaquePercentage 			= (float)Count.Opaque / TotalPixels;
+			this->TransparentPercentage 	= (float)Count.Transparent / TotalPixels;
+			this->TranslucentPercentage 	= (float)Count.Translucent / TotalPixels;
+			this->CoverageChannel 			= aChannelSelection;
+		}
+
+		// Device images without a new analysis keep the last one of the same channel.
+		if (this->CoverageChannel != aChannelSelection) return TransparencyType;
+
+		if (this->TranslucentPercentage > GPU_IMAGE_TRANSLUCENT_FRACTION) {
+			TransparencyType = 2;
+		}
+		else if ((this->TransparentPercentage > 0.0f) || (this->TranslucentPercentage > 0.0f)) {
+			TransparencyType = 1;
+		}
+		else {
+			TransparencyType = 0;
+		}
 		return TransparencyType;
 	}
 
+	VkResult image::analyze_transparency(command_buffer* aCommandBuffer, int aChannelSelection) {
+		PFN_vkGetPhysicalDeviceFormatProperties vkGetPhysicalDeviceFormatProperties = (PFN_vkGetPhysicalDeviceFormatProperties)this->Context->Instance->function_pointer("vkGetPhysicalDeviceFormatProperties");
+		if (vkGetPhysicalDeviceFormatProperties == NULL) return VK_ERROR_INITIALIZATION_FAILED;
+		if ((aChannelSelection < 0) || (aChannelSelection >= image::channel_count(this->CreateInfo.format))) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+		if ((this->CreateInfo.imageType != VK_IMAGE_TYPE_2D) || ((this->CreateInfo.usage & VK_IMAGE_USAGE_SAMPLED_BIT) == 0) || (this->View == VK_NULL_HANDLE)) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+		// Integer formats are never linearly filterable, and cannot be read as floats.
+		VkFormatProperties FormatProperties{};
+		vkGetPhysicalDeviceFormatProperties(this->Context->Device->Handle, this->CreateInfo.format, &FormatProperties);
+		VkFormatFeatureFlags Features = (this->CreateInfo.tiling == VK_IMAGE_TILING_LINEAR) ? FormatProperties.linearTilingFeatures : FormatProperties.optimalTilingFeatures;
+		if ((Features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) == 0) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+
+		// Thresholds are printed with enough digits to round trip, the device classifies exactly as the host does.
+		std::ostringstream Source;
+		Source.precision(9);
+		Source << "#version 450\n";
+		Source << "#define CHANNEL " << aChannelSelection << "\n";
+		Source << "#define OPAQUE_THRESHOLD " << std::showpoint << pixel::OpaqueThreshold << "\n";
+		Source << "#define TRANSPARENT_THRESHOLD " << pixel::TransparentThreshold << "\n";
+		Source << CoverageSource;
+		std::shared_ptr<pipeline> Pipeline = this->Context->create_compute_pipeline(Source.str());
+		if (Pipeline == nullptr) return VK_ERROR_INITIALIZATION_FAILED;
+		uint32_t Zero[3] = { 0, 0, 0 };
+		std::shared_ptr<buffer> Result = this->Context->create<buffer>(
+			device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT,
+			buffer::usage::STORAGE,
+			1, sizeof(Zero), Zero
+		);
+		std::shared_ptr<descriptor::array> Descriptor = this->Context->create<descriptor::array>(Pipeline);
+		if ((Result == nullptr) || (Descriptor == nullptr)) return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+
+		layout Layout = (this->current_layout() == GENERAL) ? GENERAL : SHADER_READ_ONLY_OPTIMAL;
+		Descriptor->bind(0, 0, 0, this->View, Layout);
+		Descriptor->bind(0, 1, 0, Result->Handle);
+
+		barrier_batch Barrier;
+		this->require(Barrier, Layout, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		Result->require(Barrier, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		Barrier.record(aCommandBuffer);
+		Pipeline->dispatch(aCommandBuffer, { (this->CreateInfo.extent.width + 15) / 16, (this->CreateInfo.extent.height + 15) / 16, 1 }, Descriptor);
+		// Counts are read by the host once the submission completes.
+		Result->require(aCommandBuffer, VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+
+		this->Coverage.Channel 		= aChannelSelection;
+		this->Coverage.Result 		= Result;
+		this->Coverage.Resource 	= { Pipeline, Descriptor };
+		return VK_SUCCESS;
+	}
+
+	void image::create_handle(std::shared_ptr<context> aContext, create_info& aCreateInfo, format aFormat, unsigned int aX, unsigned int aY, unsigned int aZ, unsigned int aT) {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkCreateImage vkCreateImage = (PFN_vkCreateImage)aContext->function_pointer("vkCreateImage");
+
+		// Image Handle Info
+		this->Context								= aContext;
+
+		if (aCreateInfo.Transient) {
+			// Contents never leave the render pass, only attachment usage may accompany TRANSIENT_ATTACHMENT.
+			aCreateInfo.Usage 						= (aCreateInfo.Usage & (usage::COLOR_ATTACHMENT | usage::DEPTH_STENCIL_ATTACHMENT | usage::INPUT_ATTACHMENT)) | usage::TRANSIENT_ATTACHMENT;
+			aCreateInfo.MipLevels 					= false;
+		}
+
+		this->CreateInfo.sType						= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		this->CreateInfo.pNext						= NULL;
+		this->CreateInfo.flags						= 0;
+		if ((aY == 1) && (aZ == 1)) {
+			// 1D Image
+			this->CreateInfo.imageType 					= VK_IMAGE_TYPE_1D;
+		} else if (aZ == 1) {
+			// 2D Image
+			this->CreateInfo.imageType 					= VK_IMAGE_TYPE_2D;
+		} else {
+			// 3D Image
+			this->CreateInfo.imageType 					= VK_IMAGE_TYPE_3D;
+		}
+		this->CreateInfo.format						= (VkFormat)aFormat;
+		this->CreateInfo.extent						= { aX, aY, aZ };
+		if (aCreateInfo.MipLevels || (aCreateInfo.MipLevelCount > 0)) {
+			this->CreateInfo.mipLevels					= std::floor(std::log2(std::max(std::max(aX, aY), aZ))) + 1;
+			if (aCreateInfo.MipLevelCount > 0) {
+				this->CreateInfo.mipLevels 					= std::min(this->CreateInfo.mipLevels, aCreateInfo.MipLevelCount);
+			}
+		}
+		else {
+			this->CreateInfo.mipLevels					= 1;
+		}
+		this->CreateInfo.arrayLayers				= aT;
+		this->CreateInfo.samples					= (VkSampleCountFlagBits)aCreateInfo.Sample;
+		this->CreateInfo.tiling						= (VkImageTiling)aCreateInfo.Tiling;
+		this->CreateInfo.usage						= (VkImageUsageFlags)aCreateInfo.Usage;
+		this->CreateInfo.sharingMode				= VK_SHARING_MODE_EXCLUSIVE;
+		this->CreateInfo.queueFamilyIndexCount		= 0;
+		this->CreateInfo.pQueueFamilyIndices		= NULL;
+		this->CreateInfo.initialLayout				= VK_IMAGE_LAYOUT_UNDEFINED;
+
+		Result = vkCreateImage(aContext->Handle, &CreateInfo, NULL, &this->Handle);
+		if (Result != VK_SUCCESS) {
+			// TODO: Error handling
+			throw std::runtime_error("Failed to create image.");
+		}
+
+		this->MemoryType = aCreateInfo.Memory;
+		if (aCreateInfo.Transient && (this->Context->Device->get_memory_type_index(this->memory_requirements(), this->MemoryType | device::memory::LAZILY_ALLOCATED) >= 0)) {
+			// Tile based GPUs back these with tile memory only.
+			this->MemoryType |= device::memory::LAZILY_ALLOCATED;
+		}
+	}
+
+	VkResult image::upload(std::shared_ptr<context> aContext, const std::vector<image*>& aImage, const std::vector<void*>& aData, const std::vector<layout>& aFinalLayout, size_t aStagingSize) {
+		VkResult Result = VK_SUCCESS;
+		std::shared_ptr<command_pool> CommandPool = nullptr;
+		std::vector<VkBufferImageCopy> Region(aImage.size());
+		for (size_t Begin = 0, End = 0; Begin < aImage.size(); Begin = End) {
+			// Images are taken in order until their data no longer fits in aStagingSize, at least one per submission.
+			size_t StagingSize = 0;
+			bool Pending = false;
+			for (End = Begin; End < aImage.size(); End++) {
+				image* Image = aImage[End];
+				if (aData[End] != NULL) {
+					VkBufferImageCopy Copy{};
+					Copy.imageSubresource 	= { aspect_flag(Image->CreateInfo.format), 0, 0, Image->CreateInfo.arrayLayers };
+					Copy.imageExtent 		= Image->CreateInfo.extent;
+					size_t Alignment = std::lcm(std::max<size_t>(block_size(Image->CreateInfo.format), 1), (size_t)4);
+					size_t Offset = ((StagingSize + Alignment - 1) / Alignment) * Alignment;
+					size_t Size = Image->region_size(Copy);
+					if ((End > Begin) && (Offset + Size > aStagingSize)) break;
+					Copy.bufferOffset 		= Offset;
+					Region[End] 			= Copy;
+					StagingSize 			= Offset + Size;
+				}
+				Pending |= (aData[End] != NULL) || (aFinalLayout[End] != LAYOUT_UNDEFINED);
+			}
+			if (!Pending) continue;
+
+			std::shared_ptr<buffer> StagingBuffer = nullptr;
+			if (StagingSize > 0) {
+				StagingBuffer = geodesy::make<buffer>(
+					aContext,
+					device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT,
+					buffer::TRANSFER_SRC,
+					StagingSize
+				);
+				if (StagingBuffer == nullptr) return VK_ERROR_OUT_OF_HOST_MEMORY;
+				uint8_t* StagingData = (uint8_t*)StagingBuffer->map_memory(0, StagingSize);
+				if (StagingData == NULL) return VK_ERROR_MEMORY_MAP_FAILED;
+				for (size_t i = Begin; i < End; i++) {
+					if (aData[i] == NULL) continue;
+					memcpy(StagingData + Region[i].bufferOffset, aData[i], aImage[i]->region_size(Region[i]));
+				}
+				StagingBuffer->unmap_memory();
+			}
+
+			if (CommandPool == nullptr) {
+				CommandPool = aContext->create<command_pool>(device::operation::GRAPHICS, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+				if (CommandPool == nullptr) return VK_ERROR_INITIALIZATION_FAILED;
+			}
+			std::shared_ptr<command_buffer> CommandBuffer = CommandPool->create<command_buffer>();
+			if (CommandBuffer == nullptr) return VK_ERROR_OUT_OF_HOST_MEMORY;
+			Result = CommandBuffer->begin();
+			if (Result != VK_SUCCESS) return Result;
+
+			// Every level is written, by the copy or by a blit.
+			barrier_batch Barrier;
+			uint32_t LevelCount = 1;
+			for (size_t i = Begin; i < End; i++) {
+				if (aData[i] == NULL) continue;
+				aImage[i]->require(Barrier, TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+				LevelCount = std::max(LevelCount, aImage[i]->CreateInfo.mipLevels);
+			}
+			Barrier.record(CommandBuffer.get());
+			for (size_t i = Begin; i < End; i++) {
+				if (aData[i] == NULL) continue;
+				aImage[i]->copy(CommandBuffer.get(), StagingBuffer, { Region[i] });
+			}
+
+			// Mip chains advance one level at a time across every image, one barrier per level. Block
+			// compressed images cannot be blit targets, their levels must come precomputed (see ktx2).
+			auto Blits = [&](size_t i, uint32_t Level) -> bool {
+				if ((aData[i] == NULL) || (Level + 1 >= aImage[i]->CreateInfo.mipLevels)) return false;
+				VkExtent2D Block = block_extent(aImage[i]->CreateInfo.format);
+				return (Block.width == 1) && (Block.height == 1);
+			};
+			for (uint32_t Level = 0; Level + 1 < LevelCount; Level++) {
+				for (size_t i = Begin; i < End; i++) {
+					if (!Blits(i, Level)) continue;
+					aImage[i]->require(Barrier, TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Level, 1);
+					aImage[i]->require(Barrier, TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Level + 1, 1);
+				}
+				Barrier.record(CommandBuffer.get());
+				for (size_t i = Begin; i < End; i++) {
+					if (!Blits(i, Level)) continue;
+					aImage[i]->blit_level(CommandBuffer.get(), Level, VK_FILTER_LINEAR);
+				}
+			}
+
+			for (size_t i = Begin; i < End; i++) {
+				if (aFinalLayout[i] == LAYOUT_UNDEFINED) continue;
+				aImage[i]->require(Barrier, aFinalLayout[i], 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			}
+			Barrier.record(CommandBuffer.get());
+
+			// Alpha coverage is counted in the same submission and read back as soon as it completes.
+			for (size_t i = Begin; i < End; i++) {
+				if ((aData[i] == NULL) || (aFinalLayout[i] != SHADER_READ_ONLY_OPTIMAL) || !aImage[i]->has_alpha_channel()) continue;
+				aImage[i]->analyze_transparency(CommandBuffer.get(), 3);
+			}
+			Result = CommandBuffer->end();
+			if (Result != VK_SUCCESS) return Result;
+
+			Result = aContext->execute_and_wait(device::operation::GRAPHICS, CommandBuffer);
+			for (size_t i = Begin; i < End; i++) {
+				aImage[i]->reset_access();
+				// Caches the percentages, then drops the result buffer and the dispatch resources of the reduction.
+				if ((Result == VK_SUCCESS) && (aImage[i]->Coverage.Result != nullptr)) {
+					aImage[i]->transparency(aImage[i]->Coverage.Channel);
+				}
+				aImage[i]->Coverage = coverage_query();
+			}
+			if (Result != VK_SUCCESS) return Result;
+		}
+		return Result;
+	}
+
+	void image::blit_level(command_buffer* aCommandBuffer, uint32_t aMipLevel, VkFilter aFilter) {
+		PFN_vkCmdBlitImage vkCmdBlitImage = (PFN_vkCmdBlitImage)this->Context->function_pointer("vkCmdBlitImage");
+		VkOffset3D d = { (int32_t)this->CreateInfo.extent.width, (int32_t)this->CreateInfo.extent.height, (int32_t)this->CreateInfo.extent.depth };
+		uint32_t i = aMipLevel;
+		VkImageBlit IBO{};
+
+		// Image Blitting Source Level
+		IBO.srcSubresource.aspectMask = aspect_flag(this->CreateInfo.format);
+		IBO.srcSubresource.mipLevel = i;
+		IBO.srcSubresource.baseArrayLayer = 0;
+		IBO.srcSubresource.layerCount = this->CreateInfo.arrayLayers;
+		IBO.srcOffsets[0] = { 0, 0, 0 };
+		IBO.srcOffsets[1] = { (d.x >> i) ? d.x >> i : 1, (d.y >> i) ? d.y >> i : 1, (d.z >> i) ? d.z >> i : 1 };
+
+		// Image Blitting Destination Level
+		IBO.dstSubresource.aspectMask = aspect_flag(this->CreateInfo.format);
+		IBO.dstSubresource.mipLevel = i + 1;
+		IBO.dstSubresource.baseArrayLayer = 0;
+		IBO.dstSubresource.layerCount = this->CreateInfo.arrayLayers;
+		IBO.dstOffsets[0] = { 0, 0, 0 };
+		IBO.dstOffsets[1] = { (d.x >> (i + 1)) ? d.x >> (i + 1) : 1, (d.y >> (i + 1)) ? d.y >> (i + 1) : 1, (d.z >> (i + 1)) ? d.z >> (i + 1) : 1 };
+
+		vkCmdBlitImage(
+			aCommandBuffer->Handle,
+			this->Handle, (VkImageLayout)layout::TRANSFER_SRC_OPTIMAL,
+			this->Handle, (VkImageLayout)layout::TRANSFER_DST_OPTIMAL,
+			1, &IBO,
+			aFilter
+		);
+	}
+
+	barrier_batch::state& image::subresource_state(uint32_t aMipLevel, uint32_t aArrayLayer) {
+		// Sized on first use, images start out in their initial layout.
+		size_t Count = (size_t)this->CreateInfo.mipLevels * this->CreateInfo.arrayLayers;
+		if (this->State.size() != Count) {
+			this->State.assign(Count, barrier_batch::state(this->CreateInfo.initialLayout));
+		}
+		return this->State[(size_t)aArrayLayer * this->CreateInfo.mipLevels + aMipLevel];
+	}
+
 }
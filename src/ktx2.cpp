@@ -0,0 +1,255 @@
+#include <geodesy/gpu/ktx2.h>
+
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+
+#include <geodesy/gpu/pixel.h>
+#include <geodesy/gpu/command_pool.h>
+#include <geodesy/gpu/context.h>
+#include <geodesy/gpu/instance.h>
+
+#ifdef GEODESY_GPU_USE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace geodesy::gpu {
+
+	// File identifier, «KTX 20»\r\n\x1A\n.
+	static const uint8_t KTX2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	// Header and index that follow the identifier, all little endian.
+	struct ktx2_header {
+		uint32_t 		vkFormat;
+		uint32_t 		typeSize;
+		uint32_t 		pixelWidth;
+		uint32_t 		pixelHeight;
+		uint32_t 		pixelDepth;
+		uint32_t 		layerCount;
+		uint32_t 		faceCount;
+		uint32_t 		levelCount;
+		uint32_t 		supercompressionScheme;
+		uint32_t 		dfdByteOffset;
+		uint32_t 		dfdByteLength;
+		uint32_t 		kvdByteOffset;
+		uint32_t 		kvdByteLength;
+		uint64_t 		sgdByteOffset;
+		uint64_t 		sgdByteLength;
+	};
+
+	ktx2::ktx2(std::string aPath, uint32_t aMaxArrayLayers) {
+		this->Path = aPath;
+		this->File.open(aPath, std::ios::binary);
+		if (!this->File.is_open()) {
+			throw std::runtime_error("Failed to open KTX2 file: " + aPath);
+		}
+
+		uint8_t Identifier[sizeof(KTX2Identifier)];
+		ktx2_header Header{};
+		this->File.read((char*)Identifier, sizeof(Identifier));
+		// Read field by field, the 64 bit fields make the struct padding compiler dependent.
+		uint32_t Field[13];
+		this->File.read((char*)Field, sizeof(Field));
+		this->File.read((char*)&Header.sgdByteOffset, sizeof(uint64_t));
+		this->File.read((char*)&Header.sgdByteLength, sizeof(uint64_t));
+		if (!this->File || (std::memcmp(Identifier, KTX2Identifier, sizeof(KTX2Identifier)) != 0)) {
+			throw std::runtime_error("Not a KTX2 file: " + aPath);
+		}
+		std::memcpy(&Header, Field, sizeof(Field));
+
+		// Zero means the dimension is not used, a level count of zero asks the loader to generate the chain.
+		this->Format 			= (image::format)Header.vkFormat;
+		this->Width 			= std::max(Header.pixelWidth, 1u);
+		this->Height 			= std::max(Header.pixelHeight, 1u);
+		this->Depth 			= std::max(Header.pixelDepth, 1u);
+		this->LayerCount 		= std::max(Header.layerCount, 1u);
+		this->FaceCount 		= Header.faceCount;
+		this->LevelCount 		= std::max(Header.levelCount, 1u);
+		this->GenerateMipmaps 	= (Header.levelCount == 0);
+		this->Supercompression 	= (supercompression)Header.supercompressionScheme;
+
+		// The counts size the level index and the image, they are checked before either is allocated.
+		uint32_t MaxLevelCount = (uint32_t)std::floor(std::log2(std::max(std::max(this->Width, this->Height), this->Depth))) + 1;
+		if (this->LevelCount > MaxLevelCount) {
+			throw std::runtime_error("KTX2 level count exceeds the full mip chain: " + aPath);
+		}
+		if ((this->FaceCount != 1) && (this->FaceCount != 6)) {
+			throw std::runtime_error("KTX2 face count must be 1 or 6: " + aPath);
+		}
+		if ((this->FaceCount == 6) && ((this->Width != this->Height) || (this->Depth != 1))) {
+			throw std::runtime_error("KTX2 cube map faces must be square and 2D: " + aPath);
+		}
+		if ((uint64_t)this->LayerCount * this->FaceCount > aMaxArrayLayers) {
+			throw std::runtime_error("KTX2 layer count exceeds the array layer limit: " + aPath);
+		}
+
+		this->Level = std::vector<level>(this->LevelCount);
+		for (uint32_t i = 0; i < this->LevelCount; i++) {
+			this->File.read((char*)&this->Level[i].ByteOffset, sizeof(uint64_t));
+			this->File.read((char*)&this->Level[i].ByteLength, sizeof(uint64_t));
+			this->File.read((char*)&this->Level[i].UncompressedByteLength, sizeof(uint64_t));
+		}
+		if (!this->File) {
+			throw std::runtime_error("Truncated KTX2 level index: " + aPath);
+		}
+	}
+
+	size_t ktx2::level_size(uint32_t aLevel) const {
+		pixel::format_traits Traits = pixel::traits(this->Format);
+		size_t LevelWidth 	= std::max(this->Width >> aLevel, 1u);
+		size_t LevelHeight 	= std::max(this->Height >> aLevel, 1u);
+		size_t LevelDepth 	= std::max(this->Depth >> aLevel, 1u);
+		size_t Columns 		= (LevelWidth + Traits.BlockWidth - 1) / Traits.BlockWidth;
+		size_t Rows 		= (LevelHeight + Traits.BlockHeight - 1) / Traits.BlockHeight;
+		return Columns * Rows * LevelDepth * Traits.BlockSize * this->LayerCount * this->FaceCount;
+	}
+
+	VkResult ktx2::read_level(uint32_t aLevel, void* aData) {
+		if (aLevel >= this->LevelCount) return VK_ERROR_UNKNOWN;
+		const level& Level = this->Level[aLevel];
+		size_t Size = this->level_size(aLevel);
+
+		switch (this->Supercompression) {
+		case NONE:
+			if (Level.ByteLength != Size) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+			this->File.clear();
+			this->File.seekg(Level.ByteOffset);
+			this->File.read((char*)aData, Size);
+			return this->File ? VK_SUCCESS : VK_ERROR_UNKNOWN;
+#ifdef GEODESY_GPU_USE_ZSTD
+		case ZSTANDARD: {
+			if (Level.UncompressedByteLength != Size) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+			std::vector<uint8_t> Compressed(Level.ByteLength);
+			this->File.clear();
+			this->File.seekg(Level.ByteOffset);
+			this->File.read((char*)Compressed.data(), Compressed.size());
+			if (!this->File) return VK_ERROR_UNKNOWN;
+			size_t Written = ZSTD_decompress(aData, Size, Compressed.data(), Compressed.size());
+			return (!ZSTD_isError(Written) && (Written == Size)) ? VK_SUCCESS : VK_ERROR_UNKNOWN;
+		}
+#endif
+		default:
+			return VK_ERROR_FORMAT_NOT_SUPPORTED;
+		}
+	}
+
+	VkResult ktx2::create_image(std::shared_ptr<context> aContext, image::create_info aCreateInfo, std::shared_ptr<image>& aImage, size_t aStagingSize) {
+		VkResult Result = VK_SUCCESS;
+		aImage = nullptr;
+
+		// Formats left undefined by the file need transcoding first (UASTC, ETC1S).
+		if (this->Format == image::format::FORMAT_UNDEFINED) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+#ifdef GEODESY_GPU_USE_ZSTD
+		if ((this->Supercompression != NONE) && (this->Supercompression != ZSTANDARD)) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+#else
+		if (this->Supercompression != NONE) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+#endif
+
+		if ((uint64_t)this->LayerCount * this->FaceCount > aContext->Device->Properties.limits.maxImageArrayLayers) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+
+		// Files without levels get the chain blitted from level 0, if the format can be filtered and blit.
+		bool Generate = false;
+		if (this->GenerateMipmaps) {
+			PFN_vkGetPhysicalDeviceFormatProperties vkGetPhysicalDeviceFormatProperties = (PFN_vkGetPhysicalDeviceFormatProperties)aContext->Instance->function_pointer("vkGetPhysicalDeviceFormatProperties");
+			VkFormatProperties FormatProperties{};
+			if (vkGetPhysicalDeviceFormatProperties != NULL) {
+				vkGetPhysicalDeviceFormatProperties(aContext->Device->Handle, (VkFormat)this->Format, &FormatProperties);
+			}
+			VkFormatFeatureFlags Required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+			VkExtent2D Block = image::block_extent(this->Format);
+			Generate = ((FormatProperties.optimalTilingFeatures & Required) == Required) && (Block.width == 1) && (Block.height == 1);
+		}
+
+		// Created without data and left undefined, every level is written below.
+		image::create_info CreateInfo = aCreateInfo;
+		CreateInfo.Layout 			= image::LAYOUT_UNDEFINED;
+		CreateInfo.Usage 			|= image::usage::TRANSFER_DST | image::usage::SAMPLED;
+		CreateInfo.MipLevels 		= Generate;
+		CreateInfo.MipLevelCount 	= Generate ? 0 : this->LevelCount;
+		CreateInfo.Transient 		= false;
+		if (Generate) {
+			CreateInfo.Usage 			|= image::usage::TRANSFER_SRC;
+		}
+		std::shared_ptr<image> Image = aContext->create<image>(CreateInfo, this->Format, this->Width, this->Height, this->Depth, this->LayerCount * this->FaceCount);
+		if (Image == nullptr) return VK_ERROR_INITIALIZATION_FAILED;
+		// Levels read from the file, generated levels follow them.
+		uint32_t LevelCount = std::min(this->LevelCount, Image->CreateInfo.mipLevels);
+
+		// Offsets must be multiples of the texel block size and of 4.
+		size_t Alignment = std::lcm(std::max<size_t>(image::block_size(this->Format), 1), (size_t)4);
+		std::vector<size_t> Offset(LevelCount);
+		size_t TotalSize = 0;
+		for (uint32_t i = 0; i < LevelCount; i++) {
+			TotalSize = ((TotalSize + Alignment - 1) / Alignment) * Alignment + this->level_size(i);
+		}
+
+		std::shared_ptr<command_pool> CommandPool = aContext->create<command_pool>(device::operation::GRAPHICS, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		if (CommandPool == nullptr) return VK_ERROR_INITIALIZATION_FAILED;
+
+		std::shared_ptr<buffer> StagingBuffer = nullptr;
+		size_t StagingCapacity = std::min(aStagingSize, TotalSize);
+		for (uint32_t Begin = 0, End = 0; Begin < LevelCount; Begin = End) {
+			// Levels are taken in order until they no longer fit in the staging buffer, at least one per submission.
+			size_t StagingSize = 0;
+			for (End = Begin; End < LevelCount; End++) {
+				size_t LevelOffset = ((StagingSize + Alignment - 1) / Alignment) * Alignment;
+				size_t LevelSize = this->level_size(End);
+				if ((End > Begin) && (LevelOffset + LevelSize > StagingCapacity)) break;
+				Offset[End] = LevelOffset;
+				StagingSize = LevelOffset + LevelSize;
+			}
+
+			// The shared staging buffer is reused once the previous submission has completed.
+			std::shared_ptr<buffer> Staging = StagingBuffer;
+			if (StagingSize > StagingCapacity) {
+				Staging = geodesy::make<buffer>(aContext, device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT, buffer::TRANSFER_SRC, StagingSize);
+			}
+			else if (StagingBuffer == nullptr) {
+				StagingBuffer = geodesy::make<buffer>(aContext, device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT, buffer::TRANSFER_SRC, StagingCapacity);
+				Staging = StagingBuffer;
+			}
+			if (Staging == nullptr) return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+
+			// Level data goes from the file straight into mapped staging memory.
+			uint8_t* StagingData = (uint8_t*)Staging->map_memory(0, StagingSize);
+			if (StagingData == NULL) return VK_ERROR_MEMORY_MAP_FAILED;
+			std::vector<VkBufferImageCopy> Region;
+			for (uint32_t i = Begin; i < End; i++) {
+				Result = this->read_level(i, StagingData + Offset[i]);
+				if (Result != VK_SUCCESS) break;
+				// Layers and faces are consecutive in the file, as array layers are in a copy.
+				VkBufferImageCopy Copy{};
+				Copy.bufferOffset 		= Offset[i];
+				Copy.imageSubresource 	= { image::aspect_flag(this->Format), i, 0, this->LayerCount * this->FaceCount };
+				Copy.imageExtent 		= { std::max(this->Width >> i, 1u), std::max(this->Height >> i, 1u), std::max(this->Depth >> i, 1u) };
+				Region.push_back(Copy);
+			}
+			Staging->unmap_memory();
+			if (Result != VK_SUCCESS) return Result;
+
+			std::shared_ptr<command_buffer> CommandBuffer = CommandPool->create<command_buffer>();
+			if (CommandBuffer == nullptr) return VK_ERROR_OUT_OF_HOST_MEMORY;
+			Result = CommandBuffer->begin();
+			if (Result != VK_SUCCESS) return Result;
+			Image->require(CommandBuffer.get(), image::TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Begin, End - Begin);
+			Image->copy(CommandBuffer.get(), Staging, Region);
+			if ((End == LevelCount) && Generate) {
+				Image->generate_mipmaps(CommandBuffer.get(), image::SHADER_READ_ONLY_OPTIMAL, VK_FILTER_LINEAR);
+			}
+			else if (End == LevelCount) {
+				Image->require(CommandBuffer.get(), image::SHADER_READ_ONLY_OPTIMAL, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			}
+			Result = CommandBuffer->end();
+			if (Result != VK_SUCCESS) return Result;
+
+			Result = aContext->execute_and_wait(device::operation::GRAPHICS, CommandBuffer);
+			Image->reset_access();
+			if (Result != VK_SUCCESS) return Result;
+		}
+
+		aImage = Image;
+		return Result;
+	}
+
+}
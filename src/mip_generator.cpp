@@ -0,0 +1,372 @@
+#include <geodesy/gpu/mip_generator.h>
+#include <geodesy/gpu/context.h>
+#include <geodesy/gpu/instance.h>
+
+#include <algorithm>
+
+namespace geodesy::gpu {
+
+	// Single pass reduction of up to twelve levels. Prefixed with the version, FORMAT and REDUCTION defines.
+	// Odd sized levels drop their last row or column, like every 2x2 reduction.
+	static const char* DownsampleSource = R"(
+layout (local_size_x = 256) in;
+
+layout (set = 0, binding = 0) uniform parameter {
+	uvec4 Value; // Base level width, height, level count, work groups per layer
+} Parameter;
+
+layout (set = 0, binding = 1, FORMAT) uniform readonly image2DArray Source;
+layout (set = 0, binding = 2, FORMAT) uniform coherent image2DArray Destination[12];
+
+layout (set = 0, binding = 3) coherent buffer counter_buffer {
+	uint Counter[];
+};
+
+shared vec4 Tile[16][16];
+shared uint Ticket;
+
+vec4 reduce(vec4 aA, vec4 aB, vec4 aC, vec4 aD) {
+#if REDUCTION == 2
+	return min(min(aA, aB), min(aC, aD));
+#elif REDUCTION == 3
+	return max(max(aA, aB), max(aC, aD));
+#else
+	return (aA + aB + aC + aD) * 0.25;
+#endif
+}
+
+// Levels are relative to the base level of the dispatch.
+ivec2 level_size(int aLevel) {
+	return max(ivec2(Parameter.Value.xy) >> aLevel, ivec2(1));
+}
+
+// Only the base level and level 6 are ever read back from memory.
+vec4 load(int aLevel, ivec2 aTexel, int aLayer) {
+	ivec3 Texel = ivec3(min(aTexel, level_size(aLevel) - 1), aLayer);
+	return (aLevel == 0) ? imageLoad(Source, Texel) : imageLoad(Destination[5], Texel);
+}
+
+// Constant indices, dynamically indexing storage image arrays is an optional feature.
+#define STORE(i) case i + 1: imageStore(Destination[i], Texel, aValue); break;
+
+void store(int aLevel, ivec2 aTexel, int aLayer, vec4 aValue) {
+	if ((aLevel > int(Parameter.Value.z)) || any(greaterThanEqual(aTexel, level_size(aLevel)))) return;
+	ivec3 Texel = ivec3(aTexel, aLayer);
+	switch (aLevel) {
+	STORE(0) STORE(1) STORE(2) STORE(3) STORE(4) STORE(5)
+	STORE(6) STORE(7) STORE(8) STORE(9) STORE(10) STORE(11)
+	}
+}
+
+// Reduces the 64x64 tile aGroup of level aBase into the six levels below it.
+void downsample(int aBase, ivec2 aGroup, int aLayer) {
+	ivec2 Thread = ivec2(gl_LocalInvocationIndex % 16, gl_LocalInvocationIndex / 16);
+	// Every thread reduces a 2x2 quad of the first level straight from memory.
+	vec4 Quad[4];
+	for (int i = 0; i < 4; i++) {
+		ivec2 Texel = aGroup * 32 + Thread * 2 + ivec2(i & 1, i >> 1);
+		ivec2 Footprint = Texel * 2;
+		Quad[i] = reduce(
+			load(aBase, Footprint, aLayer), load(aBase, Footprint + ivec2(1, 0), aLayer),
+			load(aBase, Footprint + ivec2(0, 1), aLayer), load(aBase, Footprint + ivec2(1, 1), aLayer)
+		);
+		store(aBase + 1, Texel, aLayer, Quad[i]);
+	}
+	if (int(Parameter.Value.z) < aBase + 2) return;
+	vec4 Value = reduce(Quad[0], Quad[1], Quad[2], Quad[3]);
+	store(aBase + 2, aGroup * 16 + Thread, aLayer, Value);
+	Tile[Thread.y][Thread.x] = Value;
+	// The rest of the tile never leaves shared memory, 8x8 down to 1x1.
+	for (int Level = aBase + 3, Width = 8; (Level <= aBase + 6) && (Level <= int(Parameter.Value.z)); Level++, Width /= 2) {
+		barrier();
+		bool Active = all(lessThan(Thread, ivec2(Width)));
+		if (Active) {
+			ivec2 p = Thread * 2;
+			Value = reduce(Tile[p.y][p.x], Tile[p.y][p.x + 1], Tile[p.y + 1][p.x], Tile[p.y + 1][p.x + 1]);
+		}
+		barrier();
+		if (Active) {
+			Tile[Thread.y][Thread.x] = Value;
+			store(Level, aGroup * Width + Thread, aLayer, Value);
+		}
+	}
+}
+
+void main() {
+	int Layer = int(gl_WorkGroupID.z);
+	downsample(0, ivec2(gl_WorkGroupID.xy), Layer);
+	if (Parameter.Value.z <= 6) return;
+
+	// Level 6 holds one texel per work group, the last one of the layer to finish reduces it further.
+	memoryBarrierImage();
+	barrier();
+	if (gl_LocalInvocationIndex == 0) {
+		Ticket = atomicAdd(Counter[Layer], 1);
+	}
+	barrier();
+	if (Ticket != Parameter.Value.w - 1) return;
+	// Ready for the next dispatch.
+	if (gl_LocalInvocationIndex == 0) {
+		Counter[Layer] = 0;
+	}
+	downsample(6, ivec2(0), Layer);
+}
+)";
+
+	// One level of a Kaiser windowed sinc (alpha = 4) reduction, separable taps at -1.5, -0.5, 0.5 and
+	// 1.5 source texels. Prefixed with the version and FORMAT define.
+	static const char* KaiserSource = R"(
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (set = 0, binding = 0, FORMAT) uniform readonly image2DArray Source;
+layout (set = 0, binding = 1, FORMAT) uniform writeonly image2DArray Destination;
+
+const float Weight[4] = float[4](0.0540271, 0.4459729, 0.4459729, 0.0540271);
+
+void main() {
+	ivec3 p = ivec3(gl_GlobalInvocationID);
+	if (any(greaterThanEqual(p.xy, imageSize(Destination).xy))) return;
+	ivec2 SourceSize = imageSize(Source).xy;
+	vec4 Value = vec4(0.0);
+	for (int y = 0; y < 4; y++) {
+		for (int x = 0; x < 4; x++) {
+			ivec2 Texel = clamp(p.xy * 2 + ivec2(x, y) - 1, ivec2(0), SourceSize - 1);
+			Value += (Weight[x] * Weight[y]) * imageLoad(Source, ivec3(Texel, p.z));
+		}
+	}
+	imageStore(Destination, p, Value);
+}
+)";
+
+	// GLSL storage image format qualifier, NULL if the shaders cannot reduce the format.
+	static const char* storage_format(VkFormat aFormat) {
+		switch (aFormat) {
+		case VK_FORMAT_R8_UNORM: 					return "r8";
+		case VK_FORMAT_R8_SNORM: 					return "r8_snorm";
+		case VK_FORMAT_R8G8_UNORM: 					return "rg8";
+		case VK_FORMAT_R8G8_SNORM: 					return "rg8_snorm";
+		case VK_FORMAT_R8G8B8A8_UNORM: 				return "rgba8";
+		case VK_FORMAT_R8G8B8A8_SNORM: 				return "rgba8_snorm";
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32: 	return "rgb10_a2";
+		case VK_FORMAT_B10G11R11_UFLOAT_PACK32: 	return "r11f_g11f_b10f";
+		case VK_FORMAT_R16_UNORM: 					return "r16";
+		case VK_FORMAT_R16_SNORM: 					return "r16_snorm";
+		case VK_FORMAT_R16_SFLOAT: 					return "r16f";
+		case VK_FORMAT_R16G16_UNORM: 				return "rg16";
+		case VK_FORMAT_R16G16_SNORM: 				return "rg16_snorm";
+		case VK_FORMAT_R16G16_SFLOAT: 				return "rg16f";
+		case VK_FORMAT_R16G16B16A16_UNORM: 			return "rgba16";
+		case VK_FORMAT_R16G16B16A16_SNORM: 			return "rgba16_snorm";
+		case VK_FORMAT_R16G16B16A16_SFLOAT: 		return "rgba16f";
+		case VK_FORMAT_R32_SFLOAT: 					return "r32f";
+		case VK_FORMAT_R32G32_SFLOAT: 				return "rg32f";
+		case VK_FORMAT_R32G32B32A32_SFLOAT: 		return "rgba32f";
+		default: 									return NULL;
+		}
+	}
+
+	// Views one level of every layer, 2D views cannot hold more than one layer.
+	static VkImageView level_view(std::shared_ptr<context> aContext, std::shared_ptr<image> aImage, uint32_t aMipLevel) {
+		PFN_vkCreateImageView vkCreateImageView = (PFN_vkCreateImageView)aContext->function_pointer("vkCreateImageView");
+		VkImageViewCreateInfo IVCI{};
+		VkImageView IV = VK_NULL_HANDLE;
+		IVCI.sType								= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		IVCI.pNext								= NULL;
+		IVCI.flags								= 0;
+		IVCI.image								= aImage->Handle;
+		IVCI.viewType 							= VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+		IVCI.format								= aImage->CreateInfo.format;
+		IVCI.components							= { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+		IVCI.subresourceRange.aspectMask		= image::aspect_flag(aImage->CreateInfo.format);
+		IVCI.subresourceRange.baseMipLevel		= aMipLevel;
+		IVCI.subresourceRange.levelCount		= 1;
+		IVCI.subresourceRange.baseArrayLayer	= 0;
+		IVCI.subresourceRange.layerCount		= aImage->CreateInfo.arrayLayers;
+		if (vkCreateImageView(aContext->Handle, &IVCI, NULL, &IV) != VK_SUCCESS) return VK_NULL_HANDLE;
+		return IV;
+	}
+
+	mip_generator::mip_generator() {
+		this->Context = nullptr;
+		this->Type = resource::type::UNKNOWN;
+	}
+
+	mip_generator::mip_generator(std::shared_ptr<context> aContext) : mip_generator() {
+		this->Context = aContext;
+	}
+
+	mip_generator::~mip_generator() {
+		for (auto& [Key, Target] : this->Target) {
+			this->destroy_target(Target);
+		}
+		this->Target.clear();
+	}
+
+	bool mip_generator::supported(std::shared_ptr<image> aImage) const {
+		if ((aImage == nullptr) || (aImage->CreateInfo.imageType != VK_IMAGE_TYPE_2D)) return false;
+		if (((aImage->CreateInfo.usage & VK_IMAGE_USAGE_STORAGE_BIT) == 0) || (storage_format(aImage->CreateInfo.format) == NULL)) return false;
+		PFN_vkGetPhysicalDeviceFormatProperties vkGetPhysicalDeviceFormatProperties = (PFN_vkGetPhysicalDeviceFormatProperties)this->Context->Instance->function_pointer("vkGetPhysicalDeviceFormatProperties");
+		if (vkGetPhysicalDeviceFormatProperties == NULL) return false;
+		VkFormatProperties FormatProperties{};
+		vkGetPhysicalDeviceFormatProperties(this->Context->Device->Handle, aImage->CreateInfo.format, &FormatProperties);
+		VkFormatFeatureFlags Features = (aImage->CreateInfo.tiling == VK_IMAGE_TILING_LINEAR) ? FormatProperties.linearTilingFeatures : FormatProperties.optimalTilingFeatures;
+		return (Features & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+	}
+
+	VkResult mip_generator::generate(command_buffer* aCommandBuffer, std::shared_ptr<image> aImage, reduction aReduction, image::layout aFinalLayout) {
+		if (aFinalLayout == image::layout::LAYOUT_CURRENT) {
+			aFinalLayout = aImage->current_layout();
+		}
+		if (aImage->CreateInfo.mipLevels < 2) {
+			aImage->require(aCommandBuffer, aFinalLayout, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			return VK_SUCCESS;
+		}
+		if (!this->supported(aImage)) {
+			if ((aReduction == MIN) || (aReduction == MAX)) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+			aImage->generate_mipmaps(aCommandBuffer, aFinalLayout, VK_FILTER_LINEAR);
+			return VK_SUCCESS;
+		}
+
+		target* Target = this->get_target(aImage, aReduction);
+		if (Target == nullptr) return VK_ERROR_INITIALIZATION_FAILED;
+
+		for (const pass& Pass : Target->Pass) {
+			// Waits on the previous pass only for the levels it wrote, and on the counter it reset.
+			barrier_batch Barrier;
+			aImage->require(Barrier, image::layout::GENERAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, Pass.BaseLevel, 1);
+			aImage->require(Barrier, image::layout::GENERAL, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, Pass.BaseLevel + 1, Pass.LevelCount);
+			if (Target->Counter != nullptr) {
+				Target->Counter->require(Barrier, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			}
+			Barrier.record(aCommandBuffer);
+			Target->Pipeline->dispatch(aCommandBuffer, Pass.GroupCount, Pass.Descriptor);
+		}
+
+		aImage->require(aCommandBuffer, aFinalLayout, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+		return VK_SUCCESS;
+	}
+
+	void mip_generator::prune() {
+		for (auto It = this->Target.begin(); It != this->Target.end();) {
+			if (It->second.Image.expired()) {
+				this->destroy_target(It->second);
+				It = this->Target.erase(It);
+			}
+			else {
+				++It;
+			}
+		}
+	}
+
+	uint32_t mip_generator::single_pass_level_count(uint32_t aBaseWidth, uint32_t aBaseHeight, uint32_t aRemainingLevelCount) {
+		// Every work group covers a 64x64 tile of the base, so level 6 is one tile up to 4096 texels.
+		return std::min(aRemainingLevelCount, (std::max(aBaseWidth, aBaseHeight) <= 4096) ? 12u : 6u);
+	}
+
+	std::shared_ptr<pipeline> mip_generator::get_pipeline(const char* aStorageFormat, reduction aReduction) {
+		std::string Key = std::string(aStorageFormat) + ":" + std::to_string((int)aReduction);
+		auto It = this->Pipeline.find(Key);
+		if (It != this->Pipeline.end()) return It->second;
+		std::string Source = std::string("#version 450\n#define FORMAT ") + aStorageFormat + "\n#define REDUCTION " + std::to_string((int)aReduction) + "\n";
+		Source += (aReduction == KAISER) ? KaiserSource : DownsampleSource;
+		std::shared_ptr<pipeline> Pipeline = this->Context->create_compute_pipeline(Source);
+		if (Pipeline != nullptr) {
+			this->Pipeline[Key] = Pipeline;
+		}
+		return Pipeline;
+	}
+
+	mip_generator::target* mip_generator::get_target(std::shared_ptr<image> aImage, reduction aReduction) {
+		std::pair<VkImage, reduction> Key = std::make_pair(aImage->Handle, aReduction);
+		auto It = this->Target.find(Key);
+		if (It != this->Target.end()) {
+			if (It->second.Image.lock() == aImage) return &It->second;
+			// Handle reused by a new image.
+			this->destroy_target(It->second);
+			this->Target.erase(It);
+		}
+
+		uint32_t Width = aImage->CreateInfo.extent.width;
+		uint32_t Height = aImage->CreateInfo.extent.height;
+		uint32_t LevelCount = aImage->CreateInfo.mipLevels;
+		uint32_t LayerCount = aImage->CreateInfo.arrayLayers;
+
+		target NewTarget;
+		NewTarget.Image = aImage;
+		NewTarget.Pipeline = this->get_pipeline(storage_format(aImage->CreateInfo.format), aReduction);
+		if (NewTarget.Pipeline == nullptr) return nullptr;
+		for (uint32_t i = 0; i < LevelCount; i++) {
+			NewTarget.View.push_back(level_view(this->Context, aImage, i));
+			if (NewTarget.View.back() == VK_NULL_HANDLE) {
+				this->destroy_target(NewTarget);
+				return nullptr;
+			}
+		}
+
+		if (aReduction == KAISER) {
+			for (uint32_t i = 0; i + 1 < LevelCount; i++) {
+				pass Pass{};
+				Pass.BaseLevel 		= i;
+				Pass.LevelCount 	= 1;
+				Pass.GroupCount 	= { (std::max(1u, Width >> (i + 1)) + 7) / 8, (std::max(1u, Height >> (i + 1)) + 7) / 8, LayerCount };
+				Pass.Descriptor 	= this->Context->create<descriptor::array>(NewTarget.Pipeline);
+				Pass.Descriptor->bind(0, 0, 0, NewTarget.View[i], image::layout::GENERAL);
+				Pass.Descriptor->bind(0, 1, 0, NewTarget.View[i + 1], image::layout::GENERAL);
+				NewTarget.Pass.push_back(Pass);
+			}
+		}
+		else {
+			std::vector<uint32_t> Zero(LayerCount, 0);
+			NewTarget.Counter = this->Context->create<buffer>(
+				device::memory::DEVICE_LOCAL,
+				buffer::usage::STORAGE | buffer::usage::TRANSFER_DST,
+				LayerCount, LayerCount * sizeof(uint32_t), Zero.data()
+			);
+			if (NewTarget.Counter == nullptr) {
+				this->destroy_target(NewTarget);
+				return nullptr;
+			}
+			for (uint32_t Base = 0; Base + 1 < LevelCount;) {
+				uint32_t BaseWidth = std::max(1u, Width >> Base);
+				uint32_t BaseHeight = std::max(1u, Height >> Base);
+				pass Pass{};
+				Pass.BaseLevel 		= Base;
+				Pass.LevelCount 	= single_pass_level_count(BaseWidth, BaseHeight, LevelCount - 1 - Base);
+				Pass.GroupCount 	= { (std::max(1u, BaseWidth / 2) + 31) / 32, (std::max(1u, BaseHeight / 2) + 31) / 32, LayerCount };
+				uint32_t Parameter[4] = { BaseWidth, BaseHeight, Pass.LevelCount, Pass.GroupCount[0] * Pass.GroupCount[1] };
+				Pass.Parameter 		= this->Context->create<buffer>(
+					device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT,
+					buffer::usage::UNIFORM,
+					1, sizeof(Parameter), Parameter
+				);
+				Pass.Descriptor 	= this->Context->create<descriptor::array>(NewTarget.Pipeline);
+				if (Pass.Parameter == nullptr) {
+					this->destroy_target(NewTarget);
+					return nullptr;
+				}
+				Pass.Descriptor->bind(0, 0, 0, Pass.Parameter->Handle);
+				Pass.Descriptor->bind(0, 1, 0, NewTarget.View[Base], image::layout::GENERAL);
+				for (uint32_t i = 0; i < 12; i++) {
+					// Elements past the last level are never accessed, but must still be valid.
+					Pass.Descriptor->bind(0, 2, i, NewTarget.View[Base + std::min(i + 1, Pass.LevelCount)], image::layout::GENERAL);
+				}
+				Pass.Descriptor->bind(0, 3, 0, NewTarget.Counter->Handle);
+				NewTarget.Pass.push_back(Pass);
+				Base += Pass.LevelCount;
+			}
+		}
+
+		return &(this->Target[Key] = NewTarget);
+	}
+
+	void mip_generator::destroy_target(target& aTarget) {
+		PFN_vkDestroyImageView vkDestroyImageView = (PFN_vkDestroyImageView)this->Context->function_pointer("vkDestroyImageView");
+		aTarget.Pass.clear();
+		for (VkImageView View : aTarget.View) {
+			vkDestroyImageView(this->Context->Handle, View, NULL);
+		}
+		aTarget.View.clear();
+		aTarget.Counter = nullptr;
+	}
+
+}
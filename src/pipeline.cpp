@@ -3,6 +3,9 @@
 
 #include "glslang_util.h"
 
+#include <algorithm>
+#include <chrono>
+
 namespace geodesy::gpu {
 
 	void pipeline::create_info::generate_descriptor_set_layout_binding() {
@@ -116,9 +119,104 @@ namespace geodesy::gpu {
 		}
 	}
 
+	uint64_t pipeline::create_info::key() const {
+		// Order independent, shader lists may be built from unordered sets.
+		std::vector<uint64_t> ShaderKey;
+		for (const std::shared_ptr<shader>& Shd : this->Shader) {
+			ShaderKey.push_back(Shd->Key);
+		}
+		std::sort(ShaderKey.begin(), ShaderKey.end());
+		int Type = this->BindPoint;
+		uint64_t Key = shader_cache::hash(&Type, sizeof(Type));
+		return shader_cache::hash(ShaderKey.data(), ShaderKey.size() * sizeof(uint64_t), Key);
+	}
+
+	bool pipeline::create_info::read_cache(shader_cache::program& aProgram) {
+		if ((shader::Cache == nullptr) || (this->Shader.size() == 0)) return false;
+		if (!shader::Cache->find(this->key(), aProgram)) return false;
+
+		// Map cached byte code back onto this shader ordering.
+		std::vector<std::vector<unsigned int>> ByteCode(this->Shader.size());
+		for (size_t i = 0; i < this->Shader.size(); i++) {
+			auto It = std::find(aProgram.ShaderKey.begin(), aProgram.ShaderKey.end(), this->Shader[i]->Key);
+			if (It == aProgram.ShaderKey.end()) return false;
+			ByteCode[i] = aProgram.ByteCode[It - aProgram.ShaderKey.begin()];
+		}
+
+		this->ByteCode = ByteCode;
+		this->DescriptorSetLayoutBinding = aProgram.DescriptorSetLayoutBinding;
+		return true;
+	}
+
+	void pipeline::create_info::write_cache(shader_cache::program aProgram) {
+		if (shader::Cache == nullptr) return;
+		aProgram.ShaderKey = std::vector<uint64_t>(this->Shader.size());
+		for (size_t i = 0; i < this->Shader.size(); i++) {
+			aProgram.ShaderKey[i] = this->Shader[i]->Key;
+		}
+		aProgram.ByteCode = this->ByteCode;
+		aProgram.DescriptorSetLayoutBinding = this->DescriptorSetLayoutBinding;
+		shader::Cache->insert(this->key(), aProgram);
+	}
+
+	// Linking finalizes the intermediate of each shader in place, so pipelines sharing a shader link one at a time.
+	// Locks are taken in address order so two pipelines sharing several shaders can not deadlock.
+	static std::vector<std::unique_lock<std::mutex>> lock_shaders(const std::vector<std::shared_ptr<shader>>& aShader) {
+		std::vector<shader*> Ordered;
+		for (const std::shared_ptr<shader>& Shd : aShader) {
+			Ordered.push_back(Shd.get());
+		}
+		std::sort(Ordered.begin(), Ordered.end());
+		Ordered.erase(std::unique(Ordered.begin(), Ordered.end()), Ordered.end());
+		std::vector<std::unique_lock<std::mutex>> Lock;
+		for (shader* Shd : Ordered) {
+			Lock.emplace_back(Shd->Mutex);
+		}
+		return Lock;
+	}
+
+	void pipeline::create_info::link(std::string aPipelineName) {
+		// Parse sources, deferred from shader construction.
+		for (std::shared_ptr<shader> Shd : this->Shader) {
+			if (!Shd->compile()) {
+				throw std::runtime_error("Failed to compile shader for " + aPipelineName + " pipeline: " + Shd->info_log());
+			}
+		}
+
+		std::vector<std::unique_lock<std::mutex>> Lock = lock_shaders(this->Shader);
+
+		// Link various shader stages together.
+		this->Program = std::make_shared<glslang::TProgram>();
+		for (std::shared_ptr<shader> Shd : this->Shader) {
+			this->Program->addShader(Shd->Handle.get());
+		}
+
+		// Link Shader Stages
+		bool Success = this->Program->link(CompilerMessages);
+
+		// Check if Link was successful
+		if (!Success) {
+			throw std::runtime_error("Failed to link shader stages for " + aPipelineName + " pipeline: " + std::string(this->Program->getInfoLog()));
+		}
+
+		// Generates API Reflection.
+		this->Program->buildReflection(EShReflectionAllIOVariables);
+	}
+
+	void pipeline::create_info::generate_byte_code() {
+		std::vector<std::unique_lock<std::mutex>> Lock = lock_shaders(this->Shader);
+		glslang::SpvOptions Option;
+		spv::SpvBuildLogger Logger;
+		this->ByteCode = std::vector<std::vector<unsigned int>>(this->Shader.size());
+		for (size_t i = 0; i < this->Shader.size(); i++) {
+			glslang::GlslangToSpv(*this->Program->getIntermediate(this->Shader[i]->Handle->getStage()), this->ByteCode[i], &Logger, &Option);
+		}
+	}
+
 	pipeline::rasterizer::rasterizer() {
 		this->BindPoint 											= type::RASTERIZER;
 		this->PrimitiveTopology										= VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		this->PatchControlPoints									= 3;
 		this->MinDepth												= 0.0f;
 		this->MaxDepth												= 1.0f;
 		this->PolygonMode											= VK_POLYGON_MODE_FILL;
@@ -140,44 +238,34 @@ namespace geodesy::gpu {
 	}
 
 	pipeline::rasterizer::rasterizer(std::vector<std::shared_ptr<shader>> aShaderList) : rasterizer() {
-		bool Success = true;
-
 		// Load shaders.
 		this->Shader = aShaderList;
 
-		// Link Shader Stages.
-		if (Success) {
-			EShMessages Message = (EShMessages)(
-				EShMessages::EShMsgAST |
-				EShMessages::EShMsgSpvRules |
-				EShMessages::EShMsgVulkanRules |
-				EShMessages::EShMsgDebugInfo |
-				EShMessages::EShMsgBuiltinSymbolTable
-			);
-
-			// Link various shader stages together.
-			this->Program = std::make_shared<glslang::TProgram>();
-			for (std::shared_ptr<shader> Shd : Shader) {
-				this->Program->addShader(Shd->Handle.get());
+		shader_cache::program Cached;
+		if (this->read_cache(Cached)) {
+			// Restore reflected interface from cache, glslang front end is skipped entirely.
+			this->VertexAttribute = std::vector<attribute>(Cached.VertexAttribute.size());
+			for (size_t i = 0; i < this->VertexAttribute.size(); i++) {
+				this->VertexAttribute[i].Description 					= Cached.VertexAttribute[i];
+				this->VertexAttribute[i].Variable 						= nullptr;
 			}
-
-			// Link Shader Stages
-			Success = this->Program->link(Message);
-
-			// Check if Link was successful
-			if (!Success) {
-				throw std::runtime_error("Failed to link shader stages for rasterization pipeline: " + std::string(this->Program->getInfoLog()));
+			this->ColorAttachment = std::vector<struct attachment>(Cached.ColorAttachmentFormat.size());
+			for (size_t i = 0; i < this->ColorAttachment.size(); i++) {
+				this->ColorAttachment[i].Variable 								= nullptr;
+				this->ColorAttachment[i].Description.flags						= 0;
+				this->ColorAttachment[i].Description.format						= Cached.ColorAttachmentFormat[i];
+				this->ColorAttachment[i].Description.samples					= VK_SAMPLE_COUNT_1_BIT;
+				this->ColorAttachment[i].Description.loadOp						= VK_ATTACHMENT_LOAD_OP_LOAD;
+				this->ColorAttachment[i].Description.storeOp					= VK_ATTACHMENT_STORE_OP_STORE;
+				this->ColorAttachment[i].Description.stencilLoadOp				= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				this->ColorAttachment[i].Description.stencilStoreOp				= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				this->ColorAttachment[i].Description.initialLayout				= VK_IMAGE_LAYOUT_UNDEFINED;
+				this->ColorAttachment[i].Description.finalLayout				= VK_IMAGE_LAYOUT_UNDEFINED;
 			}
 		}
 		else {
-			// No shaders provided.
-			Success = false;
-		}
-
-		// Build API reflection.
-		if (Success) {
-			// Generates API Reflection.
-			this->Program->buildReflection(EShReflectionAllIOVariables);
+			// Link Shader Stages and build reflection.
+			this->link("rasterization");
 
 			// -------------------- START -------------------- //
 
@@ -230,11 +318,18 @@ namespace geodesy::gpu {
 
 			// Generates Descriptor Set Layout Bindings.
 			this->generate_descriptor_set_layout_binding();
-			
-		}
-		else {
-			// Linking failed.
-			Success = false;
+
+			// Generate SPIRV code.
+			this->generate_byte_code();
+
+			// Store for next time.
+			for (const attribute& Attribute : this->VertexAttribute) {
+				Cached.VertexAttribute.push_back(Attribute.Description);
+			}
+			for (const struct attachment& Attachment : this->ColorAttachment) {
+				Cached.ColorAttachmentFormat.push_back(Attachment.Description.format);
+			}
+			this->write_cache(Cached);
 		}
 
 		// Setup default blending rules for each color attachment.
@@ -249,20 +344,6 @@ namespace geodesy::gpu {
 			AttachmentBlendingRules[i].alphaBlendOp					= VK_BLEND_OP_ADD;
 			AttachmentBlendingRules[i].colorWriteMask				= VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 		}
-
-		// Generate SPIRV code.
-		if (Success) {
-			glslang::SpvOptions Option;
-			spv::SpvBuildLogger Logger;
-			this->ByteCode = std::vector<std::vector<unsigned int>>(this->Shader.size());
-			for (size_t i = 0; i < this->Shader.size(); i++) {
-				glslang::GlslangToSpv(*this->Program->getIntermediate(this->Shader[i]->Handle->getStage()), this->ByteCode[i], &Logger, &Option);
-			}
-		}
-		else {
-			// failed to gather meta data.
-			Success = false;
-		}
 	}
 
 	void pipeline::rasterizer::bind(uint32_t aBindingIndex, size_t aVertexStride, uint32_t aLocationIndex, size_t aVertexOffset, input_rate aInputRate) {
@@ -303,31 +384,54 @@ namespace geodesy::gpu {
 	}
 
 	void pipeline::rasterizer::attach(uint32_t aAttachmentIndex, std::shared_ptr<image> aAttachmentImage, image::layout aImageLayout) {
-		// TODO: Maybe check that image sample count matches rasterizer sample count?
 		this->attach(aAttachmentIndex, (image::format)aAttachmentImage->CreateInfo.format, aImageLayout);
+		VkAttachmentDescription* Description = NULL;
+		if (aAttachmentIndex < this->ColorAttachment.size()) {
+			Description = &this->ColorAttachment[aAttachmentIndex].Description;
+		}
+		else if (aAttachmentIndex == this->ColorAttachment.size()) {
+			Description = &this->DepthStencilAttachment.Description;
+		}
+		if (Description == NULL) return;
+		// Multisampled attachments set the rasterization sample count, they must all match.
+		Description->samples 				= aAttachmentImage->CreateInfo.samples;
+		if (aAttachmentImage->CreateInfo.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) {
+			// Cleared on load and discarded on store, so tile based GPUs never write it out to memory.
+			Description->loadOp 			= VK_ATTACHMENT_LOAD_OP_CLEAR;
+			Description->storeOp 			= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			Description->stencilLoadOp 		= VK_ATTACHMENT_LOAD_OP_CLEAR;
+			Description->stencilStoreOp 	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			Description->initialLayout 		= VK_IMAGE_LAYOUT_UNDEFINED;
+		}
 	}
 
 	void pipeline::rasterizer::attach(uint32_t aAttachmentIndex, image::format aFormat, image::layout aImageLayout) {
 		if (aAttachmentIndex < this->ColorAttachment.size()) {
 			this->ColorAttachment[aAttachmentIndex].Description.format			= (VkFormat)aFormat;
 			this->ColorAttachment[aAttachmentIndex].Description.samples			= VK_SAMPLE_COUNT_1_BIT;
+			this->ColorAttachment[aAttachmentIndex].Description.loadOp			= VK_ATTACHMENT_LOAD_OP_LOAD;
+			this->ColorAttachment[aAttachmentIndex].Description.storeOp			= VK_ATTACHMENT_STORE_OP_STORE;
 			this->ColorAttachment[aAttachmentIndex].Description.initialLayout	= (VkImageLayout)aImageLayout;
 			this->ColorAttachment[aAttachmentIndex].Description.finalLayout		= (VkImageLayout)aImageLayout;
 		}
 		else if (aAttachmentIndex == this->ColorAttachment.size()) {
 			this->DepthStencilAttachment.Description.format						= (VkFormat)aFormat;
 			this->DepthStencilAttachment.Description.samples					= VK_SAMPLE_COUNT_1_BIT;
+			this->DepthStencilAttachment.Description.loadOp						= VK_ATTACHMENT_LOAD_OP_LOAD;
+			this->DepthStencilAttachment.Description.storeOp					= VK_ATTACHMENT_STORE_OP_STORE;
+			this->DepthStencilAttachment.Description.stencilLoadOp				= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			this->DepthStencilAttachment.Description.stencilStoreOp				= VK_ATTACHMENT_STORE_OP_DONT_CARE;
 			this->DepthStencilAttachment.Description.initialLayout				= (VkImageLayout)aImageLayout;
 			this->DepthStencilAttachment.Description.finalLayout				= (VkImageLayout)aImageLayout;
 		}
 	}
 
 	pipeline::raytracer::raytracer() {
+		this->BindPoint = pipeline::type::RAY_TRACER;
 		this->MaxRecursionDepth = 0;
 	}
 
 	pipeline::raytracer::raytracer(std::vector<shader_group> aShaderGroup, uint32_t aMaxRecursionDepth) : raytracer() {
-		bool Success = true;
 		this->ShaderGroup = aShaderGroup;
 		this->MaxRecursionDepth = aMaxRecursionDepth;
 		
@@ -348,49 +452,19 @@ namespace geodesy::gpu {
 			this->Shader = std::vector<std::shared_ptr<shader>>(LinearizedShaderSet.begin(), LinearizedShaderSet.end());
 		}
 
-		// Compile shaders.
-		// Link Shader Stages.
-		if (Success) {
-			EShMessages Message = (EShMessages)(
-				EShMessages::EShMsgAST |
-				EShMessages::EShMsgSpvRules |
-				EShMessages::EShMsgVulkanRules |
-				EShMessages::EShMsgDebugInfo |
-				EShMessages::EShMsgBuiltinSymbolTable
-			);
-
-			// Link various shader stages together.
-			this->Program = std::make_shared<glslang::TProgram>();
-			for (std::shared_ptr<shader> Shd : Shader) {
-				this->Program->addShader(Shd->Handle.get());
-			}
-
-			// Link Shader Stages
-			Success = this->Program->link(Message);
-
-			// Check if Link was successful
-			if (!Success) {
-				throw std::runtime_error("Failed to link shader stages for ray tracing pipeline: " + std::string(this->Program->getInfoLog()));
-			}
-		}
-
-		// TODO: Build and acquire reflection variables.
-		if (Success) {
-			this->Program->buildReflection(EShReflectionAllIOVariables);
+		// Compile shaders, unless already cached.
+		shader_cache::program Cached;
+		if (!this->read_cache(Cached)) {
+			// Link Shader Stages and build reflection.
+			this->link("ray tracing");
 
 			// Generates Descriptor Set Layout Bindings.
 			this->generate_descriptor_set_layout_binding();
-		
-		}
 
-		// Generate SPIRV code.
-		if (Success) {
-			glslang::SpvOptions Option;
-			spv::SpvBuildLogger Logger;
-			this->ByteCode = std::vector<std::vector<unsigned int>>(this->Shader.size());
-			for (size_t i = 0; i < this->Shader.size(); i++) {
-				glslang::GlslangToSpv(*this->Program->getIntermediate(this->Shader[i]->Handle->getStage()), this->ByteCode[i], &Logger, &Option);
-			}
+			// Generate SPIRV code.
+			this->generate_byte_code();
+
+			this->write_cache(Cached);
 		}
 	}
 
@@ -403,46 +477,18 @@ namespace geodesy::gpu {
 		// Compute Pipeline has only one shader stage.
 		this->Shader = { aComputeShader };
 
-		// Go ahead and link the shader and build reflection.
-		EShMessages Message = (EShMessages)(
-			EShMessages::EShMsgAST |
-			EShMessages::EShMsgSpvRules |
-			EShMessages::EShMsgVulkanRules |
-			EShMessages::EShMsgDebugInfo |
-			EShMessages::EShMsgBuiltinSymbolTable
-		);
-
-		// Link various shader stages together.
-		this->Program = std::make_shared<glslang::TProgram>();
-		for (std::shared_ptr<shader> Shd : Shader) {
-			this->Program->addShader(Shd->Handle.get());
-		}
-
-		// Link Shader Stages
-		bool Success = this->Program->link(Message);
-
-		// Check if Link was successful
-		if (!Success) {
-			throw std::runtime_error("Failed to link shader stages for compute pipeline: " + std::string(this->Program->getInfoLog()));
-		}
-
-		// Build and acquire reflection variables.
-		if (Success) {
-			this->Program->buildReflection(EShReflectionAllIOVariables);
+		shader_cache::program Cached;
+		if (!this->read_cache(Cached)) {
+			// Link Shader Stages and build reflection.
+			this->link("compute");
 
 			// Generates Descriptor Set Layout Bindings.
 			this->generate_descriptor_set_layout_binding();
 
-		}
+			// Generate SPIRV code.
+			this->generate_byte_code();
 
-		// Generate SPIRV code.
-		if (Success) {
-			glslang::SpvOptions Option;
-			spv::SpvBuildLogger Logger;
-			this->ByteCode = std::vector<std::vector<unsigned int>>(this->Shader.size());
-			for (size_t i = 0; i < this->Shader.size(); i++) {
-				glslang::GlslangToSpv(*this->Program->getIntermediate(this->Shader[i]->Handle->getStage()), this->ByteCode[i], &Logger, &Option);
-			}
+			this->write_cache(Cached);
 		}
 	}
 
@@ -487,248 +533,89 @@ namespace geodesy::gpu {
 		this->Handle			= VK_NULL_HANDLE;
 		this->DescriptorPool	= VK_NULL_HANDLE;
 		this->RenderPass		= VK_NULL_HANDLE;
+		this->Subpass			= 0;
+		this->Substitute		= nullptr;
+		this->Ready				= false;
+		this->LayoutKey			= 0;
+		this->SharedRenderPass	= false;
+		this->ExtendedDynamicState	= false;
 	}
 
 	pipeline::pipeline(std::shared_ptr<context> aContext, std::shared_ptr<rasterizer> aRasterizer, VkRenderPass aRenderPass, uint32_t aSubpassIndex) : pipeline() {
 		VkResult Result = VK_SUCCESS;
-		PFN_vkCreateRenderPass vkCreateRenderPass = (PFN_vkCreateRenderPass)aContext->function_pointer("vkCreateRenderPass");
 		PFN_vkCreateGraphicsPipelines vkCreateGraphicsPipelines = (PFN_vkCreateGraphicsPipelines)aContext->function_pointer("vkCreateGraphicsPipelines");		
 
-		this->CreateInfo 	= aRasterizer;
-		this->Context		= aContext;
-		this->BindPoint		= VK_PIPELINE_BIND_POINT_GRAPHICS;
-
-		// Create Render Pass.
-		{
-			// Attachments
-			std::vector<VkAttachmentDescription> AttachmentDescription(aRasterizer->ColorAttachment.size());
+		// Render pass, shader modules and pipeline layout.
+		Result = this->prepare(aContext, aRasterizer, aRenderPass, aSubpassIndex);
 
-			// References
-			std::vector<VkAttachmentReference> ColorAttachmentReference(aRasterizer->ColorAttachment.size());
-			VkAttachmentReference DepthAttachmentReference{};
-			VkAttachmentReference StencilAttachmentReference{};
+		// Create Pipeline
+		if (Result == VK_SUCCESS) {
+			rasterizer_state State;
+			this->create_rasterizer_state(State, aRasterizer);
 
-			// Load all Color Attachments.
-			for (size_t i = 0; i < aRasterizer->ColorAttachment.size(); i++) {
-				AttachmentDescription[i] = aRasterizer->ColorAttachment[i].Description;
-			}
-			
-			// If depth stencil format is not undefined, add to attachment description.
-			if (aRasterizer->DepthStencilAttachment.Description.format != VK_FORMAT_UNDEFINED) {
-				DepthAttachmentReference = { (uint32_t)AttachmentDescription.size(), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
-				AttachmentDescription.push_back(aRasterizer->DepthStencilAttachment.Description);
+			// Link from cached library parts when supported, fall back to a monolithic compile.
+			Result = VK_ERROR_FEATURE_NOT_PRESENT;
+			if (aContext->GraphicsPipelineLibrary) {
+				Result = this->link_libraries(State, aRasterizer);
 			}
 
-			// Convert to references. 
-			for (size_t i = 0; i < aRasterizer->ColorAttachment.size(); i++) {
-				ColorAttachmentReference[i].attachment	= i;
-				ColorAttachmentReference[i].layout		= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-			}
-
-			// Subpass Description
-			std::vector<VkSubpassDescription> SubpassDescription(1);
-			SubpassDescription[0].flags							= 0;
-			SubpassDescription[0].pipelineBindPoint				= VK_PIPELINE_BIND_POINT_GRAPHICS;
-			SubpassDescription[0].inputAttachmentCount			= 0;
-			SubpassDescription[0].pInputAttachments				= NULL;
-			SubpassDescription[0].colorAttachmentCount			= ColorAttachmentReference.size();
-			SubpassDescription[0].pColorAttachments				= ColorAttachmentReference.data();
-			SubpassDescription[0].pResolveAttachments			= NULL;
-			if (aRasterizer->DepthStencilAttachment.Description.format != VK_FORMAT_UNDEFINED) {
-				SubpassDescription[0].pDepthStencilAttachment		= &DepthAttachmentReference;
+			// Create Rasterization Pipeline.
+			if (Result != VK_SUCCESS) {
+				std::shared_lock<std::shared_mutex> Lock(aContext->PipelineCacheMutex);
+				Result = vkCreateGraphicsPipelines(this->Context->Handle, this->Cache, 1, &State.CreateInfo, NULL, &this->Handle);
 			}
-			else {
-				SubpassDescription[0].pDepthStencilAttachment		= NULL;
-			}
-
-			// Subpass Dependency
-			std::vector<VkSubpassDependency> SubpassDependency(1);
-			SubpassDependency[0].srcSubpass						= VK_SUBPASS_EXTERNAL;
-			SubpassDependency[0].dstSubpass						= 0;
-			SubpassDependency[0].srcStageMask					= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			SubpassDependency[0].dstStageMask					= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			SubpassDependency[0].srcAccessMask					= 0;
-			SubpassDependency[0].dstAccessMask					= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			SubpassDependency[0].dependencyFlags				= 0;
-			
-			VkRenderPassCreateInfo RPCI{};
-			RPCI.sType											= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-			RPCI.pNext											= NULL;
-			RPCI.flags											= 0;
-			RPCI.attachmentCount								= AttachmentDescription.size();
-			RPCI.pAttachments									= AttachmentDescription.data();
-			RPCI.subpassCount									= SubpassDescription.size();
-			RPCI.pSubpasses										= SubpassDescription.data();
-			RPCI.dependencyCount								= SubpassDependency.size();
-			RPCI.pDependencies									= SubpassDependency.data();
-
-			Result = vkCreateRenderPass(aContext->Handle, &RPCI, NULL, &this->RenderPass);
 		}
 
-		// Create Respective Shader Modules.
-		Result = this->shader_stage_create(aRasterizer);
-
-		// Generate Descriptor Set Layouts from Meta Data gathered from shaders.
-		Result = this->create_pipeline_layout(aRasterizer->DescriptorSetLayoutBinding);
+		this->Ready = (Result == VK_SUCCESS);
+	}
 
-		// Create Pipeline
-		if (Result == VK_SUCCESS) {
-			bool TesselationControlShaderExists = false;
-			bool TesselationEvaluationShaderExists = false;
-			for (std::shared_ptr<shader> Shdr : aRasterizer->Shader) {
-				if (Shdr->Stage == shader::stage::TESSELLATION_CONTROL) {
-					TesselationControlShaderExists = true;
-				}
-				if (Shdr->Stage == shader::stage::TESSELLATION_CONTROL) {
-					TesselationEvaluationShaderExists = true;
-				}
+	std::vector<std::shared_ptr<pipeline>> pipeline::create(std::shared_ptr<context> aContext, std::vector<std::shared_ptr<rasterizer>> aRasterizerList) {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkCreateGraphicsPipelines vkCreateGraphicsPipelines = (PFN_vkCreateGraphicsPipelines)aContext->function_pointer("vkCreateGraphicsPipelines");
+
+		std::vector<std::shared_ptr<pipeline>> Pipeline(aRasterizerList.size(), nullptr);
+		std::vector<std::unique_ptr<rasterizer_state>> State;
+		std::vector<VkGraphicsPipelineCreateInfo> GPCI;
+		std::vector<size_t> Index;
+
+		// Prepare each pipeline's layout and state, skip the ones that fail.
+		for (size_t i = 0; i < aRasterizerList.size(); i++) {
+			std::shared_ptr<pipeline> NewPipeline(new pipeline());
+			Result = NewPipeline->prepare(aContext, aRasterizerList[i], VK_NULL_HANDLE, 0);
+			if (Result != VK_SUCCESS) continue;
+			State.push_back(std::make_unique<rasterizer_state>());
+			NewPipeline->create_rasterizer_state(*State.back(), aRasterizerList[i]);
+			// Library links are cheap, only monolithic pipelines go in the batch.
+			if (aContext->GraphicsPipelineLibrary && (NewPipeline->link_libraries(*State.back(), aRasterizerList[i]) == VK_SUCCESS)) {
+				NewPipeline->Ready = true;
+				Pipeline[i] = NewPipeline;
+				continue;
 			}
+			GPCI.push_back(State.back()->CreateInfo);
+			Index.push_back(i);
+			Pipeline[i] = NewPipeline;
+		}
 
-			// Load attributes from aRasterizer->
-			std::vector<VkVertexInputAttributeDescription> VertexAttributeDescription;
-			for (rasterizer::attribute& Attribute : aRasterizer->VertexAttribute) {
-				VertexAttributeDescription.push_back(Attribute.Description);
-			}
-
-			// Loading Vertex Binding & Attribute Data
-			VkPipelineVertexInputStateCreateInfo Input{};
-			Input.sType													= VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-			Input.pNext													= NULL;
-			Input.flags													= 0;
-			Input.vertexBindingDescriptionCount							= aRasterizer->VertexBufferBindingDescription.size();
-			Input.pVertexBindingDescriptions							= aRasterizer->VertexBufferBindingDescription.data();
-			Input.vertexAttributeDescriptionCount						= VertexAttributeDescription.size();
-			Input.pVertexAttributeDescriptions							= VertexAttributeDescription.data();
-
-			// Vulkan Objects
-			VkPipelineInputAssemblyStateCreateInfo InputAssembly = {};
-			VkPipelineTessellationStateCreateInfo Tesselation = {};
-			VkPipelineViewportStateCreateInfo Viewport = {};
-			VkPipelineRasterizationStateCreateInfo Rasterizer = {};
-			VkPipelineMultisampleStateCreateInfo Multisample = {};
-			VkPipelineDepthStencilStateCreateInfo DepthStencil = {};
-			VkPipelineColorBlendStateCreateInfo	ColorBlend = {};
-			VkPipelineDynamicStateCreateInfo DynamicState = {};
-
-			InputAssembly.sType 							= VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-			InputAssembly.pNext 							= NULL;
-			InputAssembly.flags 							= 0;
-			InputAssembly.topology 							= aRasterizer->PrimitiveTopology;
-			InputAssembly.primitiveRestartEnable 			= VK_FALSE;
-
-			Tesselation.sType 								= VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
-			Tesselation.pNext 								= NULL;
-			Tesselation.flags 								= 0;
-
-			// Both are stupid options, just tie to resolution.
-			Viewport.sType 									= VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-			Viewport.pNext 									= NULL;
-			Viewport.flags 									= 0;
-			Viewport.viewportCount 							= 1;
-			Viewport.pViewports 							= NULL;
-			Viewport.scissorCount 							= 1;
-			Viewport.pScissors 								= NULL;
-
-			// Depth Clamp seems stupid, don't care about it.
-			Rasterizer.sType 								= VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-			Rasterizer.pNext 								= NULL;
-			Rasterizer.flags 								= 0;
-			Rasterizer.depthClampEnable 					= VK_FALSE;
-			Rasterizer.rasterizerDiscardEnable 				= VK_FALSE;
-			Rasterizer.polygonMode 							= aRasterizer->PolygonMode;
-			Rasterizer.cullMode 							= aRasterizer->CullMode;
-			Rasterizer.frontFace 							= aRasterizer->FrontFace;
-			Rasterizer.depthBiasEnable 						= VK_FALSE;
-			Rasterizer.depthBiasConstantFactor 				= 0.0f;
-			Rasterizer.depthBiasClamp 						= 0.0f;
-			Rasterizer.depthBiasSlopeFactor 				= 0.0f;
-			Rasterizer.lineWidth 							= aRasterizer->LineWidth;
-
-			// Disabled By Default
-			Multisample.sType 								= VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-			Multisample.pNext 								= NULL;
-			Multisample.flags 								= 0;
-			Multisample.rasterizationSamples				= VK_SAMPLE_COUNT_1_BIT;
-			Multisample.sampleShadingEnable 				= VK_FALSE;
-			Multisample.minSampleShading 					= 1.0f;
-			Multisample.pSampleMask 						= NULL;
-			Multisample.alphaToCoverageEnable 				= VK_FALSE;
-			Multisample.alphaToOneEnable 					= VK_FALSE;
-
-			// I don't care about stencil stuff, depth bounds is redundant, suppress.
-			DepthStencil.sType 								= VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-			DepthStencil.pNext 								= NULL;
-			DepthStencil.flags 								= 0;
-			DepthStencil.depthTestEnable 					= aRasterizer->DepthTestEnable;
-			DepthStencil.depthWriteEnable 					= aRasterizer->DepthWriteEnable;
-			DepthStencil.depthCompareOp 					= aRasterizer->DepthCompareOp;
-			DepthStencil.depthBoundsTestEnable 				= VK_FALSE;
-			DepthStencil.stencilTestEnable 					= VK_FALSE;
-			DepthStencil.front 								= {};
-			DepthStencil.back 								= {};
-			DepthStencil.minDepthBounds 					= 0.0f;
-			DepthStencil.maxDepthBounds 					= 1.0f;
-
-			ColorBlend.sType 								= VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-			ColorBlend.pNext 								= NULL;
-			ColorBlend.flags 								= 0;
-			ColorBlend.logicOpEnable 						= VK_FALSE;
-			ColorBlend.logicOp 								= VK_LOGIC_OP_COPY;
-			ColorBlend.attachmentCount 						= aRasterizer->AttachmentBlendingRules.size();
-			ColorBlend.pAttachments 						= aRasterizer->AttachmentBlendingRules.data();
-			ColorBlend.blendConstants[0] 					= 0.0f;
-			ColorBlend.blendConstants[1] 					= 0.0f;
-			ColorBlend.blendConstants[2] 					= 0.0f;
-			ColorBlend.blendConstants[3] 					= 0.0f;
-
-			// Default Enabled Dynamic State.
-			std::vector<VkDynamicState> DynamicStates {
-				VK_DYNAMIC_STATE_VIEWPORT,
-				VK_DYNAMIC_STATE_SCISSOR
-			};
+		if (GPCI.size() == 0) return Pipeline;
 
-			DynamicState.sType 								= VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-			DynamicState.pNext 								= NULL;
-			DynamicState.flags 								= 0;
-			DynamicState.dynamicStateCount 					= DynamicStates.size();
-			DynamicState.pDynamicStates 					= DynamicStates.data();
-
-
-			// Create Rasterizer Create Info Struct.
-			VkGraphicsPipelineCreateInfo RasterizerCreateInfo {};
-			RasterizerCreateInfo.sType							= VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-			RasterizerCreateInfo.pNext							= NULL;// &RenderingCreateInfo;
-			RasterizerCreateInfo.flags							= 0;
-			RasterizerCreateInfo.stageCount						= this->Stage.size();
-			RasterizerCreateInfo.pStages						= this->Stage.data();
-			RasterizerCreateInfo.pVertexInputState				= &Input;
-			RasterizerCreateInfo.pInputAssemblyState			= &InputAssembly;
-			if (TesselationControlShaderExists && TesselationEvaluationShaderExists) {
-				RasterizerCreateInfo.pTessellationState				= &Tesselation;
+		// One driver call for the whole batch.
+		std::vector<VkPipeline> Handle(GPCI.size(), VK_NULL_HANDLE);
+		{
+			std::shared_lock<std::shared_mutex> Lock(aContext->PipelineCacheMutex);
+			Result = vkCreateGraphicsPipelines(aContext->Handle, aContext->PipelineCache, GPCI.size(), GPCI.data(), NULL, Handle.data());
+		}
+		for (size_t i = 0; i < Index.size(); i++) {
+			if (Handle[i] != VK_NULL_HANDLE) {
+				Pipeline[Index[i]]->Handle = Handle[i];
+				Pipeline[Index[i]]->Ready = true;
 			}
 			else {
-				RasterizerCreateInfo.pTessellationState				= NULL;
-			}
-			RasterizerCreateInfo.pViewportState					= &Viewport;
-			RasterizerCreateInfo.pRasterizationState			= &Rasterizer;
-			RasterizerCreateInfo.pMultisampleState				= &Multisample;
-			if (aRasterizer->DepthStencilAttachment.Description.format != VK_FORMAT_UNDEFINED) {
-				RasterizerCreateInfo.pDepthStencilState				= &DepthStencil;
+				// Failed entries are returned as nullptr.
+				Pipeline[Index[i]] = nullptr;
 			}
-			else {
-				RasterizerCreateInfo.pDepthStencilState				= NULL;
-			}
-			RasterizerCreateInfo.pColorBlendState				= &ColorBlend;
-			RasterizerCreateInfo.pDynamicState					= &DynamicState;
-			RasterizerCreateInfo.layout							= this->Layout;
-			RasterizerCreateInfo.renderPass						= this->RenderPass;
-			RasterizerCreateInfo.subpass						= 0;
-			RasterizerCreateInfo.basePipelineHandle				= VK_NULL_HANDLE;
-			RasterizerCreateInfo.basePipelineIndex				= 0;
-			
-			// Create Rasterization Pipeline.
-			Result = vkCreateGraphicsPipelines(this->Context->Handle, this->Cache, 1, &RasterizerCreateInfo, NULL, &this->Handle);
 		}
+
+		return Pipeline;
 	}
 
 	pipeline::pipeline(std::shared_ptr<context> aContext, std::shared_ptr<raytracer> aRaytracer) : pipeline() {
@@ -740,6 +627,7 @@ namespace geodesy::gpu {
 		this->CreateInfo	= aRaytracer;
 		this->Context		= aContext;
 		this->BindPoint		= VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR;
+		this->Cache			= aContext->PipelineCache;
 
 		// Generate GPU shader modules.
 		Result = this->shader_stage_create(aRaytracer);
@@ -852,6 +740,7 @@ namespace geodesy::gpu {
 			RTPCI.basePipelineIndex						= 0;
 			
 			// Requires loading function.
+			std::shared_lock<std::shared_mutex> Lock(aContext->PipelineCacheMutex);
 			Result = vkCreateRayTracingPipelinesKHR(aContext->Handle, VK_NULL_HANDLE, this->Cache, 1, &RTPCI, NULL, &this->Handle);
 		}
 
@@ -1020,6 +909,8 @@ namespace geodesy::gpu {
 			this->ShaderBindingTable.Callable.stride 			= HandleSizeAligned;
 			this->ShaderBindingTable.Callable.size 				= CallableSize;
 		}
+
+		this->Ready = (Result == VK_SUCCESS);
 	}
 
 	pipeline::pipeline(std::shared_ptr<context> aContext, std::shared_ptr<compute> aCompute) : pipeline() {
@@ -1029,6 +920,7 @@ namespace geodesy::gpu {
 		this->CreateInfo	= aCompute;
 		this->Context		= aContext;
 		this->BindPoint		= VK_PIPELINE_BIND_POINT_COMPUTE;
+		this->Cache			= aContext->PipelineCache;
 
 		// Create Respective Shader Modules.
 		Result = this->shader_stage_create(aCompute);
@@ -1045,25 +937,36 @@ namespace geodesy::gpu {
 		CPCI.basePipelineHandle			= VK_NULL_HANDLE;
 		CPCI.basePipelineIndex			= 0;
 
-		Result = vkCreateComputePipelines(aContext->Handle, this->Cache, 1, &CPCI, NULL, &this->Handle);
+		{
+			std::shared_lock<std::shared_mutex> Lock(aContext->PipelineCacheMutex);
+			Result = vkCreateComputePipelines(aContext->Handle, this->Cache, 1, &CPCI, NULL, &this->Handle);
+		}
+
+		this->Ready = (Result == VK_SUCCESS);
 	}
 
 	pipeline::~pipeline() {
 		PFN_vkDestroyPipeline vkDestroyPipeline = (PFN_vkDestroyPipeline)this->Context->function_pointer("vkDestroyPipeline");
-		PFN_vkDestroyPipelineCache vkDestroyPipelineCache = (PFN_vkDestroyPipelineCache)this->Context->function_pointer("vkDestroyPipelineCache");
 		PFN_vkDestroyPipelineLayout vkDestroyPipelineLayout = (PFN_vkDestroyPipelineLayout)this->Context->function_pointer("vkDestroyPipelineLayout");
 		PFN_vkDestroyDescriptorPool vkDestroyDescriptorPool = (PFN_vkDestroyDescriptorPool)this->Context->function_pointer("vkDestroyDescriptorPool");
 		PFN_vkDestroyDescriptorSetLayout vkDestroyDescriptorSetLayout = (PFN_vkDestroyDescriptorSetLayout)this->Context->function_pointer("vkDestroyDescriptorSetLayout");
 		PFN_vkDestroyShaderModule vkDestroyShaderModule = (PFN_vkDestroyShaderModule)this->Context->function_pointer("vkDestroyShaderModule");
-		PFN_vkDestroyRenderPass vkDestroyRenderPass = (PFN_vkDestroyRenderPass)this->Context->function_pointer("vkDestroyRenderPass");
+
+		// Background link references the layout and render pass, finish it first.
+		if (this->Optimized.valid()) {
+			VkPipeline OptimizedHandle = this->Optimized.get();
+			if (OptimizedHandle != VK_NULL_HANDLE) {
+				vkDestroyPipeline(this->Context->Handle, OptimizedHandle, NULL);
+			}
+		}
+		for (VkPipeline RetiredHandle : this->Retired) {
+			vkDestroyPipeline(this->Context->Handle, RetiredHandle, NULL);
+		}
 
 		// Delete all vulkan allocated resources.
 		if (this->Handle != VK_NULL_HANDLE) {
 			vkDestroyPipeline(this->Context->Handle, this->Handle, NULL);
 		}
-		if (this->Cache != VK_NULL_HANDLE) {
-			vkDestroyPipelineCache(this->Context->Handle, this->Cache, NULL);
-		}
 		if (this->Layout != VK_NULL_HANDLE) {
 			vkDestroyPipelineLayout(this->Context->Handle, this->Layout, NULL);
 		}
@@ -1080,9 +983,97 @@ namespace geodesy::gpu {
 				vkDestroyShaderModule(this->Context->Handle, this->Stage[i].module, NULL);
 			}
 		}
-		if (this->RenderPass != VK_NULL_HANDLE) {
-			vkDestroyRenderPass(this->Context->Handle, this->RenderPass, NULL);
-		}		
+	}
+
+	bool pipeline::is_ready() const {
+		return this->Ready.load(std::memory_order_acquire);
+	}
+
+	pipeline* pipeline::active() {
+		if (this->is_ready()) return this;
+		if ((this->Substitute != nullptr) && this->Substitute->is_ready()) return this->Substitute.get();
+		return nullptr;
+	}
+
+	void pipeline::adopt(pipeline& aPipeline) {
+		// Readers that do not first observe Ready, such as bind() swapping handles, take the same lock.
+		std::lock_guard<std::mutex> Lock(this->Mutex);
+		this->CreateInfo 			= aPipeline.CreateInfo;
+		this->Stage 				= std::move(aPipeline.Stage);
+		this->BindPoint 			= aPipeline.BindPoint;
+		this->Layout 				= aPipeline.Layout;
+		this->Cache 				= aPipeline.Cache;
+		this->Handle 				= aPipeline.Handle;
+		this->DescriptorPool 		= aPipeline.DescriptorPool;
+		this->DescriptorSetLayout 	= std::move(aPipeline.DescriptorSetLayout);
+		this->RenderPass 			= aPipeline.RenderPass;
+		this->Subpass 				= aPipeline.Subpass;
+		this->LayoutKey 			= aPipeline.LayoutKey;
+		this->SharedRenderPass 		= aPipeline.SharedRenderPass;
+		this->ShaderBindingTable 	= aPipeline.ShaderBindingTable;
+		this->Optimized 			= std::move(aPipeline.Optimized);
+		this->Retired 				= std::move(aPipeline.Retired);
+		this->DynamicState 			= std::move(aPipeline.DynamicState);
+		this->ExtendedDynamicState 	= aPipeline.ExtendedDynamicState;
+
+		// Source no longer owns anything.
+		aPipeline.Stage.clear();
+		aPipeline.Retired.clear();
+		aPipeline.Layout 			= VK_NULL_HANDLE;
+		aPipeline.Handle 			= VK_NULL_HANDLE;
+		aPipeline.DescriptorPool 	= VK_NULL_HANDLE;
+		aPipeline.DescriptorSetLayout.clear();
+		aPipeline.RenderPass 		= VK_NULL_HANDLE;
+		aPipeline.Ready 			= false;
+
+		// Release so recording threads observe every field above once Ready reads true, none change after that.
+		this->Ready.store(this->Handle != VK_NULL_HANDLE, std::memory_order_release);
+	}
+
+	void pipeline::apply_dynamic_state(command_buffer* aCommandBuffer) {
+		std::shared_ptr<rasterizer> Rasterizer = std::dynamic_pointer_cast<rasterizer>(this->CreateInfo);
+		if ((Rasterizer == nullptr) || !this->ExtendedDynamicState) return;
+
+		command_buffer::dynamic_state Override;
+		auto It = aCommandBuffer->DynamicState.find(this);
+		if (It != aCommandBuffer->DynamicState.end()) {
+			Override = It->second;
+		}
+
+		VkCommandBuffer Handle = aCommandBuffer->Handle;
+		if (this->DynamicState.count(VK_DYNAMIC_STATE_CULL_MODE_EXT) > 0) {
+			PFN_vkCmdSetCullModeEXT vkCmdSetCullModeEXT = (PFN_vkCmdSetCullModeEXT)this->Context->function_pointer("vkCmdSetCullModeEXT");
+			PFN_vkCmdSetFrontFaceEXT vkCmdSetFrontFaceEXT = (PFN_vkCmdSetFrontFaceEXT)this->Context->function_pointer("vkCmdSetFrontFaceEXT");
+			PFN_vkCmdSetPrimitiveTopologyEXT vkCmdSetPrimitiveTopologyEXT = (PFN_vkCmdSetPrimitiveTopologyEXT)this->Context->function_pointer("vkCmdSetPrimitiveTopologyEXT");
+			PFN_vkCmdSetDepthTestEnableEXT vkCmdSetDepthTestEnableEXT = (PFN_vkCmdSetDepthTestEnableEXT)this->Context->function_pointer("vkCmdSetDepthTestEnableEXT");
+			PFN_vkCmdSetDepthWriteEnableEXT vkCmdSetDepthWriteEnableEXT = (PFN_vkCmdSetDepthWriteEnableEXT)this->Context->function_pointer("vkCmdSetDepthWriteEnableEXT");
+			PFN_vkCmdSetDepthCompareOpEXT vkCmdSetDepthCompareOpEXT = (PFN_vkCmdSetDepthCompareOpEXT)this->Context->function_pointer("vkCmdSetDepthCompareOpEXT");
+			vkCmdSetCullModeEXT(Handle, Override.CullMode.value_or(Rasterizer->CullMode));
+			vkCmdSetFrontFaceEXT(Handle, Override.FrontFace.value_or(Rasterizer->FrontFace));
+			vkCmdSetPrimitiveTopologyEXT(Handle, Override.PrimitiveTopology.value_or(Rasterizer->PrimitiveTopology));
+			vkCmdSetDepthTestEnableEXT(Handle, Override.DepthTestEnable.value_or(Rasterizer->DepthTestEnable));
+			vkCmdSetDepthWriteEnableEXT(Handle, Override.DepthWriteEnable.value_or(Rasterizer->DepthWriteEnable));
+			vkCmdSetDepthCompareOpEXT(Handle, Override.DepthCompareOp.value_or(Rasterizer->DepthCompareOp));
+		}
+		if (this->DynamicState.count(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT) > 0) {
+			PFN_vkCmdSetPrimitiveRestartEnableEXT vkCmdSetPrimitiveRestartEnableEXT = (PFN_vkCmdSetPrimitiveRestartEnableEXT)this->Context->function_pointer("vkCmdSetPrimitiveRestartEnableEXT");
+			vkCmdSetPrimitiveRestartEnableEXT(Handle, Override.PrimitiveRestartEnable.value_or(false));
+		}
+		if (this->DynamicState.count(VK_DYNAMIC_STATE_POLYGON_MODE_EXT) > 0) {
+			PFN_vkCmdSetPolygonModeEXT vkCmdSetPolygonModeEXT = (PFN_vkCmdSetPolygonModeEXT)this->Context->function_pointer("vkCmdSetPolygonModeEXT");
+			vkCmdSetPolygonModeEXT(Handle, Override.PolygonMode.value_or(Rasterizer->PolygonMode));
+		}
+		if (this->DynamicState.count(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT) > 0) {
+			PFN_vkCmdSetColorBlendEnableEXT vkCmdSetColorBlendEnableEXT = (PFN_vkCmdSetColorBlendEnableEXT)this->Context->function_pointer("vkCmdSetColorBlendEnableEXT");
+			std::vector<VkBool32> BlendEnable(Rasterizer->AttachmentBlendingRules.size());
+			for (size_t i = 0; i < BlendEnable.size(); i++) {
+				BlendEnable[i] = Rasterizer->AttachmentBlendingRules[i].blendEnable;
+				if (Override.BlendEnable.count(i) > 0) {
+					BlendEnable[i] = Override.BlendEnable[i];
+				}
+			}
+			vkCmdSetColorBlendEnableEXT(Handle, 0, BlendEnable.size(), BlendEnable.data());
+		}
 	}
 
 	void pipeline::bind(
@@ -1096,8 +1087,29 @@ namespace geodesy::gpu {
 		PFN_vkCmdBindDescriptorSets vkCmdBindDescriptorSets = (PFN_vkCmdBindDescriptorSets)this->Context->function_pointer("vkCmdBindDescriptorSets");
 		PFN_vkCmdBindVertexBuffers vkCmdBindVertexBuffers = (PFN_vkCmdBindVertexBuffers)this->Context->function_pointer("vkCmdBindVertexBuffers");
 		PFN_vkCmdBindIndexBuffer vkCmdBindIndexBuffer = (PFN_vkCmdBindIndexBuffer)this->Context->function_pointer("vkCmdBindIndexBuffer");
+		// Still compiling, bind substitute or nothing.
+		pipeline* Active = this->active();
+		if (Active == nullptr) return;
+		if (Active != this) {
+			Active->bind(aCommandBuffer, aVertexBuffer, aIndexBuffer, aDescriptorArray);
+			return;
+		}
+		// Swap in the optimized link once finished, the fast linked handle is retired.
+		VkPipeline Handle = VK_NULL_HANDLE;
+		{
+			std::lock_guard<std::mutex> Lock(this->Mutex);
+			if (this->Optimized.valid() && (this->Optimized.wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+				VkPipeline OptimizedHandle = this->Optimized.get();
+				if (OptimizedHandle != VK_NULL_HANDLE) {
+					this->Retired.push_back(this->Handle);
+					this->Handle = OptimizedHandle;
+				}
+			}
+			Handle = this->Handle;
+		}
 		// Bind resources to pipeline.
-		vkCmdBindPipeline(aCommandBuffer->Handle, this->BindPoint, this->Handle);
+		vkCmdBindPipeline(aCommandBuffer->Handle, this->BindPoint, Handle);
+		this->apply_dynamic_state(aCommandBuffer);
 		if ((aDescriptorArray != nullptr) ? (aDescriptorArray->DescriptorSet.size() > 0) : false) {
 			vkCmdBindDescriptorSets(aCommandBuffer->Handle, this->BindPoint, this->Layout, 0, aDescriptorArray->DescriptorSet.size(), aDescriptorArray->DescriptorSet.data(), 0, NULL);
 		}
@@ -1122,10 +1134,34 @@ namespace geodesy::gpu {
 		VkSubpassContents 				aSubpassContents
 	) {
 		PFN_vkCmdBeginRenderPass vkCmdBeginRenderPass = (PFN_vkCmdBeginRenderPass)this->Context->function_pointer("vkCmdBeginRenderPass");
+		// Nothing to render with yet, remember so the matching end() is skipped too.
+		pipeline* Active = this->active();
+		aCommandBuffer->RenderPassSkipped = (Active == nullptr);
+		if (Active == nullptr) return;
+		std::shared_ptr<rasterizer> Rasterizer = std::dynamic_pointer_cast<rasterizer>(Active->CreateInfo);
+
+		// Attachments are brought into the initial layout the render pass expects, and tracked in their final layout by end().
+		std::vector<command_buffer::rendering_attachment> Attachment;
+		barrier_batch Barrier;
+		for (size_t i = 0; i < aFramebuffer->Image.size(); i++) {
+			bool IsColor = (i < Rasterizer->ColorAttachment.size());
+			const VkAttachmentDescription& Description = IsColor ? Rasterizer->ColorAttachment[i].Description : Rasterizer->DepthStencilAttachment.Description;
+			if (!IsColor && (Description.format == VK_FORMAT_UNDEFINED)) break;
+			if (Description.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+				VkAccessFlags Access = IsColor ? (VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT) : (VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+				VkPipelineStageFlags Stage = IsColor ? VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT : (VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT);
+				aFramebuffer->Image[i]->require(Barrier, (image::layout)Description.initialLayout, Access, Stage, 0, 1, 0, 1);
+			}
+			Attachment.push_back({ aFramebuffer->Image[i], Description.initialLayout, Description.finalLayout });
+		}
+		Barrier.record(aCommandBuffer);
+		aCommandBuffer->RenderingScope 			= false;
+		aCommandBuffer->RenderingAttachment 	= std::move(Attachment);
+
 		VkRenderPassBeginInfo RPBI{};
 		RPBI.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 		RPBI.pNext				= NULL;
-		RPBI.renderPass			= this->RenderPass;
+		RPBI.renderPass			= Active->RenderPass;
 		RPBI.framebuffer		= aFramebuffer->Handle;
 		RPBI.renderArea			= aRenderArea;
 		RPBI.clearValueCount	= aFramebuffer->ClearValue.size();
@@ -1146,33 +1182,316 @@ namespace geodesy::gpu {
 		// described sections of pixels, but anything outside of the render area will be ignored. Scissor operations act as a union 
 		// on a pipeline level, but with the render area, what ever region of pixels the scissors choose, it must ultimately be inside 
 		// the render area?
-		PFN_vkCmdDrawIndexed vkCmdDrawIndexed = (PFN_vkCmdDrawIndexed)this->Context->function_pointer("vkCmdDrawIndexed");
-		PFN_vkCmdSetViewport vkCmdSetViewport = (PFN_vkCmdSetViewport)this->Context->function_pointer("vkCmdSetViewport");
-		PFN_vkCmdSetScissor vkCmdSetScissor = (PFN_vkCmdSetScissor)this->Context->function_pointer("vkCmdSetScissor");
-		PFN_vkCmdDraw vkCmdDraw = (PFN_vkCmdDraw)this->Context->function_pointer("vkCmdDraw");
+		// Skip the draw, or record the substitute, until compilation finishes.
+		pipeline* Active = this->active();
+		if (Active == nullptr) return;
+		if (Active != this) {
+			Active->rasterize(aCommandBuffer, aFramebuffer, aResolution, aVertexBuffer, aIndexBuffer, aDescriptorArray);
+			return;
+		}
 		// TODO: This can be expanded for multiple viewports and scissors later.
 		// Determines the render area for the render pass.
 		VkRect2D RenderArea 	= { { 0, 0 }, { aResolution[0], aResolution[1] } };
+		this->begin(aCommandBuffer, aFramebuffer, RenderArea);
+		this->record_draw(aCommandBuffer, aResolution, aVertexBuffer, aIndexBuffer, aDescriptorArray);
+		this->end(aCommandBuffer);
+	}
+
+	void pipeline::begin(
+		command_buffer* 						aCommandBuffer,
+		std::vector<std::shared_ptr<image>> 	aImage,
+		VkRect2D 								aRenderArea,
+		std::vector<VkClearValue> 				aClearValue,
+		VkSubpassContents 						aSubpassContents
+	) {
+		PFN_vkCmdBeginRendering vkCmdBeginRendering = (PFN_vkCmdBeginRendering)this->Context->function_pointer("vkCmdBeginRendering");
+		if (vkCmdBeginRendering == NULL) {
+			// Pre 1.3 device with VK_KHR_dynamic_rendering.
+			vkCmdBeginRendering = (PFN_vkCmdBeginRendering)this->Context->function_pointer("vkCmdBeginRenderingKHR");
+		}
+		// Nothing to render with yet, remember so the matching end() is skipped too.
+		pipeline* Active = this->active();
+		aCommandBuffer->RenderPassSkipped = (Active == nullptr);
+		if (Active == nullptr) return;
+		std::shared_ptr<rasterizer> Rasterizer = std::dynamic_pointer_cast<rasterizer>(Active->CreateInfo);
+
+		std::vector<command_buffer::rendering_attachment> Attachment;
+		std::vector<VkRenderingAttachmentInfo> ColorAttachment;
+		VkRenderingAttachmentInfo DepthAttachment{};
+		bool DepthExists = false;
+		barrier_batch Barrier;
+		for (size_t i = 0; i < aImage.size(); i++) {
+			bool IsColor = (i < Rasterizer->ColorAttachment.size());
+			const VkAttachmentDescription& Description = IsColor ? Rasterizer->ColorAttachment[i].Description : Rasterizer->DepthStencilAttachment.Description;
+			if (!IsColor && (Description.format == VK_FORMAT_UNDEFINED)) break;
+
+			// What a render pass would have done on load, made available from whatever last touched the image.
+			image::layout Layout = IsColor ? image::layout::COLOR_ATTACHMENT_OPTIMAL : image::layout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+			VkAccessFlags Access = IsColor ? (VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT) : (VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+			VkPipelineStageFlags Stage = IsColor ? VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT : (VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT);
+			aImage[i]->require(Barrier, Layout, Access, Stage, 0, 1, 0, 1);
+			Attachment.push_back({ aImage[i], (VkImageLayout)Layout, Description.finalLayout });
+
+			VkRenderingAttachmentInfo RAI{};
+			RAI.sType 					= VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+			RAI.pNext 					= NULL;
+			RAI.imageView 				= aImage[i]->View;
+			RAI.imageLayout 			= (VkImageLayout)Layout;
+			RAI.resolveMode 			= VK_RESOLVE_MODE_NONE;
+			RAI.resolveImageView 		= VK_NULL_HANDLE;
+			RAI.resolveImageLayout 		= VK_IMAGE_LAYOUT_UNDEFINED;
+			RAI.loadOp 					= Description.loadOp;
+			RAI.storeOp 				= Description.storeOp;
+			if (i < aClearValue.size()) {
+				RAI.clearValue 				= aClearValue[i];
+			}
+			else if (IsColor) {
+				RAI.clearValue.color 		= { 0.0f, 0.0f, 0.0f, 1.0f };
+			}
+			else {
+				RAI.clearValue.depthStencil = { 1.0f, 0 };
+			}
+
+			if (IsColor) {
+				ColorAttachment.push_back(RAI);
+			}
+			else {
+				DepthAttachment = RAI;
+				DepthExists = true;
+			}
+		}
+
+		VkRenderingInfo RI{};
+		RI.sType 					= VK_STRUCTURE_TYPE_RENDERING_INFO;
+		RI.pNext 					= NULL;
+		RI.flags 					= (aSubpassContents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0;
+		RI.renderArea 				= aRenderArea;
+		RI.layerCount 				= 1;
+		RI.viewMask 				= 0;
+		RI.colorAttachmentCount 	= ColorAttachment.size();
+		RI.pColorAttachments 		= ColorAttachment.data();
+		RI.pDepthAttachment 		= NULL;
+		RI.pStencilAttachment 		= NULL;
+		if (DepthExists) {
+			VkImageAspectFlags Aspect = image::aspect_flag(Rasterizer->DepthStencilAttachment.Description.format);
+			if (Aspect & VK_IMAGE_ASPECT_DEPTH_BIT) {
+				RI.pDepthAttachment 		= &DepthAttachment;
+			}
+			if (Aspect & VK_IMAGE_ASPECT_STENCIL_BIT) {
+				RI.pStencilAttachment 		= &DepthAttachment;
+			}
+		}
+
+		Barrier.record(aCommandBuffer);
+		aCommandBuffer->RenderingScope 			= true;
+		aCommandBuffer->RenderingAttachment 	= std::move(Attachment);
+		vkCmdBeginRendering(aCommandBuffer->Handle, &RI);
+	}
+
+	void pipeline::rasterize(
+		command_buffer* 											aCommandBuffer,
+		std::vector<std::shared_ptr<image>> 						aImage,
+		std::array<unsigned int, 3> 								aResolution,
+		std::vector<std::shared_ptr<buffer>> 						aVertexBuffer,
+		std::shared_ptr<buffer> 									aIndexBuffer,
+		std::shared_ptr<descriptor::array> 							aDescriptorArray
+	) {
+		// Skip the draw, or record the substitute, until compilation finishes.
+		pipeline* Active = this->active();
+		if (Active == nullptr) return;
+		if (Active != this) {
+			Active->rasterize(aCommandBuffer, aImage, aResolution, aVertexBuffer, aIndexBuffer, aDescriptorArray);
+			return;
+		}
+		VkRect2D RenderArea 	= { { 0, 0 }, { aResolution[0], aResolution[1] } };
+		this->begin(aCommandBuffer, aImage, RenderArea);
+		this->record_draw(aCommandBuffer, aResolution, aVertexBuffer, aIndexBuffer, aDescriptorArray);
+		this->end(aCommandBuffer);
+	}
+
+	void pipeline::end(command_buffer* aCommandBuffer) {
+		PFN_vkCmdEndRenderPass vkCmdEndRenderPass = (PFN_vkCmdEndRenderPass)this->Context->function_pointer("vkCmdEndRenderPass");
+		PFN_vkCmdEndRendering vkCmdEndRendering = (PFN_vkCmdEndRendering)this->Context->function_pointer("vkCmdEndRendering");
+		if (vkCmdEndRendering == NULL) {
+			vkCmdEndRendering = (PFN_vkCmdEndRendering)this->Context->function_pointer("vkCmdEndRenderingKHR");
+		}
+		// Matching begin() was skipped, even if the pipeline became ready since.
+		if (aCommandBuffer->RenderPassSkipped) {
+			aCommandBuffer->RenderPassSkipped = false;
+			return;
+		}
+		if (!aCommandBuffer->RenderingScope) {
+			vkCmdEndRenderPass(aCommandBuffer->Handle);
+			// The render pass transitioned its attachments to their final layouts, after the attachment writes.
+			for (const command_buffer::rendering_attachment& Target : aCommandBuffer->RenderingAttachment) {
+				bool IsColor = (image::aspect_flag(Target.Image->CreateInfo.format) & (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) == 0;
+				VkAccessFlags Access = IsColor ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+				VkPipelineStageFlags Stage = IsColor ? VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT : VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+				Target.Image->track((image::layout)Target.FinalLayout, Access, Stage, 0, 1, 0, 1);
+			}
+			aCommandBuffer->RenderingAttachment.clear();
+			return;
+		}
+		vkCmdEndRendering(aCommandBuffer->Handle);
+		// Final layout transition a render pass would have done, ordered after the attachment writes tracked at begin().
+		barrier_batch Barrier;
+		for (const command_buffer::rendering_attachment& Target : aCommandBuffer->RenderingAttachment) {
+			if ((Target.FinalLayout != Target.Layout) && (Target.FinalLayout != VK_IMAGE_LAYOUT_UNDEFINED)) {
+				Target.Image->require(Barrier, (image::layout)Target.FinalLayout, 0, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, 0, 1);
+			}
+		}
+		Barrier.record(aCommandBuffer);
+		aCommandBuffer->RenderingScope = false;
+		aCommandBuffer->RenderingAttachment.clear();
+	}
+
+	void pipeline::set_viewport(command_buffer* aCommandBuffer, std::array<unsigned int, 3> aResolution) {
+		PFN_vkCmdSetViewport vkCmdSetViewport = (PFN_vkCmdSetViewport)this->Context->function_pointer("vkCmdSetViewport");
+		PFN_vkCmdSetScissor vkCmdSetScissor = (PFN_vkCmdSetScissor)this->Context->function_pointer("vkCmdSetScissor");
 		// Determines the viewport output for the pipeline.
 		VkViewport Viewport 	= { 0.0f, 0.0f, (float)aResolution[0], (float)aResolution[1], 0.0f, 1.0f };
 		// Much like render area, determines where fragments will be output to at pipeline level.
 		VkRect2D Scissor 		= { {0, 0}, {aResolution[0], aResolution[1]} };
-		this->begin(aCommandBuffer, aFramebuffer, RenderArea);
-		this->bind(aCommandBuffer, aVertexBuffer, aIndexBuffer, aDescriptorArray);		
 		vkCmdSetViewport(aCommandBuffer->Handle, 0, 1, &Viewport);
 		vkCmdSetScissor(aCommandBuffer->Handle, 0, 1, &Scissor);
-		if (aIndexBuffer != nullptr) {
-			vkCmdDrawIndexed(aCommandBuffer->Handle, aIndexBuffer->ElementCount, 1, 0, 0, 0);
+	}
+
+	void pipeline::draw(command_buffer* aCommandBuffer, draw_parameter aDraw) {
+		PFN_vkCmdDraw vkCmdDraw = (PFN_vkCmdDraw)this->Context->function_pointer("vkCmdDraw");
+		if (this->active() == nullptr) return;
+		vkCmdDraw(aCommandBuffer->Handle, aDraw.Count, aDraw.InstanceCount, aDraw.First, aDraw.FirstInstance);
+	}
+
+	void pipeline::draw_indexed(command_buffer* aCommandBuffer, draw_parameter aDraw) {
+		PFN_vkCmdDrawIndexed vkCmdDrawIndexed = (PFN_vkCmdDrawIndexed)this->Context->function_pointer("vkCmdDrawIndexed");
+		if (this->active() == nullptr) return;
+		vkCmdDrawIndexed(aCommandBuffer->Handle, aDraw.Count, aDraw.InstanceCount, aDraw.First, aDraw.VertexOffset, aDraw.FirstInstance);
+	}
+
+	// True if every draw can go through a single multi draw call.
+	static bool shared_instance_parameters(const std::vector<pipeline::draw_parameter>& aDraw) {
+		for (size_t i = 1; i < aDraw.size(); i++) {
+			if ((aDraw[i].InstanceCount != aDraw[0].InstanceCount) || (aDraw[i].FirstInstance != aDraw[0].FirstInstance)) return false;
 		}
-		else {
-			vkCmdDraw(aCommandBuffer->Handle, aVertexBuffer[0]->ElementCount, 1, 0, 0);
+		return aDraw.size() > 0;
+	}
+
+	void pipeline::draw(command_buffer* aCommandBuffer, const std::vector<draw_parameter>& aDraw) {
+		PFN_vkCmdDraw vkCmdDraw = (PFN_vkCmdDraw)this->Context->function_pointer("vkCmdDraw");
+		PFN_vkCmdDrawMultiEXT vkCmdDrawMultiEXT = (PFN_vkCmdDrawMultiEXT)this->Context->function_pointer("vkCmdDrawMultiEXT");
+		if (this->active() == nullptr) return;
+		if (this->Context->MultiDraw && (vkCmdDrawMultiEXT != NULL) && shared_instance_parameters(aDraw)) {
+			std::vector<VkMultiDrawInfoEXT> MultiDraw(aDraw.size());
+			for (size_t i = 0; i < aDraw.size(); i++) {
+				MultiDraw[i].firstVertex 		= aDraw[i].First;
+				MultiDraw[i].vertexCount 		= aDraw[i].Count;
+			}
+			// A single call may not exceed the device's draw count limit.
+			for (size_t i = 0; i < MultiDraw.size(); i += this->Context->MaxMultiDrawCount) {
+				uint32_t DrawCount = (uint32_t)std::min<size_t>(MultiDraw.size() - i, this->Context->MaxMultiDrawCount);
+				vkCmdDrawMultiEXT(aCommandBuffer->Handle, DrawCount, &MultiDraw[i], aDraw[0].InstanceCount, aDraw[0].FirstInstance, sizeof(VkMultiDrawInfoEXT));
+			}
+			return;
+		}
+		for (const draw_parameter& Draw : aDraw) {
+			vkCmdDraw(aCommandBuffer->Handle, Draw.Count, Draw.InstanceCount, Draw.First, Draw.FirstInstance);
 		}
-		this->end(aCommandBuffer);
 	}
 
-	void pipeline::end(command_buffer* aCommandBuffer) {
-		PFN_vkCmdEndRenderPass vkCmdEndRenderPass = (PFN_vkCmdEndRenderPass)this->Context->function_pointer("vkCmdEndRenderPass");
-		vkCmdEndRenderPass(aCommandBuffer->Handle);
+	void pipeline::draw_indexed(command_buffer* aCommandBuffer, const std::vector<draw_parameter>& aDraw) {
+		PFN_vkCmdDrawIndexed vkCmdDrawIndexed = (PFN_vkCmdDrawIndexed)this->Context->function_pointer("vkCmdDrawIndexed");
+		PFN_vkCmdDrawMultiIndexedEXT vkCmdDrawMultiIndexedEXT = (PFN_vkCmdDrawMultiIndexedEXT)this->Context->function_pointer("vkCmdDrawMultiIndexedEXT");
+		if (this->active() == nullptr) return;
+		if (this->Context->MultiDraw && (vkCmdDrawMultiIndexedEXT != NULL) && shared_instance_parameters(aDraw)) {
+			std::vector<VkMultiDrawIndexedInfoEXT> MultiDraw(aDraw.size());
+			for (size_t i = 0; i < aDraw.size(); i++) {
+				MultiDraw[i].firstIndex 		= aDraw[i].First;
+				MultiDraw[i].indexCount 		= aDraw[i].Count;
+				MultiDraw[i].vertexOffset 		= aDraw[i].VertexOffset;
+			}
+			// Null vertex offset pointer, each draw uses its own. A single call may not exceed the device's draw count limit.
+			for (size_t i = 0; i < MultiDraw.size(); i += this->Context->MaxMultiDrawCount) {
+				uint32_t DrawCount = (uint32_t)std::min<size_t>(MultiDraw.size() - i, this->Context->MaxMultiDrawCount);
+				vkCmdDrawMultiIndexedEXT(aCommandBuffer->Handle, DrawCount, &MultiDraw[i], aDraw[0].InstanceCount, aDraw[0].FirstInstance, sizeof(VkMultiDrawIndexedInfoEXT), NULL);
+			}
+			return;
+		}
+		for (const draw_parameter& Draw : aDraw) {
+			vkCmdDrawIndexed(aCommandBuffer->Handle, Draw.Count, Draw.InstanceCount, Draw.First, Draw.VertexOffset, Draw.FirstInstance);
+		}
+	}
+
+	void pipeline::draw_indirect(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aIndirectBuffer, VkDeviceSize aOffset, uint32_t aDrawCount, uint32_t aStride) {
+		PFN_vkCmdDrawIndirect vkCmdDrawIndirect = (PFN_vkCmdDrawIndirect)this->Context->function_pointer("vkCmdDrawIndirect");
+		if (this->active() == nullptr) return;
+		vkCmdDrawIndirect(aCommandBuffer->Handle, aIndirectBuffer->Handle, aOffset, aDrawCount, aStride);
+	}
+
+	void pipeline::draw_indexed_indirect(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aIndirectBuffer, VkDeviceSize aOffset, uint32_t aDrawCount, uint32_t aStride) {
+		PFN_vkCmdDrawIndexedIndirect vkCmdDrawIndexedIndirect = (PFN_vkCmdDrawIndexedIndirect)this->Context->function_pointer("vkCmdDrawIndexedIndirect");
+		if (this->active() == nullptr) return;
+		vkCmdDrawIndexedIndirect(aCommandBuffer->Handle, aIndirectBuffer->Handle, aOffset, aDrawCount, aStride);
+	}
+
+	void pipeline::draw_indirect_count(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aIndirectBuffer, VkDeviceSize aOffset, std::shared_ptr<buffer> aCountBuffer, VkDeviceSize aCountOffset, uint32_t aMaxDrawCount, uint32_t aStride) {
+		PFN_vkCmdDrawIndirectCount vkCmdDrawIndirectCount = (PFN_vkCmdDrawIndirectCount)this->Context->function_pointer("vkCmdDrawIndirectCount");
+		if (vkCmdDrawIndirectCount == NULL) {
+			// Pre 1.2 device with VK_KHR_draw_indirect_count.
+			vkCmdDrawIndirectCount = (PFN_vkCmdDrawIndirectCount)this->Context->function_pointer("vkCmdDrawIndirectCountKHR");
+		}
+		if (this->active() == nullptr) return;
+		vkCmdDrawIndirectCount(aCommandBuffer->Handle, aIndirectBuffer->Handle, aOffset, aCountBuffer->Handle, aCountOffset, aMaxDrawCount, aStride);
+	}
+
+	void pipeline::draw_indexed_indirect_count(command_buffer* aCommandBuffer, std::shared_ptr<buffer> aIndirectBuffer, VkDeviceSize aOffset, std::shared_ptr<buffer> aCountBuffer, VkDeviceSize aCountOffset, uint32_t aMaxDrawCount, uint32_t aStride) {
+		PFN_vkCmdDrawIndexedIndirectCount vkCmdDrawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCount)this->Context->function_pointer("vkCmdDrawIndexedIndirectCount");
+		if (vkCmdDrawIndexedIndirectCount == NULL) {
+			vkCmdDrawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCount)this->Context->function_pointer("vkCmdDrawIndexedIndirectCountKHR");
+		}
+		if (this->active() == nullptr) return;
+		vkCmdDrawIndexedIndirectCount(aCommandBuffer->Handle, aIndirectBuffer->Handle, aOffset, aCountBuffer->Handle, aCountOffset, aMaxDrawCount, aStride);
+	}
+
+	void pipeline::set_cull_mode(command_buffer* aCommandBuffer, VkCullModeFlags aCullMode) {
+		aCommandBuffer->DynamicState[this].CullMode = aCullMode;
+		this->apply_dynamic_state(aCommandBuffer);
+	}
+
+	void pipeline::set_front_face(command_buffer* aCommandBuffer, VkFrontFace aFrontFace) {
+		aCommandBuffer->DynamicState[this].FrontFace = aFrontFace;
+		this->apply_dynamic_state(aCommandBuffer);
+	}
+
+	void pipeline::set_primitive_topology(command_buffer* aCommandBuffer, VkPrimitiveTopology aPrimitiveTopology) {
+		aCommandBuffer->DynamicState[this].PrimitiveTopology = aPrimitiveTopology;
+		this->apply_dynamic_state(aCommandBuffer);
+	}
+
+	void pipeline::set_depth_test(command_buffer* aCommandBuffer, bool aDepthTestEnable, bool aDepthWriteEnable, VkCompareOp aDepthCompareOp) {
+		command_buffer::dynamic_state& Override = aCommandBuffer->DynamicState[this];
+		Override.DepthTestEnable 	= aDepthTestEnable;
+		Override.DepthWriteEnable 	= aDepthWriteEnable;
+		Override.DepthCompareOp 	= aDepthCompareOp;
+		this->apply_dynamic_state(aCommandBuffer);
+	}
+
+	void pipeline::set_primitive_restart(command_buffer* aCommandBuffer, bool aPrimitiveRestartEnable) {
+		aCommandBuffer->DynamicState[this].PrimitiveRestartEnable = aPrimitiveRestartEnable;
+		this->apply_dynamic_state(aCommandBuffer);
+	}
+
+	void pipeline::set_polygon_mode(command_buffer* aCommandBuffer, VkPolygonMode aPolygonMode) {
+		aCommandBuffer->DynamicState[this].PolygonMode = aPolygonMode;
+		this->apply_dynamic_state(aCommandBuffer);
+	}
+
+	void pipeline::set_blend_enable(command_buffer* aCommandBuffer, uint32_t aAttachmentIndex, bool aBlendEnable) {
+		aCommandBuffer->DynamicState[this].BlendEnable[aAttachmentIndex] = aBlendEnable;
+		this->apply_dynamic_state(aCommandBuffer);
+	}
+
+	void pipeline::clear_dynamic_state(command_buffer* aCommandBuffer) {
+		aCommandBuffer->DynamicState.erase(this);
 	}
 
 	void pipeline::raytrace(
@@ -1181,6 +1500,12 @@ namespace geodesy::gpu {
 		std::shared_ptr<descriptor::array> 							aDescriptorArray
 	) {
 		PFN_vkCmdTraceRaysKHR vkCmdTraceRaysKHR = (PFN_vkCmdTraceRaysKHR)this->Context->function_pointer("vkCmdTraceRaysKHR");
+		pipeline* Active = this->active();
+		if (Active == nullptr) return;
+		if (Active != this) {
+			Active->raytrace(aCommandBuffer, aResolution, aDescriptorArray);
+			return;
+		}
 		this->bind(aCommandBuffer, {}, nullptr, aDescriptorArray);
 		vkCmdTraceRaysKHR(
 			aCommandBuffer->Handle, 
@@ -1200,6 +1525,12 @@ namespace geodesy::gpu {
 		std::shared_ptr<descriptor::array> 							aDescriptorArray
 	) {
 		PFN_vkCmdDispatch vkCmdDispatch = (PFN_vkCmdDispatch)this->Context->function_pointer("vkCmdDispatch");
+		pipeline* Active = this->active();
+		if (Active == nullptr) return;
+		if (Active != this) {
+			Active->dispatch(aCommandBuffer, aThreadGroupCount, aDescriptorArray);
+			return;
+		}
 		this->bind(aCommandBuffer, {}, nullptr, aDescriptorArray);
 		vkCmdDispatch(aCommandBuffer->Handle, aThreadGroupCount[0], aThreadGroupCount[1], aThreadGroupCount[2]);
 	}
@@ -1211,6 +1542,9 @@ namespace geodesy::gpu {
 		std::shared_ptr<buffer> 									aIndexBuffer,
 		std::shared_ptr<descriptor::array> 							aDescriptorArray
 	) {
+		// Immediate mode never falls back to a substitute.
+		if (!this->is_ready()) return VK_NOT_READY;
+
 		VkResult Result = VK_SUCCESS;
 
 		auto CommandPool = this->Context->create<command_pool>(device::operation::GRAPHICS);
@@ -1232,6 +1566,9 @@ namespace geodesy::gpu {
 		std::shared_ptr<buffer> 									aIndexBuffer,
 		std::map<std::pair<int, int>, std::shared_ptr<resource>> 	aUniformSetBinding
 	) {
+		// Immediate mode never falls back to a substitute.
+		if (!this->is_ready()) return VK_NOT_READY;
+
 		// Error code tracking.
 		VkResult Result = VK_SUCCESS;
 
@@ -1241,7 +1578,11 @@ namespace geodesy::gpu {
 		// Allocated GPU Resources needed to execute.
 		auto CommandPool = this->Context->create<command_pool>(device::operation::GRAPHICS);
 		auto CommandBuffer = CommandPool->create<command_buffer>();
-		auto Framebuffer = this->Context->create<framebuffer>(this->shared_from_this(), aImage, aResolution);
+		// Dynamic rendering pipelines have no render pass, so no framebuffer is needed.
+		std::shared_ptr<framebuffer> Framebuffer = nullptr;
+		if (this->RenderPass != VK_NULL_HANDLE) {
+			Framebuffer = this->Context->create_framebuffer(this->RenderPass, aImage, aResolution);
+		}
 		auto DescriptorArray = this->Context->create<descriptor::array>(this->shared_from_this());
 
 		// Bind Resources to Descriptor Sets
@@ -1267,7 +1608,12 @@ namespace geodesy::gpu {
 
 		// Write Command Buffer here.
 		Result = CommandBuffer->begin();
-		this->rasterize(CommandBuffer.get(), Framebuffer, aResolution, aVertexBuffer, aIndexBuffer, DescriptorArray);
+		if (Framebuffer != nullptr) {
+			this->rasterize(CommandBuffer.get(), Framebuffer, aResolution, aVertexBuffer, aIndexBuffer, DescriptorArray);
+		}
+		else {
+			this->rasterize(CommandBuffer.get(), aImage, aResolution, aVertexBuffer, aIndexBuffer, DescriptorArray);
+		}
 		Result = CommandBuffer->end();
 
 		// Execute Command Buffer here.
@@ -1282,6 +1628,9 @@ namespace geodesy::gpu {
 		std::array<unsigned int, 3> 								aResolution,
 		std::map<std::pair<int, int>, std::shared_ptr<resource>> 	aUniformSetBinding
 	) {
+		// Immediate mode never falls back to a substitute.
+		if (!this->is_ready()) return VK_NOT_READY;
+
 		VkResult Result = VK_SUCCESS;
 		
 		auto CommandPool = this->Context->create<command_pool>(device::operation::GRAPHICS);
@@ -1323,13 +1672,16 @@ namespace geodesy::gpu {
 		std::array<unsigned int, 3> 								aThreadGroupCount,
 		std::shared_ptr<descriptor::array> 							aDescriptorArray
 	) {
+		// Immediate mode never falls back to a substitute.
+		if (!this->is_ready()) return VK_NOT_READY;
+
 		VkResult Result = VK_SUCCESS;
 		
 		auto CommandPool = this->Context->create<command_pool>(device::operation::COMPUTE);
 		auto CommandBuffer = CommandPool->create<command_buffer>();
 
 		Result = CommandBuffer->begin();
-		this->raytrace(CommandBuffer.get(), aThreadGroupCount, aDescriptorArray);
+		this->dispatch(CommandBuffer.get(), aThreadGroupCount, aDescriptorArray);
 		Result = CommandBuffer->end();
 
 		// Execute Command Buffer here.
@@ -1342,6 +1694,9 @@ namespace geodesy::gpu {
 		std::array<unsigned int, 3> 								aThreadGroupCount,
 		std::map<std::pair<int, int>, std::shared_ptr<resource>> 	aUniformSetBinding
 	) {
+		// Immediate mode never falls back to a substitute.
+		if (!this->is_ready()) return VK_NOT_READY;
+
 		VkResult Result = VK_SUCCESS;
 		
 		auto CommandPool = this->Context->create<command_pool>(device::operation::COMPUTE);
@@ -1370,7 +1725,7 @@ namespace geodesy::gpu {
 		}
 
 		Result = CommandBuffer->begin();
-		this->raytrace(CommandBuffer.get(), aThreadGroupCount, DescriptorArray);
+		this->dispatch(CommandBuffer.get(), aThreadGroupCount, DescriptorArray);
 		Result = CommandBuffer->end();
 
 		// Execute Command Buffer here.
@@ -1379,6 +1734,23 @@ namespace geodesy::gpu {
 		return Result;
 	}
 
+	void pipeline::record_draw(
+		command_buffer* 											aCommandBuffer,
+		std::array<unsigned int, 3> 								aResolution,
+		std::vector<std::shared_ptr<buffer>> 						aVertexBuffer,
+		std::shared_ptr<buffer> 									aIndexBuffer,
+		std::shared_ptr<descriptor::array> 							aDescriptorArray
+	) {
+		this->bind(aCommandBuffer, aVertexBuffer, aIndexBuffer, aDescriptorArray);		
+		this->set_viewport(aCommandBuffer, aResolution);
+		if (aIndexBuffer != nullptr) {
+			this->draw_indexed(aCommandBuffer, draw_parameter{ (uint32_t)aIndexBuffer->ElementCount, 1, 0, 0, 0 });
+		}
+		else {
+			this->draw(aCommandBuffer, draw_parameter{ (uint32_t)aVertexBuffer[0]->ElementCount, 1, 0, 0, 0 });
+		}
+	}
+
 	std::vector<VkDescriptorPoolSize> pipeline::descriptor_pool_sizes() const {
 		std::map<VkDescriptorType, uint32_t> DescriptorTypeCount = this->descriptor_type_count();
 		// Convert to pool size to vector data structure.
@@ -1412,6 +1784,476 @@ namespace geodesy::gpu {
 		return this->CreateInfo->DescriptorSetLayoutBinding;
 	}
 
+	VkResult pipeline::prepare(std::shared_ptr<context> aContext, std::shared_ptr<rasterizer> aRasterizer, VkRenderPass aRenderPass, uint32_t aSubpassIndex) {
+		VkResult Result = VK_SUCCESS;
+
+		this->CreateInfo 	= aRasterizer;
+		this->Context		= aContext;
+		this->BindPoint		= VK_PIPELINE_BIND_POINT_GRAPHICS;
+		this->Cache			= aContext->PipelineCache;
+
+		// Render pass, dynamic rendering only needs the attachment formats at pipeline creation. A caller
+		// supplied render pass is used as is, otherwise a compatible one is shared through the context.
+		if (aRenderPass != VK_NULL_HANDLE) {
+			this->RenderPass 	= aRenderPass;
+			this->Subpass 		= aSubpassIndex;
+		}
+		else if (!aContext->DynamicRendering) {
+			std::vector<VkAttachmentDescription> ColorAttachment(aRasterizer->ColorAttachment.size());
+			for (size_t i = 0; i < aRasterizer->ColorAttachment.size(); i++) {
+				ColorAttachment[i] = aRasterizer->ColorAttachment[i].Description;
+			}
+			this->RenderPass = aContext->create_render_pass(ColorAttachment, aRasterizer->DepthStencilAttachment.Description);
+			this->SharedRenderPass = true;
+			if (this->RenderPass == VK_NULL_HANDLE) {
+				Result = VK_ERROR_INITIALIZATION_FAILED;
+			}
+		}
+
+		// Create Respective Shader Modules.
+		if (Result == VK_SUCCESS) {
+			Result = this->shader_stage_create(aRasterizer);
+		}
+
+		// Generate Descriptor Set Layouts from Meta Data gathered from shaders.
+		if (Result == VK_SUCCESS) {
+			Result = this->create_pipeline_layout(aRasterizer->DescriptorSetLayoutBinding);
+		}
+
+		return Result;
+	}
+
+	void pipeline::create_rasterizer_state(rasterizer_state& aState, std::shared_ptr<rasterizer> aRasterizer) {
+		bool TesselationControlShaderExists = false;
+		bool TesselationEvaluationShaderExists = false;
+		for (std::shared_ptr<shader> Shdr : aRasterizer->Shader) {
+			if (Shdr->Stage == shader::stage::TESSELLATION_CONTROL) {
+				TesselationControlShaderExists = true;
+			}
+			if (Shdr->Stage == shader::stage::TESSELLATION_EVALUATION) {
+				TesselationEvaluationShaderExists = true;
+			}
+		}
+
+		// Load attributes from aRasterizer->
+		aState.VertexAttributeDescription.clear();
+		for (rasterizer::attribute& Attribute : aRasterizer->VertexAttribute) {
+			aState.VertexAttributeDescription.push_back(Attribute.Description);
+		}
+
+		// Loading Vertex Binding & Attribute Data
+		aState.Input = {};
+		aState.Input.sType											= VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		aState.Input.pNext											= NULL;
+		aState.Input.flags											= 0;
+		aState.Input.vertexBindingDescriptionCount					= aRasterizer->VertexBufferBindingDescription.size();
+		aState.Input.pVertexBindingDescriptions						= aRasterizer->VertexBufferBindingDescription.data();
+		aState.Input.vertexAttributeDescriptionCount				= aState.VertexAttributeDescription.size();
+		aState.Input.pVertexAttributeDescriptions					= aState.VertexAttributeDescription.data();
+
+		// Vulkan Objects
+		aState.InputAssembly = {};
+		aState.Tesselation = {};
+		aState.Viewport = {};
+		aState.Rasterizer = {};
+		aState.Multisample = {};
+		aState.DepthStencil = {};
+		aState.ColorBlend = {};
+		aState.DynamicState = {};
+
+		aState.InputAssembly.sType 							= VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		aState.InputAssembly.pNext 							= NULL;
+		aState.InputAssembly.flags 							= 0;
+		aState.InputAssembly.topology 						= aRasterizer->PrimitiveTopology;
+		aState.InputAssembly.primitiveRestartEnable 		= VK_FALSE;
+
+		aState.Tesselation.sType 							= VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+		aState.Tesselation.pNext 							= NULL;
+		aState.Tesselation.flags 							= 0;
+		aState.Tesselation.patchControlPoints 				= aRasterizer->PatchControlPoints;
+
+		// Both are stupid options, just tie to resolution.
+		aState.Viewport.sType 								= VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		aState.Viewport.pNext 								= NULL;
+		aState.Viewport.flags 								= 0;
+		aState.Viewport.viewportCount 						= 1;
+		aState.Viewport.pViewports 							= NULL;
+		aState.Viewport.scissorCount 						= 1;
+		aState.Viewport.pScissors 							= NULL;
+
+		// Depth Clamp seems stupid, don't care about it.
+		aState.Rasterizer.sType 							= VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		aState.Rasterizer.pNext 							= NULL;
+		aState.Rasterizer.flags 							= 0;
+		aState.Rasterizer.depthClampEnable 					= VK_FALSE;
+		aState.Rasterizer.rasterizerDiscardEnable 			= VK_FALSE;
+		aState.Rasterizer.polygonMode 						= aRasterizer->PolygonMode;
+		aState.Rasterizer.cullMode 							= aRasterizer->CullMode;
+		aState.Rasterizer.frontFace 						= aRasterizer->FrontFace;
+		aState.Rasterizer.depthBiasEnable 					= VK_FALSE;
+		aState.Rasterizer.depthBiasConstantFactor 			= 0.0f;
+		aState.Rasterizer.depthBiasClamp 					= 0.0f;
+		aState.Rasterizer.depthBiasSlopeFactor 				= 0.0f;
+		aState.Rasterizer.lineWidth 						= aRasterizer->LineWidth;
+
+		// Disabled By Default, follows the attachments' sample count.
+		VkSampleCountFlagBits SampleCount = VK_SAMPLE_COUNT_1_BIT;
+		if (aRasterizer->ColorAttachment.size() > 0) {
+			SampleCount = aRasterizer->ColorAttachment[0].Description.samples;
+		}
+		else if (aRasterizer->DepthStencilAttachment.Description.format != VK_FORMAT_UNDEFINED) {
+			SampleCount = aRasterizer->DepthStencilAttachment.Description.samples;
+		}
+		aState.Multisample.sType 							= VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		aState.Multisample.pNext 							= NULL;
+		aState.Multisample.flags 							= 0;
+		aState.Multisample.rasterizationSamples				= SampleCount;
+		aState.Multisample.sampleShadingEnable 				= VK_FALSE;
+		aState.Multisample.minSampleShading 				= 1.0f;
+		aState.Multisample.pSampleMask 						= NULL;
+		aState.Multisample.alphaToCoverageEnable 			= VK_FALSE;
+		aState.Multisample.alphaToOneEnable 				= VK_FALSE;
+
+		// I don't care about stencil stuff, depth bounds is redundant, suppress.
+		aState.DepthStencil.sType 							= VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		aState.DepthStencil.pNext 							= NULL;
+		aState.DepthStencil.flags 							= 0;
+		aState.DepthStencil.depthTestEnable 				= aRasterizer->DepthTestEnable;
+		aState.DepthStencil.depthWriteEnable 				= aRasterizer->DepthWriteEnable;
+		aState.DepthStencil.depthCompareOp 					= aRasterizer->DepthCompareOp;
+		aState.DepthStencil.depthBoundsTestEnable 			= VK_FALSE;
+		aState.DepthStencil.stencilTestEnable 				= VK_FALSE;
+		aState.DepthStencil.front 							= {};
+		aState.DepthStencil.back 							= {};
+		aState.DepthStencil.minDepthBounds 					= 0.0f;
+		aState.DepthStencil.maxDepthBounds 					= 1.0f;
+
+		aState.ColorBlend.sType 							= VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		aState.ColorBlend.pNext 							= NULL;
+		aState.ColorBlend.flags 							= 0;
+		aState.ColorBlend.logicOpEnable 					= VK_FALSE;
+		aState.ColorBlend.logicOp 							= VK_LOGIC_OP_COPY;
+		aState.ColorBlend.attachmentCount 					= aRasterizer->AttachmentBlendingRules.size();
+		aState.ColorBlend.pAttachments 						= aRasterizer->AttachmentBlendingRules.data();
+		aState.ColorBlend.blendConstants[0] 				= 0.0f;
+		aState.ColorBlend.blendConstants[1] 				= 0.0f;
+		aState.ColorBlend.blendConstants[2] 				= 0.0f;
+		aState.ColorBlend.blendConstants[3] 				= 0.0f;
+
+		// Default Enabled Dynamic State.
+		aState.DynamicStates = {
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR
+		};
+		size_t DefaultDynamicStateCount = aState.DynamicStates.size();
+
+		// Extended dynamic state, baked values above become defaults set at bind(). States are only
+		// used when their matching features were enabled with the context.
+		if (this->Context->ExtendedDynamicState) {
+			aState.DynamicStates.push_back(VK_DYNAMIC_STATE_CULL_MODE_EXT);
+			aState.DynamicStates.push_back(VK_DYNAMIC_STATE_FRONT_FACE_EXT);
+			aState.DynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT);
+			aState.DynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT);
+			aState.DynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT);
+			aState.DynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT);
+		}
+		if (this->Context->ExtendedDynamicState2) {
+			aState.DynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT);
+		}
+		if (this->Context->DynamicPolygonMode) {
+			aState.DynamicStates.push_back(VK_DYNAMIC_STATE_POLYGON_MODE_EXT);
+		}
+		if (this->Context->DynamicColorBlendEnable && (aRasterizer->AttachmentBlendingRules.size() > 0)) {
+			aState.DynamicStates.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+		}
+		this->DynamicState = std::set<VkDynamicState>(aState.DynamicStates.begin(), aState.DynamicStates.end());
+		this->ExtendedDynamicState = (aState.DynamicStates.size() > DefaultDynamicStateCount);
+
+		aState.DynamicState.sType 							= VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		aState.DynamicState.pNext 							= NULL;
+		aState.DynamicState.flags 							= 0;
+		aState.DynamicState.dynamicStateCount 				= aState.DynamicStates.size();
+		aState.DynamicState.pDynamicStates 					= aState.DynamicStates.data();
+
+		// Attachment formats for dynamic rendering, in place of a render pass.
+		aState.ColorAttachmentFormat.clear();
+		for (const rasterizer::attachment& Attachment : aRasterizer->ColorAttachment) {
+			aState.ColorAttachmentFormat.push_back(Attachment.Description.format);
+		}
+		VkFormat DepthStencilFormat 						= aRasterizer->DepthStencilAttachment.Description.format;
+		VkImageAspectFlags DepthStencilAspect 				= (DepthStencilFormat != VK_FORMAT_UNDEFINED) ? image::aspect_flag(DepthStencilFormat) : 0;
+		aState.Rendering = {};
+		aState.Rendering.sType 								= VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		aState.Rendering.pNext 								= NULL;
+		aState.Rendering.viewMask 							= 0;
+		aState.Rendering.colorAttachmentCount 				= aState.ColorAttachmentFormat.size();
+		aState.Rendering.pColorAttachmentFormats 			= aState.ColorAttachmentFormat.data();
+		aState.Rendering.depthAttachmentFormat 				= (DepthStencilAspect & VK_IMAGE_ASPECT_DEPTH_BIT) ? DepthStencilFormat : VK_FORMAT_UNDEFINED;
+		aState.Rendering.stencilAttachmentFormat 			= (DepthStencilAspect & VK_IMAGE_ASPECT_STENCIL_BIT) ? DepthStencilFormat : VK_FORMAT_UNDEFINED;
+
+		// Create Rasterizer Create Info Struct.
+		aState.CreateInfo = {};
+		aState.CreateInfo.sType								= VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		aState.CreateInfo.pNext								= (this->RenderPass == VK_NULL_HANDLE) ? &aState.Rendering : NULL;
+		aState.CreateInfo.flags								= 0;
+		aState.CreateInfo.stageCount						= this->Stage.size();
+		aState.CreateInfo.pStages							= this->Stage.data();
+		aState.CreateInfo.pVertexInputState					= &aState.Input;
+		aState.CreateInfo.pInputAssemblyState				= &aState.InputAssembly;
+		if (TesselationControlShaderExists && TesselationEvaluationShaderExists) {
+			aState.CreateInfo.pTessellationState				= &aState.Tesselation;
+		}
+		else {
+			aState.CreateInfo.pTessellationState				= NULL;
+		}
+		aState.CreateInfo.pViewportState					= &aState.Viewport;
+		aState.CreateInfo.pRasterizationState				= &aState.Rasterizer;
+		aState.CreateInfo.pMultisampleState					= &aState.Multisample;
+		if (aRasterizer->DepthStencilAttachment.Description.format != VK_FORMAT_UNDEFINED) {
+			aState.CreateInfo.pDepthStencilState				= &aState.DepthStencil;
+		}
+		else {
+			aState.CreateInfo.pDepthStencilState				= NULL;
+		}
+		aState.CreateInfo.pColorBlendState					= &aState.ColorBlend;
+		aState.CreateInfo.pDynamicState						= &aState.DynamicState;
+		aState.CreateInfo.layout							= this->Layout;
+		aState.CreateInfo.renderPass						= this->RenderPass;
+		aState.CreateInfo.subpass							= this->Subpass;
+		aState.CreateInfo.basePipelineHandle				= VK_NULL_HANDLE;
+		aState.CreateInfo.basePipelineIndex					= 0;
+	}
+
+	template<typename T>
+	static uint64_t mix(uint64_t aSeed, const T& aValue) {
+		return shader_cache::hash(&aValue, sizeof(T), aSeed);
+	}
+
+	template<typename T>
+	static uint64_t mix(uint64_t aSeed, const std::vector<T>& aValue) {
+		aSeed = mix(aSeed, (uint64_t)aValue.size());
+		return shader_cache::hash(aValue.data(), aValue.size() * sizeof(T), aSeed);
+	}
+
+	static uint32_t topology_class(VkPrimitiveTopology aTopology) {
+		switch (aTopology) {
+		case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+			return 0;
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+			return 1;
+		case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+			return 3;
+		default:
+			return 2;
+		}
+	}
+
+	// Creates one graphics pipeline library part, or returns the one already cached in the context.
+	static VkPipeline create_library(std::shared_ptr<context> aContext, VkPipelineCache aCache, uint64_t aKey, VkGraphicsPipelineLibraryFlagsEXT aFlags, VkGraphicsPipelineCreateInfo aCreateInfo) {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkCreateGraphicsPipelines vkCreateGraphicsPipelines = (PFN_vkCreateGraphicsPipelines)aContext->function_pointer("vkCreateGraphicsPipelines");
+
+		VkPipeline Library = aContext->find_pipeline_library(aKey);
+		if (Library != VK_NULL_HANDLE) return Library;
+
+		VkGraphicsPipelineLibraryCreateInfoEXT GPLCI{};
+		GPLCI.sType 						= VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+		GPLCI.pNext 						= aCreateInfo.pNext; 	// Keeps dynamic rendering formats chained.
+		GPLCI.flags 						= aFlags;
+
+		// Retain link time optimization info so the background link can optimize across parts.
+		aCreateInfo.pNext 					= &GPLCI;
+		aCreateInfo.flags 					= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+		{
+			std::shared_lock<std::shared_mutex> Lock(aContext->PipelineCacheMutex);
+			Result = vkCreateGraphicsPipelines(aContext->Handle, aCache, 1, &aCreateInfo, NULL, &Library);
+		}
+		if (Result != VK_SUCCESS) return VK_NULL_HANDLE;
+
+		return aContext->insert_pipeline_library(aKey, Library);
+	}
+
+	VkResult pipeline::link_libraries(rasterizer_state& aState, std::shared_ptr<rasterizer> aRasterizer) {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkCreateGraphicsPipelines vkCreateGraphicsPipelines = (PFN_vkCreateGraphicsPipelines)this->Context->function_pointer("vkCreateGraphicsPipelines");
+
+		// Split shader stages between the pre-rasterization and fragment shader parts.
+		std::vector<VkPipelineShaderStageCreateInfo> PreRasterizationStage;
+		std::vector<VkPipelineShaderStageCreateInfo> FragmentStage;
+		uint64_t PreRasterizationKey 	= shader_cache::hash("pre-rasterization");
+		uint64_t FragmentShaderKey 		= shader_cache::hash("fragment shader");
+		for (size_t i = 0; i < this->Stage.size(); i++) {
+			if (this->Stage[i].stage == VK_SHADER_STAGE_FRAGMENT_BIT) {
+				FragmentStage.push_back(this->Stage[i]);
+				FragmentShaderKey = mix(FragmentShaderKey, aRasterizer->Shader[i]->Key);
+			}
+			else {
+				PreRasterizationStage.push_back(this->Stage[i]);
+				PreRasterizationKey = mix(PreRasterizationKey, aRasterizer->Shader[i]->Key);
+			}
+		}
+
+		// Parts are only linkable with an identically defined layout and a compatible render pass. Context render
+		// passes live as long as the context, so their handle identifies their description. A caller supplied
+		// one may be destroyed and its handle reused for an incompatible pass, those pipelines are monolithic.
+		if ((this->RenderPass != VK_NULL_HANDLE) && !this->SharedRenderPass) {
+			return VK_ERROR_FEATURE_NOT_PRESENT;
+		}
+		uint64_t RenderPassKey = shader_cache::hash("render pass");
+		for (const rasterizer::attachment& Attachment : aRasterizer->ColorAttachment) {
+			RenderPassKey = mix(RenderPassKey, Attachment.Description.format);
+			RenderPassKey = mix(RenderPassKey, Attachment.Description.samples);
+		}
+		RenderPassKey = mix(RenderPassKey, aRasterizer->DepthStencilAttachment.Description.format);
+		RenderPassKey = mix(RenderPassKey, aRasterizer->DepthStencilAttachment.Description.samples);
+		RenderPassKey = mix(RenderPassKey, this->RenderPass);
+		RenderPassKey = mix(RenderPassKey, this->Subpass);
+		uint64_t LayoutKey = this->LayoutKey;
+
+		uint64_t VertexInputKey = shader_cache::hash("vertex input");
+		VertexInputKey = mix(VertexInputKey, aRasterizer->VertexBufferBindingDescription);
+		VertexInputKey = mix(VertexInputKey, aState.VertexAttributeDescription);
+		// Baked values of dynamic states are ignored by the driver, leave them out so those variants share parts.
+		bool DynamicRasterization = this->DynamicState.count(VK_DYNAMIC_STATE_CULL_MODE_EXT) > 0;
+		if (!DynamicRasterization) {
+			VertexInputKey = mix(VertexInputKey, aState.InputAssembly.topology);
+			PreRasterizationKey = mix(PreRasterizationKey, aState.Rasterizer.cullMode);
+			PreRasterizationKey = mix(PreRasterizationKey, aState.Rasterizer.frontFace);
+		}
+		else {
+			// Dynamic topology must still stay within the same topology class.
+			VertexInputKey = mix(VertexInputKey, topology_class(aState.InputAssembly.topology));
+		}
+		if (this->DynamicState.count(VK_DYNAMIC_STATE_POLYGON_MODE_EXT) == 0) {
+			PreRasterizationKey = mix(PreRasterizationKey, aState.Rasterizer.polygonMode);
+		}
+		PreRasterizationKey = mix(PreRasterizationKey, aState.Rasterizer.lineWidth);
+		PreRasterizationKey = mix(PreRasterizationKey, aState.CreateInfo.pTessellationState != NULL);
+		if (aState.CreateInfo.pTessellationState != NULL) {
+			PreRasterizationKey = mix(PreRasterizationKey, aState.Tesselation.patchControlPoints);
+		}
+		PreRasterizationKey = mix(PreRasterizationKey, aState.DynamicStates);
+		PreRasterizationKey = mix(PreRasterizationKey, LayoutKey);
+		PreRasterizationKey = mix(PreRasterizationKey, RenderPassKey);
+
+		if (!DynamicRasterization) {
+			FragmentShaderKey = mix(FragmentShaderKey, aState.DepthStencil.depthTestEnable);
+			FragmentShaderKey = mix(FragmentShaderKey, aState.DepthStencil.depthWriteEnable);
+			FragmentShaderKey = mix(FragmentShaderKey, aState.DepthStencil.depthCompareOp);
+		}
+		FragmentShaderKey = mix(FragmentShaderKey, aState.DynamicStates);
+		FragmentShaderKey = mix(FragmentShaderKey, aState.Multisample.rasterizationSamples);
+		FragmentShaderKey = mix(FragmentShaderKey, LayoutKey);
+		FragmentShaderKey = mix(FragmentShaderKey, RenderPassKey);
+
+		uint64_t FragmentOutputKey = shader_cache::hash("fragment output");
+		for (VkPipelineColorBlendAttachmentState Blend : aRasterizer->AttachmentBlendingRules) {
+			if (this->DynamicState.count(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT) > 0) {
+				Blend.blendEnable = VK_FALSE;
+			}
+			FragmentOutputKey = mix(FragmentOutputKey, Blend);
+		}
+		FragmentOutputKey = mix(FragmentOutputKey, aState.DynamicStates);
+		FragmentOutputKey = mix(FragmentOutputKey, aState.Multisample.rasterizationSamples);
+		FragmentOutputKey = mix(FragmentOutputKey, RenderPassKey);
+
+		// State outside a part's subset is ignored by the driver, so each part starts from the full create info.
+		std::array<VkPipeline, 4> Library;
+		{
+			VkGraphicsPipelineCreateInfo GPCI = aState.CreateInfo;
+			GPCI.stageCount 				= 0;
+			GPCI.pStages 					= NULL;
+			GPCI.layout 					= VK_NULL_HANDLE;
+			GPCI.renderPass 				= VK_NULL_HANDLE;
+			Library[0] = create_library(this->Context, this->Cache, VertexInputKey, VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, GPCI);
+		}
+		{
+			VkGraphicsPipelineCreateInfo GPCI = aState.CreateInfo;
+			GPCI.stageCount 				= PreRasterizationStage.size();
+			GPCI.pStages 					= PreRasterizationStage.data();
+			Library[1] = create_library(this->Context, this->Cache, PreRasterizationKey, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT, GPCI);
+		}
+		{
+			VkGraphicsPipelineCreateInfo GPCI = aState.CreateInfo;
+			GPCI.stageCount 				= FragmentStage.size();
+			GPCI.pStages 					= FragmentStage.data();
+			Library[2] = create_library(this->Context, this->Cache, FragmentShaderKey, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, GPCI);
+		}
+		{
+			VkGraphicsPipelineCreateInfo GPCI = aState.CreateInfo;
+			GPCI.stageCount 				= 0;
+			GPCI.pStages 					= NULL;
+			GPCI.layout 					= VK_NULL_HANDLE;
+			Library[3] = create_library(this->Context, this->Cache, FragmentOutputKey, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT, GPCI);
+		}
+		for (VkPipeline Part : Library) {
+			if (Part == VK_NULL_HANDLE) return VK_ERROR_INITIALIZATION_FAILED;
+		}
+
+		// Fast link, no cross part optimization.
+		VkPipelineLibraryCreateInfoKHR PLCI{};
+		PLCI.sType 							= VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+		PLCI.pNext 							= NULL;
+		PLCI.libraryCount 					= Library.size();
+		PLCI.pLibraries 					= Library.data();
+
+		VkGraphicsPipelineCreateInfo GPCI{};
+		GPCI.sType 							= VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		GPCI.pNext 							= &PLCI;
+		GPCI.flags 							= 0;
+		GPCI.layout 						= this->Layout;
+		GPCI.renderPass 					= this->RenderPass;
+		GPCI.subpass 						= this->Subpass;
+		GPCI.basePipelineHandle 			= VK_NULL_HANDLE;
+		GPCI.basePipelineIndex 				= -1;
+		{
+			std::shared_lock<std::shared_mutex> Lock(this->Context->PipelineCacheMutex);
+			Result = vkCreateGraphicsPipelines(this->Context->Handle, this->Cache, 1, &GPCI, NULL, &this->Handle);
+		}
+		if (Result != VK_SUCCESS) {
+			this->Handle = VK_NULL_HANDLE;
+			return Result;
+		}
+
+		// Optimized link in the background, bind() swaps it in once done. The task only holds plain handles,
+		// the pipeline waits for it before destroying the layout, and the context outlives its pipelines.
+		VkDevice Device 					= this->Context->Handle;
+		VkPipelineCache Cache 				= this->Cache;
+		std::shared_mutex* CacheMutex 		= &this->Context->PipelineCacheMutex;
+		VkPipelineLayout Layout 			= this->Layout;
+		VkRenderPass RenderPass 			= this->RenderPass;
+		uint32_t Subpass 					= this->Subpass;
+		this->Optimized = this->Context->get_worker_pool()->submit([vkCreateGraphicsPipelines, Device, Cache, CacheMutex, Layout, RenderPass, Subpass, Library]() -> VkPipeline {
+			VkPipelineLibraryCreateInfoKHR PLCI{};
+			PLCI.sType 							= VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+			PLCI.pNext 							= NULL;
+			PLCI.libraryCount 					= Library.size();
+			PLCI.pLibraries 					= Library.data();
+
+			VkGraphicsPipelineCreateInfo GPCI{};
+			GPCI.sType 							= VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			GPCI.pNext 							= &PLCI;
+			GPCI.flags 							= VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+			GPCI.layout 						= Layout;
+			GPCI.renderPass 					= RenderPass;
+			GPCI.subpass 						= Subpass;
+			GPCI.basePipelineHandle 			= VK_NULL_HANDLE;
+			GPCI.basePipelineIndex 				= -1;
+
+			VkPipeline Handle = VK_NULL_HANDLE;
+			std::shared_lock<std::shared_mutex> Lock(*CacheMutex);
+			if (vkCreateGraphicsPipelines(Device, Cache, 1, &GPCI, NULL, &Handle) != VK_SUCCESS) {
+				return VK_NULL_HANDLE;
+			}
+			return Handle;
+		});
+
+		return Result;
+	}
+
 	VkResult pipeline::shader_stage_create(std::shared_ptr<create_info> aCreateInfo) {
 		VkResult Result = VK_SUCCESS;
 		PFN_vkCreateShaderModule vkCreateShaderModule = (PFN_vkCreateShaderModule)this->Context->function_pointer("vkCreateShaderModule");
@@ -1487,6 +2329,23 @@ namespace geodesy::gpu {
 			CreateInfo.pushConstantRangeCount		= 0;
 			CreateInfo.pPushConstantRanges			= NULL;
 
+			// Identity of an identically defined layout, pipeline library parts are only shared between those.
+			this->LayoutKey = mix(shader_cache::hash("layout"), CreateInfo.flags);
+			for (const std::vector<VkDescriptorSetLayoutBinding>& Set : aDescriptorSetLayoutBinding) {
+				this->LayoutKey = mix(this->LayoutKey, (uint64_t)Set.size());
+				for (const VkDescriptorSetLayoutBinding& DSLB : Set) {
+					this->LayoutKey = mix(this->LayoutKey, DSLB.binding);
+					this->LayoutKey = mix(this->LayoutKey, DSLB.descriptorType);
+					this->LayoutKey = mix(this->LayoutKey, DSLB.descriptorCount);
+					this->LayoutKey = mix(this->LayoutKey, DSLB.stageFlags);
+					this->LayoutKey = mix(this->LayoutKey, DSLB.pImmutableSamplers != NULL);
+				}
+			}
+			this->LayoutKey = mix(this->LayoutKey, (uint64_t)CreateInfo.pushConstantRangeCount);
+			for (uint32_t i = 0; i < CreateInfo.pushConstantRangeCount; i++) {
+				this->LayoutKey = mix(this->LayoutKey, CreateInfo.pPushConstantRanges[i]);
+			}
+
 			Result = vkCreatePipelineLayout(this->Context->Handle, &CreateInfo, NULL, &this->Layout);
 		}
 
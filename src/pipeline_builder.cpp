@@ -0,0 +1,191 @@
+#include <geodesy/gpu/pipeline_builder.h>
+#include <geodesy/gpu/context.h>
+
+#include <algorithm>
+
+namespace geodesy::gpu {
+
+	pipeline_builder::pipeline_builder(std::shared_ptr<context> aContext, std::shared_ptr<worker_pool> aWorkerPool, size_t aBatchSize) {
+		this->Context 		= aContext;
+		this->WorkerPool 	= aWorkerPool != nullptr ? aWorkerPool : std::make_shared<worker_pool>();
+		this->BatchSize 	= std::max<size_t>(1, aBatchSize);
+		this->InFlight 		= 0;
+		this->Compiling 	= 0;
+	}
+
+	pipeline_builder::~pipeline_builder() {
+		// Tasks reference this builder, all must resolve first.
+		this->wait();
+	}
+
+	std::shared_future<std::shared_ptr<pipeline>> pipeline_builder::build(std::vector<std::shared_ptr<shader>> aShaderList, rasterizer_setup aSetup) {
+		return this->enqueue(aShaderList, aSetup, nullptr);
+	}
+
+	std::shared_future<std::shared_ptr<pipeline>> pipeline_builder::build(std::shared_ptr<shader> aComputeShader) {
+		return this->enqueue(aComputeShader, nullptr);
+	}
+
+	std::shared_future<std::shared_ptr<pipeline>> pipeline_builder::build(std::vector<pipeline::raytracer::shader_group> aShaderGroup, uint32_t aMaxRecursionDepth) {
+		return this->enqueue(aShaderGroup, aMaxRecursionDepth, nullptr);
+	}
+
+	std::shared_ptr<pipeline> pipeline_builder::build_async(std::vector<std::shared_ptr<shader>> aShaderList, rasterizer_setup aSetup, std::shared_ptr<pipeline> aSubstitute) {
+		std::shared_ptr<pipeline> Placeholder = this->placeholder(aSubstitute);
+		this->enqueue(aShaderList, aSetup, Placeholder);
+		return Placeholder;
+	}
+
+	std::shared_ptr<pipeline> pipeline_builder::build_async(std::shared_ptr<shader> aComputeShader, std::shared_ptr<pipeline> aSubstitute) {
+		std::shared_ptr<pipeline> Placeholder = this->placeholder(aSubstitute);
+		this->enqueue(aComputeShader, Placeholder);
+		return Placeholder;
+	}
+
+	std::shared_ptr<pipeline> pipeline_builder::build_async(std::vector<pipeline::raytracer::shader_group> aShaderGroup, uint32_t aMaxRecursionDepth, std::shared_ptr<pipeline> aSubstitute) {
+		std::shared_ptr<pipeline> Placeholder = this->placeholder(aSubstitute);
+		this->enqueue(aShaderGroup, aMaxRecursionDepth, Placeholder);
+		return Placeholder;
+	}
+
+	std::shared_future<std::shared_ptr<pipeline>> pipeline_builder::enqueue(std::vector<std::shared_ptr<shader>> aShaderList, rasterizer_setup aSetup, std::shared_ptr<pipeline> aTarget) {
+		std::shared_ptr<std::promise<std::shared_ptr<pipeline>>> Promise = std::make_shared<std::promise<std::shared_ptr<pipeline>>>();
+		std::shared_future<std::shared_ptr<pipeline>> Future = Promise->get_future().share();
+		{
+			std::lock_guard<std::mutex> Lock(this->Mutex);
+			this->InFlight++;
+			this->Compiling++;
+		}
+		this->WorkerPool->submit([this, aShaderList, aSetup, Promise, aTarget]() {
+			// Parse, link, reflect and generate SPIRV on this thread.
+			std::shared_ptr<pipeline::rasterizer> Rasterizer = geodesy::make<pipeline::rasterizer>(aShaderList);
+			if ((Rasterizer != nullptr) && aSetup) {
+				try {
+					aSetup(*Rasterizer);
+				} catch (...) {
+					Rasterizer = nullptr;
+				}
+			}
+
+			// Queue for batched creation, the batch is issued once full or once nothing else is compiling.
+			std::vector<pending> Batch;
+			{
+				std::lock_guard<std::mutex> Lock(this->Mutex);
+				this->Compiling--;
+				if (Rasterizer != nullptr) {
+					this->Pending.push_back({ Rasterizer, Promise, aTarget });
+				}
+				else {
+					Promise->set_value(nullptr);
+				}
+				if ((this->Pending.size() >= this->BatchSize) || ((this->Compiling == 0) && (this->Pending.size() > 0))) {
+					Batch.swap(this->Pending);
+				}
+			}
+			if (Batch.size() > 0) {
+				this->create_batch(Batch);
+			}
+
+			this->finish();
+		});
+		return Future;
+	}
+
+	std::shared_future<std::shared_ptr<pipeline>> pipeline_builder::enqueue(std::shared_ptr<shader> aComputeShader, std::shared_ptr<pipeline> aTarget) {
+		std::shared_ptr<std::promise<std::shared_ptr<pipeline>>> Promise = std::make_shared<std::promise<std::shared_ptr<pipeline>>>();
+		std::shared_future<std::shared_ptr<pipeline>> Future = Promise->get_future().share();
+		{
+			std::lock_guard<std::mutex> Lock(this->Mutex);
+			this->InFlight++;
+		}
+		this->WorkerPool->submit([this, aComputeShader, Promise, aTarget]() {
+			std::shared_ptr<pipeline> Pipeline = nullptr;
+			std::shared_ptr<pipeline::compute> Compute = geodesy::make<pipeline::compute>(aComputeShader);
+			if (Compute != nullptr) {
+				Pipeline = geodesy::make<pipeline>(this->Context, Compute);
+			}
+			this->resolve({ nullptr, Promise, aTarget }, Pipeline);
+			this->finish();
+		});
+		return Future;
+	}
+
+	std::shared_future<std::shared_ptr<pipeline>> pipeline_builder::enqueue(std::vector<pipeline::raytracer::shader_group> aShaderGroup, uint32_t aMaxRecursionDepth, std::shared_ptr<pipeline> aTarget) {
+		std::shared_ptr<std::promise<std::shared_ptr<pipeline>>> Promise = std::make_shared<std::promise<std::shared_ptr<pipeline>>>();
+		std::shared_future<std::shared_ptr<pipeline>> Future = Promise->get_future().share();
+		{
+			std::lock_guard<std::mutex> Lock(this->Mutex);
+			this->InFlight++;
+		}
+		this->WorkerPool->submit([this, aShaderGroup, aMaxRecursionDepth, Promise, aTarget]() {
+			std::shared_ptr<pipeline> Pipeline = nullptr;
+			std::shared_ptr<pipeline::raytracer> Raytracer = geodesy::make<pipeline::raytracer>(aShaderGroup, aMaxRecursionDepth);
+			if (Raytracer != nullptr) {
+				Pipeline = geodesy::make<pipeline>(this->Context, Raytracer);
+			}
+			this->resolve({ nullptr, Promise, aTarget }, Pipeline);
+			this->finish();
+		});
+		return Future;
+	}
+
+	void pipeline_builder::flush() {
+		std::vector<pending> Batch;
+		{
+			std::lock_guard<std::mutex> Lock(this->Mutex);
+			Batch.swap(this->Pending);
+		}
+		if (Batch.size() > 0) {
+			this->create_batch(Batch);
+		}
+	}
+
+	void pipeline_builder::wait() {
+		std::unique_lock<std::mutex> Lock(this->Mutex);
+		this->Condition.wait(Lock, [this]() { return this->InFlight == 0; });
+	}
+
+	void pipeline_builder::create_batch(std::vector<pending> aBatch) {
+		std::vector<std::shared_ptr<pipeline::rasterizer>> RasterizerList(aBatch.size());
+		for (size_t i = 0; i < aBatch.size(); i++) {
+			RasterizerList[i] = aBatch[i].Rasterizer;
+		}
+
+		std::vector<std::shared_ptr<pipeline>> Pipeline;
+		try {
+			Pipeline = pipeline::create(this->Context, RasterizerList);
+		} catch (...) {
+			Pipeline = std::vector<std::shared_ptr<pipeline>>(aBatch.size(), nullptr);
+		}
+
+		for (size_t i = 0; i < aBatch.size(); i++) {
+			this->resolve(aBatch[i], Pipeline[i]);
+		}
+	}
+
+	std::shared_ptr<pipeline> pipeline_builder::placeholder(std::shared_ptr<pipeline> aSubstitute) {
+		std::shared_ptr<pipeline> Placeholder = std::make_shared<pipeline>();
+		Placeholder->Context 		= this->Context;
+		Placeholder->Substitute 	= aSubstitute;
+		return Placeholder;
+	}
+
+	void pipeline_builder::resolve(const pending& aPending, std::shared_ptr<pipeline> aPipeline) {
+		if ((aPending.Target != nullptr) && (aPipeline != nullptr)) {
+			// Hand the compiled handles to the placeholder the caller is already recording with.
+			aPending.Target->adopt(*aPipeline);
+			aPending.Promise->set_value(aPending.Target);
+		}
+		else {
+			aPending.Promise->set_value(aPipeline);
+		}
+	}
+
+	void pipeline_builder::finish() {
+		// Notify under lock, wait() may destroy this builder as soon as it observes zero.
+		std::lock_guard<std::mutex> Lock(this->Mutex);
+		this->InFlight--;
+		this->Condition.notify_all();
+	}
+
+}
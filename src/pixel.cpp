@@ -0,0 +1,565 @@
+#include <geodesy/gpu/pixel.h>
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <bitset>
+
+#if defined(__AVX2__)
+#define GEODESY_GPU_PIXEL_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define GEODESY_GPU_PIXEL_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#define GEODESY_GPU_PIXEL_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+// MSVC has no F16C macro, every CPU with AVX2 has F16C.
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define GEODESY_GPU_PIXEL_F16C 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GEODESY_GPU_PIXEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace geodesy::gpu::pixel {
+
+	// Decoded sRGB values of every byte.
+	static const float* srgb_decode_table() {
+		static const std::array<float, 256> Table = []() {
+			std::array<float, 256> Value{};
+			for (size_t i = 0; i < Value.size(); i++) {
+				float Encoded = (float)i / 255.0f;
+				Value[i] = (Encoded <= 0.04045f) ? Encoded / 12.92f : std::pow((Encoded + 0.055f) / 1.055f, 2.4f);
+			}
+			return Value;
+		}();
+		return Table.data();
+	}
+
+	// sRGB encoded bytes of linear values quantized to 16 bits, fine enough to round like the exact curve.
+	static const uint8_t* srgb_encode_table() {
+		static const std::vector<uint8_t> Table = []() {
+			std::vector<uint8_t> Value(65536);
+			for (size_t i = 0; i < Value.size(); i++) {
+				float Linear = (float)i / 65535.0f;
+				float Encoded = (Linear <= 0.0031308f) ? Linear * 12.92f : 1.055f * std::pow(Linear, 1.0f / 2.4f) - 0.055f;
+				Value[i] = (uint8_t)std::min(Encoded * 255.0f + 0.5f, 255.0f);
+			}
+			return Value;
+		}();
+		return Table.data();
+	}
+
+	static inline size_t bit_count(uint32_t aBits) {
+		return std::bitset<32>(aBits).count();
+	}
+
+#if defined(GEODESY_GPU_PIXEL_NEON)
+	// Number of set lanes of a comparison result.
+	static inline size_t lane_count(uint8x16_t aMask) {
+		uint64x2_t Sum = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vshrq_n_u8(aMask, 7))));
+		return (size_t)(vgetq_lane_u64(Sum, 0) + vgetq_lane_u64(Sum, 1));
+	}
+
+	static inline size_t lane_count(uint32x4_t aMask) {
+		uint64x2_t Sum = vpaddlq_u32(vshrq_n_u32(aMask, 31));
+		return (size_t)(vgetq_lane_u64(Sum, 0) + vgetq_lane_u64(Sum, 1));
+	}
+#endif
+
+	static inline float saturate(float aValue) {
+		// NaN ends up at zero.
+		return (aValue > 0.0f) ? ((aValue < 1.0f) ? aValue : 1.0f) : 0.0f;
+	}
+
+	static inline uint16_t half_from_float(float aValue) {
+		uint32_t Bits;
+		std::memcpy(&Bits, &aValue, sizeof(Bits));
+		uint32_t Sign 		= (Bits >> 16) & 0x8000;
+		uint32_t Exponent 	= (Bits >> 23) & 0xFF;
+		uint32_t Mantissa 	= Bits & 0x7FFFFF;
+		if (Exponent == 0xFF) {
+			// Infinity stays infinity, NaN stays a quiet NaN.
+			return (uint16_t)(Sign | 0x7C00 | ((Mantissa != 0) ? (0x200 | (Mantissa >> 13)) : 0));
+		}
+		int32_t HalfExponent = (int32_t)Exponent - 127 + 15;
+		if (HalfExponent >= 31) return (uint16_t)(Sign | 0x7C00);
+		if (HalfExponent <= 0) {
+			// Subnormal, rounding may carry into the smallest normal.
+			if (HalfExponent < -10) return (uint16_t)Sign;
+			Mantissa |= 0x800000;
+			uint32_t Shift 		= (uint32_t)(14 - HalfExponent);
+			uint32_t Half 		= Mantissa >> Shift;
+			uint32_t Remainder 	= Mantissa & ((1u << Shift) - 1);
+			uint32_t Halfway 	= 1u << (Shift - 1);
+			if ((Remainder > Halfway) || ((Remainder == Halfway) && (Half & 1))) Half++;
+			return (uint16_t)(Sign | Half);
+		}
+		// Rounding may carry into the exponent, and from the largest finite value into infinity.
+		uint32_t Half 		= ((uint32_t)HalfExponent << 10) | (Mantissa >> 13);
+		uint32_t Remainder 	= Mantissa & 0x1FFF;
+		if ((Remainder > 0x1000) || ((Remainder == 0x1000) && (Half & 1))) Half++;
+		return (uint16_t)(Sign | Half);
+	}
+
+	static inline float float_from_half(uint16_t aValue) {
+		uint32_t Sign 		= (uint32_t)(aValue & 0x8000) << 16;
+		uint32_t Exponent 	= (aValue >> 10) & 0x1F;
+		uint32_t Mantissa 	= aValue & 0x3FF;
+		uint32_t Bits 		= 0;
+		if (Exponent == 0x1F) {
+			Bits = Sign | 0x7F800000 | (Mantissa << 13);
+		}
+		else if (Exponent != 0) {
+			Bits = Sign | ((Exponent + 112) << 23) | (Mantissa << 13);
+		}
+		else if (Mantissa == 0) {
+			Bits = Sign;
+		}
+		else {
+			// Subnormal, renormalized.
+			Exponent = 113;
+			while ((Mantissa & 0x400) == 0) {
+				Mantissa <<= 1;
+				Exponent--;
+			}
+			Bits = Sign | (Exponent << 23) | ((Mantissa & 0x3FF) << 13);
+		}
+		float Value;
+		std::memcpy(&Value, &Bits, sizeof(Value));
+		return Value;
+	}
+
+	void fill(void* aDestination, const void* aPixel, size_t aPixelSize, size_t aCount) {
+		uint8_t* Destination = (uint8_t*)aDestination;
+		size_t Size = aPixelSize * aCount;
+		if (Size == 0) return;
+
+		if ((aPixelSize <= 16) && ((16 % aPixelSize) == 0)) {
+			// Pixels tile a vector register exactly, every store is a whole number of pixels.
+			alignas(32) uint8_t Pattern[32];
+			for (size_t i = 0; i < sizeof(Pattern); i += aPixelSize) {
+				std::memcpy(Pattern + i, aPixel, aPixelSize);
+			}
+			size_t i = 0;
+#if defined(GEODESY_GPU_PIXEL_AVX2)
+			__m256i Wide = _mm256_load_si256((const __m256i*)Pattern);
+			for (; i + 32 <= Size; i += 32) {
+				_mm256_storeu_si256((__m256i*)(Destination + i), Wide);
+			}
+#endif
+#if defined(GEODESY_GPU_PIXEL_SSE2)
+			__m128i Value = _mm_load_si128((const __m128i*)Pattern);
+			for (; i + 16 <= Size; i += 16) {
+				_mm_storeu_si128((__m128i*)(Destination + i), Value);
+			}
+#elif defined(GEODESY_GPU_PIXEL_NEON)
+			uint8x16_t Value = vld1q_u8(Pattern);
+			for (; i + 16 <= Size; i += 16) {
+				vst1q_u8(Destination + i, Value);
+			}
+#endif
+			for (; i < Size; i += std::min(Size - i, sizeof(Pattern))) {
+				std::memcpy(Destination + i, Pattern, std::min(Size - i, sizeof(Pattern)));
+			}
+			return;
+		}
+
+		// Other sizes double the filled prefix, in steps small enough to stay in cache.
+		size_t Step = std::max<size_t>((65536 / aPixelSize) * aPixelSize, aPixelSize);
+		std::memcpy(Destination, aPixel, aPixelSize);
+		size_t Filled = aPixelSize;
+		while (Filled < Size) {
+			size_t Chunk = std::min(std::min(Filled, Size - Filled), Step);
+			std::memcpy(Destination + Filled, Destination, Chunk);
+			Filled += Chunk;
+		}
+	}
+
+	void swizzle_rgba8_bgra8(void* aDestination, const void* aSource, size_t aCount) {
+		uint8_t* Destination = (uint8_t*)aDestination;
+		const uint8_t* Source = (const uint8_t*)aSource;
+		size_t i = 0;
+#if defined(GEODESY_GPU_PIXEL_AVX2)
+		const __m256i Shuffle = _mm256_setr_epi8(
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+		);
+		for (; i + 8 <= aCount; i += 8) {
+			__m256i Pixel = _mm256_loadu_si256((const __m256i*)(Source + 4 * i));
+			_mm256_storeu_si256((__m256i*)(Destination + 4 * i), _mm256_shuffle_epi8(Pixel, Shuffle));
+		}
+#endif
+#if defined(GEODESY_GPU_PIXEL_SSE2)
+		const __m128i GreenAlpha = _mm_set1_epi32((int)0xFF00FF00);
+		const __m128i LowByte = _mm_set1_epi32(0x000000FF);
+		for (; i + 4 <= aCount; i += 4) {
+			__m128i Pixel = _mm_loadu_si128((const __m128i*)(Source + 4 * i));
+			__m128i Red = _mm_slli_epi32(_mm_and_si128(Pixel, LowByte), 16);
+			__m128i Blue = _mm_and_si128(_mm_srli_epi32(Pixel, 16), LowByte);
+			_mm_storeu_si128((__m128i*)(Destination + 4 * i), _mm_or_si128(_mm_and_si128(Pixel, GreenAlpha), _mm_or_si128(Red, Blue)));
+		}
+#elif defined(GEODESY_GPU_PIXEL_NEON)
+		for (; i + 16 <= aCount; i += 16) {
+			uint8x16x4_t Pixel = vld4q_u8(Source + 4 * i);
+			uint8x16_t Red = Pixel.val[0];
+			Pixel.val[0] = Pixel.val[2];
+			Pixel.val[2] = Red;
+			vst4q_u8(Destination + 4 * i, Pixel);
+		}
+#endif
+		for (; i < aCount; i++) {
+			uint8_t Red = Source[4 * i + 0];
+			uint8_t Blue = Source[4 * i + 2];
+			Destination[4 * i + 0] = Blue;
+			Destination[4 * i + 1] = Source[4 * i + 1];
+			Destination[4 * i + 2] = Red;
+			Destination[4 * i + 3] = Source[4 * i + 3];
+		}
+	}
+
+	void unorm8_to_float(float* aDestination, const uint8_t* aSource, size_t aCount) {
+		size_t i = 0;
+#if defined(GEODESY_GPU_PIXEL_SSE2)
+		const __m128 Scale = _mm_set1_ps(1.0f / 255.0f);
+		const __m128i Zero = _mm_setzero_si128();
+		for (; i + 16 <= aCount; i += 16) {
+			__m128i Byte = _mm_loadu_si128((const __m128i*)(aSource + i));
+			__m128i Low = _mm_unpacklo_epi8(Byte, Zero);
+			__m128i High = _mm_unpackhi_epi8(Byte, Zero);
+			_mm_storeu_ps(aDestination + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(Low, Zero)), Scale));
+			_mm_storeu_ps(aDestination + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(Low, Zero)), Scale));
+			_mm_storeu_ps(aDestination + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(High, Zero)), Scale));
+			_mm_storeu_ps(aDestination + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(High, Zero)), Scale));
+		}
+#elif defined(GEODESY_GPU_PIXEL_NEON)
+		const float32x4_t Scale = vdupq_n_f32(1.0f / 255.0f);
+		for (; i + 16 <= aCount; i += 16) {
+			uint8x16_t Byte = vld1q_u8(aSource + i);
+			uint16x8_t Low = vmovl_u8(vget_low_u8(Byte));
+			uint16x8_t High = vmovl_u8(vget_high_u8(Byte));
+			vst1q_f32(aDestination + i + 0, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(Low))), Scale));
+			vst1q_f32(aDestination + i + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(Low))), Scale));
+			vst1q_f32(aDestination + i + 8, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(High))), Scale));
+			vst1q_f32(aDestination + i + 12, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(High))), Scale));
+		}
+#endif
+		for (; i < aCount; i++) {
+			aDestination[i] = (float)aSource[i] * (1.0f / 255.0f);
+		}
+	}
+
+	void float_to_unorm8(uint8_t* aDestination, const float* aSource, size_t aCount) {
+		size_t i = 0;
+#if defined(GEODESY_GPU_PIXEL_SSE2)
+		const __m128 Zero = _mm_setzero_ps();
+		const __m128 One = _mm_set1_ps(1.0f);
+		const __m128 Scale = _mm_set1_ps(255.0f);
+		for (; i + 16 <= aCount; i += 16) {
+			__m128i Integer[4];
+			for (size_t j = 0; j < 4; j++) {
+				// max(NaN, 0) is 0, cvtps rounds to nearest.
+				__m128 Value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(aSource + i + 4 * j), Zero), One);
+				Integer[j] = _mm_cvtps_epi32(_mm_mul_ps(Value, Scale));
+			}
+			__m128i Byte = _mm_packus_epi16(_mm_packs_epi32(Integer[0], Integer[1]), _mm_packs_epi32(Integer[2], Integer[3]));
+			_mm_storeu_si128((__m128i*)(aDestination + i), Byte);
+		}
+#elif defined(GEODESY_GPU_PIXEL_NEON)
+		const float32x4_t Zero = vdupq_n_f32(0.0f);
+		const float32x4_t One = vdupq_n_f32(1.0f);
+		const float32x4_t Scale = vdupq_n_f32(255.0f);
+		const float32x4_t Half = vdupq_n_f32(0.5f);
+		for (; i + 16 <= aCount; i += 16) {
+			uint16x4_t Integer[4];
+			for (size_t j = 0; j < 4; j++) {
+				float32x4_t Value = vminq_f32(vmaxq_f32(vld1q_f32(aSource + i + 4 * j), Zero), One);
+				Integer[j] = vmovn_u32(vcvtq_u32_f32(vmlaq_f32(Half, Value, Scale)));
+			}
+			uint8x8_t Low = vmovn_u16(vcombine_u16(Integer[0], Integer[1]));
+			uint8x8_t High = vmovn_u16(vcombine_u16(Integer[2], Integer[3]));
+			vst1q_u8(aDestination + i, vcombine_u8(Low, High));
+		}
+#endif
+		for (; i < aCount; i++) {
+			aDestination[i] = (uint8_t)(saturate(aSource[i]) * 255.0f + 0.5f);
+		}
+	}
+
+	void srgb8_to_linear(float* aDestination, const uint8_t* aSource, size_t aCount, size_t aChannelCount) {
+		const float* Table = srgb_decode_table();
+		if (aChannelCount == 4) {
+			for (size_t i = 0; i < aCount; i++) {
+				aDestination[4 * i + 0] = Table[aSource[4 * i + 0]];
+				aDestination[4 * i + 1] = Table[aSource[4 * i + 1]];
+				aDestination[4 * i + 2] = Table[aSource[4 * i + 2]];
+				aDestination[4 * i + 3] = (float)aSource[4 * i + 3] * (1.0f / 255.0f);
+			}
+			return;
+		}
+		for (size_t i = 0; i < aCount * aChannelCount; i++) {
+			aDestination[i] = Table[aSource[i]];
+		}
+	}
+
+	void linear_to_srgb8(uint8_t* aDestination, const float* aSource, size_t aCount, size_t aChannelCount) {
+		const uint8_t* Table = srgb_encode_table();
+		auto encode = [Table](float aValue) -> uint8_t {
+			return Table[(uint32_t)(saturate(aValue) * 65535.0f + 0.5f)];
+		};
+		if (aChannelCount == 4) {
+			for (size_t i = 0; i < aCount; i++) {
+				aDestination[4 * i + 0] = encode(aSource[4 * i + 0]);
+				aDestination[4 * i + 1] = encode(aSource[4 * i + 1]);
+				aDestination[4 * i + 2] = encode(aSource[4 * i + 2]);
+				aDestination[4 * i + 3] = (uint8_t)(saturate(aSource[4 * i + 3]) * 255.0f + 0.5f);
+			}
+			return;
+		}
+		for (size_t i = 0; i < aCount * aChannelCount; i++) {
+			aDestination[i] = encode(aSource[i]);
+		}
+	}
+
+	void float_to_half(uint16_t* aDestination, const float* aSource, size_t aCount) {
+		size_t i = 0;
+#if defined(GEODESY_GPU_PIXEL_F16C)
+		for (; i + 8 <= aCount; i += 8) {
+			_mm_storeu_si128((__m128i*)(aDestination + i), _mm256_cvtps_ph(_mm256_loadu_ps(aSource + i), _MM_FROUND_TO_NEAREST_INT));
+		}
+#elif defined(GEODESY_GPU_PIXEL_NEON) && defined(__aarch64__)
+		for (; i + 4 <= aCount; i += 4) {
+			vst1_u16(aDestination + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(aSource + i))));
+		}
+#endif
+		for (; i < aCount; i++) {
+			aDestination[i] = half_from_float(aSource[i]);
+		}
+	}
+
+	void half_to_float(float* aDestination, const uint16_t* aSource, size_t aCount) {
+		size_t i = 0;
+#if defined(GEODESY_GPU_PIXEL_F16C)
+		for (; i + 8 <= aCount; i += 8) {
+			_mm256_storeu_ps(aDestination + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(aSource + i))));
+		}
+#elif defined(GEODESY_GPU_PIXEL_NEON) && defined(__aarch64__)
+		for (; i + 4 <= aCount; i += 4) {
+			vst1q_f32(aDestination + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(aSource + i))));
+		}
+#endif
+		for (; i < aCount; i++) {
+			aDestination[i] = float_from_half(aSource[i]);
+		}
+	}
+
+	void rgb8_to_rgba8(uint8_t* aDestination, const uint8_t* aSource, size_t aCount, uint8_t aAlpha) {
+		size_t i = 0;
+#if defined(GEODESY_GPU_PIXEL_SSSE3)
+		const __m128i Shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i Alpha = _mm_set1_epi32((int)((uint32_t)aAlpha << 24));
+		// Loads 16 bytes to use 12, stops while all 16 are still inside the source.
+		for (; i + 6 <= aCount; i += 4) {
+			__m128i Pixel = _mm_loadu_si128((const __m128i*)(aSource + 3 * i));
+			_mm_storeu_si128((__m128i*)(aDestination + 4 * i), _mm_or_si128(_mm_shuffle_epi8(Pixel, Shuffle), Alpha));
+		}
+#elif defined(GEODESY_GPU_PIXEL_NEON)
+		for (; i + 16 <= aCount; i += 16) {
+			uint8x16x3_t Pixel = vld3q_u8(aSource + 3 * i);
+			uint8x16x4_t Expanded;
+			Expanded.val[0] = Pixel.val[0];
+			Expanded.val[1] = Pixel.val[1];
+			Expanded.val[2] = Pixel.val[2];
+			Expanded.val[3] = vdupq_n_u8(aAlpha);
+			vst4q_u8(aDestination + 4 * i, Expanded);
+		}
+#endif
+		for (; i < aCount; i++) {
+			aDestination[4 * i + 0] = aSource[3 * i + 0];
+			aDestination[4 * i + 1] = aSource[3 * i + 1];
+			aDestination[4 * i + 2] = aSource[3 * i + 2];
+			aDestination[4 * i + 3] = aAlpha;
+		}
+	}
+
+	void rgb32f_to_rgba32f(float* aDestination, const float* aSource, size_t aCount, float aAlpha) {
+		size_t i = 0;
+#if defined(GEODESY_GPU_PIXEL_SSE2)
+		const __m128 Alpha = _mm_set1_ps(aAlpha);
+		// Loads one float past the pixel, the last pixel is left to the scalar loop.
+		for (; i + 1 < aCount; i++) {
+			__m128 Pixel = _mm_loadu_ps(aSource + 3 * i);
+			__m128 BlueAlpha = _mm_shuffle_ps(Pixel, Alpha, _MM_SHUFFLE(0, 0, 2, 2));
+			_mm_storeu_ps(aDestination + 4 * i, _mm_shuffle_ps(Pixel, BlueAlpha, _MM_SHUFFLE(2, 0, 1, 0)));
+		}
+#elif defined(GEODESY_GPU_PIXEL_NEON)
+		for (; i + 4 <= aCount; i += 4) {
+			float32x4x3_t Pixel = vld3q_f32(aSource + 3 * i);
+			float32x4x4_t Expanded;
+			Expanded.val[0] = Pixel.val[0];
+			Expanded.val[1] = Pixel.val[1];
+			Expanded.val[2] = Pixel.val[2];
+			Expanded.val[3] = vdupq_n_f32(aAlpha);
+			vst4q_f32(aDestination + 4 * i, Expanded);
+		}
+#endif
+		for (; i < aCount; i++) {
+			aDestination[4 * i + 0] = aSource[3 * i + 0];
+			aDestination[4 * i + 1] = aSource[3 * i + 1];
+			aDestination[4 * i + 2] = aSource[3 * i + 2];
+			aDestination[4 * i + 3] = aAlpha;
+		}
+	}
+
+	coverage coverage_unorm8(const uint8_t* aSource, size_t aCount, size_t aStride) {
+		coverage Coverage = { 0, 0, 0 };
+		if (aCount == 0) return Coverage;
+		// Elements that may be read, the last pixel can end at the channel.
+		size_t Extent = (aCount - 1) * aStride + 1;
+		size_t i = 0;
+#if defined(GEODESY_GPU_PIXEL_SSE2)
+		if ((aStride == 1) || (aStride == 2) || (aStride == 4)) {
+			// One mask bit per byte, only the bytes of the channel are counted.
+			uint32_t Lane = (aStride == 1) ? 0xFFFFFFFFu : ((aStride == 2) ? 0x55555555u : 0x11111111u);
+#if defined(GEODESY_GPU_PIXEL_AVX2)
+			const __m256i Empty256 = _mm256_setzero_si256();
+			const __m256i Full256 = _mm256_set1_epi8((char)0xFF);
+			for (; i * aStride + 32 <= Extent; i += 32 / aStride) {
+				__m256i Value = _mm256_loadu_si256((const __m256i*)(aSource + i * aStride));
+				Coverage.Opaque 		+= bit_count((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(Value, Full256)) & Lane);
+				Coverage.Transparent 	+= bit_count((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(Value, Empty256)) & Lane);
+			}
+#endif
+			const __m128i Empty = _mm_setzero_si128();
+			const __m128i Full = _mm_set1_epi8((char)0xFF);
+			for (; i * aStride + 16 <= Extent; i += 16 / aStride) {
+				__m128i Value = _mm_loadu_si128((const __m128i*)(aSource + i * aStride));
+				Coverage.Opaque 		+= bit_count((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(Value, Full)) & Lane & 0xFFFF);
+				Coverage.Transparent 	+= bit_count((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(Value, Empty)) & Lane & 0xFFFF);
+			}
+		}
+#elif defined(GEODESY_GPU_PIXEL_NEON)
+		const uint8x16_t Empty = vdupq_n_u8(0x00);
+		const uint8x16_t Full = vdupq_n_u8(0xFF);
+		if (aStride == 1) {
+			for (; i + 16 <= aCount; i += 16) {
+				uint8x16_t Value = vld1q_u8(aSource + i);
+				Coverage.Opaque 		+= lane_count(vceqq_u8(Value, Full));
+				Coverage.Transparent 	+= lane_count(vceqq_u8(Value, Empty));
+			}
+		}
+		else if (aStride == 4) {
+			for (; i * 4 + 64 <= Extent; i += 16) {
+				uint8x16_t Value = vld4q_u8(aSource + i * 4).val[0];
+				Coverage.Opaque 		+= lane_count(vceqq_u8(Value, Full));
+				Coverage.Transparent 	+= lane_count(vceqq_u8(Value, Empty));
+			}
+		}
+#endif
+		for (; i < aCount; i++) {
+			uint8_t Value = aSource[i * aStride];
+			Coverage.Opaque 		+= (Value == 0xFF);
+			Coverage.Transparent 	+= (Value == 0x00);
+		}
+		Coverage.Translucent = aCount - Coverage.Opaque - Coverage.Transparent;
+		return Coverage;
+	}
+
+	coverage coverage_unorm16(const uint16_t* aSource, size_t aCount, size_t aStride) {
+		coverage Coverage = { 0, 0, 0 };
+		// Integer bounds of the thresholds, 65470 and 65.
+		const uint16_t OpaqueMinimum = (uint16_t)std::ceil(OpaqueThreshold * 65535.0f);
+		const uint16_t TransparentMaximum = (uint16_t)std::floor(TransparentThreshold * 65535.0f);
+		for (size_t i = 0; i < aCount; i++) {
+			uint16_t Value = aSource[i * aStride];
+			Coverage.Opaque 		+= (Value >= OpaqueMinimum);
+			Coverage.Transparent 	+= (Value <= TransparentMaximum);
+		}
+		Coverage.Translucent = aCount - Coverage.Opaque - Coverage.Transparent;
+		return Coverage;
+	}
+
+	coverage coverage_half(const uint16_t* aSource, size_t aCount, size_t aStride) {
+		coverage Coverage = { 0, 0, 0 };
+		// Unpacked a chunk at a time.
+		uint16_t Half[256];
+		float Value[256];
+		for (size_t i = 0; i < aCount; i += 256) {
+			size_t Count = std::min<size_t>(aCount - i, 256);
+			for (size_t j = 0; j < Count; j++) {
+				Half[j] = aSource[(i + j) * aStride];
+			}
+			half_to_float(Value, Half, Count);
+			coverage Chunk = coverage_float(Value, Count, 1);
+			Coverage.Opaque 		+= Chunk.Opaque;
+			Coverage.Transparent 	+= Chunk.Transparent;
+			Coverage.Translucent 	+= Chunk.Translucent;
+		}
+		return Coverage;
+	}
+
+	coverage coverage_float(const float* aSource, size_t aCount, size_t aStride) {
+		coverage Coverage = { 0, 0, 0 };
+		if (aCount == 0) return Coverage;
+		size_t Extent = (aCount - 1) * aStride + 1;
+		size_t i = 0;
+#if defined(GEODESY_GPU_PIXEL_SSE2)
+		const __m128 Opaque = _mm_set1_ps(OpaqueThreshold);
+		const __m128 Transparent = _mm_set1_ps(TransparentThreshold);
+		if (aStride == 1) {
+			for (; i + 4 <= aCount; i += 4) {
+				__m128 Value = _mm_loadu_ps(aSource + i);
+				Coverage.Opaque 		+= bit_count((uint32_t)_mm_movemask_ps(_mm_cmpge_ps(Value, Opaque)));
+				Coverage.Transparent 	+= bit_count((uint32_t)_mm_movemask_ps(_mm_cmple_ps(Value, Transparent)));
+			}
+		}
+		else if (aStride == 4) {
+			// The channel is the first lane of every load, gathered from four pixels with unpacks.
+			for (; i * 4 + 16 <= Extent; i += 4) {
+				__m128 A = _mm_loadu_ps(aSource + i * 4 + 0);
+				__m128 B = _mm_loadu_ps(aSource + i * 4 + 4);
+				__m128 C = _mm_loadu_ps(aSource + i * 4 + 8);
+				__m128 D = _mm_loadu_ps(aSource + i * 4 + 12);
+				__m128 Value = _mm_movelh_ps(_mm_unpacklo_ps(A, B), _mm_unpacklo_ps(C, D));
+				Coverage.Opaque 		+= bit_count((uint32_t)_mm_movemask_ps(_mm_cmpge_ps(Value, Opaque)));
+				Coverage.Transparent 	+= bit_count((uint32_t)_mm_movemask_ps(_mm_cmple_ps(Value, Transparent)));
+			}
+		}
+#elif defined(GEODESY_GPU_PIXEL_NEON)
+		const float32x4_t Opaque = vdupq_n_f32(OpaqueThreshold);
+		const float32x4_t Transparent = vdupq_n_f32(TransparentThreshold);
+		if (aStride == 1) {
+			for (; i + 4 <= aCount; i += 4) {
+				float32x4_t Value = vld1q_f32(aSource + i);
+				Coverage.Opaque 		+= lane_count(vcgeq_f32(Value, Opaque));
+				Coverage.Transparent 	+= lane_count(vcleq_f32(Value, Transparent));
+			}
+		}
+		else if (aStride == 4) {
+			for (; i * 4 + 16 <= Extent; i += 4) {
+				float32x4_t Value = vld4q_f32(aSource + i * 4).val[0];
+				Coverage.Opaque 		+= lane_count(vcgeq_f32(Value, Opaque));
+				Coverage.Transparent 	+= lane_count(vcleq_f32(Value, Transparent));
+			}
+		}
+#endif
+		for (; i < aCount; i++) {
+			float Value = aSource[i * aStride];
+			Coverage.Opaque 		+= (Value >= OpaqueThreshold);
+			Coverage.Transparent 	+= (Value <= TransparentThreshold);
+		}
+		Coverage.Translucent = aCount - Coverage.Opaque - Coverage.Transparent;
+		return Coverage;
+	}
+
+}
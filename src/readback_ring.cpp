@@ -0,0 +1,269 @@
+#include <geodesy/gpu/readback_ring.h>
+#include <geodesy/gpu/pixel.h>
+#include <geodesy/gpu/context.h>
+
+namespace geodesy::gpu {
+
+	// Host cached memory first, reads from write combined memory are very slow.
+	static unsigned int readback_memory_type(std::shared_ptr<device> aDevice) {
+		const unsigned int Candidate[3] = {
+			device::memory::HOST_VISIBLE | device::memory::HOST_CACHED | device::memory::HOST_COHERENT,
+			device::memory::HOST_VISIBLE | device::memory::HOST_CACHED,
+			device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT
+		};
+		for (unsigned int MemoryType : Candidate) {
+			for (uint32_t i = 0; i < aDevice->MemoryProperties.memoryTypeCount; i++) {
+				if ((aDevice->MemoryProperties.memoryTypes[i].propertyFlags & MemoryType) == MemoryType) return MemoryType;
+			}
+		}
+		return device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT;
+	}
+
+	static bool is_rgba8(int aFormat) {
+		return (aFormat == VK_FORMAT_R8G8B8A8_UNORM) || (aFormat == VK_FORMAT_R8G8B8A8_SRGB);
+	}
+
+	static bool is_bgra8(int aFormat) {
+		return (aFormat == VK_FORMAT_B8G8R8A8_UNORM) || (aFormat == VK_FORMAT_B8G8R8A8_SRGB);
+	}
+
+	static bool is_srgb8(int aFormat) {
+		return (aFormat == VK_FORMAT_R8G8B8A8_SRGB) || (aFormat == VK_FORMAT_B8G8R8A8_SRGB);
+	}
+
+	// Encodes linear RGBA floats as RGBA8, sRGB encoding the color channels if aFormat is sRGB.
+	static void encode_rgba8(uint8_t* aDestination, const float* aSource, size_t aPixelCount, int aFormat) {
+		if (aFormat == VK_FORMAT_R8G8B8A8_SRGB) {
+			pixel::linear_to_srgb8(aDestination, aSource, aPixelCount, 4);
+		}
+		else {
+			pixel::float_to_unorm8(aDestination, aSource, aPixelCount * 4);
+		}
+	}
+
+	readback_ring::readback_ring() {
+		this->Context 		= nullptr;
+		this->Type 			= resource::type::UNKNOWN;
+		this->SlotCount 	= 0;
+		this->SlotSize 		= 0;
+		this->OutputFormat 	= image::format::FORMAT_UNDEFINED;
+		this->Callback 		= nullptr;
+		this->WriteIndex 	= 0;
+		this->ReadIndex 	= 0;
+		this->Held 			= -1;
+		this->Coherent 		= true;
+	}
+
+	readback_ring::readback_ring(std::shared_ptr<context> aContext, uint32_t aSlotCount, size_t aSlotSize, image::format aOutputFormat, callback aCallback) : readback_ring() {
+		VkResult Result = VK_SUCCESS;
+		PFN_vkCreateEvent vkCreateEvent = (PFN_vkCreateEvent)aContext->function_pointer("vkCreateEvent");
+		this->Context 		= aContext;
+		this->SlotCount 	= aSlotCount;
+		this->SlotSize 		= aSlotSize;
+		this->OutputFormat 	= aOutputFormat;
+		this->Callback 		= aCallback;
+
+		unsigned int MemoryType = readback_memory_type(aContext->Device);
+		this->Coherent = (MemoryType & device::memory::HOST_COHERENT) != 0;
+		this->Slot = std::vector<slot>(aSlotCount);
+		for (slot& Slot : this->Slot) {
+			Slot.Buffer = geodesy::make<buffer>(aContext, MemoryType, buffer::TRANSFER_DST, aSlotSize);
+			if (Slot.Buffer == nullptr) {
+				throw std::runtime_error("Failed to create readback buffer.");
+			}
+			// Mapped for the lifetime of the ring, unmapped by the buffer.
+			Slot.Data = (uint8_t*)Slot.Buffer->map_memory(0, aSlotSize);
+			VkEventCreateInfo ECI{};
+			ECI.sType 		= VK_STRUCTURE_TYPE_EVENT_CREATE_INFO;
+			ECI.pNext 		= NULL;
+			ECI.flags 		= 0;
+			Slot.Event 		= VK_NULL_HANDLE;
+			Result = vkCreateEvent(aContext->Handle, &ECI, NULL, &Slot.Event);
+			if ((Slot.Data == NULL) || (Result != VK_SUCCESS)) {
+				throw std::runtime_error("Failed to create readback slot.");
+			}
+			Slot.Pending 	= false;
+		}
+	}
+
+	readback_ring::~readback_ring() {
+		if (this->Context == nullptr) return;
+		PFN_vkDestroyEvent vkDestroyEvent = (PFN_vkDestroyEvent)this->Context->function_pointer("vkDestroyEvent");
+		for (slot& Slot : this->Slot) {
+			if (Slot.Event != VK_NULL_HANDLE) {
+				vkDestroyEvent(this->Context->Handle, Slot.Event, NULL);
+			}
+		}
+	}
+
+	bool readback_ring::convertible(int aSourceFormat, int aOutputFormat) {
+		if ((aOutputFormat == VK_FORMAT_UNDEFINED) || (aOutputFormat == aSourceFormat)) return true;
+		switch (aSourceFormat) {
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			// Swizzles only, the encoding is kept.
+			return ((is_rgba8(aSourceFormat) && is_bgra8(aOutputFormat)) || (is_bgra8(aSourceFormat) && is_rgba8(aOutputFormat))) && (is_srgb8(aSourceFormat) == is_srgb8(aOutputFormat));
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			return (aOutputFormat == VK_FORMAT_R32G32B32A32_SFLOAT) || (aOutputFormat == VK_FORMAT_R8G8B8A8_UNORM) || (aOutputFormat == VK_FORMAT_R8G8B8A8_SRGB);
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return (aOutputFormat == VK_FORMAT_R8G8B8A8_UNORM) || (aOutputFormat == VK_FORMAT_R8G8B8A8_SRGB);
+		default:
+			return false;
+		}
+	}
+
+	VkResult readback_ring::record(command_buffer* aCommandBuffer, std::shared_ptr<image> aImage, uint64_t aFrameIndex, uint32_t aMipLevel) {
+		PFN_vkCmdSetEvent vkCmdSetEvent = (PFN_vkCmdSetEvent)this->Context->function_pointer("vkCmdSetEvent");
+		if ((aImage == nullptr) || (aMipLevel >= aImage->CreateInfo.mipLevels)) return VK_ERROR_INITIALIZATION_FAILED;
+		if (!convertible(aImage->CreateInfo.format, this->OutputFormat)) return VK_ERROR_FORMAT_NOT_SUPPORTED;
+		slot& Slot = this->Slot[this->WriteIndex];
+		if (Slot.Pending) return VK_NOT_READY;
+
+		VkBufferImageCopy Region{};
+		Region.bufferOffset 		= 0;
+		Region.bufferRowLength 		= 0; 		// Tightly packed.
+		Region.bufferImageHeight 	= 0;
+		Region.imageSubresource 	= { image::aspect_flag(aImage->CreateInfo.format), aMipLevel, 0, aImage->CreateInfo.arrayLayers };
+		Region.imageOffset 			= { 0, 0, 0 };
+		Region.imageExtent 			= {
+			std::max(aImage->CreateInfo.extent.width >> aMipLevel, 1u),
+			std::max(aImage->CreateInfo.extent.height >> aMipLevel, 1u),
+			std::max(aImage->CreateInfo.extent.depth >> aMipLevel, 1u)
+		};
+		size_t Size = aImage->region_size(Region);
+		if (Size > this->SlotSize) return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+
+		aImage->require(aCommandBuffer, image::TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, aMipLevel, 1);
+		Slot.Buffer->require(aCommandBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+		Slot.Buffer->copy(aCommandBuffer, aImage, { Region });
+		// Makes the copy visible to the host before the event is signaled.
+		Slot.Buffer->require(aCommandBuffer, VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+		vkCmdSetEvent(aCommandBuffer->Handle, Slot.Event, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		Slot.Pending 		= true;
+		Slot.Index 			= aFrameIndex;
+		Slot.Format 		= (image::format)aImage->CreateInfo.format;
+		Slot.Extent 		= Region.imageExtent;
+		Slot.LayerCount 	= aImage->CreateInfo.arrayLayers;
+		Slot.Size 			= Size;
+		this->WriteIndex 	= (this->WriteIndex + 1) % this->SlotCount;
+		return VK_SUCCESS;
+	}
+
+	bool readback_ring::next(frame& aFrame) {
+		PFN_vkGetEventStatus vkGetEventStatus = (PFN_vkGetEventStatus)this->Context->function_pointer("vkGetEventStatus");
+		PFN_vkInvalidateMappedMemoryRanges vkInvalidateMappedMemoryRanges = (PFN_vkInvalidateMappedMemoryRanges)this->Context->function_pointer("vkInvalidateMappedMemoryRanges");
+		if (this->SlotCount == 0) return false;
+		this->release_held();
+		slot& Slot = this->Slot[this->ReadIndex];
+		if (!Slot.Pending || (vkGetEventStatus(this->Context->Handle, Slot.Event) != VK_EVENT_SET)) return false;
+
+		if (!this->Coherent) {
+			VkMappedMemoryRange Range{};
+			Range.sType 	= VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+			Range.pNext 	= NULL;
+			Range.memory 	= Slot.Buffer->MemoryHandle;
+			Range.offset 	= 0;
+			Range.size 		= VK_WHOLE_SIZE;
+			vkInvalidateMappedMemoryRanges(this->Context->Handle, 1, &Range);
+		}
+
+		aFrame.Index 		= Slot.Index;
+		aFrame.Extent 		= Slot.Extent;
+		aFrame.LayerCount 	= Slot.LayerCount;
+		// Consumed even if it could not be converted, so later frames are not held up.
+		this->Held 			= (int)this->ReadIndex;
+		this->ReadIndex 	= (this->ReadIndex + 1) % this->SlotCount;
+		return this->convert(Slot, aFrame);
+	}
+
+	size_t readback_ring::poll() {
+		size_t Count = 0;
+		frame Frame{};
+		while (this->next(Frame)) {
+			if (this->Callback != nullptr) {
+				this->Callback(Frame);
+			}
+			Count++;
+		}
+		return Count;
+	}
+
+	bool readback_ring::cancel() {
+		PFN_vkGetEventStatus vkGetEventStatus = (PFN_vkGetEventStatus)this->Context->function_pointer("vkGetEventStatus");
+		if (this->SlotCount == 0) return false;
+		uint32_t Last = (this->WriteIndex + this->SlotCount - 1) % this->SlotCount;
+		slot& Slot = this->Slot[Last];
+		// A set event means the copy was submitted and has completed, that frame is consumed by next().
+		if (!Slot.Pending || ((int)Last == this->Held) || (vkGetEventStatus(this->Context->Handle, Slot.Event) == VK_EVENT_SET)) return false;
+		Slot.Pending 		= false;
+		this->WriteIndex 	= Last;
+		return true;
+	}
+
+	size_t readback_ring::pending() const {
+		size_t Count = 0;
+		for (const slot& Slot : this->Slot) {
+			Count += Slot.Pending ? 1 : 0;
+		}
+		return Count;
+	}
+
+	void readback_ring::release_held() {
+		PFN_vkResetEvent vkResetEvent = (PFN_vkResetEvent)this->Context->function_pointer("vkResetEvent");
+		if (this->Held < 0) return;
+		slot& Slot = this->Slot[this->Held];
+		vkResetEvent(this->Context->Handle, Slot.Event);
+		Slot.Pending 	= false;
+		this->Held 		= -1;
+	}
+
+	bool readback_ring::convert(slot& aSlot, frame& aFrame) {
+		int Output = (this->OutputFormat == image::format::FORMAT_UNDEFINED) ? (int)aSlot.Format : (int)this->OutputFormat;
+		size_t PixelCount = (size_t)aSlot.Extent.width * aSlot.Extent.height * aSlot.Extent.depth * aSlot.LayerCount;
+		aFrame.Format 		= (image::format)Output;
+		aFrame.RowPitch 	= (size_t)aSlot.Extent.width * image::bytes_per_pixel(Output);
+
+		// Mapped memory is handed out directly when no conversion is needed.
+		if (Output == (int)aSlot.Format) {
+			aFrame.Data = aSlot.Data;
+			aFrame.Size = aSlot.Size;
+			return true;
+		}
+
+		aFrame.Size = PixelCount * image::bytes_per_pixel(Output);
+		aSlot.Converted.resize(aFrame.Size);
+		aFrame.Data = aSlot.Converted.data();
+		switch (aSlot.Format) {
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			pixel::swizzle_rgba8_bgra8(aSlot.Converted.data(), aSlot.Data, PixelCount);
+			return true;
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			if (Output == VK_FORMAT_R32G32B32A32_SFLOAT) {
+				pixel::half_to_float((float*)aSlot.Converted.data(), (const uint16_t*)aSlot.Data, PixelCount * 4);
+				return true;
+			}
+			{
+				// Unpacked a chunk at a time, nothing is allocated per frame.
+				float Linear[256 * 4];
+				for (size_t i = 0; i < PixelCount; i += 256) {
+					size_t Count = std::min<size_t>(PixelCount - i, 256);
+					pixel::half_to_float(Linear, (const uint16_t*)aSlot.Data + i * 4, Count * 4);
+					encode_rgba8(aSlot.Converted.data() + i * 4, Linear, Count, Output);
+				}
+			}
+			return true;
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			encode_rgba8(aSlot.Converted.data(), (const float*)aSlot.Data, PixelCount, Output);
+			return true;
+		default:
+			return false;
+		}
+	}
+
+}
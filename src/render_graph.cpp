@@ -0,0 +1,469 @@
+#include <geodesy/gpu/render_graph.h>
+#include <geodesy/gpu/pipeline.h>
+#include <geodesy/gpu/context.h>
+
+#include <cmath>
+#include <set>
+#include <algorithm>
+
+namespace geodesy::gpu {
+
+	static const size_t NoBatch = SIZE_MAX;
+
+	render_graph::pass::pass(std::string aName, device::operation aOperation, record_function aRecord) {
+		this->Name = aName;
+		this->Operation = aOperation;
+		this->Record = aRecord;
+	}
+
+	render_graph::pass& render_graph::pass::read(std::shared_ptr<image> aImage, image::layout aLayout, VkPipelineStageFlags aStage, VkAccessFlags aAccess) {
+		this->Image.push_back({ aImage, aLayout, aStage, aAccess, false });
+		return *this;
+	}
+
+	render_graph::pass& render_graph::pass::write(std::shared_ptr<image> aImage, image::layout aLayout, VkPipelineStageFlags aStage, VkAccessFlags aAccess) {
+		this->Image.push_back({ aImage, aLayout, aStage, aAccess, true });
+		return *this;
+	}
+
+	render_graph::pass& render_graph::pass::read(std::shared_ptr<buffer> aBuffer, VkPipelineStageFlags aStage, VkAccessFlags aAccess) {
+		this->Buffer.push_back({ aBuffer, aStage, aAccess, false });
+		return *this;
+	}
+
+	render_graph::pass& render_graph::pass::write(std::shared_ptr<buffer> aBuffer, VkPipelineStageFlags aStage, VkAccessFlags aAccess) {
+		this->Buffer.push_back({ aBuffer, aStage, aAccess, true });
+		return *this;
+	}
+
+	render_graph::render_graph() {
+		this->Context = nullptr;
+	}
+
+	render_graph::render_graph(std::shared_ptr<context> aContext) : render_graph() {
+		this->Context = aContext;
+	}
+
+	render_graph::~render_graph() {
+		this->destroy_transients();
+	}
+
+	std::shared_ptr<render_graph::pass> render_graph::add_pass(std::string aName, device::operation aOperation, record_function aRecord) {
+		std::shared_ptr<pass> NewPass = std::make_shared<pass>(aName, aOperation, aRecord);
+		this->Pass.push_back(NewPass);
+		return NewPass;
+	}
+
+	std::shared_ptr<image> render_graph::create_transient(image::create_info aCreateInfo, image::format aFormat, unsigned int aX, unsigned int aY, unsigned int aZ, unsigned int aT) {
+		// Described now so callers can query it, handles are created by compile().
+		std::shared_ptr<image> Image = std::make_shared<image>();
+		Image->Context 							= this->Context;
+		Image->CreateInfo.pNext 				= NULL;
+		Image->CreateInfo.flags 				= 0;
+		Image->CreateInfo.imageType 			= (aZ == 1) ? ((aY == 1) ? VK_IMAGE_TYPE_1D : VK_IMAGE_TYPE_2D) : VK_IMAGE_TYPE_3D;
+		Image->CreateInfo.format 				= (VkFormat)aFormat;
+		Image->CreateInfo.extent 				= { aX, aY, aZ };
+		Image->CreateInfo.mipLevels 			= aCreateInfo.MipLevels ? (uint32_t)std::floor(std::log2(std::max(std::max(aX, aY), aZ))) + 1 : 1;
+		Image->CreateInfo.arrayLayers 			= aT;
+		Image->CreateInfo.samples 				= (VkSampleCountFlagBits)aCreateInfo.Sample;
+		Image->CreateInfo.tiling 				= (VkImageTiling)aCreateInfo.Tiling;
+		Image->CreateInfo.usage 				= (VkImageUsageFlags)aCreateInfo.Usage;
+		Image->CreateInfo.sharingMode 			= VK_SHARING_MODE_EXCLUSIVE;
+		Image->CreateInfo.queueFamilyIndexCount = 0;
+		Image->CreateInfo.pQueueFamilyIndices 	= NULL;
+		Image->CreateInfo.initialLayout 		= VK_IMAGE_LAYOUT_UNDEFINED;
+		Image->MemoryType 						= aCreateInfo.Memory;
+		if (aCreateInfo.Transient) {
+			Image->CreateInfo.mipLevels 			= 1;
+			Image->CreateInfo.usage 				= (Image->CreateInfo.usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT)) | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		}
+		this->Transient.push_back({ Image, aCreateInfo, 0, 0, 0 });
+		return Image;
+	}
+
+	void render_graph::import(std::shared_ptr<image> aImage, image::layout aInitialLayout, image::layout aFinalLayout) {
+		this->Import[aImage] = { aInitialLayout, aFinalLayout };
+	}
+
+	VkResult render_graph::compile() {
+		VkResult Result = VK_SUCCESS;
+
+		Result = this->allocate_transients();
+		if (Result != VK_SUCCESS) return Result;
+
+		// Adjacent passes on the same queue family share a batch.
+		this->Batch.clear();
+		this->Semaphore.clear();
+		for (size_t i = 0; i < this->Pass.size(); i++) {
+			context::queue Queue = this->Context->get_execution_queue(this->Pass[i]->Operation);
+			if (Queue.Handle == VK_NULL_HANDLE) return VK_ERROR_FEATURE_NOT_PRESENT;
+			if (this->Batch.empty() || (this->Batch.back().QueueFamily != (uint32_t)Queue.FamilyIndex)) {
+				batch NewBatch{};
+				NewBatch.Operation 		= this->Pass[i]->Operation;
+				NewBatch.QueueFamily 	= Queue.FamilyIndex;
+				this->Batch.push_back(NewBatch);
+			}
+			this->Batch.back().Pass.push_back(i);
+		}
+
+		// Transient image to memory block, and last use of each block.
+		std::map<image*, size_t> TransientBlock;
+		for (const transient& Entry : this->Transient) {
+			TransientBlock[Entry.Image.get()] = Entry.Block;
+		}
+		// Stages and writes of the last occupant of each block, and the batch it was last used in.
+		struct block_use {
+			VkPipelineStageFlags 	Stage;
+			VkAccessFlags 			Access;
+			size_t 					Batch;
+		};
+		std::vector<block_use> BlockUse(this->Memory.size(), { 0, 0, NoBatch });
+
+		std::map<void*, state> State;
+		// Images whose first layout comes from their tracking, re-read by every execute().
+		std::set<image*> Tracked;
+		this->FirstUse.clear();
+		// Batch b waits on batch a at these stages.
+		std::vector<std::map<size_t, VkPipelineStageFlags>> Wait(this->Batch.size());
+
+		auto initial_state = [&](void* aResource, image* aImage) -> state& {
+			auto It = State.find(aResource);
+			if (It != State.end()) return It->second;
+			state Initial{};
+			Initial.Layout 			= image::layout::LAYOUT_UNDEFINED;
+			Initial.QueueFamily 	= VK_QUEUE_FAMILY_IGNORED;
+			Initial.Batch 			= NoBatch;
+			if (aImage != nullptr) {
+				auto Block = TransientBlock.find(aImage);
+				if (Block != TransientBlock.end()) {
+					// Aliased memory, the previous occupant must be done with it and its writes made available.
+					Initial.WriteStage 		= BlockUse[Block->second].Stage;
+					Initial.WriteAccess 	= BlockUse[Block->second].Access;
+					Initial.Batch 			= BlockUse[Block->second].Batch;
+				}
+				else {
+					auto Imported = std::find_if(this->Import.begin(), this->Import.end(), [&](const auto& aEntry) { return aEntry.first.get() == aImage; });
+					bool Explicit = (Imported != this->Import.end()) && (Imported->second.InitialLayout != image::layout::LAYOUT_CURRENT);
+					Initial.Layout 			= Explicit ? Imported->second.InitialLayout : aImage->current_layout();
+					if (!Explicit) {
+						Tracked.insert(aImage);
+					}
+				}
+			}
+			return State[aResource] = Initial;
+		};
+
+		// Derives the barrier needed before an access, and updates the resource state.
+		auto access = [&](size_t aBatch, barrier_set& aBarrier, void* aResource, image* aImage, buffer* aBuffer, image::layout aLayout, VkPipelineStageFlags aStage, VkAccessFlags aAccess, bool aWrite) {
+			state& S = initial_state(aResource, aImage);
+			batch& B = this->Batch[aBatch];
+			// The layout a tracked image starts in may differ by execute(), its first use always transitions.
+			bool FirstUse = (aImage != nullptr) && (S.Batch == NoBatch) && (Tracked.count(aImage) > 0);
+			bool LayoutChange = (aImage != nullptr) && ((S.Layout != aLayout) || FirstUse);
+			bool CrossBatch = (S.Batch != NoBatch) && (S.Batch != aBatch);
+			// Contents must be kept, ownership moves to this queue family.
+			bool CrossQueue = (S.QueueFamily != VK_QUEUE_FAMILY_IGNORED) && (S.QueueFamily != B.QueueFamily) && (S.Layout != image::layout::LAYOUT_UNDEFINED || aImage == nullptr);
+
+			if (CrossBatch) {
+				Wait[aBatch][S.Batch] |= aStage;
+			}
+
+			bool Needed = false;
+			VkPipelineStageFlags SrcStage = 0;
+			VkAccessFlags SrcAccess = 0;
+			if (CrossQueue) {
+				// Release in the batch that last used it, acquire here.
+				batch& Owner = this->Batch[S.Batch];
+				if (aImage != nullptr) {
+					VkImageMemoryBarrier Release = aImage->memory_barrier(S.WriteAccess, 0, S.Layout, aLayout);
+					Release.srcQueueFamilyIndex 	= S.QueueFamily;
+					Release.dstQueueFamilyIndex 	= B.QueueFamily;
+					Owner.ReleaseImage.push_back(Release);
+					VkImageMemoryBarrier Acquire = Release;
+					Acquire.srcAccessMask 			= 0;
+					Acquire.dstAccessMask 			= aAccess;
+					aBarrier.ImageBarrier.push_back(Acquire);
+				}
+				else {
+					VkBufferMemoryBarrier Release = aBuffer->memory_barrier(S.WriteAccess, 0, 0, VK_WHOLE_SIZE);
+					Release.srcQueueFamilyIndex 	= S.QueueFamily;
+					Release.dstQueueFamilyIndex 	= B.QueueFamily;
+					Owner.ReleaseBuffer.push_back(Release);
+					VkBufferMemoryBarrier Acquire = Release;
+					Acquire.srcAccessMask 			= 0;
+					Acquire.dstAccessMask 			= aAccess;
+					aBarrier.BufferBarrier.push_back(Acquire);
+				}
+				Owner.ReleaseStage 	|= S.WriteStage | S.ReadStage;
+				aBarrier.SrcStage 	|= aStage;
+				aBarrier.DstStage 	|= aStage;
+			}
+			else {
+				if (CrossBatch) {
+					// The semaphore wait already made prior writes visible at aStage.
+					Needed = LayoutChange;
+					SrcStage = aStage;
+				}
+				else if (LayoutChange) {
+					Needed = true;
+					SrcStage = S.WriteStage | S.ReadStage;
+					SrcAccess = S.WriteAccess;
+				}
+				else if (aWrite) {
+					// Write after write or write after read.
+					Needed = (S.WriteStage | S.ReadStage) != 0;
+					SrcStage = S.WriteStage | S.ReadStage;
+					SrcAccess = S.WriteAccess;
+				}
+				else {
+					// Read after write, unless an earlier read already covered this stage and access.
+					bool Covered = ((S.ReadStage & aStage) == aStage) && ((S.ReadAccess & aAccess) == aAccess);
+					Needed = (S.WriteStage != 0) && !Covered;
+					SrcStage = S.WriteStage;
+					SrcAccess = S.WriteAccess;
+				}
+				if (Needed) {
+					if (FirstUse) {
+						this->FirstUse.push_back({ aImage, aBatch, B.Barrier.size(), aBarrier.ImageBarrier.size() });
+					}
+					if (aImage != nullptr) {
+						aBarrier.ImageBarrier.push_back(aImage->memory_barrier(SrcAccess, aAccess, S.Layout, aLayout));
+					}
+					else {
+						aBarrier.BufferBarrier.push_back(aBuffer->memory_barrier(SrcAccess, aAccess, 0, VK_WHOLE_SIZE));
+					}
+					aBarrier.SrcStage 	|= (SrcStage != 0) ? SrcStage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+					aBarrier.DstStage 	|= aStage;
+				}
+			}
+
+			// Layout transitions count as writes.
+			if (aWrite || LayoutChange || CrossQueue) {
+				S.WriteStage 	= aStage;
+				S.WriteAccess 	= aWrite ? aAccess : 0;
+				S.ReadStage 	= aWrite ? 0 : aStage;
+				S.ReadAccess 	= aWrite ? 0 : aAccess;
+			}
+			else {
+				S.ReadStage 	|= aStage;
+				S.ReadAccess 	|= aAccess;
+			}
+			if (aImage != nullptr) S.Layout = aLayout;
+			S.QueueFamily 	= B.QueueFamily;
+			S.Batch 		= aBatch;
+
+			if (aImage != nullptr) {
+				auto Block = TransientBlock.find(aImage);
+				if (Block != TransientBlock.end()) {
+					BlockUse[Block->second] = { S.WriteStage | S.ReadStage, S.WriteAccess, aBatch };
+				}
+			}
+		};
+
+		for (size_t b = 0; b < this->Batch.size(); b++) {
+			for (size_t p : this->Batch[b].Pass) {
+				barrier_set Barrier{};
+				for (const pass::image_access& Access : this->Pass[p]->Image) {
+					access(b, Barrier, Access.Image.get(), Access.Image.get(), nullptr, Access.Layout, Access.Stage, Access.Access, Access.Write);
+				}
+				for (const pass::buffer_access& Access : this->Pass[p]->Buffer) {
+					access(b, Barrier, Access.Buffer.get(), nullptr, Access.Buffer.get(), image::layout::LAYOUT_UNDEFINED, Access.Stage, Access.Access, Access.Write);
+				}
+				this->Batch[b].Barrier.push_back(Barrier);
+			}
+		}
+
+		// Imported images are left in their requested layouts, by the batch that used them last.
+		for (auto& [Image, Info] : this->Import) {
+			auto It = State.find(Image.get());
+			if ((It == State.end()) || (Info.FinalLayout == image::layout::LAYOUT_UNDEFINED) || (It->second.Layout == Info.FinalLayout)) continue;
+			barrier_set& Final = this->Batch[It->second.Batch].Final;
+			Final.ImageBarrier.push_back(Image->memory_barrier(It->second.WriteAccess, 0, It->second.Layout, Info.FinalLayout));
+			Final.SrcStage |= It->second.WriteStage | It->second.ReadStage;
+			// Access and stage of the final transition, as a render pass end() tracks it.
+			It->second.Layout 		= Info.FinalLayout;
+			It->second.WriteStage 	= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			It->second.WriteAccess 	= 0;
+			It->second.ReadStage 	= 0;
+		}
+
+		// Layout and outstanding accesses of every image once the graph completes.
+		this->Track.clear();
+		for (size_t p = 0; p < this->Pass.size(); p++) {
+			for (const pass::image_access& Access : this->Pass[p]->Image) {
+				const state& S = State[Access.Image.get()];
+				if (std::any_of(this->Track.begin(), this->Track.end(), [&](const image_track& aTrack) { return aTrack.Image == Access.Image.get(); })) continue;
+				this->Track.push_back({ Access.Image.get(), S.Layout, S.WriteAccess, S.WriteStage | S.ReadStage });
+			}
+		}
+
+		// Command buffers, one pool per queue family.
+		for (batch& B : this->Batch) {
+			if (this->CommandPool.count(B.QueueFamily) == 0) {
+				this->CommandPool[B.QueueFamily] = this->Context->create<command_pool>(B.Operation, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+				if (this->CommandPool[B.QueueFamily] == nullptr) return VK_ERROR_INITIALIZATION_FAILED;
+			}
+			B.Submission = std::make_shared<command_batch>(std::vector<std::shared_ptr<command_buffer>>{ this->CommandPool[B.QueueFamily]->create<command_buffer>() });
+		}
+
+		// Semaphores between dependent batches, every terminal batch also signals the last one so one fence covers the graph.
+		std::vector<bool> Waited(this->Batch.size(), false);
+		for (size_t b = 0; b < this->Batch.size(); b++) {
+			for (auto& [Source, Stage] : Wait[b]) {
+				std::shared_ptr<semaphore> Semaphore = this->Context->create<semaphore>();
+				this->Batch[b].Submission->depends_on(Semaphore, Stage, this->Batch[Source].Submission);
+				this->Semaphore.push_back(Semaphore);
+				Waited[Source] = true;
+			}
+		}
+		for (size_t b = 0; b + 1 < this->Batch.size(); b++) {
+			if (Waited[b]) continue;
+			std::shared_ptr<semaphore> Semaphore = this->Context->create<semaphore>();
+			this->Batch.back().Submission->depends_on(Semaphore, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, this->Batch[b].Submission);
+			this->Semaphore.push_back(Semaphore);
+		}
+
+		return VK_SUCCESS;
+	}
+
+	VkResult render_graph::execute(std::shared_ptr<fence> aFence) {
+		VkResult Result = VK_SUCCESS;
+		// First uses of tracked images transition from wherever the previous execute() or other work left them.
+		for (const first_use& Use : this->FirstUse) {
+			this->Batch[Use.Batch].Barrier[Use.Pass].ImageBarrier[Use.Barrier].oldLayout = (VkImageLayout)Use.Image->current_layout();
+		}
+		for (batch& B : this->Batch) {
+			command_buffer* CommandBuffer = (*B.Submission)[0].get();
+			Result = CommandBuffer->begin();
+			if (Result != VK_SUCCESS) return Result;
+			for (size_t i = 0; i < B.Pass.size(); i++) {
+				const barrier_set& Barrier = B.Barrier[i];
+				if ((Barrier.ImageBarrier.size() > 0) || (Barrier.BufferBarrier.size() > 0)) {
+					pipeline::barrier(CommandBuffer, Barrier.SrcStage, Barrier.DstStage, {}, Barrier.BufferBarrier, Barrier.ImageBarrier);
+				}
+				if (this->Pass[B.Pass[i]]->Record) {
+					this->Pass[B.Pass[i]]->Record(CommandBuffer);
+				}
+			}
+			// Ownership releases and final layouts share one barrier.
+			std::vector<VkImageMemoryBarrier> ImageBarrier = B.ReleaseImage;
+			ImageBarrier.insert(ImageBarrier.end(), B.Final.ImageBarrier.begin(), B.Final.ImageBarrier.end());
+			if ((ImageBarrier.size() > 0) || (B.ReleaseBuffer.size() > 0)) {
+				VkPipelineStageFlags SrcStage = B.ReleaseStage | B.Final.SrcStage;
+				pipeline::barrier(CommandBuffer, (SrcStage != 0) ? SrcStage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, {}, B.ReleaseBuffer, ImageBarrier);
+			}
+			Result = CommandBuffer->end();
+			if (Result != VK_SUCCESS) return Result;
+		}
+		// Operations recorded after the graph start from where it leaves its images.
+		for (const image_track& Track : this->Track) {
+			Track.Image->track(Track.Layout, Track.Access, Track.Stage);
+		}
+		// Submitted in graph order, every wait is on an earlier submission.
+		for (size_t b = 0; b < this->Batch.size(); b++) {
+			Result = this->Context->execute(this->Batch[b].Operation, std::vector<std::shared_ptr<command_batch>>{ this->Batch[b].Submission }, (b + 1 == this->Batch.size()) ? aFence : nullptr);
+			if (Result != VK_SUCCESS) return Result;
+		}
+		return Result;
+	}
+
+	void render_graph::destroy_transients() {
+		if (this->Context == nullptr) return;
+		PFN_vkDestroyImageView vkDestroyImageView = (PFN_vkDestroyImageView)this->Context->function_pointer("vkDestroyImageView");
+		PFN_vkDestroyImage vkDestroyImage = (PFN_vkDestroyImage)this->Context->function_pointer("vkDestroyImage");
+		// The image objects stay valid for the passes referencing them, only their handles go.
+		for (transient& Entry : this->Transient) {
+			this->Context->evict_framebuffers(Entry.Image.get());
+			if (Entry.Image->View != VK_NULL_HANDLE) {
+				vkDestroyImageView(this->Context->Handle, Entry.Image->View, NULL);
+				Entry.Image->View = VK_NULL_HANDLE;
+			}
+			if (Entry.Image->Handle != VK_NULL_HANDLE) {
+				vkDestroyImage(this->Context->Handle, Entry.Image->Handle, NULL);
+				Entry.Image->Handle = VK_NULL_HANDLE;
+			}
+		}
+		for (VkDeviceMemory& Block : this->Memory) {
+			this->Context->free_memory(Block);
+		}
+		this->Memory.clear();
+	}
+
+	VkResult render_graph::allocate_transients() {
+		PFN_vkCreateImage vkCreateImage = (PFN_vkCreateImage)this->Context->function_pointer("vkCreateImage");
+		PFN_vkBindImageMemory vkBindImageMemory = (PFN_vkBindImageMemory)this->Context->function_pointer("vkBindImageMemory");
+		VkResult Result = VK_SUCCESS;
+
+		this->destroy_transients();
+
+		// Lifetime of each transient in pass indices.
+		std::vector<size_t> Used;
+		for (size_t i = 0; i < this->Transient.size(); i++) {
+			transient& Entry = this->Transient[i];
+			Entry.FirstPass = SIZE_MAX;
+			Entry.LastPass = 0;
+			for (size_t p = 0; p < this->Pass.size(); p++) {
+				for (const pass::image_access& Access : this->Pass[p]->Image) {
+					if (Access.Image != Entry.Image) continue;
+					Entry.FirstPass = std::min(Entry.FirstPass, p);
+					Entry.LastPass = std::max(Entry.LastPass, p);
+				}
+			}
+			if (Entry.FirstPass != SIZE_MAX) Used.push_back(i);
+		}
+		std::sort(Used.begin(), Used.end(), [&](size_t aLHS, size_t aRHS) { return this->Transient[aLHS].FirstPass < this->Transient[aRHS].FirstPass; });
+
+		// First fit into blocks whose previous occupants are dead, blocks grow to their largest occupant.
+		struct block {
+			VkMemoryRequirements 	Requirements;
+			unsigned int 			Memory;
+			size_t 					LastPass;
+		};
+		std::vector<block> Block;
+		for (size_t i : Used) {
+			transient& Entry = this->Transient[i];
+			Result = vkCreateImage(this->Context->Handle, &Entry.Image->CreateInfo, NULL, &Entry.Image->Handle);
+			if (Result != VK_SUCCESS) return Result;
+			VkMemoryRequirements Requirements = Entry.Image->memory_requirements();
+			Entry.Image->MemoryType = Entry.CreateInfo.Memory;
+			if (Entry.CreateInfo.Transient && (this->Context->Device->get_memory_type_index(Requirements, Entry.Image->MemoryType | device::memory::LAZILY_ALLOCATED) >= 0)) {
+				Entry.Image->MemoryType |= device::memory::LAZILY_ALLOCATED;
+			}
+			size_t Fit = Block.size();
+			for (size_t j = 0; j < Block.size(); j++) {
+				if ((Block[j].LastPass < Entry.FirstPass) && (Block[j].Memory == Entry.Image->MemoryType) && ((Block[j].Requirements.memoryTypeBits & Requirements.memoryTypeBits) != 0)) {
+					Fit = j;
+					break;
+				}
+			}
+			if (Fit == Block.size()) {
+				Block.push_back({ Requirements, Entry.Image->MemoryType, Entry.LastPass });
+			}
+			else {
+				Block[Fit].Requirements.size 			= std::max(Block[Fit].Requirements.size, Requirements.size);
+				Block[Fit].Requirements.alignment 		= std::max(Block[Fit].Requirements.alignment, Requirements.alignment);
+				Block[Fit].Requirements.memoryTypeBits 	&= Requirements.memoryTypeBits;
+				Block[Fit].LastPass 					= Entry.LastPass;
+			}
+			Entry.Block = Fit;
+		}
+
+		for (const block& Entry : Block) {
+			VkDeviceMemory Memory = this->Context->allocate_memory(Entry.Requirements, Entry.Memory);
+			if (Memory == VK_NULL_HANDLE) return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+			this->Memory.push_back(Memory);
+		}
+
+		// Images never own aliased memory, MemoryHandle stays null.
+		for (size_t i : Used) {
+			transient& Entry = this->Transient[i];
+			Result = vkBindImageMemory(this->Context->Handle, Entry.Image->Handle, this->Memory[Entry.Block], 0);
+			if (Result != VK_SUCCESS) return Result;
+			Entry.Image->View = Entry.Image->view();
+			Entry.Image->ViewGeneration++;
+		}
+
+		return VK_SUCCESS;
+	}
+
+}
@@ -7,6 +7,7 @@ namespace geodesy::gpu {
 	semaphore::semaphore() {
 		this->Handle = VK_NULL_HANDLE;
 		this->Type = resource::type::SEMAPHORE;
+		this->Timeline = false;
 	}
 
 	semaphore::semaphore(std::shared_ptr<context> aContext) : semaphore() {
@@ -24,10 +25,61 @@ namespace geodesy::gpu {
 		}
 	}
 	
+	semaphore::semaphore(std::shared_ptr<context> aContext, uint64_t aInitialValue) : semaphore() {
+		PFN_vkCreateSemaphore vkCreateSemaphore = (PFN_vkCreateSemaphore)aContext->function_pointer("vkCreateSemaphore");
+		this->Context = aContext;
+		this->Timeline = true;
+
+		VkSemaphoreTypeCreateInfo STCI = {};
+		STCI.sType						= VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		STCI.pNext						= NULL;
+		STCI.semaphoreType				= VK_SEMAPHORE_TYPE_TIMELINE;
+		STCI.initialValue				= aInitialValue;
+
+		VkSemaphoreCreateInfo SCI = {};
+		SCI.sType						= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		SCI.pNext						= &STCI;
+		SCI.flags						= 0;
+
+		VkResult Result = vkCreateSemaphore(this->Context->Handle, &SCI, NULL, &this->Handle);
+		if (Result != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create timeline semaphore.");
+		}
+	}
+
 	semaphore::~semaphore() {
 		PFN_vkDestroySemaphore vkDestroySemaphore = (PFN_vkDestroySemaphore)this->Context->function_pointer("vkDestroySemaphore");
 		// It is automatically assumed that Context and Handle are valid.
 		vkDestroySemaphore(this->Context->Handle, this->Handle, NULL);
 	}
+
+	uint64_t semaphore::value() const {
+		PFN_vkGetSemaphoreCounterValue vkGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValue)this->Context->function_pointer("vkGetSemaphoreCounterValue");
+		uint64_t Value = 0;
+		vkGetSemaphoreCounterValue(this->Context->Handle, this->Handle, &Value);
+		return Value;
+	}
+
+	VkResult semaphore::wait(uint64_t aValue, uint64_t aTimeout) const {
+		PFN_vkWaitSemaphores vkWaitSemaphores = (PFN_vkWaitSemaphores)this->Context->function_pointer("vkWaitSemaphores");
+		VkSemaphoreWaitInfo SWI = {};
+		SWI.sType						= VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		SWI.pNext						= NULL;
+		SWI.flags						= 0;
+		SWI.semaphoreCount				= 1;
+		SWI.pSemaphores					= &this->Handle;
+		SWI.pValues						= &aValue;
+		return vkWaitSemaphores(this->Context->Handle, &SWI, aTimeout);
+	}
+
+	VkResult semaphore::signal(uint64_t aValue) {
+		PFN_vkSignalSemaphore vkSignalSemaphore = (PFN_vkSignalSemaphore)this->Context->function_pointer("vkSignalSemaphore");
+		VkSemaphoreSignalInfo SSI = {};
+		SSI.sType						= VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+		SSI.pNext						= NULL;
+		SSI.semaphore					= this->Handle;
+		SSI.value						= aValue;
+		return vkSignalSemaphore(this->Context->Handle, &SSI);
+	}
 	
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "glslang_util.h"
 
 #include <iostream>
+#include <sstream>
 
 namespace geodesy::gpu {
 
@@ -36,6 +37,8 @@ namespace geodesy::gpu {
 		return shader::stage::UNKNOWN;
 	}
 
+	std::shared_ptr<shader_cache> shader::Cache = std::make_shared<shader_cache>();
+
 	bool shader::initialize() {
 		return glslang::InitializeProcess();
 	}
@@ -46,7 +49,10 @@ namespace geodesy::gpu {
 
 	shader::shader() {
 		this->Stage			= shader::stage::UNKNOWN;
+		this->Source		= "";
+		this->Key			= 0;
 		this->Handle		= nullptr;
+		this->Parsed		= false;
 	}
 
 	// shader::shader(std::string aFilePath) : file(aFilePath) {
@@ -64,11 +70,30 @@ namespace geodesy::gpu {
 	// }
 
 	shader::shader(stage aShaderStage, std::string aSourceCode) : shader() {
-		// Determine Stage and compile to SPIRV.
 		this->Stage = aShaderStage;
+		this->Source = aSourceCode;
+
+		// Key everything that affects glslang output. Parsing is deferred until a pipeline 
+		// misses the cache, so cached programs never touch the glslang front end.
+		std::stringstream Options;
+		Options << GEODESY_GPU_SHADER_CACHE_VERSION << "|glsl|vulkan:" << (int)CompilerClientVersion << "|spirv:" << (int)CompilerTargetLanguageVersion;
+		Options << "|version:" << CompilerDefaultVersion << "|messages:" << (int)CompilerMessages << "|entry:main|stage:" << (int)aShaderStage << "|";
+		this->Key = shader_cache::hash(aSourceCode, shader_cache::hash(Options.str()));
+	}
+
+	bool shader::compile() {
+		// Pipelines sharing this shader may be built on several threads, only the first parses it.
+		std::lock_guard<std::mutex> Lock(this->Mutex);
+		if (this->Handle == nullptr) {
+			this->Parsed = this->compile_source(this->Stage, this->Source);
+		}
+		return this->Parsed;
+	}
 
-		// Compile and generate SPIRV.
-		this->compile_source(this->Stage, aSourceCode);
+	std::string shader::info_log() const {
+		std::lock_guard<std::mutex> Lock(this->Mutex);
+		if (this->Handle == nullptr) return "";
+		return std::string(this->Handle->getInfoLog());
 	}
 
 	VkShaderStageFlagBits shader::get_stage() {
@@ -88,22 +113,16 @@ namespace geodesy::gpu {
 	}
 
 	bool shader::compile_source(stage aShaderStage, std::string aSourceCode) {
-		EShMessages Options = (EShMessages)(
-			EShMessages::EShMsgAST | 
-			EShMessages::EShMsgSpvRules | 
-			EShMessages::EShMsgVulkanRules | 
-			EShMessages::EShMsgDebugInfo | 
-			EShMessages::EShMsgBuiltinSymbolTable
-		);
+		EShMessages Options = CompilerMessages;
 
 		EShLanguage ShaderStage 									= vulkan_to_glslang((VkShaderStageFlagBits)aShaderStage);
 		glslang::EShSource Source									= glslang::EShSource::EShSourceGlsl;
 		glslang::EShClient Client									= glslang::EShClient::EShClientVulkan;
 		int ClientInputSemanticsVersion								= 100;
-		const int DefaultVersion									= 100;
-		glslang::EShTargetClientVersion ClientVersion				= glslang::EShTargetClientVersion::EShTargetVulkan_1_2;
+		const int DefaultVersion									= CompilerDefaultVersion;
+		glslang::EShTargetClientVersion ClientVersion				= CompilerClientVersion;
 		glslang::EShTargetLanguage TargetLanguage					= glslang::EShTargetLanguage::EShTargetSpv;
-		glslang::EShTargetLanguageVersion TargetLanguageVersion		= glslang::EShTargetLanguageVersion::EShTargetSpv_1_4;
+		glslang::EShTargetLanguageVersion TargetLanguageVersion		= CompilerTargetLanguageVersion;
 
 		std::vector<const char*> SourceCode = { aSourceCode.c_str() };
 
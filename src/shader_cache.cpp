@@ -0,0 +1,254 @@
+#include <geodesy/gpu/shader_cache.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+
+namespace geodesy::gpu {
+
+	// On disk entry signature.
+	static const uint32_t ShaderCacheMagic = 0x43534747; // "GGSC"
+
+	static void write_u32(std::vector<uint8_t>& aData, uint32_t aValue) {
+		size_t Offset = aData.size();
+		aData.resize(Offset + sizeof(uint32_t));
+		std::memcpy(aData.data() + Offset, &aValue, sizeof(uint32_t));
+	}
+
+	static void write_u64(std::vector<uint8_t>& aData, uint64_t aValue) {
+		size_t Offset = aData.size();
+		aData.resize(Offset + sizeof(uint64_t));
+		std::memcpy(aData.data() + Offset, &aValue, sizeof(uint64_t));
+	}
+
+	static bool read_u32(const std::vector<uint8_t>& aData, size_t& aOffset, uint32_t& aValue) {
+		if (aOffset + sizeof(uint32_t) > aData.size()) return false;
+		std::memcpy(&aValue, aData.data() + aOffset, sizeof(uint32_t));
+		aOffset += sizeof(uint32_t);
+		return true;
+	}
+
+	static bool read_u64(const std::vector<uint8_t>& aData, size_t& aOffset, uint64_t& aValue) {
+		if (aOffset + sizeof(uint64_t) > aData.size()) return false;
+		std::memcpy(&aValue, aData.data() + aOffset, sizeof(uint64_t));
+		aOffset += sizeof(uint64_t);
+		return true;
+	}
+
+	std::vector<uint8_t> shader_cache::serialize(uint64_t aKey, const program& aProgram) {
+		std::vector<uint8_t> Data;
+		write_u32(Data, ShaderCacheMagic);
+		write_u32(Data, GEODESY_GPU_SHADER_CACHE_VERSION);
+		write_u64(Data, aKey);
+
+		// Shader stages.
+		write_u32(Data, aProgram.ShaderKey.size());
+		for (size_t i = 0; i < aProgram.ShaderKey.size(); i++) {
+			write_u64(Data, aProgram.ShaderKey[i]);
+			write_u32(Data, aProgram.ByteCode[i].size());
+			size_t Offset = Data.size();
+			Data.resize(Offset + aProgram.ByteCode[i].size() * sizeof(unsigned int));
+			std::memcpy(Data.data() + Offset, aProgram.ByteCode[i].data(), aProgram.ByteCode[i].size() * sizeof(unsigned int));
+		}
+
+		// Descriptor set layout bindings.
+		write_u32(Data, aProgram.DescriptorSetLayoutBinding.size());
+		for (const std::vector<VkDescriptorSetLayoutBinding>& Set : aProgram.DescriptorSetLayoutBinding) {
+			write_u32(Data, Set.size());
+			for (const VkDescriptorSetLayoutBinding& DSLB : Set) {
+				write_u32(Data, DSLB.binding);
+				write_u32(Data, DSLB.descriptorType);
+				write_u32(Data, DSLB.descriptorCount);
+				write_u32(Data, DSLB.stageFlags);
+			}
+		}
+
+		// Vertex attributes.
+		write_u32(Data, aProgram.VertexAttribute.size());
+		for (const VkVertexInputAttributeDescription& Attribute : aProgram.VertexAttribute) {
+			write_u32(Data, Attribute.location);
+			write_u32(Data, Attribute.binding);
+			write_u32(Data, Attribute.format);
+			write_u32(Data, Attribute.offset);
+		}
+
+		// Color attachments.
+		write_u32(Data, aProgram.ColorAttachmentFormat.size());
+		for (VkFormat Format : aProgram.ColorAttachmentFormat) {
+			write_u32(Data, Format);
+		}
+
+		return Data;
+	}
+
+	bool shader_cache::deserialize(uint64_t aKey, const std::vector<uint8_t>& aData, program& aProgram) {
+		size_t Offset = 0;
+		uint32_t Magic = 0, Version = 0, Count = 0;
+		uint64_t Key = 0;
+		if (!read_u32(aData, Offset, Magic) || (Magic != ShaderCacheMagic)) return false;
+		if (!read_u32(aData, Offset, Version) || (Version != GEODESY_GPU_SHADER_CACHE_VERSION)) return false;
+		if (!read_u64(aData, Offset, Key) || (Key != aKey)) return false;
+
+		shader_cache::program Program;
+
+		// Shader stages.
+		if (!read_u32(aData, Offset, Count)) return false;
+		Program.ShaderKey = std::vector<uint64_t>(Count);
+		Program.ByteCode = std::vector<std::vector<unsigned int>>(Count);
+		for (size_t i = 0; i < Count; i++) {
+			uint32_t WordCount = 0;
+			if (!read_u64(aData, Offset, Program.ShaderKey[i])) return false;
+			if (!read_u32(aData, Offset, WordCount)) return false;
+			if (Offset + (size_t)WordCount * sizeof(unsigned int) > aData.size()) return false;
+			Program.ByteCode[i] = std::vector<unsigned int>(WordCount);
+			std::memcpy(Program.ByteCode[i].data(), aData.data() + Offset, (size_t)WordCount * sizeof(unsigned int));
+			Offset += (size_t)WordCount * sizeof(unsigned int);
+		}
+
+		// Descriptor set layout bindings.
+		if (!read_u32(aData, Offset, Count)) return false;
+		Program.DescriptorSetLayoutBinding = std::vector<std::vector<VkDescriptorSetLayoutBinding>>(Count);
+		for (size_t i = 0; i < Count; i++) {
+			uint32_t BindingCount = 0;
+			if (!read_u32(aData, Offset, BindingCount)) return false;
+			Program.DescriptorSetLayoutBinding[i] = std::vector<VkDescriptorSetLayoutBinding>(BindingCount);
+			for (size_t j = 0; j < BindingCount; j++) {
+				VkDescriptorSetLayoutBinding& DSLB = Program.DescriptorSetLayoutBinding[i][j];
+				uint32_t Type = 0, StageFlags = 0;
+				if (!read_u32(aData, Offset, DSLB.binding)) return false;
+				if (!read_u32(aData, Offset, Type)) return false;
+				if (!read_u32(aData, Offset, DSLB.descriptorCount)) return false;
+				if (!read_u32(aData, Offset, StageFlags)) return false;
+				DSLB.descriptorType 		= (VkDescriptorType)Type;
+				DSLB.stageFlags 			= (VkShaderStageFlags)StageFlags;
+				DSLB.pImmutableSamplers 	= NULL;
+			}
+		}
+
+		// Vertex attributes.
+		if (!read_u32(aData, Offset, Count)) return false;
+		Program.VertexAttribute = std::vector<VkVertexInputAttributeDescription>(Count);
+		for (size_t i = 0; i < Count; i++) {
+			uint32_t Format = 0;
+			if (!read_u32(aData, Offset, Program.VertexAttribute[i].location)) return false;
+			if (!read_u32(aData, Offset, Program.VertexAttribute[i].binding)) return false;
+			if (!read_u32(aData, Offset, Format)) return false;
+			if (!read_u32(aData, Offset, Program.VertexAttribute[i].offset)) return false;
+			Program.VertexAttribute[i].format = (VkFormat)Format;
+		}
+
+		// Color attachments.
+		if (!read_u32(aData, Offset, Count)) return false;
+		Program.ColorAttachmentFormat = std::vector<VkFormat>(Count);
+		for (size_t i = 0; i < Count; i++) {
+			uint32_t Format = 0;
+			if (!read_u32(aData, Offset, Format)) return false;
+			Program.ColorAttachmentFormat[i] = (VkFormat)Format;
+		}
+
+		aProgram = Program;
+		return true;
+	}
+
+	uint64_t shader_cache::hash(const void* aData, size_t aSize, uint64_t aSeed) {
+		const uint8_t* Byte = (const uint8_t*)aData;
+		uint64_t Hash = aSeed;
+		for (size_t i = 0; i < aSize; i++) {
+			Hash ^= Byte[i];
+			Hash *= 1099511628211ull;
+		}
+		return Hash;
+	}
+
+	uint64_t shader_cache::hash(std::string aString, uint64_t aSeed) {
+		return hash(aString.data(), aString.size(), aSeed);
+	}
+
+	std::string shader_cache::temporary_path(std::string aFilePath) {
+		// Seeded once per process, the counter keeps threads of the same process apart.
+		static const uint64_t ProcessSeed = ((uint64_t)std::random_device{}() << 32) ^ (uint64_t)std::random_device{}() ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+		static std::atomic<uint64_t> Counter(0);
+		std::stringstream Suffix;
+		Suffix << "." << std::hex << ProcessSeed << "." << Counter.fetch_add(1, std::memory_order_relaxed) << ".tmp";
+		return aFilePath + Suffix.str();
+	}
+
+	shader_cache::shader_cache(std::string aDirectory) {
+		this->Directory = aDirectory;
+		if (this->Directory.size() > 0) {
+			std::error_code ErrorCode;
+			std::filesystem::create_directories(this->Directory, ErrorCode);
+		}
+	}
+
+	bool shader_cache::find(uint64_t aKey, program& aProgram) {
+		std::lock_guard<std::mutex> Lock(this->Mutex);
+
+		// Check memory first.
+		auto It = this->Program.find(aKey);
+		if (It != this->Program.end()) {
+			aProgram = It->second;
+			return true;
+		}
+
+		// Then check disk.
+		if (this->Directory.size() == 0) return false;
+		std::ifstream File(this->file_path(aKey), std::ios::binary | std::ios::ate);
+		if (!File.is_open()) return false;
+		std::streamsize FileSize = File.tellg();
+		if (FileSize <= 0) return false;
+		std::vector<uint8_t> Data((size_t)FileSize);
+		File.seekg(0, std::ios::beg);
+		if (!File.read((char*)Data.data(), FileSize)) return false;
+		if (!deserialize(aKey, Data, aProgram)) return false;
+
+		this->Program[aKey] = aProgram;
+		return true;
+	}
+
+	void shader_cache::insert(uint64_t aKey, const program& aProgram) {
+		std::lock_guard<std::mutex> Lock(this->Mutex);
+		this->Program[aKey] = aProgram;
+
+		if (this->Directory.size() == 0) return;
+
+		// Write to a temporary file then rename, concurrent processes never observe partial entries. Each writer
+		// has its own temporary file, so two processes inserting the same key can not interleave their writes.
+		std::vector<uint8_t> Data = serialize(aKey, aProgram);
+		std::string FilePath = this->file_path(aKey);
+		std::string TemporaryPath = temporary_path(FilePath);
+		{
+			std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+			if (!File.is_open()) return;
+			File.write((const char*)Data.data(), Data.size());
+			if (!File.good()) {
+				File.close();
+				std::error_code ErrorCode;
+				std::filesystem::remove(TemporaryPath, ErrorCode);
+				return;
+			}
+		}
+		std::error_code ErrorCode;
+		std::filesystem::rename(TemporaryPath, FilePath, ErrorCode);
+		if (ErrorCode) {
+			std::filesystem::remove(TemporaryPath, ErrorCode);
+		}
+	}
+
+	void shader_cache::clear() {
+		std::lock_guard<std::mutex> Lock(this->Mutex);
+		this->Program.clear();
+	}
+
+	std::string shader_cache::file_path(uint64_t aKey) const {
+		std::stringstream Name;
+		Name << std::hex << std::setw(16) << std::setfill('0') << aKey << ".spvc";
+		return (std::filesystem::path(this->Directory) / Name.str()).string();
+	}
+
+}
@@ -0,0 +1,355 @@
+#include <geodesy/gpu/texture_streamer.h>
+#include <geodesy/gpu/context.h>
+
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+
+namespace geodesy::gpu {
+
+	texture_streamer::create_info::create_info() {
+		this->Budget 				= 1 << 28;
+		this->StagingSize 			= 1 << 26;
+		this->ResidentLevelCount 	= 4;
+		this->TextureCapacity 		= 4096;
+		this->FrameLatency 			= 3;
+	}
+
+	texture_streamer::texture_streamer() {
+		this->Context 			= nullptr;
+		this->Type 				= resource::type::UNKNOWN;
+		this->WorkerPool 		= nullptr;
+		this->Feedback 			= nullptr;
+		this->CommandPool 		= nullptr;
+		this->MinLod 			= false;
+		this->UpdateCount 		= 0;
+		this->ResidentSize 		= 0;
+		this->StagingSize 		= 0;
+	}
+
+	texture_streamer::texture_streamer(std::shared_ptr<context> aContext, create_info aCreateInfo, std::shared_ptr<worker_pool> aWorkerPool) : texture_streamer() {
+		this->Context 			= aContext;
+		this->CreateInfo 		= aCreateInfo;
+		this->WorkerPool 		= aWorkerPool != nullptr ? aWorkerPool : std::make_shared<worker_pool>();
+		this->MinLod 			= aContext->ImageViewMinLod;
+		this->Texture 			= std::vector<texture>(aCreateInfo.TextureCapacity);
+
+		this->Feedback = geodesy::make<buffer>(
+			aContext,
+			device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT,
+			buffer::STORAGE | buffer::TRANSFER_DST,
+			aCreateInfo.TextureCapacity * sizeof(uint32_t)
+		);
+		this->CommandPool = aContext->create<command_pool>(device::operation::GRAPHICS, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		if ((this->Feedback == nullptr) || (this->CommandPool == nullptr)) {
+			throw std::runtime_error("Failed to create texture streamer.");
+		}
+		std::vector<uint32_t> NoRequest(aCreateInfo.TextureCapacity, UINT32_MAX);
+		this->Feedback->write(0, NoRequest.data(), 0, NoRequest.size() * sizeof(uint32_t));
+	}
+
+	texture_streamer::~texture_streamer() {
+		for (int i = 0; i < (int)this->Texture.size(); i++) {
+			if (this->Texture[i].Image != nullptr) {
+				this->remove(i);
+			}
+		}
+		this->release(true);
+	}
+
+	int texture_streamer::add(std::shared_ptr<image> aImage, loader aLoader) {
+		VkResult Result = VK_SUCCESS;
+		if ((aImage == nullptr) || (aLoader == nullptr)) return -1;
+		int Slot = -1;
+		for (int i = 0; i < (int)this->Texture.size(); i++) {
+			if (this->Texture[i].Image == nullptr) {
+				Slot = i;
+				break;
+			}
+		}
+		if (Slot < 0) return -1;
+
+		texture Texture{};
+		Texture.Image 			= aImage;
+		Texture.Loader 			= aLoader;
+		Texture.MinimumLevel 	= (aImage->CreateInfo.mipLevels > this->CreateInfo.ResidentLevelCount) ? aImage->CreateInfo.mipLevels - this->CreateInfo.ResidentLevelCount : 0;
+		Texture.ResidentLevel 	= Texture.MinimumLevel;
+		Texture.RequestedLevel 	= UINT32_MAX;
+		Texture.DesiredLevel 	= Texture.MinimumLevel;
+		Texture.LastRequest 	= this->UpdateCount;
+		Texture.Load 			= nullptr;
+
+		// The coarsest levels share one staging buffer and one submission.
+		size_t Alignment = std::lcm(std::max<size_t>(image::block_size(aImage->CreateInfo.format), 1), (size_t)4);
+		std::vector<VkBufferImageCopy> Region;
+		size_t Size = 0;
+		for (uint32_t Level = Texture.MinimumLevel; Level < aImage->CreateInfo.mipLevels; Level++) {
+			VkBufferImageCopy Copy{};
+			Copy.bufferOffset 		= ((Size + Alignment - 1) / Alignment) * Alignment;
+			Copy.imageSubresource 	= { image::aspect_flag(aImage->CreateInfo.format), Level, 0, aImage->CreateInfo.arrayLayers };
+			Copy.imageExtent 		= {
+				std::max(aImage->CreateInfo.extent.width >> Level, 1u),
+				std::max(aImage->CreateInfo.extent.height >> Level, 1u),
+				std::max(aImage->CreateInfo.extent.depth >> Level, 1u)
+			};
+			Size = Copy.bufferOffset + this->level_size(Texture, Level);
+			Region.push_back(Copy);
+		}
+
+		std::shared_ptr<buffer> Staging = geodesy::make<buffer>(this->Context, device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT, buffer::TRANSFER_SRC, Size);
+		if (Staging == nullptr) return -1;
+		uint8_t* StagingData = (uint8_t*)Staging->map_memory(0, Size);
+		if (StagingData == NULL) return -1;
+		for (size_t i = 0; i < Region.size(); i++) {
+			Result = aLoader(Region[i].imageSubresource.mipLevel, StagingData + Region[i].bufferOffset, this->level_size(Texture, Region[i].imageSubresource.mipLevel));
+			if (Result != VK_SUCCESS) break;
+		}
+		Staging->unmap_memory();
+		if (Result != VK_SUCCESS) return -1;
+
+		std::shared_ptr<command_buffer> CommandBuffer = this->CommandPool->create<command_buffer>();
+		if (CommandBuffer == nullptr) return -1;
+		if (CommandBuffer->begin() != VK_SUCCESS) return -1;
+		aImage->require(CommandBuffer.get(), image::TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Texture.MinimumLevel);
+		aImage->copy(CommandBuffer.get(), Staging, Region);
+		// Levels not loaded yet are moved too, so every level a view covers is in the layout descriptors expect.
+		aImage->require(CommandBuffer.get(), image::SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+		if (CommandBuffer->end() != VK_SUCCESS) return -1;
+		Result = this->Context->execute_and_wait(device::operation::GRAPHICS, CommandBuffer);
+		aImage->reset_access();
+		if (Result != VK_SUCCESS) return -1;
+
+		Texture.View = this->create_view(Texture);
+		this->Texture[Slot] = Texture;
+		return Slot;
+	}
+
+	void texture_streamer::remove(int aTexture) {
+		if ((aTexture < 0) || (aTexture >= (int)this->Texture.size()) || (this->Texture[aTexture].Image == nullptr)) return;
+		texture& Texture = this->Texture[aTexture];
+		if (Texture.Load != nullptr) {
+			Texture.Load->Result.wait();
+			this->StagingSize -= Texture.Load->Size;
+		}
+		for (uint32_t Level = Texture.ResidentLevel; Level < Texture.MinimumLevel; Level++) {
+			this->ResidentSize -= this->level_size(Texture, Level);
+		}
+		this->Retired.push_back({ this->UpdateCount, Texture.View, nullptr, Texture.Image });
+		Texture = texture{};
+	}
+
+	VkImageView texture_streamer::view(int aTexture) const {
+		if ((aTexture < 0) || (aTexture >= (int)this->Texture.size())) return VK_NULL_HANDLE;
+		return this->Texture[aTexture].View;
+	}
+
+	uint32_t texture_streamer::resident_level(int aTexture) const {
+		if ((aTexture < 0) || (aTexture >= (int)this->Texture.size()) || (this->Texture[aTexture].Image == nullptr)) return UINT32_MAX;
+		return this->Texture[aTexture].ResidentLevel;
+	}
+
+	uint32_t texture_streamer::base_level(int aTexture) const {
+		if ((aTexture < 0) || (aTexture >= (int)this->Texture.size()) || (this->Texture[aTexture].Image == nullptr)) return 0;
+		return this->MinLod ? 0 : this->Texture[aTexture].ResidentLevel;
+	}
+
+	size_t texture_streamer::resident_size() const {
+		return this->ResidentSize;
+	}
+
+	void texture_streamer::request(int aTexture, uint32_t aLevel) {
+		if ((aTexture < 0) || (aTexture >= (int)this->Texture.size()) || (this->Texture[aTexture].Image == nullptr)) return;
+		this->Texture[aTexture].RequestedLevel = std::min(this->Texture[aTexture].RequestedLevel, aLevel);
+	}
+
+	void texture_streamer::reset_feedback(command_buffer* aCommandBuffer) {
+		PFN_vkCmdFillBuffer vkCmdFillBuffer = (PFN_vkCmdFillBuffer)this->Context->function_pointer("vkCmdFillBuffer");
+		this->Feedback->require(aCommandBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+		vkCmdFillBuffer(aCommandBuffer->Handle, this->Feedback->Handle, 0, VK_WHOLE_SIZE, UINT32_MAX);
+		this->Feedback->require(aCommandBuffer, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+	}
+
+	void texture_streamer::read_feedback() {
+		std::vector<uint32_t> Level(this->Texture.size(), UINT32_MAX);
+		if (this->Feedback->read(0, Level.data(), 0, Level.size() * sizeof(uint32_t)) != VK_SUCCESS) return;
+		for (int i = 0; i < (int)this->Texture.size(); i++) {
+			if ((this->Texture[i].Image == nullptr) || (Level[i] == UINT32_MAX)) continue;
+			this->request(i, Level[i]);
+		}
+	}
+
+	VkResult texture_streamer::update(command_buffer* aCommandBuffer, std::vector<int>& aChanged) {
+		this->UpdateCount++;
+		this->release(false);
+
+		for (texture& Texture : this->Texture) {
+			if ((Texture.Image == nullptr) || (Texture.RequestedLevel == UINT32_MAX)) continue;
+			Texture.DesiredLevel 	= std::min(Texture.RequestedLevel, Texture.Image->CreateInfo.mipLevels - 1);
+			Texture.LastRequest 	= this->UpdateCount;
+			Texture.RequestedLevel 	= UINT32_MAX;
+		}
+
+		// Finished loads are uploaded together, one barrier before and after every copy.
+		std::vector<int> Finished;
+		for (int i = 0; i < (int)this->Texture.size(); i++) {
+			texture& Texture = this->Texture[i];
+			if ((Texture.Load == nullptr) || (Texture.Load->Result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) continue;
+			this->StagingSize -= Texture.Load->Size;
+			if ((Texture.Load->Result.get() == VK_SUCCESS) && (Texture.Load->Level + 1 == Texture.ResidentLevel)) {
+				Finished.push_back(i);
+			}
+			else {
+				// Not retried until requested again.
+				Texture.DesiredLevel = Texture.ResidentLevel;
+				Texture.Load = nullptr;
+			}
+		}
+
+		barrier_batch Barrier;
+		for (int i : Finished) {
+			texture& Texture = this->Texture[i];
+			Texture.Image->require(Barrier, image::TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, Texture.Load->Level, 1);
+		}
+		Barrier.record(aCommandBuffer);
+		for (int i : Finished) {
+			texture& Texture = this->Texture[i];
+			image* Image = Texture.Image.get();
+			VkBufferImageCopy Copy{};
+			Copy.imageSubresource 	= { image::aspect_flag(Image->CreateInfo.format), Texture.Load->Level, 0, Image->CreateInfo.arrayLayers };
+			Copy.imageExtent 		= {
+				std::max(Image->CreateInfo.extent.width >> Texture.Load->Level, 1u),
+				std::max(Image->CreateInfo.extent.height >> Texture.Load->Level, 1u),
+				std::max(Image->CreateInfo.extent.depth >> Texture.Load->Level, 1u)
+			};
+			Image->copy(aCommandBuffer, Texture.Load->Staging, { Copy });
+			Image->require(Barrier, image::SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, Texture.Load->Level, 1);
+		}
+		Barrier.record(aCommandBuffer);
+		for (int i : Finished) {
+			texture& Texture = this->Texture[i];
+			this->Retired.push_back({ this->UpdateCount, VK_NULL_HANDLE, Texture.Load->Staging, nullptr });
+			this->ResidentSize 		+= Texture.Load->Size;
+			Texture.ResidentLevel 	= Texture.Load->Level;
+			Texture.Load 			= nullptr;
+			this->replace_view(i, aChanged);
+		}
+
+		// Most recently requested first, then the textures furthest from their desired level.
+		std::vector<int> Candidate;
+		for (int i = 0; i < (int)this->Texture.size(); i++) {
+			const texture& Texture = this->Texture[i];
+			if ((Texture.Image == nullptr) || (Texture.Load != nullptr) || (Texture.DesiredLevel >= Texture.ResidentLevel)) continue;
+			Candidate.push_back(i);
+		}
+		std::sort(Candidate.begin(), Candidate.end(), [&](int aA, int aB) {
+			const texture& A = this->Texture[aA];
+			const texture& B = this->Texture[aB];
+			if (A.LastRequest != B.LastRequest) return A.LastRequest > B.LastRequest;
+			return (A.ResidentLevel - A.DesiredLevel) > (B.ResidentLevel - B.DesiredLevel);
+		});
+
+		for (int i : Candidate) {
+			texture& Texture = this->Texture[i];
+			uint32_t Level = Texture.ResidentLevel - 1;
+			size_t Size = this->level_size(Texture, Level);
+			if ((this->StagingSize > 0) && (this->StagingSize + Size > this->CreateInfo.StagingSize)) break;
+			// Pending loads count against the budget, they become resident once uploaded.
+			bool Evicted = true;
+			while (Evicted && (this->ResidentSize + this->StagingSize + Size > this->CreateInfo.Budget)) {
+				Evicted = this->evict(i, aChanged);
+			}
+			if (this->ResidentSize + this->StagingSize + Size > this->CreateInfo.Budget) continue;
+
+			std::shared_ptr<load> Load = std::make_shared<load>();
+			Load->Level 	= Level;
+			Load->Size 		= Size;
+			Load->Staging 	= geodesy::make<buffer>(this->Context, device::memory::HOST_VISIBLE | device::memory::HOST_COHERENT, buffer::TRANSFER_SRC, Size);
+			if (Load->Staging == nullptr) return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+			std::shared_ptr<buffer> Staging = Load->Staging;
+			loader Loader = Texture.Loader;
+			Load->Result = this->WorkerPool->submit([Staging, Loader, Level, Size]() -> VkResult {
+				void* Data = Staging->map_memory(0, Size);
+				if (Data == NULL) return VK_ERROR_MEMORY_MAP_FAILED;
+				VkResult Result = Loader(Level, Data, Size);
+				Staging->unmap_memory();
+				return Result;
+			});
+			Texture.Load = Load;
+			this->StagingSize += Size;
+		}
+
+		return VK_SUCCESS;
+	}
+
+	size_t texture_streamer::level_size(const texture& aTexture, uint32_t aLevel) const {
+		const VkImageCreateInfo& ImageCreateInfo = aTexture.Image->CreateInfo;
+		VkBufferImageCopy Copy{};
+		Copy.imageSubresource 	= { image::aspect_flag(ImageCreateInfo.format), aLevel, 0, ImageCreateInfo.arrayLayers };
+		Copy.imageExtent 		= {
+			std::max(ImageCreateInfo.extent.width >> aLevel, 1u),
+			std::max(ImageCreateInfo.extent.height >> aLevel, 1u),
+			std::max(ImageCreateInfo.extent.depth >> aLevel, 1u)
+		};
+		return aTexture.Image->region_size(Copy);
+	}
+
+	VkImageView texture_streamer::create_view(const texture& aTexture) const {
+		if (this->MinLod) {
+			return aTexture.Image->view(0, UINT32_MAX, 0, UINT32_MAX, (float)aTexture.ResidentLevel);
+		}
+		return aTexture.Image->view(aTexture.ResidentLevel);
+	}
+
+	void texture_streamer::replace_view(int aTexture, std::vector<int>& aChanged) {
+		texture& Texture = this->Texture[aTexture];
+		this->Retired.push_back({ this->UpdateCount, Texture.View, nullptr, nullptr });
+		Texture.View = this->create_view(Texture);
+		aChanged.push_back(aTexture);
+	}
+
+	bool texture_streamer::evict(int aKeep, std::vector<int>& aChanged) {
+		// Levels finer than a texture still asks for go first, then the least recently requested. Textures
+		// requested this update keep the levels they need.
+		int Victim = -1;
+		for (int i = 0; i < (int)this->Texture.size(); i++) {
+			const texture& Texture = this->Texture[i];
+			if ((i == aKeep) || (Texture.Image == nullptr) || (Texture.Load != nullptr) || (Texture.ResidentLevel >= Texture.MinimumLevel)) continue;
+			bool Surplus = Texture.ResidentLevel < Texture.DesiredLevel;
+			if (!Surplus && (Texture.LastRequest == this->UpdateCount)) continue;
+			if (Victim < 0) {
+				Victim = i;
+				continue;
+			}
+			const texture& Current = this->Texture[Victim];
+			bool CurrentSurplus = Current.ResidentLevel < Current.DesiredLevel;
+			if ((Surplus && !CurrentSurplus) || ((Surplus == CurrentSurplus) && (Texture.LastRequest < Current.LastRequest))) {
+				Victim = i;
+			}
+		}
+		if (Victim < 0) return false;
+
+		// Memory stays allocated, the view no longer reaches the level.
+		texture& Texture = this->Texture[Victim];
+		this->ResidentSize -= this->level_size(Texture, Texture.ResidentLevel);
+		Texture.ResidentLevel++;
+		this->replace_view(Victim, aChanged);
+		return true;
+	}
+
+	void texture_streamer::release(bool aAll) {
+		if (this->Retired.size() == 0) return;
+		PFN_vkDestroyImageView vkDestroyImageView = (PFN_vkDestroyImageView)this->Context->function_pointer("vkDestroyImageView");
+		std::vector<retired> Kept;
+		for (retired& Retired : this->Retired) {
+			if (!aAll && (Retired.Update + this->CreateInfo.FrameLatency > this->UpdateCount)) {
+				Kept.push_back(Retired);
+				continue;
+			}
+			if (Retired.View != VK_NULL_HANDLE) {
+				vkDestroyImageView(this->Context->Handle, Retired.View, NULL);
+			}
+		}
+		this->Retired = Kept;
+	}
+
+}
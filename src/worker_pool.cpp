@@ -0,0 +1,57 @@
+#include <geodesy/gpu/worker_pool.h>
+
+#include <algorithm>
+
+namespace geodesy::gpu {
+
+	worker_pool::worker_pool(size_t aThreadCount) {
+		this->Stop = false;
+		if (aThreadCount == 0) {
+			aThreadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+		}
+		for (size_t i = 0; i < aThreadCount; i++) {
+			this->Thread.emplace_back(&worker_pool::run, this);
+		}
+	}
+
+	worker_pool::~worker_pool() {
+		// Drain remaining tasks, then join.
+		{
+			std::lock_guard<std::mutex> Lock(this->Mutex);
+			this->Stop = true;
+		}
+		this->Condition.notify_all();
+		for (std::thread& Worker : this->Thread) {
+			if (Worker.joinable()) {
+				Worker.join();
+			}
+		}
+	}
+
+	size_t worker_pool::size() const {
+		return this->Thread.size();
+	}
+
+	bool worker_pool::is_worker_thread() const {
+		std::thread::id ID = std::this_thread::get_id();
+		for (const std::thread& Worker : this->Thread) {
+			if (Worker.get_id() == ID) return true;
+		}
+		return false;
+	}
+
+	void worker_pool::run() {
+		while (true) {
+			std::function<void()> Job;
+			{
+				std::unique_lock<std::mutex> Lock(this->Mutex);
+				this->Condition.wait(Lock, [this]() { return this->Stop || !this->Task.empty(); });
+				if (this->Stop && this->Task.empty()) return;
+				Job = std::move(this->Task.front());
+				this->Task.pop();
+			}
+			Job();
+		}
+	}
+
+}
@@ -0,0 +1,64 @@
+#include <geodesy/gpu/context.h>
+
+#include <cstring>
+
+#include "unit_test.h"
+
+using namespace geodesy::gpu;
+
+static std::vector<uint8_t> pipeline_cache_data(const VkPhysicalDeviceProperties& aProperties, size_t aPayloadSize) {
+	VkPipelineCacheHeaderVersionOne Header{};
+	Header.headerSize 		= sizeof(VkPipelineCacheHeaderVersionOne);
+	Header.headerVersion 	= VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+	Header.vendorID 		= aProperties.vendorID;
+	Header.deviceID 		= aProperties.deviceID;
+	std::memcpy(Header.pipelineCacheUUID, aProperties.pipelineCacheUUID, VK_UUID_SIZE);
+	std::vector<uint8_t> Data(sizeof(Header) + aPayloadSize, 0xAB);
+	std::memcpy(Data.data(), &Header, sizeof(Header));
+	return Data;
+}
+
+GEODESY_TEST(pipeline_cache_header_validation) {
+	VkPhysicalDeviceProperties Properties{};
+	Properties.vendorID 	= 0x10DE;
+	Properties.deviceID 	= 0x2204;
+	for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+		Properties.pipelineCacheUUID[i] = (uint8_t)(i * 7 + 1);
+	}
+
+	// Written by this device.
+	GEODESY_CHECK(context::valid_pipeline_cache(pipeline_cache_data(Properties, 64), Properties));
+	GEODESY_CHECK(context::valid_pipeline_cache(pipeline_cache_data(Properties, 0), Properties));
+
+	// Empty or truncated files.
+	GEODESY_CHECK(!context::valid_pipeline_cache({}, Properties));
+	std::vector<uint8_t> Truncated = pipeline_cache_data(Properties, 0);
+	Truncated.resize(Truncated.size() - 1);
+	GEODESY_CHECK(!context::valid_pipeline_cache(Truncated, Properties));
+
+	// Other vendor, device or driver build.
+	VkPhysicalDeviceProperties Other = Properties;
+	Other.vendorID = 0x1002;
+	GEODESY_CHECK(!context::valid_pipeline_cache(pipeline_cache_data(Properties, 64), Other));
+	Other = Properties;
+	Other.deviceID = 0x2206;
+	GEODESY_CHECK(!context::valid_pipeline_cache(pipeline_cache_data(Properties, 64), Other));
+	Other = Properties;
+	Other.pipelineCacheUUID[VK_UUID_SIZE - 1] ^= 0xFF;
+	GEODESY_CHECK(!context::valid_pipeline_cache(pipeline_cache_data(Properties, 64), Other));
+
+	// Header claims to be larger than the file, or smaller than version one.
+	std::vector<uint8_t> Data = pipeline_cache_data(Properties, 0);
+	uint32_t HeaderSize = (uint32_t)Data.size() + 1;
+	std::memcpy(Data.data(), &HeaderSize, sizeof(uint32_t));
+	GEODESY_CHECK(!context::valid_pipeline_cache(Data, Properties));
+	HeaderSize = 4;
+	std::memcpy(Data.data(), &HeaderSize, sizeof(uint32_t));
+	GEODESY_CHECK(!context::valid_pipeline_cache(Data, Properties));
+
+	// Unknown header version.
+	Data = pipeline_cache_data(Properties, 16);
+	uint32_t HeaderVersion = 2;
+	std::memcpy(Data.data() + sizeof(uint32_t), &HeaderVersion, sizeof(uint32_t));
+	GEODESY_CHECK(!context::valid_pipeline_cache(Data, Properties));
+}
@@ -0,0 +1,81 @@
+#include <geodesy/gpu/culler.h>
+
+#include <cmath>
+
+#include "unit_test.h"
+
+using namespace geodesy::gpu;
+
+static float plane_distance(const float aPlane[4], float aX, float aY, float aZ) {
+	return aPlane[0] * aX + aPlane[1] * aY + aPlane[2] * aZ + aPlane[3];
+}
+
+static bool near_equal(float aLHS, float aRHS, float aTolerance = 1e-5f) {
+	return std::fabs(aLHS - aRHS) < aTolerance;
+}
+
+GEODESY_TEST(frustum_planes_identity) {
+	// Clip space is world space, the frustum is the [-1, 1] x [-1, 1] x [0, 1] box.
+	const float Identity[16] = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	const float Expected[6][4] = {
+		{  1.0f,  0.0f,  0.0f, 1.0f }, 	// Left
+		{ -1.0f,  0.0f,  0.0f, 1.0f }, 	// Right
+		{  0.0f,  1.0f,  0.0f, 1.0f }, 	// Bottom
+		{  0.0f, -1.0f,  0.0f, 1.0f }, 	// Top
+		{  0.0f,  0.0f,  1.0f, 0.0f }, 	// Near
+		{  0.0f,  0.0f, -1.0f, 1.0f } 	// Far
+	};
+	float Plane[6][4];
+	culler::frustum_planes(Identity, Plane);
+	for (int p = 0; p < 6; p++) {
+		for (int c = 0; c < 4; c++) {
+			GEODESY_CHECK(near_equal(Plane[p][c], Expected[p][c]));
+		}
+	}
+}
+
+GEODESY_TEST(frustum_planes_perspective) {
+	// Column major, 90 degree vertical field of view, square aspect, near 1, far 101, 0 to 1 depth.
+	const float Near = 1.0f;
+	const float Far = 101.0f;
+	const float ViewProjection[16] = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, Far / (Far - Near), 1.0f,
+		0.0f, 0.0f, -Far * Near / (Far - Near), 0.0f
+	};
+	float Plane[6][4];
+	culler::frustum_planes(ViewProjection, Plane);
+
+	// Every plane normal is unit length.
+	for (int p = 0; p < 6; p++) {
+		float Length = std::sqrt(Plane[p][0] * Plane[p][0] + Plane[p][1] * Plane[p][1] + Plane[p][2] * Plane[p][2]);
+		GEODESY_CHECK(near_equal(Length, 1.0f));
+	}
+
+	// Points inside lie on the positive side of every plane.
+	const float Inside[][3] = { { 0.0f, 0.0f, 2.0f }, { 4.0f, -4.0f, 5.0f }, { 0.0f, 0.0f, 100.0f } };
+	for (const auto& Point : Inside) {
+		for (int p = 0; p < 6; p++) {
+			GEODESY_CHECK(plane_distance(Plane[p], Point[0], Point[1], Point[2]) >= 0.0f);
+		}
+	}
+
+	// And points outside on the negative side of the plane they cross.
+	GEODESY_CHECK(plane_distance(Plane[0], -6.0f, 0.0f, 5.0f) < 0.0f);
+	GEODESY_CHECK(plane_distance(Plane[1], 6.0f, 0.0f, 5.0f) < 0.0f);
+	GEODESY_CHECK(plane_distance(Plane[2], 0.0f, -6.0f, 5.0f) < 0.0f);
+	GEODESY_CHECK(plane_distance(Plane[3], 0.0f, 6.0f, 5.0f) < 0.0f);
+	GEODESY_CHECK(plane_distance(Plane[4], 0.0f, 0.0f, 0.5f) < 0.0f);
+	GEODESY_CHECK(plane_distance(Plane[5], 0.0f, 0.0f, 102.0f) < 0.0f);
+
+	// Distances are in world units once normalized. The far plane is the difference of nearly equal rows,
+	// single precision only keeps a few digits of it.
+	GEODESY_CHECK(near_equal(plane_distance(Plane[4], 0.0f, 0.0f, 3.0f), 2.0f));
+	GEODESY_CHECK(near_equal(plane_distance(Plane[5], 0.0f, 0.0f, 91.0f), 10.0f, 1e-2f));
+}
@@ -0,0 +1,109 @@
+#include <geodesy/gpu/image.h>
+
+#include "unit_test.h"
+
+using namespace geodesy::gpu;
+
+static VkBufferImageCopy buffer_image_copy(uint32_t aWidth, uint32_t aHeight, uint32_t aDepth, uint32_t aLayerCount, uint32_t aRowLength = 0, uint32_t aImageHeight = 0) {
+	VkBufferImageCopy Region{};
+	Region.bufferOffset 					= 0;
+	Region.bufferRowLength 					= aRowLength;
+	Region.bufferImageHeight 				= aImageHeight;
+	Region.imageSubresource.aspectMask 		= VK_IMAGE_ASPECT_COLOR_BIT;
+	Region.imageSubresource.mipLevel 		= 0;
+	Region.imageSubresource.baseArrayLayer 	= 0;
+	Region.imageSubresource.layerCount 		= aLayerCount;
+	Region.imageOffset 						= { 0, 0, 0 };
+	Region.imageExtent 						= { aWidth, aHeight, aDepth };
+	return Region;
+}
+
+GEODESY_TEST(image_region_size) {
+	// Only the format is read, no device is needed.
+	image Image;
+	Image.CreateInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+
+	// Tightly packed.
+	GEODESY_CHECK(Image.region_size(buffer_image_copy(4, 3, 1, 1)) == 4 * 3 * 4);
+	GEODESY_CHECK(Image.region_size(buffer_image_copy(4, 3, 1, 2)) == 4 * 3 * 4 * 2);
+	GEODESY_CHECK(Image.region_size(buffer_image_copy(4, 3, 2, 1)) == 4 * 3 * 4 * 2);
+
+	// Row and slice pitch come from bufferRowLength and bufferImageHeight, the last row is only as long as the region.
+	GEODESY_CHECK(Image.region_size(buffer_image_copy(4, 3, 1, 1, 8)) == 8 * 4 * 2 + 4 * 4);
+	GEODESY_CHECK(Image.region_size(buffer_image_copy(4, 3, 2, 1, 0, 4)) == 4 * 4 * 4 + 4 * 4 * 2 + 4 * 4);
+
+	// Empty regions occupy nothing.
+	GEODESY_CHECK(Image.region_size(buffer_image_copy(0, 3, 1, 1)) == 0);
+	GEODESY_CHECK(Image.region_size(buffer_image_copy(4, 3, 1, 0)) == 0);
+
+	// Block compressed, 8 byte 4x4 blocks, partial blocks at the edges are whole blocks.
+	Image.CreateInfo.format = VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+	GEODESY_CHECK(Image.region_size(buffer_image_copy(4, 4, 1, 1)) == 8);
+	GEODESY_CHECK(Image.region_size(buffer_image_copy(10, 10, 1, 1)) == 3 * 3 * 8);
+	GEODESY_CHECK(Image.region_size(buffer_image_copy(10, 10, 1, 1, 16)) == 4 * 8 * 2 + 3 * 8);
+}
+
+GEODESY_TEST(image_stage) {
+	image Image;
+
+	// Three byte texels, offsets are multiples of 12.
+	Image.CreateInfo.format = VK_FORMAT_R8G8B8_UNORM;
+	std::vector<VkBufferImageCopy> RegionList = { buffer_image_copy(1, 1, 1, 1), buffer_image_copy(3, 1, 1, 1), buffer_image_copy(1, 1, 1, 1) };
+	size_t Size = Image.stage(RegionList);
+	GEODESY_CHECK(RegionList[0].bufferOffset == 0);
+	GEODESY_CHECK(RegionList[1].bufferOffset == 12);
+	GEODESY_CHECK(RegionList[2].bufferOffset == 24);
+	GEODESY_CHECK(Size == 27);
+
+	// Sixteen byte texels and blocks align to themselves.
+	Image.CreateInfo.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+	RegionList = { buffer_image_copy(1, 1, 1, 1), buffer_image_copy(2, 2, 1, 1) };
+	Size = Image.stage(RegionList);
+	GEODESY_CHECK(RegionList[1].bufferOffset == 16);
+	GEODESY_CHECK(Size == 16 + 64);
+
+	Image.CreateInfo.format = VK_FORMAT_BC7_UNORM_BLOCK;
+	RegionList = { buffer_image_copy(2, 2, 1, 1), buffer_image_copy(8, 4, 1, 1) };
+	Size = Image.stage(RegionList);
+	GEODESY_CHECK(RegionList[1].bufferOffset == 16);
+	GEODESY_CHECK(Size == 16 + 32);
+
+	// Nothing to stage.
+	RegionList.clear();
+	GEODESY_CHECK(Image.stage(RegionList) == 0);
+}
+
+GEODESY_TEST(image_require_coalesces) {
+	// Tracking only, no handle or device is needed.
+	image Image;
+	Image.CreateInfo.format 		= VK_FORMAT_R8G8B8A8_UNORM;
+	Image.CreateInfo.mipLevels 		= 2;
+	Image.CreateInfo.arrayLayers 	= 1;
+	Image.CreateInfo.initialLayout 	= VK_IMAGE_LAYOUT_UNDEFINED;
+
+	// Two copies into the same level share one transition out of the first layout.
+	barrier_batch Batch;
+	Image.require(Batch, image::TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1);
+	Image.require(Batch, image::TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1);
+	GEODESY_CHECK(Batch.ImageBarrier.size() == 1);
+	GEODESY_CHECK(Batch.ImageBarrier[0].oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+	GEODESY_CHECK(Batch.ImageBarrier[0].newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	GEODESY_CHECK(Batch.ImageBarrier[0].subresourceRange.levelCount == 1);
+
+	// A later layout for part of a pending range splits it, every level keeps its first old layout.
+	image Chain;
+	Chain.CreateInfo = Image.CreateInfo;
+	Batch.clear();
+	Chain.require(Batch, image::TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 2);
+	GEODESY_CHECK(Batch.ImageBarrier.size() == 1);
+	Chain.require(Batch, image::SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 1, 1);
+	GEODESY_CHECK(Batch.ImageBarrier.size() == 2);
+	for (const VkImageMemoryBarrier& Barrier : Batch.ImageBarrier) {
+		GEODESY_CHECK(Barrier.subresourceRange.levelCount == 1);
+		GEODESY_CHECK(Barrier.oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+		bool Level1 = (Barrier.subresourceRange.baseMipLevel == 1);
+		GEODESY_CHECK(Barrier.newLayout == (Level1 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+	}
+	GEODESY_CHECK(Chain.current_layout(0) == image::TRANSFER_DST_OPTIMAL);
+	GEODESY_CHECK(Chain.current_layout(1) == image::SHADER_READ_ONLY_OPTIMAL);
+}
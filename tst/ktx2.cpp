@@ -0,0 +1,132 @@
+#include <geodesy/gpu/ktx2.h>
+
+#include <cstring>
+#include <filesystem>
+
+#include "unit_test.h"
+
+using namespace geodesy::gpu;
+
+// Header fields after the identifier, in file order.
+struct ktx2_counts {
+	uint32_t 		Format 		= VK_FORMAT_R8G8B8A8_UNORM;
+	uint32_t 		Width 		= 16;
+	uint32_t 		Height 		= 16;
+	uint32_t 		Depth 		= 0;
+	uint32_t 		LayerCount 	= 0;
+	uint32_t 		FaceCount 	= 1;
+	uint32_t 		LevelCount 	= 1;
+};
+
+// Writes an identifier, header and level index without level data, returns the path.
+static std::string write_ktx2(const char* aName, const ktx2_counts& aCounts, uint32_t aIndexCount) {
+	static const uint8_t Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+	std::error_code ErrorCode;
+	std::string Path = (std::filesystem::temp_directory_path(ErrorCode) / aName).string();
+	std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+	uint32_t Field[13] = { aCounts.Format, 1, aCounts.Width, aCounts.Height, aCounts.Depth, aCounts.LayerCount, aCounts.FaceCount, aCounts.LevelCount, 0, 0, 0, 0, 0 };
+	uint64_t Global[2] = { 0, 0 };
+	File.write((const char*)Identifier, sizeof(Identifier));
+	File.write((const char*)Field, sizeof(Field));
+	File.write((const char*)Global, sizeof(Global));
+	for (uint32_t i = 0; i < aIndexCount; i++) {
+		uint64_t Level[3] = { 1024 + i, 64, 64 };
+		File.write((const char*)Level, sizeof(Level));
+	}
+	return Path;
+}
+
+static bool opens(const std::string& aPath, uint32_t aMaxArrayLayers = 256) {
+	try {
+		ktx2 File(aPath, aMaxArrayLayers);
+		return true;
+	}
+	catch (const std::runtime_error&) {
+		return false;
+	}
+}
+
+GEODESY_TEST(ktx2_header) {
+	ktx2_counts Counts;
+	Counts.Width 		= 64;
+	Counts.Height 		= 32;
+	Counts.LevelCount 	= 7;
+	std::string Path = write_ktx2("geodesy-gpu-ktx2-header.ktx2", Counts, 7);
+	{
+		ktx2 File(Path);
+		GEODESY_CHECK(File.Format == (image::format)VK_FORMAT_R8G8B8A8_UNORM);
+		GEODESY_CHECK((File.Width == 64) && (File.Height == 32) && (File.Depth == 1));
+		GEODESY_CHECK((File.LayerCount == 1) && (File.FaceCount == 1));
+		GEODESY_CHECK(File.LevelCount == 7);
+		GEODESY_CHECK(!File.GenerateMipmaps);
+		GEODESY_CHECK(File.Supercompression == ktx2::NONE);
+		GEODESY_CHECK(File.Level.size() == 7);
+		GEODESY_CHECK((File.Level[6].ByteOffset == 1030) && (File.Level[6].ByteLength == 64));
+		GEODESY_CHECK(File.level_size(0) == 64 * 32 * 4);
+		GEODESY_CHECK(File.level_size(6) == 1 * 1 * 4);
+	}
+	std::filesystem::remove(Path);
+}
+
+GEODESY_TEST(ktx2_header_generate_mipmaps) {
+	// A level count of zero still indexes level 0.
+	ktx2_counts Counts;
+	Counts.LevelCount = 0;
+	std::string Path = write_ktx2("geodesy-gpu-ktx2-generate.ktx2", Counts, 1);
+	{
+		ktx2 File(Path);
+		GEODESY_CHECK(File.LevelCount == 1);
+		GEODESY_CHECK(File.GenerateMipmaps);
+	}
+	std::filesystem::remove(Path);
+}
+
+GEODESY_TEST(ktx2_header_bounds) {
+	ktx2_counts Counts;
+	std::string Path = "";
+
+	// 16 x 16 has five levels.
+	Counts.LevelCount = 5;
+	Path = write_ktx2("geodesy-gpu-ktx2-bounds.ktx2", Counts, 5);
+	GEODESY_CHECK(opens(Path));
+	Counts.LevelCount = 6;
+	Path = write_ktx2("geodesy-gpu-ktx2-bounds.ktx2", Counts, 6);
+	GEODESY_CHECK(!opens(Path));
+	Counts.LevelCount = 0xFFFFFFFF;
+	Path = write_ktx2("geodesy-gpu-ktx2-bounds.ktx2", Counts, 0);
+	GEODESY_CHECK(!opens(Path));
+	Counts.LevelCount = 1;
+
+	// Faces are 1 or 6, cube faces are square.
+	Counts.FaceCount = 6;
+	Path = write_ktx2("geodesy-gpu-ktx2-bounds.ktx2", Counts, 1);
+	GEODESY_CHECK(opens(Path));
+	Counts.Width = 8;
+	Path = write_ktx2("geodesy-gpu-ktx2-bounds.ktx2", Counts, 1);
+	GEODESY_CHECK(!opens(Path));
+	Counts.Width = 16;
+	Counts.FaceCount = 0;
+	Path = write_ktx2("geodesy-gpu-ktx2-bounds.ktx2", Counts, 1);
+	GEODESY_CHECK(!opens(Path));
+	Counts.FaceCount = 2;
+	Path = write_ktx2("geodesy-gpu-ktx2-bounds.ktx2", Counts, 1);
+	GEODESY_CHECK(!opens(Path));
+
+	// Layers times faces are limited by the array layer limit.
+	Counts.FaceCount = 6;
+	Counts.LayerCount = 42;
+	Path = write_ktx2("geodesy-gpu-ktx2-bounds.ktx2", Counts, 1);
+	GEODESY_CHECK(opens(Path));
+	Counts.LayerCount = 43;
+	Path = write_ktx2("geodesy-gpu-ktx2-bounds.ktx2", Counts, 1);
+	GEODESY_CHECK(!opens(Path));
+	GEODESY_CHECK(opens(Path, 2048));
+	Counts.LayerCount = 0xFFFFFFFF;
+	Path = write_ktx2("geodesy-gpu-ktx2-bounds.ktx2", Counts, 1);
+	GEODESY_CHECK(!opens(Path, 0xFFFFFFFF));
+
+	// Not a container, or truncated.
+	std::filesystem::resize_file(Path, 20);
+	GEODESY_CHECK(!opens(Path));
+	std::filesystem::remove(Path);
+}
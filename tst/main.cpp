@@ -2,10 +2,19 @@
 
 #include <iostream>
 
+#include "unit_test.h"
+
 int main(int argc, char* argv[]) {
     std::cout << "geodesy-gpu unit tests starting..." << std::endl;
 
-    // Unit tests go here
+    int FailedTestCount = 0;
+    for (const geodesy::gpu::test::test_case& Test : geodesy::gpu::test::registry()) {
+        int FailureCount = 0;
+        Test.Function(FailureCount);
+        std::cout << (FailureCount == 0 ? "[PASS] " : "[FAIL] ") << Test.Name << std::endl;
+        FailedTestCount += (FailureCount > 0) ? 1 : 0;
+    }
 
-    return 0;
+    std::cout << (geodesy::gpu::test::registry().size() - FailedTestCount) << "/" << geodesy::gpu::test::registry().size() << " tests passed." << std::endl;
+    return FailedTestCount > 0 ? 1 : 0;
 }
@@ -0,0 +1,48 @@
+#include <geodesy/gpu/mip_generator.h>
+
+#include <algorithm>
+
+#include "unit_test.h"
+
+using namespace geodesy::gpu;
+
+// Levels of each single pass dispatch over a full chain, as get_target() schedules them.
+static std::vector<uint32_t> single_pass_schedule(uint32_t aWidth, uint32_t aHeight, uint32_t aLevelCount) {
+	std::vector<uint32_t> Schedule;
+	for (uint32_t Base = 0; Base + 1 < aLevelCount;) {
+		uint32_t LevelCount = mip_generator::single_pass_level_count(std::max(1u, aWidth >> Base), std::max(1u, aHeight >> Base), aLevelCount - 1 - Base);
+		Schedule.push_back(LevelCount);
+		Base += LevelCount;
+	}
+	return Schedule;
+}
+
+GEODESY_TEST(mip_generator_single_pass_level_count) {
+	// Level 6 of a 4096 base is 64x64, one tile for the last work group.
+	GEODESY_CHECK(mip_generator::single_pass_level_count(4096, 4096, 12) == 12);
+	GEODESY_CHECK(mip_generator::single_pass_level_count(4096, 1024, 12) == 12);
+	GEODESY_CHECK(mip_generator::single_pass_level_count(64, 64, 6) == 6);
+
+	// Anything larger leaves more than one tile at level 6.
+	GEODESY_CHECK(mip_generator::single_pass_level_count(4097, 4097, 12) == 6);
+	GEODESY_CHECK(mip_generator::single_pass_level_count(6000, 6000, 12) == 6);
+	GEODESY_CHECK(mip_generator::single_pass_level_count(1024, 6000, 12) == 6);
+	GEODESY_CHECK(mip_generator::single_pass_level_count(8192, 8192, 13) == 6);
+
+	// Never more than the chain has left.
+	GEODESY_CHECK(mip_generator::single_pass_level_count(16, 16, 4) == 4);
+}
+
+GEODESY_TEST(mip_generator_single_pass_schedule) {
+	// 6000 texels, 13 levels. Level 6 is 93x93, reduced by a second dispatch.
+	std::vector<uint32_t> Schedule = single_pass_schedule(6000, 6000, 13);
+	GEODESY_CHECK((Schedule.size() == 2) && (Schedule[0] == 6) && (Schedule[1] == 6));
+
+	// 4096 texels, 13 levels, all twelve below the base in one dispatch.
+	Schedule = single_pass_schedule(4096, 4096, 13);
+	GEODESY_CHECK((Schedule.size() == 1) && (Schedule[0] == 12));
+
+	// 16384 texels, 15 levels.
+	Schedule = single_pass_schedule(16384, 16384, 15);
+	GEODESY_CHECK((Schedule.size() == 2) && (Schedule[0] == 6) && (Schedule[1] == 8));
+}
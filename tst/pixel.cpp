@@ -0,0 +1,282 @@
+#include <geodesy/gpu/pixel.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "unit_test.h"
+
+using namespace geodesy::gpu;
+
+// Counts that cover whole vector iterations, their tails, and arrays shorter than one vector.
+static const size_t KernelCount[] = { 0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 257 };
+
+// Deterministic test data.
+static uint32_t next_random(uint32_t& aState) {
+	aState = aState * 1664525u + 1013904223u;
+	return aState >> 8;
+}
+
+static std::vector<uint8_t> random_bytes(size_t aCount, uint32_t aSeed) {
+	std::vector<uint8_t> Byte(aCount);
+	for (uint8_t& Value : Byte) {
+		Value = (uint8_t)next_random(aSeed);
+	}
+	return Byte;
+}
+
+GEODESY_TEST(pixel_format_traits) {
+	// R16G16 formats are two 16 bit channels.
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_R16G16_UNORM).BitsPerPixel == 32);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_R16G16_SFLOAT).BitsPerPixel == 32);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_R16G16_SFLOAT).BlockSize == 4);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_R16G16_SFLOAT).ChannelCount == 2);
+
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_R8G8B8_UNORM).BlockSize == 3);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_R8G8B8A8_SRGB).BitsPerPixel == 32);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_R8G8B8A8_SRGB).ChannelCount == 4);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_R32G32B32A32_SFLOAT).BlockSize == 16);
+
+	// Block compressed.
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_BC1_RGB_UNORM_BLOCK).BitsPerPixel == 0);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_BC1_RGB_UNORM_BLOCK).BlockWidth == 4);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_BC1_RGB_UNORM_BLOCK).BlockHeight == 4);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_BC1_RGB_UNORM_BLOCK).BlockSize == 8);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_BC7_SRGB_BLOCK).BlockSize == 16);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_ASTC_8x6_UNORM_BLOCK).BlockWidth == 8);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_ASTC_8x6_UNORM_BLOCK).BlockHeight == 6);
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_ASTC_8x6_UNORM_BLOCK).BlockSize == 16);
+
+	// Unknown formats.
+	GEODESY_CHECK(pixel::traits(VK_FORMAT_UNDEFINED).BlockSize == 0);
+	GEODESY_CHECK(pixel::traits(-1).BlockSize == 0);
+
+	// The table agrees with the switches it was built from.
+	bool Consistent = true;
+	for (int Format = 0; Format < (int)pixel::CoreFormatCount; Format++) {
+		pixel::format_traits Traits = pixel::traits(Format);
+		Consistent = Consistent
+			&& (Traits.BitsPerPixel == pixel::format_bits_per_pixel(Format))
+			&& (Traits.ChannelCount == pixel::format_channel_count(Format))
+			&& (Traits.BlockWidth == pixel::format_block_width(Format))
+			&& (Traits.BlockHeight == pixel::format_block_height(Format))
+			&& (Traits.BlockSize == pixel::format_block_size(Format));
+	}
+	GEODESY_CHECK(Consistent);
+}
+
+GEODESY_TEST(pixel_fill) {
+	const size_t PixelSize[] = { 1, 2, 3, 4, 5, 8, 12, 16, 20 };
+	for (size_t Size : PixelSize) {
+		std::vector<uint8_t> Pixel = random_bytes(Size, (uint32_t)Size);
+		for (size_t Count : KernelCount) {
+			std::vector<uint8_t> Destination(Size * Count + 1, 0xCD);
+			pixel::fill(Destination.data(), Pixel.data(), Size, Count);
+			bool Match = true;
+			for (size_t i = 0; i < Count; i++) {
+				Match = Match && (std::memcmp(Destination.data() + i * Size, Pixel.data(), Size) == 0);
+			}
+			GEODESY_CHECK(Match);
+			// Nothing written past the end.
+			GEODESY_CHECK(Destination.back() == 0xCD);
+		}
+	}
+}
+
+GEODESY_TEST(pixel_swizzle_rgba8_bgra8) {
+	for (size_t Count : KernelCount) {
+		std::vector<uint8_t> Source = random_bytes(4 * Count, 7);
+		std::vector<uint8_t> Destination(4 * Count);
+		pixel::swizzle_rgba8_bgra8(Destination.data(), Source.data(), Count);
+		bool Match = true;
+		for (size_t i = 0; i < Count; i++) {
+			Match = Match
+				&& (Destination[4 * i + 0] == Source[4 * i + 2])
+				&& (Destination[4 * i + 1] == Source[4 * i + 1])
+				&& (Destination[4 * i + 2] == Source[4 * i + 0])
+				&& (Destination[4 * i + 3] == Source[4 * i + 3]);
+		}
+		GEODESY_CHECK(Match);
+
+		// In place, twice is the identity.
+		std::vector<uint8_t> InPlace = Source;
+		pixel::swizzle_rgba8_bgra8(InPlace.data(), InPlace.data(), Count);
+		GEODESY_CHECK(InPlace == Destination);
+		pixel::swizzle_rgba8_bgra8(InPlace.data(), InPlace.data(), Count);
+		GEODESY_CHECK(InPlace == Source);
+	}
+}
+
+GEODESY_TEST(pixel_unorm8_float) {
+	std::vector<uint8_t> Byte(256);
+	for (size_t i = 0; i < Byte.size(); i++) {
+		Byte[i] = (uint8_t)i;
+	}
+	std::vector<float> Value(256);
+	pixel::unorm8_to_float(Value.data(), Byte.data(), Byte.size());
+	bool Match = true;
+	for (size_t i = 0; i < Value.size(); i++) {
+		Match = Match && (std::fabs(Value[i] - (float)i / 255.0f) < 1e-6f);
+	}
+	GEODESY_CHECK(Match);
+
+	std::vector<uint8_t> RoundTrip(256);
+	pixel::float_to_unorm8(RoundTrip.data(), Value.data(), Value.size());
+	GEODESY_CHECK(RoundTrip == Byte);
+
+	// Clamped, NaN to zero, rounded to nearest, through both the vector body and the tail.
+	std::vector<float> Edge = { -1.0f, 2.0f, NAN, 0.5f / 255.0f + 1e-4f, 254.6f / 255.0f, 1.0f, 0.0f, -0.0f };
+	std::vector<uint8_t> Expected = { 0, 255, 0, 1, 255, 255, 0, 0 };
+	for (size_t Repeat = 0; Repeat < 3; Repeat++) {
+		std::vector<float> Source;
+		std::vector<uint8_t> Reference;
+		for (size_t i = 0; i < 2 * Repeat + 1; i++) {
+			Source.insert(Source.end(), Edge.begin(), Edge.end());
+			Reference.insert(Reference.end(), Expected.begin(), Expected.end());
+		}
+		std::vector<uint8_t> Destination(Source.size());
+		pixel::float_to_unorm8(Destination.data(), Source.data(), Source.size());
+		GEODESY_CHECK(Destination == Reference);
+	}
+}
+
+GEODESY_TEST(pixel_srgb8_round_trip) {
+	std::vector<uint8_t> Byte(4 * 256);
+	for (size_t i = 0; i < Byte.size(); i++) {
+		Byte[i] = (uint8_t)(i / 4);
+	}
+	std::vector<float> Linear(Byte.size());
+	std::vector<uint8_t> RoundTrip(Byte.size());
+	pixel::srgb8_to_linear(Linear.data(), Byte.data(), 256, 4);
+	pixel::linear_to_srgb8(RoundTrip.data(), Linear.data(), 256, 4);
+	GEODESY_CHECK(RoundTrip == Byte);
+	// Alpha is linear.
+	GEODESY_CHECK(std::fabs(Linear[4 * 128 + 3] - 128.0f / 255.0f) < 1e-6f);
+	GEODESY_CHECK(Linear[4 * 128 + 0] < 0.22f);
+
+	pixel::srgb8_to_linear(Linear.data(), Byte.data(), 256 * 4, 1);
+	pixel::linear_to_srgb8(RoundTrip.data(), Linear.data(), 256 * 4, 1);
+	GEODESY_CHECK(RoundTrip == Byte);
+}
+
+GEODESY_TEST(pixel_half_float) {
+	// Every finite half survives the round trip, infinities too.
+	std::vector<uint16_t> Half(65536);
+	for (size_t i = 0; i < Half.size(); i++) {
+		Half[i] = (uint16_t)i;
+	}
+	std::vector<float> Value(Half.size());
+	std::vector<uint16_t> RoundTrip(Half.size());
+	pixel::half_to_float(Value.data(), Half.data(), Half.size());
+	pixel::float_to_half(RoundTrip.data(), Value.data(), Value.size());
+	bool Match = true;
+	for (size_t i = 0; i < Half.size(); i++) {
+		bool NaN = ((Half[i] & 0x7C00) == 0x7C00) && ((Half[i] & 0x03FF) != 0);
+		if (NaN) {
+			Match = Match && std::isnan(Value[i]) && ((RoundTrip[i] & 0x7C00) == 0x7C00) && ((RoundTrip[i] & 0x03FF) != 0);
+		}
+		else {
+			Match = Match && (RoundTrip[i] == Half[i]);
+		}
+	}
+	GEODESY_CHECK(Match);
+	GEODESY_CHECK(Value[0x3C00] == 1.0f);
+	GEODESY_CHECK(Value[0xC000] == -2.0f);
+	GEODESY_CHECK(Value[0x0001] == std::ldexp(1.0f, -24));
+
+	// Rounding to nearest even, overflow to infinity, underflow to zero, repeated past one vector.
+	const float Source[] = {
+		1.0f + std::ldexp(1.0f, -11), 			// Halfway, even is down.
+		1.0f + 3.0f * std::ldexp(1.0f, -11), 	// Halfway, even is up.
+		65504.0f, 65520.0f, -1e10f, 1e-10f, std::ldexp(1.0f, -25) * 1.5f
+	};
+	const uint16_t Expected[] = { 0x3C00, 0x3C02, 0x7BFF, 0x7C00, 0xFC00, 0x0000, 0x0001 };
+	const size_t Count = sizeof(Source) / sizeof(Source[0]);
+	std::vector<float> Repeated;
+	std::vector<uint16_t> Reference;
+	for (size_t Repeat = 0; Repeat < 5; Repeat++) {
+		Repeated.insert(Repeated.end(), Source, Source + Count);
+		Reference.insert(Reference.end(), Expected, Expected + Count);
+	}
+	std::vector<uint16_t> Destination(Repeated.size());
+	pixel::float_to_half(Destination.data(), Repeated.data(), Repeated.size());
+	GEODESY_CHECK(Destination == Reference);
+}
+
+GEODESY_TEST(pixel_rgb_to_rgba) {
+	for (size_t Count : KernelCount) {
+		std::vector<uint8_t> Source = random_bytes(3 * Count, 11);
+		std::vector<uint8_t> Destination(4 * Count);
+		pixel::rgb8_to_rgba8(Destination.data(), Source.data(), Count, 0x80);
+		bool Match = true;
+		for (size_t i = 0; i < Count; i++) {
+			Match = Match
+				&& (Destination[4 * i + 0] == Source[3 * i + 0])
+				&& (Destination[4 * i + 1] == Source[3 * i + 1])
+				&& (Destination[4 * i + 2] == Source[3 * i + 2])
+				&& (Destination[4 * i + 3] == 0x80);
+		}
+		GEODESY_CHECK(Match);
+
+		std::vector<float> SourceFloat(3 * Count);
+		for (size_t i = 0; i < SourceFloat.size(); i++) {
+			SourceFloat[i] = (float)i * 0.25f;
+		}
+		std::vector<float> DestinationFloat(4 * Count);
+		pixel::rgb32f_to_rgba32f(DestinationFloat.data(), SourceFloat.data(), Count, 0.5f);
+		Match = true;
+		for (size_t i = 0; i < Count; i++) {
+			Match = Match
+				&& (DestinationFloat[4 * i + 0] == SourceFloat[3 * i + 0])
+				&& (DestinationFloat[4 * i + 1] == SourceFloat[3 * i + 1])
+				&& (DestinationFloat[4 * i + 2] == SourceFloat[3 * i + 2])
+				&& (DestinationFloat[4 * i + 3] == 0.5f);
+		}
+		GEODESY_CHECK(Match);
+	}
+}
+
+GEODESY_TEST(pixel_coverage) {
+	const size_t Stride[] = { 1, 2, 3, 4 };
+	for (size_t S : Stride) {
+		for (size_t Count : KernelCount) {
+			// Alpha values biased towards the thresholds.
+			std::vector<uint8_t> Byte = random_bytes(Count * S, (uint32_t)(Count + S));
+			for (size_t i = 0; i < Byte.size(); i++) {
+				if ((Byte[i] % 3) == 0) Byte[i] = 0x00;
+				else if ((Byte[i] % 3) == 1) Byte[i] = 0xFF;
+			}
+			pixel::coverage Expected = { 0, 0, 0 };
+			for (size_t i = 0; i < Count; i++) {
+				Expected.Opaque 		+= (Byte[i * S] == 0xFF);
+				Expected.Transparent 	+= (Byte[i * S] == 0x00);
+			}
+			Expected.Translucent = Count - Expected.Opaque - Expected.Transparent;
+			pixel::coverage Coverage = pixel::coverage_unorm8(Byte.data(), Count, S);
+			GEODESY_CHECK((Coverage.Opaque == Expected.Opaque) && (Coverage.Transparent == Expected.Transparent) && (Coverage.Translucent == Expected.Translucent));
+
+			// The same alpha as floats, halves and 16 bit unorm classifies the same way.
+			std::vector<float> Float(Byte.size());
+			pixel::unorm8_to_float(Float.data(), Byte.data(), Byte.size());
+			Coverage = pixel::coverage_float(Float.data(), Count, S);
+			GEODESY_CHECK((Coverage.Opaque == Expected.Opaque) && (Coverage.Transparent == Expected.Transparent) && (Coverage.Translucent == Expected.Translucent));
+
+			std::vector<uint16_t> Half(Float.size());
+			pixel::float_to_half(Half.data(), Float.data(), Float.size());
+			Coverage = pixel::coverage_half(Half.data(), Count, S);
+			GEODESY_CHECK((Coverage.Opaque == Expected.Opaque) && (Coverage.Transparent == Expected.Transparent) && (Coverage.Translucent == Expected.Translucent));
+
+			std::vector<uint16_t> Short(Byte.size());
+			for (size_t i = 0; i < Short.size(); i++) {
+				Short[i] = (uint16_t)(Byte[i] * 257);
+			}
+			Coverage = pixel::coverage_unorm16(Short.data(), Count, S);
+			GEODESY_CHECK((Coverage.Opaque == Expected.Opaque) && (Coverage.Transparent == Expected.Transparent) && (Coverage.Translucent == Expected.Translucent));
+		}
+	}
+
+	// Values just inside and outside the float thresholds.
+	const float Alpha[] = { pixel::OpaqueThreshold, std::nextafter(pixel::OpaqueThreshold, 0.0f), pixel::TransparentThreshold, std::nextafter(pixel::TransparentThreshold, 1.0f), 0.5f };
+	pixel::coverage Coverage = pixel::coverage_float(Alpha, 5, 1);
+	GEODESY_CHECK((Coverage.Opaque == 1) && (Coverage.Transparent == 1) && (Coverage.Translucent == 3));
+}
@@ -0,0 +1,30 @@
+#include <geodesy/gpu/shader.h>
+#include <geodesy/gpu/worker_pool.h>
+
+#include "unit_test.h"
+
+using namespace geodesy::gpu;
+
+GEODESY_TEST(shader_concurrent_compile) {
+	GEODESY_CHECK(shader::initialize());
+	{
+		// Every pipeline sharing a shader may ask for it to be parsed at the same time.
+		std::shared_ptr<shader> Compute = std::make_shared<shader>(shader::stage::COMPUTE, "#version 450\nlayout(local_size_x = 8) in;\nvoid main() {}\n");
+		worker_pool Pool(8);
+		std::vector<std::future<bool>> Result;
+		for (int i = 0; i < 64; i++) {
+			Result.push_back(Pool.submit([Compute]() { return Compute->compile(); }));
+		}
+		for (std::future<bool>& Compiled : Result) {
+			GEODESY_CHECK(Compiled.get());
+		}
+		GEODESY_CHECK(Compute->Handle != nullptr);
+
+		// A failed parse keeps failing instead of reporting the stale handle as compiled.
+		std::shared_ptr<shader> Broken = std::make_shared<shader>(shader::stage::COMPUTE, "#version 450\nvoid main() { undeclared = 1; }\n");
+		GEODESY_CHECK(!Broken->compile());
+		GEODESY_CHECK(!Broken->compile());
+		GEODESY_CHECK(Broken->info_log().size() > 0);
+	}
+	shader::terminate();
+}
@@ -0,0 +1,118 @@
+#include <geodesy/gpu/shader_cache.h>
+
+#include <filesystem>
+#include <set>
+
+#include "unit_test.h"
+
+using namespace geodesy::gpu;
+
+static shader_cache::program sample_program() {
+	shader_cache::program Program;
+	Program.ShaderKey 					= { 0x0123456789ABCDEFull, 0xFEDCBA9876543210ull };
+	Program.ByteCode 					= { { 0x07230203, 0x00010400, 1, 2, 3 }, { 0x07230203, 0x00010400 } };
+	Program.DescriptorSetLayoutBinding 	= {
+		{ { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, 0x1, NULL }, { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, 0x10, NULL } },
+		{},
+		{ { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, 0x11, NULL } }
+	};
+	Program.VertexAttribute 			= { { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 }, { 1, 0, VK_FORMAT_R32G32_SFLOAT, 12 } };
+	Program.ColorAttachmentFormat 		= { VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT };
+	return Program;
+}
+
+static bool same_program(const shader_cache::program& aLHS, const shader_cache::program& aRHS) {
+	if ((aLHS.ShaderKey != aRHS.ShaderKey) || (aLHS.ByteCode != aRHS.ByteCode)) return false;
+	if (aLHS.DescriptorSetLayoutBinding.size() != aRHS.DescriptorSetLayoutBinding.size()) return false;
+	for (size_t i = 0; i < aLHS.DescriptorSetLayoutBinding.size(); i++) {
+		if (aLHS.DescriptorSetLayoutBinding[i].size() != aRHS.DescriptorSetLayoutBinding[i].size()) return false;
+		for (size_t j = 0; j < aLHS.DescriptorSetLayoutBinding[i].size(); j++) {
+			const VkDescriptorSetLayoutBinding& L = aLHS.DescriptorSetLayoutBinding[i][j];
+			const VkDescriptorSetLayoutBinding& R = aRHS.DescriptorSetLayoutBinding[i][j];
+			if ((L.binding != R.binding) || (L.descriptorType != R.descriptorType) || (L.descriptorCount != R.descriptorCount) || (L.stageFlags != R.stageFlags)) return false;
+		}
+	}
+	if (aLHS.VertexAttribute.size() != aRHS.VertexAttribute.size()) return false;
+	for (size_t i = 0; i < aLHS.VertexAttribute.size(); i++) {
+		const VkVertexInputAttributeDescription& L = aLHS.VertexAttribute[i];
+		const VkVertexInputAttributeDescription& R = aRHS.VertexAttribute[i];
+		if ((L.location != R.location) || (L.binding != R.binding) || (L.format != R.format) || (L.offset != R.offset)) return false;
+	}
+	return aLHS.ColorAttachmentFormat == aRHS.ColorAttachmentFormat;
+}
+
+GEODESY_TEST(shader_cache_serialize_round_trip) {
+	const uint64_t Key = shader_cache::hash("round trip");
+	shader_cache::program Program = sample_program();
+	std::vector<uint8_t> Data = shader_cache::serialize(Key, Program);
+
+	shader_cache::program Loaded;
+	GEODESY_CHECK(shader_cache::deserialize(Key, Data, Loaded));
+	GEODESY_CHECK(same_program(Program, Loaded));
+
+	// Empty programs survive as well.
+	shader_cache::program Empty;
+	GEODESY_CHECK(shader_cache::deserialize(Key, shader_cache::serialize(Key, Empty), Loaded));
+	GEODESY_CHECK(same_program(Empty, Loaded));
+}
+
+GEODESY_TEST(shader_cache_deserialize_rejects_foreign_data) {
+	const uint64_t Key = shader_cache::hash("foreign");
+	std::vector<uint8_t> Data = shader_cache::serialize(Key, sample_program());
+	shader_cache::program Loaded;
+
+	// Entry written for another key, i.e. a hash collision on the file name.
+	GEODESY_CHECK(!shader_cache::deserialize(Key + 1, Data, Loaded));
+
+	// Every truncation is rejected rather than read past the end.
+	for (size_t Size = 0; Size < Data.size(); Size++) {
+		std::vector<uint8_t> Truncated(Data.begin(), Data.begin() + Size);
+		GEODESY_CHECK(!shader_cache::deserialize(Key, Truncated, Loaded));
+	}
+
+	// Bad magic and version.
+	std::vector<uint8_t> Corrupt = Data;
+	Corrupt[0] ^= 0xFF;
+	GEODESY_CHECK(!shader_cache::deserialize(Key, Corrupt, Loaded));
+	Corrupt = Data;
+	Corrupt[4] ^= 0xFF;
+	GEODESY_CHECK(!shader_cache::deserialize(Key, Corrupt, Loaded));
+}
+
+GEODESY_TEST(shader_cache_disk_round_trip) {
+	std::error_code ErrorCode;
+	std::filesystem::path Directory = std::filesystem::temp_directory_path(ErrorCode) / ("geodesy-gpu-shader-cache-" + std::to_string(shader_cache::hash(shader_cache::temporary_path("test"))));
+	const uint64_t Key = shader_cache::hash("disk");
+	shader_cache::program Program = sample_program();
+	{
+		shader_cache Writer(Directory.string());
+		Writer.insert(Key, Program);
+	}
+	{
+		// Fresh instance, so the entry can only come from disk.
+		shader_cache Reader(Directory.string());
+		shader_cache::program Loaded;
+		GEODESY_CHECK(Reader.find(Key, Loaded));
+		GEODESY_CHECK(same_program(Program, Loaded));
+		GEODESY_CHECK(!Reader.find(Key + 1, Loaded));
+	}
+
+	// No temporary files are left behind.
+	size_t FileCount = 0;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(Directory, ErrorCode)) {
+		GEODESY_CHECK(Entry.path().extension() == ".spvc");
+		FileCount++;
+	}
+	GEODESY_CHECK(FileCount == 1);
+	std::filesystem::remove_all(Directory, ErrorCode);
+}
+
+GEODESY_TEST(shader_cache_temporary_path_is_unique) {
+	std::set<std::string> Path;
+	for (int i = 0; i < 64; i++) {
+		std::string TemporaryPath = shader_cache::temporary_path("entry.spvc");
+		GEODESY_CHECK(TemporaryPath.rfind("entry.spvc.", 0) == 0);
+		Path.insert(TemporaryPath);
+	}
+	GEODESY_CHECK(Path.size() == 64);
+}
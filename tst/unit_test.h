@@ -0,0 +1,43 @@
+#pragma once
+#ifndef GEODESY_GPU_UNIT_TEST_H
+#define GEODESY_GPU_UNIT_TEST_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Minimal self registering test harness, tests run without a device and only cover host side code.
+namespace geodesy::gpu::test {
+
+	struct test_case {
+		std::string 	Name;
+		void 			(*Function)(int& aFailureCount);
+	};
+
+	inline std::vector<test_case>& registry() {
+		static std::vector<test_case> Registry;
+		return Registry;
+	}
+
+	struct registrar {
+		registrar(const char* aName, void (*aFunction)(int&)) {
+			registry().push_back({ aName, aFunction });
+		}
+	};
+
+}
+
+#define GEODESY_TEST(Name) \
+	static void Name(int& aFailureCount); \
+	static geodesy::gpu::test::registrar Name##Registrar(#Name, Name); \
+	static void Name(int& aFailureCount)
+
+#define GEODESY_CHECK(Expression) \
+	do { \
+		if (!(Expression)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #Expression << std::endl; \
+			aFailureCount++; \
+		} \
+	} while (0)
+
+#endif // !GEODESY_GPU_UNIT_TEST_H
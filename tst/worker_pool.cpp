@@ -0,0 +1,55 @@
+#include <geodesy/gpu/worker_pool.h>
+
+#include <atomic>
+#include <stdexcept>
+
+#include "unit_test.h"
+
+using namespace geodesy::gpu;
+
+GEODESY_TEST(worker_pool_returns_results) {
+	worker_pool Pool(4);
+	GEODESY_CHECK(Pool.size() == 4);
+	GEODESY_CHECK(!Pool.is_worker_thread());
+
+	std::vector<std::future<int>> Result;
+	for (int i = 0; i < 256; i++) {
+		Result.push_back(Pool.submit([i]() { return i * i; }));
+	}
+	for (int i = 0; i < 256; i++) {
+		GEODESY_CHECK(Result[i].get() == i * i);
+	}
+
+	std::future<bool> OnWorker = Pool.submit([&Pool]() { return Pool.is_worker_thread(); });
+	GEODESY_CHECK(OnWorker.get());
+}
+
+GEODESY_TEST(worker_pool_propagates_exceptions) {
+	worker_pool Pool(2);
+	std::future<int> Failed = Pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+	bool Thrown = false;
+	try {
+		Failed.get();
+	} catch (const std::runtime_error&) {
+		Thrown = true;
+	}
+	GEODESY_CHECK(Thrown);
+
+	// The worker survives a throwing task.
+	GEODESY_CHECK(Pool.submit([]() { return 7; }).get() == 7);
+}
+
+GEODESY_TEST(worker_pool_drains_on_destruction) {
+	std::atomic<int> Count(0);
+	{
+		worker_pool Pool(3);
+		for (int i = 0; i < 1000; i++) {
+			Pool.submit([&Count]() { Count.fetch_add(1); });
+		}
+	}
+	GEODESY_CHECK(Count.load() == 1000);
+
+	// Zero picks the hardware thread count, never less than one.
+	worker_pool Default;
+	GEODESY_CHECK(Default.size() >= 1);
+}